@@ -56,10 +56,30 @@ int testCommand = 1000;
 #define RATE_FLIGHT_MODE 0
 #define ATTITUDE_FLIGHT_MODE 1
 byte previousFlightMode = ATTITUDE_FLIGHT_MODE;
-#define TASK_100HZ 1
-#define TASK_50HZ 2
-#define TASK_10HZ 10
-#define TASK_1HZ 100
+
+// Inner loop (sensor evaluation, kinematics, PID, mixer) rate in Hz, the
+// other tasks keep their rate and run every TASK_xxHZ inner loop frames
+#ifndef CONTROL_LOOP_RATE
+  #define CONTROL_LOOP_RATE 100
+#endif
+#if CONTROL_LOOP_RATE != 100 && CONTROL_LOOP_RATE != 200 && CONTROL_LOOP_RATE != 400 && CONTROL_LOOP_RATE != 500
+  #error "CONTROL_LOOP_RATE must be 100, 200, 400 or 500"
+#endif
+#if CONTROL_LOOP_RATE != 100 && !defined(AeroQuadSTM32)
+  #error "CONTROL_LOOP_RATE above 100 needs an AeroQuad32 board"
+#endif
+#if defined(DynamicNotch) && CONTROL_LOOP_RATE < 200
+  #error "DynamicNotch needs CONTROL_LOOP_RATE 200 or more"
+#endif
+#if defined(MavLinkHIL) && !defined(AeroQuadSTM32)
+  #error "MavLinkHIL needs an AeroQuad32 board"
+#endif
+#define CONTROL_LOOP_PERIOD (1000000 / CONTROL_LOOP_RATE)  // us
+
+#define TASK_100HZ (CONTROL_LOOP_RATE / 100)
+#define TASK_50HZ (CONTROL_LOOP_RATE / 50)
+#define TASK_10HZ (CONTROL_LOOP_RATE / 10)
+#define TASK_1HZ CONTROL_LOOP_RATE
 #define THROTTLE_ADJUST_TASK_SPEED TASK_50HZ
 
 byte flightMode = RATE_FLIGHT_MODE;
@@ -87,6 +107,11 @@ unsigned long lowPriorityTenHZpreviousTime = 0;
 unsigned long lowPriorityTenHZpreviousTime2 = 0;
 unsigned long fiftyHZpreviousTime = 0;
 unsigned long hundredHZpreviousTime = 0;
+unsigned long controlLoopPreviousTime = 0;
+#if defined(MPU6000_FIFO)
+  unsigned long controlLoopPreviousSampleTime = 0;
+  float controlLoopSampleDt = CONTROL_LOOP_PERIOD / 1000000.0;
+#endif
 
 
 
@@ -112,7 +137,7 @@ float headingHold         = 0; // calculated adjustment for quad to go to headin
 float heading             = 0; // measured heading from yaw gyro (process variable)
 float relativeHeading     = 0; // current heading the quad is set to (set point)
 byte  headingHoldState    = OFF;
-void  processHeading();
+void  processHeading(struct ControlSetpoint *setpoint);
 //////////////////////////////////////////////////////
 
 
@@ -331,12 +356,23 @@ typedef struct {
   // GPS mission storing
   float GPS_MISSION_NB_POINT_ADR;
   GeodeticPosition WAYPOINT_ADR[MAX_WAYPOINTS];
+  // Mag soft iron calibration, row major
+  float MAG_SOFT_IRON_ADR[9];
+  // Gyro temperature compensation model
+  float GYRO_TEMP_WEIGHT_ADR;
+  float GYRO_TEMP_MEAN_ADR;
+  float GYRO_TEMP_VARIANCE_ADR;
+  float GYRO_TEMP_MIN_ADR;
+  float GYRO_TEMP_MAX_ADR;
+  float GYRO_TEMP_BIAS_ADR[3];
+  float GYRO_TEMP_COVARIANCE_ADR[3];
 } t_NVR_Data;  
 
 
 void readEEPROM(); 
 void initSensorsZeroFromEEPROM();
 void storeSensorsZeroToEEPROM();
+void storeGyroTempCompensationToEEPROM();
 void initReceiverFromEEPROM();
 
 float nvrReadFloat(int address); // defined in DataStorage.h
@@ -346,7 +382,7 @@ void nvrWriteLong(long value, int address); // defined in DataStorage.h
 void nvrReadPID(unsigned char IDPid, unsigned int IDEeprom);
 void nvrWritePID(unsigned char IDPid, unsigned int IDEeprom);
 
-#define GET_NVR_OFFSET(param) ((int)&(((t_NVR_Data*) 0)->param))
+#define GET_NVR_OFFSET(param) ((int)(size_t)&(((t_NVR_Data*) 0)->param))
 #define readFloat(addr) nvrReadFloat(GET_NVR_OFFSET(addr))
 #define writeFloat(value, addr) nvrWriteFloat(value, GET_NVR_OFFSET(addr))
 #define readLong(addr) nvrReadLong(GET_NVR_OFFSET(addr))
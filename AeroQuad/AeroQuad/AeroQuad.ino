@@ -44,6 +44,14 @@
   #error "AutoLanding NEED AltitudeHoldBaro and AltitudeHoldRangeFinder defined"
 #endif
 
+#if defined(PIDAutotune) && defined(AutoLanding)
+  #error "PIDAutotune and AutoLanding both use AUX3, they can't be used together"
+#endif
+
+#if defined(PIDAutotune) && LASTCHANNEL < 8
+  #error "PIDAutotune is switched by AUX3, it needs LASTCHANNEL 8 or more"
+#endif
+
 #if defined(ReceiverSBUS) && defined(SlowTelemetry)
   #error "Receiver SWBUS and SlowTelemetry are in conflict for Seria2, they can't be used together"
 #endif
@@ -52,13 +60,25 @@
   #error "CameraTXControl need to have CameraControl defined"
 #endif 
 
+#if defined(MavLinkHIL) && (!defined(MavLink) || defined(SerialMux))
+  #error "MavLinkHIL needs MavLink on its own serial port, without SerialMux"
+#endif
+
 #include <EEPROM.h>
 #include <Wire.h>
 #include <GlobalDefined.h>
 #include "AeroQuad.h"
 #include "PID.h"
 #include <AQMath.h>
+#include <FastTrig.h>
+#include <NumberFormat.h>
+#include <BackgroundADC.h>
 #include <FourtOrderFilter.h>
+#if defined(DynamicNotch)
+  #include <DynamicNotch.h>
+#else
+  #include <DynamicNotchLayout.h>   // size of the '0' reply
+#endif
 #ifdef BattMonitor
   #include <BatteryMonitorTypes.h>
 #endif
@@ -382,7 +402,7 @@
    * Measure critical sensors
    */
   void measureCriticalSensors() {
-    if (deltaTime >= 10000) {
+    if (deltaTime >= CONTROL_LOOP_PERIOD) {
       measureGyro();
       measureAccel();
     }
@@ -754,7 +774,7 @@
    * Measure critical sensors
    */
   void measureCriticalSensors() {
-    if (deltaTime >= 10000) {
+    if (deltaTime >= CONTROL_LOOP_PERIOD) {
       readWiiSensors();
       measureGyro();
       measureAccel();
@@ -844,7 +864,7 @@
    * Measure critical sensors
    */
   void measureCriticalSensors() {
-    if (deltaTime >= 10000) {
+    if (deltaTime >= CONTROL_LOOP_PERIOD) {
       readWiiSensors();
       measureGyro();
       measureAccel();
@@ -942,8 +962,8 @@
    * Measure critical sensors
    */
   void measureCriticalSensors() {
-    if (deltaTime >= 10000) {
-      chr6dm.read();
+    chr6dm.read();    // non blocking, takes whatever bytes have arrived
+    if (deltaTime >= CONTROL_LOOP_PERIOD) {
       measureGyro();
       measureAccel();
     }
@@ -1045,8 +1065,8 @@
    * Measure critical sensors
    */
   void measureCriticalSensors() {
-    if (deltaTime >= 10000) {
-      chr6dm.read();
+    chr6dm.read();    // non blocking, takes whatever bytes have arrived
+    if (deltaTime >= CONTROL_LOOP_PERIOD) {
       measureGyro();
       measureAccel();
     }
@@ -1135,6 +1155,11 @@
   #include <Motors_STM32.h>    
 #endif
 
+// only the ITG3200 and MPU6000 gyro drivers report a temperature
+#if defined(GyroTempCompensation) && !defined(_AEROQUAD_GYRO_TEMPERATURE_COMPENSATION_H_)
+  #undef GyroTempCompensation
+#endif
+
 //********************************************************
 //******* HEADING HOLD MAGNETOMETER DECLARATION **********
 //********************************************************
@@ -1244,20 +1269,48 @@
 //********************************************************
 #if defined(WirelessTelemetry) 
   #if defined(__AVR_ATmega1280__) || defined(__AVR_ATmega2560__)
-    #define SERIAL_PORT Serial3
+    #define SERIAL_LINK Serial3
   #else    // force 328p to use the normal port
-    #define SERIAL_PORT Serial
+    #define SERIAL_LINK Serial
   #endif
 #else  
   #if defined(SERIAL_USES_USB)   // STM32 Maple
-    #define SERIAL_PORT SerialUSB
+    #define SERIAL_LINK SerialUSB
     #undef BAUD
     #define BAUD
   #else
-    #define SERIAL_PORT Serial
+    #define SERIAL_LINK Serial
   #endif
 #endif  
 
+#if defined(SerialMux)
+  // SERIAL_PORT is the Configurator channel, the channels share the port chosen above
+  #define SERIAL_MUX_LINK SERIAL_LINK
+  #define SERIAL_PORT serialMuxConfigurator
+  #include <SerialMux.h>
+
+  #define SERIAL_MUX_CONFIGURATOR_CHANNEL 0
+  #define SERIAL_MUX_MAVLINK_CHANNEL 1
+  #define SERIAL_MUX_LOG_CHANNEL 2
+
+  byte serialMuxConfiguratorTx[384];
+  byte serialMuxConfiguratorRx[64];
+  SerialMuxChannel serialMuxConfigurator(SERIAL_MUX_CONFIGURATOR_CHANNEL, 2, 24, serialMuxConfiguratorTx, sizeof(serialMuxConfiguratorTx), serialMuxConfiguratorRx, sizeof(serialMuxConfiguratorRx));
+  #if defined(MavLink)
+    byte serialMuxMavLinkTx[256];
+    byte serialMuxMavLinkRx[128];
+    SerialMuxChannel serialMuxMavLink(SERIAL_MUX_MAVLINK_CHANNEL, 1, 32, serialMuxMavLinkTx, sizeof(serialMuxMavLinkTx), serialMuxMavLinkRx, sizeof(serialMuxMavLinkRx));
+  #endif
+  #if defined(BinaryWrite) && !defined(OpenlogBinaryWrite)
+    byte serialMuxLogTx[256];
+    byte serialMuxLogRx[2];
+    SerialMuxChannel serialMuxLog(SERIAL_MUX_LOG_CHANNEL, 0, 64, serialMuxLogTx, sizeof(serialMuxLogTx), serialMuxLogRx, sizeof(serialMuxLogRx));
+    SerialMuxChannel *binaryPort = &serialMuxLog;
+  #endif
+#else
+  #define SERIAL_PORT SERIAL_LINK
+#endif
+
 #ifdef SlowTelemetry
   #include <AQ_RSCode.h>
 #endif
@@ -1268,6 +1321,13 @@
 
 
 // Include this last as it contains objects from above declarations
+#include "ControlSetpoint.h"
+#if defined(PIDAutotune)
+  #include <RelayAutotune.h>
+  #include "AutotuneProcessor.h"
+#else
+  #include "AutotuneLayout.h"       // size of the '@' reply
+#endif
 #include "AltitudeControlProcessor.h"
 #include "FlightControlProcessor.h"
 #include "FlightCommandProcessor.h"
@@ -1278,9 +1338,25 @@
   #include "LedStatusProcessor.h"
 #endif  
 
-#if defined(MavLink)
+#if defined(SerialMux) && defined(MavLink)
+  // both protocols at once, MavLink gets its own channel and entry points
+  #undef SERIAL_PORT
+  #define SERIAL_PORT serialMuxMavLink
+  #define initCommunication initMavLinkCommunication
+  #define readSerialCommand readMavLinkCommand
+  #define sendSerialTelemetry sendMavLinkTelemetry
+  #include "MavLink.h"
+  #undef initCommunication
+  #undef readSerialCommand
+  #undef sendSerialTelemetry
+  #undef SERIAL_PORT
+  #define SERIAL_PORT serialMuxConfigurator
+  #include <SerialCommandParser.h>
+  #include "SerialCom.h"
+#elif defined(MavLink)
   #include "MavLink.h"
 #else
+  #include <SerialCommandParser.h>
   #include "SerialCom.h"
 #endif
 
@@ -1292,12 +1368,20 @@
  * Aeroquad
  ******************************************************************/
 void setup() {
-  SERIAL_BEGIN(BAUD);
+  #if defined(SerialMux)
+    SERIAL_MUX_LINK.begin(BAUD);
+  #else
+    SERIAL_BEGIN(BAUD);
+  #endif
   pinMode(LED_Green, OUTPUT);
   digitalWrite(LED_Green, LOW);
 
   initCommunication();
+  #if defined(SerialMux) && defined(MavLink)
+    initMavLinkCommunication();
+  #endif
   
+  initializePIDEngine();
   readEEPROM(); // defined in DataStorage.h
   boolean firstTimeBoot = false;
   if (readFloat(SOFTWARE_VERSION_ADR) != SOFTWARE_VERSION) { // If we detect the wrong soft version, we init all parameters
@@ -1323,13 +1407,24 @@ void setup() {
   // If sensors have a common initialization routine
   // insert it into the gyro class because it executes first
   initializeGyro(); // defined in Gyro.h
-  while (!calibrateGyro()); // this make sure the craft is still befor to continue init process
+  #if defined(GyroTempCompensation)
+    // a learned temperature model replaces the boot calibration
+    if (!applyGyroTempCompensation()) {
+      while (!calibrateGyro()); // this make sure the craft is still befor to continue init process
+    }
+  #else
+    while (!calibrateGyro()); // this make sure the craft is still befor to continue init process
+  #endif
   initializeAccel(); // defined in Accel.h
   if (firstTimeBoot) {
     computeAccelBias();
     writeEEPROM();
+    storeSensorsZeroToEEPROM(); // read back by initSensorsZeroFromEEPROM() below
   }
   setupFourthOrder();
+  #if defined(DynamicNotch)
+    initializeDynamicNotch();
+  #endif
   initSensorsZeroFromEEPROM();
   
   // Integral Limit for attitude mode
@@ -1386,7 +1481,7 @@ void setup() {
       binaryPort = &Serial1;
       binaryPort->begin(115200);
       delay(1000);
-    #else
+    #elif !defined(SerialMux)
      binaryPort = &Serial;
     #endif
   #endif
@@ -1406,14 +1501,42 @@ void setup() {
 
 
 /*******************************************************************
- * 100Hz task
+ * Rate loop and motor outputs
  ******************************************************************/
-void process100HzTask() {
+void processRateControl() {
+  processFlightControl();
+  #if defined(MavLinkHIL)
+    sendHILMotors();
+  #endif
+}
+
+/*******************************************************************
+ * Control loop task, CONTROL_LOOP_RATE
+ ******************************************************************/
+void processControlLoopTask() {
   
-  G_Dt = (currentTime - hundredHZpreviousTime) / 1000000.0;
-  hundredHZpreviousTime = currentTime;
+  #if defined(MPU6000_FIFO)
+    // timed by the MPU6000's own clock over the samples the gyro rate
+    // averages, a pass with no new sample keeps the previous rate and step
+    if (gyroSampleTime != controlLoopPreviousSampleTime) {
+      controlLoopSampleDt = (gyroSampleTime - controlLoopPreviousSampleTime) / 1000000.0;
+      controlLoopPreviousSampleTime = gyroSampleTime;
+    }
+    G_Dt = controlLoopSampleDt;
+  #else
+    G_Dt = (currentTime - controlLoopPreviousTime) / 1000000.0;
+    controlLoopPreviousTime = currentTime;
+  #endif
   
   evaluateGyroRate();
+  #if defined(DynamicNotch)
+    computeDynamicNotch(gyroRate);
+  #endif
+  #if TASK_100HZ > 1
+    // gyro straight to the motors, everything else comes after
+    processRateControl();
+  #endif
+
   evaluateMetersPerSec();
 
   for (int axis = XAXIS; axis <= ZAXIS; axis++) {
@@ -1421,6 +1544,15 @@ void process100HzTask() {
   }
     
   calculateKinematics(gyroRate[XAXIS], gyroRate[YAXIS], gyroRate[ZAXIS], filteredAccel[XAXIS], filteredAccel[YAXIS], filteredAccel[ZAXIS], G_Dt);
+}
+
+/*******************************************************************
+ * 100Hz task
+ ******************************************************************/
+void process100HzTask() {
+  
+  G_Dt = (currentTime - hundredHZpreviousTime) / 1000000.0;
+  hundredHZpreviousTime = currentTime;
   
   #if defined AltitudeHoldBaro || defined AltitudeHoldRangeFinder
     zVelocity = (filteredAccel[ZAXIS] * (1 - accelOneG * invSqrt(isq(filteredAccel[XAXIS]) + isq(filteredAccel[YAXIS]) + isq(filteredAccel[ZAXIS])))) - runTimeAccelBias[ZAXIS] - runtimeZBias;
@@ -1438,10 +1570,18 @@ void process100HzTask() {
       evaluateBaroAltitude();
     }
   #endif
-        
-  processFlightControl();
-  
-  
+
+  processAttitudeControl();
+  #if TASK_100HZ == 1
+    // at 100Hz the rate loop follows the attitude loop of the same frame
+    processRateControl();
+  #endif
+
+  #if !defined(MavLink) || defined(SerialMux)
+    // keep the port drained, the command itself is applied by the 10Hz task
+    parseSerialCommand();
+  #endif
+
   #if defined(BinaryWrite)
     if (fastTransfer == ON) {
       // write out fastTelemetry to Configurator or openLog
@@ -1449,12 +1589,20 @@ void process100HzTask() {
     }
   #endif      
   
+  #if defined(SerialMux)
+    serialMuxService();
+  #endif
+
   #ifdef SlowTelemetry
     updateSlowTelemetry100Hz();
   #endif
 
   #if defined(UseGPS)
-    updateGps();
+    #if defined(MavLinkHIL)
+      updateHILGps();
+    #else
+      updateGps();
+    #endif
   #endif      
   
   #if defined(CameraControl)
@@ -1501,7 +1649,7 @@ void process10HzTask1() {
     G_Dt = (currentTime - tenHZpreviousTime) / 1000000.0;
     tenHZpreviousTime = currentTime;
      
-    measureMagnetometer(kinematicsAngle[XAXIS], kinematicsAngle[YAXIS]);
+    measureMagnetometer(kinematicsSinAngle[XAXIS], kinematicsCosAngle[XAXIS], kinematicsSinAngle[YAXIS], kinematicsCosAngle[YAXIS]);
     
     calculateHeading();
     
@@ -1522,6 +1670,10 @@ void process10HzTask2() {
   // Listen for configuration commands and reports telemetry
   readSerialCommand();
   sendSerialTelemetry();
+  #if defined(SerialMux) && defined(MavLink)
+    readMavLinkCommand();
+    sendMavLinkTelemetry();
+  #endif
 }
 
 /*******************************************************************
@@ -1552,11 +1704,27 @@ void process10HzTask3() {
  * 1Hz task 
  ******************************************************************/
 void process1HzTask() {
+  #if defined(GyroTempCompensation)
+    if (processGyroTempCompensation(motorArmed == OFF)) {
+      storeGyroTempCompensationToEEPROM();
+    }
+  #endif
+
+  #if defined(UseGPS)
+    // follow the declination as the craft moves, cheap unless a 5 degree cell is crossed
+    if (haveAGpsLock() && isHomeBaseInitialized()) {
+      setDeclinationLocation(currentPosition.latitude, currentPosition.longitude);
+    }
+  #endif
+
   #ifdef MavLink
     G_Dt = (currentTime - oneHZpreviousTime) / 1000000.0;
     oneHZpreviousTime = currentTime;
     
     sendSerialHeartbeat();   
+    #if defined(MavLinkHIL)
+      sendHILFrameTime();
+    #endif
   #endif
 }
 
@@ -1571,13 +1739,20 @@ void loop () {
   measureCriticalSensors();
 
   // ================================================================
-  // 100Hz task loop
+  // Control loop, CONTROL_LOOP_RATE
   // ================================================================
-  if (deltaTime >= 10000) {
+  if (deltaTime >= CONTROL_LOOP_PERIOD) {
     
     frameCounter++;
     
-    process100HzTask();
+    processControlLoopTask();
+
+    // ================================================================
+    // 100Hz task loop
+    // ================================================================
+    if (frameCounter % TASK_100HZ == 0) {  //  100 Hz tasks
+      process100HzTask();
+    }
 
     // ================================================================
     // 50Hz task loop
@@ -1606,10 +1781,13 @@ void loop () {
       process1HzTask();
     }
     
+    #if defined(MavLinkHIL)
+      measureHILFrame(micros() - currentTime);
+    #endif
     previousTime = currentTime;
   }
   
-  if (frameCounter >= 100) {
+  if (frameCounter >= TASK_1HZ) {
       frameCounter = 0;
   }
 }
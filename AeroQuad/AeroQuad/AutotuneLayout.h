@@ -0,0 +1,42 @@
+/*
+  AeroQuad v3.2 - In flight PID autotune stages
+  www.AeroQuad.com
+  Copyright (c) 2012 Ted Carancho.  All rights reserved.
+  An Open Source Arduino based multicopter.
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Stages of AutotuneProcessor.h, apart from it so the '@' query of
+// SerialCom.h sends as many values without PIDAutotune
+
+#ifndef _AQ_AUTOTUNE_LAYOUT_H_
+#define _AQ_AUTOTUNE_LAYOUT_H_
+
+enum {
+  AUTOTUNE_ROLL_RATE = 0,
+  AUTOTUNE_ROLL_ATTITUDE,
+  AUTOTUNE_PITCH_RATE,
+  AUTOTUNE_PITCH_ATTITUDE,
+  AUTOTUNE_YAW_RATE,
+  AUTOTUNE_STAGES
+};
+
+#define AUTOTUNE_PIDS 7
+
+// state, stage and stages done, Ku and Tu of each stage, gains flown and
+// staged of each PID
+#define AUTOTUNE_REPORT_FIELDS (3 + 2 * AUTOTUNE_STAGES + 6 * AUTOTUNE_PIDS)
+
+#endif
@@ -0,0 +1,277 @@
+/*
+  AeroQuad v3.2 - In flight PID autotune
+  www.AeroQuad.com
+  Copyright (c) 2012 Ted Carancho.  All rights reserved.
+  An Open Source Arduino based multicopter.
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Autotune flies one relay experiment at a time, in attitude mode with
+// the sticks centered:
+//   roll rate      the relay takes over the roll rate PID output
+//   roll attitude  the relay takes over the roll attitude PID output,
+//                  the rate loop flies with the gains just found
+//   pitch rate, pitch attitude, yaw rate the same way
+// Each experiment waits for AUTOTUNE_SETTLE_TIME of calm flight first. A
+// stick moved out of center, or a bank beyond AUTOTUNE_MAX_ANGLE, hands
+// the axis back to its PID and the experiment starts over once calm again.
+// The gains found are only staged, the 'R' command of the Configurator
+// copies them to PID[] and writes the EEPROM, or drops them.
+
+#ifndef _AQ_AUTOTUNE_PROCESSOR_H_
+#define _AQ_AUTOTUNE_PROCESSOR_H_
+
+#define AUTOTUNE_STICK_DEADBAND 50        // stick from center that stops the experiment
+#define AUTOTUNE_MAX_ANGLE 0.5            // rad of bank that stops the experiment
+#define AUTOTUNE_SETTLE_TIME 1000000UL    // us of calm flight before each experiment
+
+// relay start, limits, hysteresis and wanted error swing
+#define AUTOTUNE_RATE_RELAY 50.0, 10.0, 300.0, 0.02, 0.2        // motor axis command, rad/s
+#define AUTOTUNE_YAW_RELAY 50.0, 10.0, 400.0, 0.02, 0.15        // motor axis command, rad/s
+#define AUTOTUNE_ATTITUDE_RELAY 0.5, 0.1, 2.0, 0.005, 0.08      // rad/s, rad
+
+#include "AutotuneLayout.h"
+
+enum {
+  AUTOTUNE_OFF = 0,
+  AUTOTUNE_SETTLING,
+  AUTOTUNE_RUNNING,
+  AUTOTUNE_COMPLETE
+};
+
+// PIDs the stages stage gains for, in this order
+const byte autotunePIDIndex[AUTOTUNE_PIDS] = {
+  RATE_XAXIS_PID_IDX, ATTITUDE_GYRO_XAXIS_PID_IDX, ATTITUDE_XAXIS_PID_IDX,
+  RATE_YAXIS_PID_IDX, ATTITUDE_GYRO_YAXIS_PID_IDX, ATTITUDE_YAXIS_PID_IDX,
+  ZAXIS_PID_IDX
+};
+
+struct AutotuneGains {
+  float P, I, D;
+};
+
+byte autotuneState = AUTOTUNE_OFF;
+byte autotuneStage = AUTOTUNE_ROLL_RATE;
+byte autotuneStagesDone = 0;              // bit per stage
+unsigned long autotuneCalmSince = 0;
+struct RelayExperiment autotuneRelay;
+float autotuneUltimateGain[AUTOTUNE_STAGES];
+float autotuneUltimatePeriod[AUTOTUNE_STAGES];
+struct AutotuneGains autotuneStaged[AUTOTUNE_PIDS];
+byte autotuneStagedPIDs = 0;              // bit per autotunePIDIndex entry
+struct AutotuneGains autotuneFlownGains;  // rate PID put aside for an attitude stage
+
+byte getAutotuneAxis(byte stage) {
+  if (stage == AUTOTUNE_YAW_RATE) {
+    return ZAXIS;
+  }
+  return (stage < AUTOTUNE_PITCH_RATE) ? XAXIS : YAXIS;
+}
+
+boolean isAutotuneAttitudeStage(byte stage) {
+  return stage == AUTOTUNE_ROLL_ATTITUDE || stage == AUTOTUNE_PITCH_ATTITUDE;
+}
+
+// Rate PID the attitude loop of the axis flies on
+byte getAutotuneGyroPID(byte axis) {
+  return (axis == XAXIS) ? ATTITUDE_GYRO_XAXIS_PID_IDX : ATTITUDE_GYRO_YAXIS_PID_IDX;
+}
+
+void stageAutotuneGains(byte slot, float P, float I, float D) {
+  autotuneStaged[slot].P = P;
+  autotuneStaged[slot].I = I;
+  autotuneStaged[slot].D = D;
+  autotuneStagedPIDs |= 1 << slot;
+}
+
+// The gains of a slot, staged or else the ones flown
+struct AutotuneGains getAutotuneGains(byte slot) {
+  if (autotuneStagedPIDs & (1 << slot)) {
+    return autotuneStaged[slot];
+  }
+  struct AutotuneGains gains = {PID[autotunePIDIndex[slot]].P, PID[autotunePIDIndex[slot]].I, PID[autotunePIDIndex[slot]].D};
+  return gains;
+}
+
+/**
+ * Turns the result of the experiment into staged gains. The rate mode PID
+ * sees the gyro times rotationSpeedFactor, its gains are divided by it to
+ * give the same loop.
+ */
+void stageAutotuneResult(byte stage) {
+  const float ultimateGain = autotuneUltimateGain[stage];
+  const float ultimatePeriod = autotuneUltimatePeriod[stage];
+  float P, I, D;
+  if (stage == AUTOTUNE_YAW_RATE) {
+    computeRelayRatePID(ultimateGain, ultimatePeriod, &P, &I, &D);
+    stageAutotuneGains(6, P, I, PID[ZAXIS_PID_IDX].D);
+  }
+  else if (isAutotuneAttitudeStage(stage)) {
+    const byte slot = (stage == AUTOTUNE_ROLL_ATTITUDE) ? 2 : 5;
+    const struct AutotuneGains flown = getAutotuneGains(slot);
+    stageAutotuneGains(slot, computeRelayAttitudeP(ultimateGain), flown.I, flown.D);
+  }
+  else {
+    const byte slot = (stage == AUTOTUNE_ROLL_RATE) ? 0 : 3;
+    computeRelayRatePID(ultimateGain, ultimatePeriod, &P, &I, &D);
+    stageAutotuneGains(slot, P / rotationSpeedFactor, I / rotationSpeedFactor, D / rotationSpeedFactor);
+    stageAutotuneGains(slot + 1, P, getAutotuneGains(slot + 1).I, D);
+  }
+}
+
+// Rate PID of the axis back to what it was before an attitude stage
+void restoreAutotuneFlownGains() {
+  if (autotuneState == AUTOTUNE_RUNNING && isAutotuneAttitudeStage(autotuneStage)) {
+    struct PIDdata *pid = &PID[getAutotuneGyroPID(getAutotuneAxis(autotuneStage))];
+    pid->P = autotuneFlownGains.P;
+    pid->D = autotuneFlownGains.D;
+  }
+}
+
+void startAutotuneStage() {
+  const byte axis = getAutotuneAxis(autotuneStage);
+  if (isAutotuneAttitudeStage(autotuneStage)) {
+    // the attitude loop is tuned on the rate gains just found
+    struct PIDdata *pid = &PID[getAutotuneGyroPID(axis)];
+    const struct AutotuneGains staged = getAutotuneGains(axis == XAXIS ? 1 : 4);
+    autotuneFlownGains.P = pid->P;
+    autotuneFlownGains.D = pid->D;
+    pid->P = staged.P;
+    pid->D = staged.D;
+    startRelayExperiment(&autotuneRelay, AUTOTUNE_ATTITUDE_RELAY, currentTime);
+  }
+  else if (axis == ZAXIS) {
+    startRelayExperiment(&autotuneRelay, AUTOTUNE_YAW_RELAY, currentTime);
+  }
+  else {
+    startRelayExperiment(&autotuneRelay, AUTOTUNE_RATE_RELAY, currentTime);
+  }
+  autotuneState = AUTOTUNE_RUNNING;
+}
+
+// Next stage not done yet, or complete
+void nextAutotuneStage() {
+  autotuneStage = 0;
+  while (autotuneStage < AUTOTUNE_STAGES && (autotuneStagesDone & (1 << autotuneStage))) {
+    autotuneStage++;
+  }
+  autotuneState = (autotuneStage == AUTOTUNE_STAGES) ? AUTOTUNE_COMPLETE : AUTOTUNE_SETTLING;
+  autotuneCalmSince = currentTime;
+}
+
+void startAutotune() {
+  nextAutotuneStage();
+}
+
+void stopAutotune() {
+  restoreAutotuneFlownGains();
+  autotuneState = AUTOTUNE_OFF;
+}
+
+// Drops the staged gains and the experiments done
+void clearAutotune() {
+  stopAutotune();
+  autotuneStagesDone = 0;
+  autotuneStagedPIDs = 0;
+}
+
+void applyAutotuneGains() {
+  for (byte slot = 0; slot < AUTOTUNE_PIDS; slot++) {
+    if (autotuneStagedPIDs & (1 << slot)) {
+      struct PIDdata *pid = &PID[autotunePIDIndex[slot]];
+      pid->P = autotuneStaged[slot].P;
+      pid->I = autotuneStaged[slot].I;
+      pid->D = autotuneStaged[slot].D;
+      pid->integratedError = 0.0;
+    }
+  }
+  clearAutotune();
+}
+
+boolean isAutotuneCalm() {
+  for (byte axis = XAXIS; axis <= ZAXIS; axis++) {
+    if (abs(receiverCommand[axis] - receiverZero[axis]) > AUTOTUNE_STICK_DEADBAND) {
+      return false;
+    }
+  }
+  return abs(kinematicsAngle[XAXIS]) < AUTOTUNE_MAX_ANGLE && abs(kinematicsAngle[YAXIS]) < AUTOTUNE_MAX_ANGLE;
+}
+
+/**
+ * Moves the experiments on, run with the attitude loop
+ */
+void updateAutotune() {
+  if (autotuneState == AUTOTUNE_OFF || autotuneState == AUTOTUNE_COMPLETE) {
+    return;
+  }
+  if (!isAutotuneCalm()) {
+    restoreAutotuneFlownGains();
+    autotuneState = AUTOTUNE_SETTLING;
+    autotuneCalmSince = currentTime;
+    return;
+  }
+  if (autotuneState == AUTOTUNE_SETTLING) {
+    if (currentTime - autotuneCalmSince >= AUTOTUNE_SETTLE_TIME) {
+      startAutotuneStage();
+    }
+    return;
+  }
+  if (autotuneRelay.state == RELAY_DONE) {
+    restoreAutotuneFlownGains();
+    autotuneUltimateGain[autotuneStage] = autotuneRelay.ultimateGain;
+    autotuneUltimatePeriod[autotuneStage] = autotuneRelay.ultimatePeriod;
+    autotuneStagesDone |= 1 << autotuneStage;
+    stageAutotuneResult(autotuneStage);
+    nextAutotuneStage();
+  }
+  else if (autotuneRelay.state == RELAY_FAILED) {
+    // no oscillation within the relay limits, try again after settling
+    restoreAutotuneFlownGains();
+    autotuneState = AUTOTUNE_SETTLING;
+    autotuneCalmSince = currentTime;
+  }
+}
+
+/**
+ * Rate loop, the motor axis command of the axis in a rate experiment
+ * comes from the relay, measured is what the rate PID measures. The relay
+ * holds the axis at zero rate by itself, so neither the attitude loop nor
+ * heading hold move its target while it is measured.
+ */
+float getAutotuneRateCommand(byte axis, float measured, float command) {
+  if (autotuneState == AUTOTUNE_RUNNING && !isAutotuneAttitudeStage(autotuneStage) && getAutotuneAxis(autotuneStage) == axis) {
+    const float output = updateRelayExperiment(&autotuneRelay, -measured, currentTime);
+    if (autotuneRelay.state == RELAY_RUNNING) {
+      return output;
+    }
+  }
+  return command;
+}
+
+/**
+ * Attitude loop, the rate setpoint of the axis in an attitude experiment
+ * comes from the relay, error is the attitude PID error
+ */
+float getAutotuneRateSetpoint(byte axis, float error, float rate) {
+  if (autotuneState == AUTOTUNE_RUNNING && isAutotuneAttitudeStage(autotuneStage) && getAutotuneAxis(autotuneStage) == axis) {
+    const float output = updateRelayExperiment(&autotuneRelay, error, currentTime);
+    if (autotuneRelay.state == RELAY_RUNNING) {
+      return output;
+    }
+  }
+  return rate;
+}
+
+#endif
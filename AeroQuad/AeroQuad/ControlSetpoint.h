@@ -0,0 +1,64 @@
+/*
+  AeroQuad v3.0.1 - February 2012
+  www.AeroQuad.com
+  Copyright (c) 2012 Ted Carancho.  All rights reserved.
+  An Open Source Arduino based multicopter.
+ 
+  This program is free software: you can redistribute it and/or modify 
+  it under the terms of the GNU General Public License as published by 
+  the Free Software Foundation, either version 3 of the License, or 
+  (at your option) any later version. 
+ 
+  This program is distributed in the hope that it will be useful, 
+  but WITHOUT ANY WARRANTY; without even the implied warranty of 
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the 
+  GNU General Public License for more details. 
+ 
+  You should have received a copy of the GNU General Public License 
+  along with this program. If not, see <http://www.gnu.org/licenses/>. 
+*/
+
+
+// Setpoints handed from the outer loops to the rate loop
+//
+// Attitude, heading, altitude and GPS navigation run at 100Hz or slower
+// and publish the rate and throttle they want here, the rate PIDs and
+// the mixer read them at CONTROL_LOOP_RATE. There are two copies, the
+// writer fills the one not in use and then flips controlSetpointIndex,
+// a single byte store. Both sides run from the main loop and never
+// preempt each other, so the reader always copies one complete set.
+// This is not enough if one side moves to an interrupt: a writer that
+// publishes twice during one read would tear the copy.
+
+#ifndef _AQ_CONTROL_SETPOINT_H_
+#define _AQ_CONTROL_SETPOINT_H_
+
+struct ControlSetpoint {
+  float rate[3];      // rad/s, pitch has the sign of -gyroRate[YAXIS]
+  int throttle;
+  byte rateMode;      // use the RATE_ PIDs and rotationSpeedFactor instead of the ATTITUDE_GYRO_ PIDs
+};
+
+struct ControlSetpoint controlSetpoint[2] = {{{0.0,0.0,0.0}, MINCOMMAND, true},
+                                            {{0.0,0.0,0.0}, MINCOMMAND, true}};
+volatile byte controlSetpointIndex = 0;
+
+/**
+ * Returns the copy the rate loop is not reading, every field has to be
+ * written before publishControlSetpoint()
+ */
+struct ControlSetpoint *getControlSetpointBuffer() {
+  return &controlSetpoint[controlSetpointIndex ^ 1];
+}
+
+void publishControlSetpoint() {
+  // the copy must be complete in memory before the index says so
+  __asm__ __volatile__ ("" ::: "memory");
+  controlSetpointIndex ^= 1;
+}
+
+void readControlSetpoint(struct ControlSetpoint *setpoint) {
+  *setpoint = controlSetpoint[controlSetpointIndex];
+}
+
+#endif
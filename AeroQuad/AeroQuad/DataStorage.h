@@ -177,6 +177,12 @@ void initializeEEPROM() {
   #endif
   
   initializePlatformSpecificAccelCalibration();
+  #ifdef HeadingMagHold
+    initializeMagSoftIron();
+  #endif
+  #if defined(GyroTempCompensation)
+    resetGyroTempCompensation();
+  #endif
 
   windupGuard = 1000.0;
 
@@ -291,8 +297,31 @@ void readEEPROM() {
     magBias[XAXIS]  = readFloat(XAXIS_MAG_BIAS_ADR);
     magBias[YAXIS]  = readFloat(YAXIS_MAG_BIAS_ADR);
     magBias[ZAXIS]  = readFloat(ZAXIS_MAG_BIAS_ADR);
+    for (byte i = 0; i < 9; i++) {
+      magSoftIron[i / 3][i % 3] = readFloat(MAG_SOFT_IRON_ADR[i]);
+    }
+    // EEPROM written before the soft iron matrix existed holds 0xFF there
+    if (isnan(magSoftIron[XAXIS][XAXIS])) {
+      initializeMagSoftIron();
+    }
   #endif
   
+  #if defined(GyroTempCompensation)
+    gyroTempWeight = readFloat(GYRO_TEMP_WEIGHT_ADR);
+    gyroTempMean = readFloat(GYRO_TEMP_MEAN_ADR);
+    gyroTempVariance = readFloat(GYRO_TEMP_VARIANCE_ADR);
+    gyroTempMin = readFloat(GYRO_TEMP_MIN_ADR);
+    gyroTempMax = readFloat(GYRO_TEMP_MAX_ADR);
+    for (byte axis = XAXIS; axis <= ZAXIS; axis++) {
+      gyroTempBias[axis] = readFloat(GYRO_TEMP_BIAS_ADR[axis]);
+      gyroTempCovariance[axis] = readFloat(GYRO_TEMP_COVARIANCE_ADR[axis]);
+    }
+    // never written since the model was added
+    if (isnan(gyroTempWeight)) {
+      resetGyroTempCompensation();
+    }
+  #endif
+
   // Battery Monitor
   #ifdef BattMonitor
     batteryMonitorAlarmVoltage = readFloat(BATT_ALARM_VOLTAGE_ADR);
@@ -395,6 +424,9 @@ void writeEEPROM(){
     writeFloat(magBias[XAXIS], XAXIS_MAG_BIAS_ADR);
     writeFloat(magBias[YAXIS], YAXIS_MAG_BIAS_ADR);
     writeFloat(magBias[ZAXIS], ZAXIS_MAG_BIAS_ADR);
+    for (byte i = 0; i < 9; i++) {
+      writeFloat(magSoftIron[i / 3][i % 3], MAG_SOFT_IRON_ADR[i]);
+    }
   #endif
   writeFloat(windupGuard, WINDUPGUARD_ADR);
   writeFloat(receiverXmitFactor, XMITFACTOR_ADR);
@@ -441,6 +473,10 @@ void writeEEPROM(){
     }       
   #endif
 
+  #if defined(GyroTempCompensation)
+    storeGyroTempCompensationToEEPROM();
+  #endif
+
     // Camera Control
   #ifdef CameraControl
     writeFloat(cameraMode, CAMERAMODE_ADR);
@@ -489,6 +525,20 @@ void storeSensorsZeroToEEPROM() {
   writeFloat(runTimeAccelBias[ZAXIS], ZAXIS_ACCEL_BIAS_ADR);
 }
 
+void storeGyroTempCompensationToEEPROM() {
+  #if defined(GyroTempCompensation)
+    writeFloat(gyroTempWeight, GYRO_TEMP_WEIGHT_ADR);
+    writeFloat(gyroTempMean, GYRO_TEMP_MEAN_ADR);
+    writeFloat(gyroTempVariance, GYRO_TEMP_VARIANCE_ADR);
+    writeFloat(gyroTempMin, GYRO_TEMP_MIN_ADR);
+    writeFloat(gyroTempMax, GYRO_TEMP_MAX_ADR);
+    for (byte axis = XAXIS; axis <= ZAXIS; axis++) {
+      writeFloat(gyroTempBias[axis], GYRO_TEMP_BIAS_ADR[axis]);
+      writeFloat(gyroTempCovariance[axis], GYRO_TEMP_COVARIANCE_ADR[axis]);
+    }
+  #endif
+}
+
 void initReceiverFromEEPROM() {
   receiverXmitFactor = readFloat(XMITFACTOR_ADR);
   
@@ -114,6 +114,21 @@
 #endif
 
 
+#if defined (PIDAutotune)
+  void processAutotuneStateFromReceiverCommand() {
+    // active high, a receiver that does not drive AUX3 leaves it at 1000 and autotune off
+    if (receiverCommand[AUX3] > 1750 && motorArmed == ON && inFlight && flightMode == ATTITUDE_FLIGHT_MODE) {
+      if (autotuneState == AUTOTUNE_OFF) {
+        startAutotune();
+      }
+    }
+    else if (autotuneState != AUTOTUNE_OFF) {
+      stopAutotune();
+    }
+  }
+#endif
+
+
 #if defined (UseGPSNavigator)
   void processGpsNavigationStateFromReceiverCommand() {
     // Init home command
@@ -276,6 +291,10 @@ void readPilotCommands() {
     processAutoLandingStateFromReceiverCommand();
   #endif
 
+  #if defined (PIDAutotune)
+    processAutotuneStateFromReceiverCommand();
+  #endif
+
   #if defined (UseGPSNavigator)
     processGpsNavigationStateFromReceiverCommand();
   #endif
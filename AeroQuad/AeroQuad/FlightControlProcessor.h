@@ -29,32 +29,72 @@
 
 
 /**
- * calculateFlightError
+ * calculateRateSetpoint
  *
- * Calculate roll/pitch axis error with gyro/accel data to
- * compute motor command thrust so used command are executed
+ * Outer attitude loop, turns the roll/pitch stick or GPS correction and
+ * the kinematics angles into the rate the inner loop has to follow
  */
-void calculateFlightError()
+void calculateRateSetpoint(struct ControlSetpoint *setpoint)
 {
   #if defined (UseGPSNavigator)
     if (navigationState == ON || positionHoldState == ON) {
-      float rollAttitudeCmd  = updatePID((receiverCommand[XAXIS] - receiverZero[XAXIS] + gpsRollAxisCorrection) * ATTITUDE_SCALING, kinematicsAngle[XAXIS], &PID[ATTITUDE_XAXIS_PID_IDX]);
-      float pitchAttitudeCmd = updatePID((receiverCommand[YAXIS] - receiverZero[YAXIS] + gpsPitchAxisCorrection) * ATTITUDE_SCALING, -kinematicsAngle[YAXIS], &PID[ATTITUDE_YAXIS_PID_IDX]);
-      motorAxisCommandRoll   = updatePID(rollAttitudeCmd, gyroRate[XAXIS], &PID[ATTITUDE_GYRO_XAXIS_PID_IDX]);
-      motorAxisCommandPitch  = updatePID(pitchAttitudeCmd, -gyroRate[YAXIS], &PID[ATTITUDE_GYRO_YAXIS_PID_IDX]);
+      setpoint->rate[XAXIS] = updatePID((receiverCommand[XAXIS] - receiverZero[XAXIS] + gpsRollAxisCorrection) * ATTITUDE_SCALING, kinematicsAngle[XAXIS], &PID[ATTITUDE_XAXIS_PID_IDX]);
+      setpoint->rate[YAXIS] = updatePID((receiverCommand[YAXIS] - receiverZero[YAXIS] + gpsPitchAxisCorrection) * ATTITUDE_SCALING, -kinematicsAngle[YAXIS], &PID[ATTITUDE_YAXIS_PID_IDX]);
+      setpoint->rateMode = false;
     }
     else
   #endif
   if (flightMode == ATTITUDE_FLIGHT_MODE) {
-    float rollAttitudeCmd  = updatePID((receiverCommand[XAXIS] - receiverZero[XAXIS]) * ATTITUDE_SCALING, kinematicsAngle[XAXIS], &PID[ATTITUDE_XAXIS_PID_IDX]);
-    float pitchAttitudeCmd = updatePID((receiverCommand[YAXIS] - receiverZero[YAXIS]) * ATTITUDE_SCALING, -kinematicsAngle[YAXIS], &PID[ATTITUDE_YAXIS_PID_IDX]);
-    motorAxisCommandRoll   = updatePID(rollAttitudeCmd, gyroRate[XAXIS], &PID[ATTITUDE_GYRO_XAXIS_PID_IDX]);
-    motorAxisCommandPitch  = updatePID(pitchAttitudeCmd, -gyroRate[YAXIS], &PID[ATTITUDE_GYRO_YAXIS_PID_IDX]);
+    setpoint->rate[XAXIS] = updatePID((receiverCommand[XAXIS] - receiverZero[XAXIS]) * ATTITUDE_SCALING, kinematicsAngle[XAXIS], &PID[ATTITUDE_XAXIS_PID_IDX]);
+    setpoint->rate[YAXIS] = updatePID((receiverCommand[YAXIS] - receiverZero[YAXIS]) * ATTITUDE_SCALING, -kinematicsAngle[YAXIS], &PID[ATTITUDE_YAXIS_PID_IDX]);
+    setpoint->rateMode = false;
+    #if defined (PIDAutotune)
+      setpoint->rate[XAXIS] = getAutotuneRateSetpoint(XAXIS, (receiverCommand[XAXIS] - receiverZero[XAXIS]) * ATTITUDE_SCALING - kinematicsAngle[XAXIS], setpoint->rate[XAXIS]);
+      setpoint->rate[YAXIS] = getAutotuneRateSetpoint(YAXIS, (receiverCommand[YAXIS] - receiverZero[YAXIS]) * ATTITUDE_SCALING + kinematicsAngle[YAXIS], setpoint->rate[YAXIS]);
+    #endif
+  }
+  else {
+    setpoint->rate[XAXIS] = getReceiverSIData(XAXIS);
+    setpoint->rate[YAXIS] = getReceiverSIData(YAXIS);
+    setpoint->rateMode = true;
+  }
+}
+
+/**
+ * calculateFlightError
+ *
+ * Inner rate loop, compute the motor axis commands from the published
+ * rate setpoint and the latest gyro rates, G_Dt is the control loop dt
+ */
+void calculateFlightError(const struct ControlSetpoint *setpoint)
+{
+  byte index[3];
+  float measured[3];
+  float command[3];
+  if (setpoint->rateMode) {
+    index[XAXIS] = RATE_XAXIS_PID_IDX;
+    index[YAXIS] = RATE_YAXIS_PID_IDX;
+    measured[XAXIS] = gyroRate[XAXIS]*rotationSpeedFactor;
+    measured[YAXIS] = -gyroRate[YAXIS]*rotationSpeedFactor;
   }
   else {
-    motorAxisCommandRoll = updatePID(getReceiverSIData(XAXIS), gyroRate[XAXIS]*rotationSpeedFactor, &PID[RATE_XAXIS_PID_IDX]);
-    motorAxisCommandPitch = updatePID(getReceiverSIData(YAXIS), -gyroRate[YAXIS]*rotationSpeedFactor, &PID[RATE_YAXIS_PID_IDX]);
+    index[XAXIS] = ATTITUDE_GYRO_XAXIS_PID_IDX;
+    index[YAXIS] = ATTITUDE_GYRO_YAXIS_PID_IDX;
+    measured[XAXIS] = gyroRate[XAXIS];
+    measured[YAXIS] = -gyroRate[YAXIS];
   }
+  index[ZAXIS] = ZAXIS_PID_IDX;
+  measured[ZAXIS] = gyroRate[ZAXIS];
+
+  updatePIDs(index, setpoint->rate, measured, command, 3, G_Dt);
+  #if defined (PIDAutotune)
+    for (byte axis = XAXIS; axis <= ZAXIS; axis++) {
+      command[axis] = getAutotuneRateCommand(axis, measured[axis], command[axis]);
+    }
+  #endif
+  motorAxisCommandRoll  = command[XAXIS];
+  motorAxisCommandPitch = command[YAXIS];
+  motorAxisCommandYaw   = command[ZAXIS];
 }
 
 /**
@@ -195,7 +235,7 @@ void processThrottleCorrection() {
   int throttleAdjust = 0;
   #if defined UseGPSNavigator
     if (navigationState == ON || positionHoldState == ON) {
-      throttleAdjust = throttle / (cos (kinematicsAngle[XAXIS]*0.55) * cos (kinematicsAngle[YAXIS]*0.55));
+      throttleAdjust = throttle / (fastCos(kinematicsAngle[XAXIS]*0.55) * fastCos(kinematicsAngle[YAXIS]*0.55));
       throttleAdjust = constrain ((throttleAdjust - throttle), 0, 50); //compensate max  +/- 25 deg XAXIS or YAXIS or  +/- 18 ( 18(XAXIS) + 18(YAXIS))
     }
   #endif
@@ -266,17 +306,24 @@ void processMinMaxCommand()
 }
 
 /**
- * processFlightControl
+ * processAttitudeControl
  *
- * Main flight control processos function
+ * Outer loops, attitude, heading, navigation and altitude, run at 100Hz
+ * and publish the setpoint processFlightControl() follows
  */
-void processFlightControl() {
+void processAttitudeControl() {
+
+  struct ControlSetpoint *setpoint = getControlSetpointBuffer();
+
+  #if defined (PIDAutotune)
+    updateAutotune();
+  #endif
   
-  // ********************** Calculate Flight Error ***************************
-  calculateFlightError();
+  // ********************** Calculate rate setpoint ***************************
+  calculateRateSetpoint(setpoint);
   
   // ********************** Update Yaw ***************************************
-  processHeading();
+  processHeading(setpoint);
   
   if (frameCounter % THROTTLE_ADJUST_TASK_SPEED == 0) {  // 50hz task
     
@@ -307,7 +354,26 @@ void processFlightControl() {
     // ********************** Process throttle correction ********************
     processThrottleCorrection();
   }
+  setpoint->throttle = throttle;
+
+  publishControlSetpoint();
+}
+
+/**
+ * processFlightControl
+ *
+ * Inner rate loop and mixer, run at CONTROL_LOOP_RATE right after the
+ * gyro is evaluated
+ */
+void processFlightControl() {
 
+  struct ControlSetpoint setpoint;
+  readControlSetpoint(&setpoint);
+  
+  // ********************** Calculate Flight Error ***************************
+  calculateFlightError(&setpoint);
+  throttle = setpoint.throttle;
+  
   // ********************** Calculate Motor Commands *************************
   if (motorArmed && safetyCheck) {
     applyMotorCommand();
@@ -220,14 +220,16 @@ void initHomeBase() {
     currentSpeedY = currentSpeedY * (100000 / estimatedDelay); 
     currentSpeed = currentSpeed * (100000 / estimatedDelay); 
   
-    float tmp = degrees(atan2(currentSpeedX, currentSpeedY));
+    float tmp = degrees(fastAtan2(currentSpeedX, currentSpeedY));
     if (tmp < 0) {
       tmp += 360; 
     }
 
     float courseRads = radians(tmp);
-    currentSpeedRoll = (sin(courseRads-trueNorthHeading)*currentSpeed); 
-    currentSpeedPitch = (cos(courseRads-trueNorthHeading)*currentSpeed);
+    float courseSin, courseCos;
+    fastSinCos(courseRads-trueNorthHeading, &courseSin, &courseCos);
+    currentSpeedRoll = (courseSin*currentSpeed); 
+    currentSpeedPitch = (courseCos*currentSpeed);
   }
     
   /**
@@ -236,9 +238,9 @@ void initHomeBase() {
    */
   void computeRollPitchCraftAxisCorrection() {
     
-    angleToWaypoint = atan2(distanceToDestinationX, distanceToDestinationY)-trueNorthHeading;
-    float tmpsin = sin(angleToWaypoint);
-    float tmpcos = cos(angleToWaypoint);
+    angleToWaypoint = fastAtan2(distanceToDestinationX, distanceToDestinationY)-trueNorthHeading;
+    float tmpsin, tmpcos;
+    fastSinCos(angleToWaypoint, &tmpsin, &tmpcos);
     
     float rollSpeedDesired = ((maxSpeedToDestination*tmpsin)*(float)distanceToDestination)/1000; 
     float pitchSpeedDesired = ((maxSpeedToDestination*tmpcos)*(float)distanceToDestination)/1000;
@@ -32,9 +32,9 @@ unsigned long headingTime = micros();
  *
  * This function will calculate the craft heading correction depending 
  * of the users command. Heading correction is process with the gyro
- * or a magnetometer
+ * or a magnetometer, the resulting yaw rate goes into the setpoint
  */
-void processHeading()
+void processHeading(struct ControlSetpoint *setpoint)
 {
   if (headingHoldConfig == ON) {
 
@@ -111,8 +111,7 @@ void processHeading()
     float receiverSiData = (receiverCommand[ZAXIS] - receiverZero[ZAXIS]) * (2.5 * PWM2RAD);
   #endif
   
-  const float commandedYaw = constrain(receiverSiData + radians(headingHold), -PI, PI);
-  motorAxisCommandYaw = updatePID(commandedYaw, gyroRate[ZAXIS], &PID[ZAXIS_PID_IDX]);
+  setpoint->rate[ZAXIS] = constrain(receiverSiData + radians(headingHold), -PI, PI);
 }
 
 #endif
@@ -165,6 +165,46 @@ mavlink_message_t msg;
 uint8_t buf[MAVLINK_MAX_PACKET_LEN];
 mavlink_status_t status;
 
+#if defined(MavLinkHIL)
+  // Hardware in the loop
+  //
+  // A simulator on the other end of the link streams the sensors, the board
+  // flies them with all its code and answers with its motor commands. The
+  // device reads still run, only the values they return are replaced, so the
+  // loop keeps the timing of a real flight, and the ESCs are held at
+  // MINCOMMAND. MAVLink 1.0 has neither HIL_SENSOR nor HIL_ACTUATOR_CONTROLS,
+  // these carry the same:
+  //
+  //   RAW_IMU            in, MPU6000 accel and gyro registers, HMC5883L X, Y and Z registers
+  //   SCALED_PRESSURE    in, the MS5611 pressure
+  //   GPS_RAW_INT        in, the fix, through AP_GPS_HIL
+  //   HIL_RC_INPUTS_RAW  in, the receiver channels in AeroQuad order, roll, pitch, yaw, throttle, mode, AUX1...
+  //   SERVO_OUTPUT_RAW   out, each control loop, the motor commands, time_usec the one of the last RAW_IMU
+  //   NAMED_VALUE_INT    out, every second, frameMean, frameMax and the control loop period in us
+  //
+  // setup() waits for the first RAW_IMU. AeroQuadHost/AeroQuadHIL.cpp is
+  // such a simulator.
+  #if defined(UseGPS)
+    #include <AP_GPS_HIL.h>
+    AP_GPS_HIL hilGps(NULL);
+    uint8_t hilGpsFixType = GPS_NOFIX;
+    uint16_t hilGpsAccuracy = 0;      // cm
+  #endif
+
+  bool hilSensorReceived = false;
+  bool hilParsing = false;
+  uint32_t hilSampleTime = 0;         // us, of the simulator
+  int16_t hilAccel[3] = {0, 0, 0};
+  int16_t hilGyro[3] = {0, 0, 0};
+  int16_t hilMag[3] = {0, 0, 0};
+  float hilPressure = 101325.0;       // Pa
+  int hilReceiver[MAX_NB_CHANNEL] = {1500, 1500, 1500, 1000, 1000, 1000, 1000, 1000, 1000, 1000};
+
+  unsigned long hilFrameSum = 0;
+  unsigned long hilFrameMax = 0;
+  unsigned long hilFrameCount = 0;
+#endif
+
 
 void evaluateParameterListSize() {
 	parameterListSize = 28;
@@ -399,7 +439,7 @@ void sendSerialSysStatus() {
   controlSensorsHealthy = controlSensorsPresent;
 
   #if defined(BattMonitor)
-    mavlink_msg_sys_status_pack(MAV_SYSTEM_ID, MAV_COMPONENT_ID, &msg, controlSensorsPresent, controlSensorEnabled, controlSensorsHealthy, 0, batteryData[0].voltage * 10, (int)(batteryData[0].current*1000), -1, system_dropped_packets, 0, 0, 0, 0, 0);
+    mavlink_msg_sys_status_pack(MAV_SYSTEM_ID, MAV_COMPONENT_ID, &msg, controlSensorsPresent, controlSensorEnabled, controlSensorsHealthy, 0, batteryData[0].voltage * 10, (int)(batteryData[0].current*1000), batteryRemainingPercent(), system_dropped_packets, 0, 0, 0, 0, 0);
   #else
     mavlink_msg_sys_status_pack(MAV_SYSTEM_ID, MAV_COMPONENT_ID, &msg, controlSensorsPresent, controlSensorEnabled, controlSensorsHealthy, 0, 0, 0, 0, system_dropped_packets, 0, 0, 0, 0, 0);  // system_dropped_packets
   #endif
@@ -1229,6 +1269,13 @@ void changeAndSendParameter() {
 }
 
 void readSerialCommand() {
+  #if defined(MavLinkHIL)
+    // the MPU6000 reads call back in here, not while a command calibrates the gyro
+    if (hilParsing) {
+      return;
+    }
+    hilParsing = true;
+  #endif
   while(SERIAL_PORT.available() > 0) {
 
     uint8_t c = SERIAL_PORT.read();
@@ -1377,14 +1424,173 @@ void readSerialCommand() {
         }
         break;
 
+      #if defined(MavLinkHIL)
+        case MAVLINK_MSG_ID_RAW_IMU: {
+            mavlink_raw_imu_t imu;
+            mavlink_msg_raw_imu_decode(&msg, &imu);
+            hilSampleTime = imu.time_usec;
+            hilAccel[XAXIS] = imu.xacc;
+            hilAccel[YAXIS] = imu.yacc;
+            hilAccel[ZAXIS] = imu.zacc;
+            hilGyro[XAXIS] = imu.xgyro;
+            hilGyro[YAXIS] = imu.ygyro;
+            hilGyro[ZAXIS] = imu.zgyro;
+            hilMag[XAXIS] = imu.xmag;
+            hilMag[YAXIS] = imu.ymag;
+            hilMag[ZAXIS] = imu.zmag;
+            hilSensorReceived = true;
+          }
+          break;
+
+        case MAVLINK_MSG_ID_SCALED_PRESSURE: {
+            hilPressure = mavlink_msg_scaled_pressure_get_press_abs(&msg) * 100.0;
+          }
+          break;
+
+        case MAVLINK_MSG_ID_HIL_RC_INPUTS_RAW: {
+            mavlink_hil_rc_inputs_raw_t rc;
+            mavlink_msg_hil_rc_inputs_raw_decode(&msg, &rc);
+            const uint16_t channels[MAX_NB_CHANNEL] = {rc.chan1_raw, rc.chan2_raw, rc.chan3_raw, rc.chan4_raw, rc.chan5_raw,
+                                                       rc.chan6_raw, rc.chan7_raw, rc.chan8_raw, rc.chan9_raw, rc.chan10_raw};
+            for (byte channel = 0; channel < MAX_NB_CHANNEL; channel++) {
+              hilReceiver[channel] = channels[channel];
+            }
+          }
+          break;
+
+        #if defined(UseGPS)
+          case MAVLINK_MSG_ID_GPS_RAW_INT: {
+              mavlink_gps_raw_int_t fix;
+              mavlink_msg_gps_raw_int_decode(&msg, &fix);
+              hilGps.setHIL(fix.time_usec / 1000, fix.lat / 1.0e7, fix.lon / 1.0e7, fix.alt / 1000.0,
+                            fix.vel / 100.0, fix.cog / 100.0, fix.vel / 100.0, fix.satellites_visible);
+              // setHIL() takes float degrees, half a meter steps here, keep the fix's own
+              hilGps.latitude = fix.lat;
+              hilGps.longitude = fix.lon;
+              hilGpsFixType = fix.fix_type;
+              hilGpsAccuracy = fix.eph;
+            }
+            break;
+        #endif
+      #endif
+
       default:
         break;
       }
     }
   }
   system_dropped_packets += status.packet_rx_drop_count;
+  #if defined(MavLinkHIL)
+    hilParsing = false;
+  #endif
 }
 
+#if defined(MavLinkHIL)
+  /**
+   * The simulator's accel and gyro, the port is parsed at each MPU6000 read
+   */
+  void readHILMPU6000(tAxis *accel, tAxis *gyro) {
+    readSerialCommand();
+    while (!hilSensorReceived && !hilParsing) {
+      readSerialCommand();
+    }
+    accel->x = hilAccel[XAXIS];
+    accel->y = hilAccel[YAXIS];
+    accel->z = hilAccel[ZAXIS];
+    gyro->x = hilGyro[XAXIS];
+    gyro->y = hilGyro[YAXIS];
+    gyro->z = hilGyro[ZAXIS];
+  }
+
+  /**
+   * The HMC5883L registers turned as readSpecificMag() turns them
+   */
+  void readHILMag(float *rawMag) {
+    rawMag[XAXIS] = hilMag[YAXIS];
+    rawMag[YAXIS] = hilMag[XAXIS];
+    rawMag[ZAXIS] = -hilMag[ZAXIS];
+  }
+
+  float readHILPressure() {
+    return hilPressure;
+  }
+
+  int getHILChannelValue(byte channel) {
+    return hilReceiver[channel];
+  }
+
+  #if defined(UseGPS)
+    /**
+     * Moves the last fix into gpsData as the UBlox parser does, AP_GPS_HIL
+     * drops to NO_GPS when the fixes stop
+     */
+    void updateHILGps() {
+      hilGps.update();
+      if (hilGps.status() == GPS::NO_GPS) {
+        initializeGpsData();
+        return;
+      }
+      if (!hilGps.new_data) {
+        return;
+      }
+      hilGps.new_data = false;
+      gpsData.lat = hilGps.latitude;
+      gpsData.lon = hilGps.longitude;
+      gpsData.height = hilGps.altitude * 10;          // cm to mm
+      gpsData.speed = hilGps.ground_speed;
+      gpsData.course = hilGps.ground_course * 1000;   // 1/100 to 1/100000 degree
+      gpsData.accuracy = hilGpsAccuracy * 10;
+      gpsData.fixtime = hilGps.time;
+      gpsData.sats = hilGps.num_sats;
+      gpsData.state = hilGpsFixType;
+      gpsData.sentences++;
+      gpsData.idlecount = 0;
+      currentPosition.latitude = gpsData.lat;
+      currentPosition.longitude = gpsData.lon;
+      currentPosition.altitude = gpsData.height;
+    }
+  #endif
+
+  /**
+   * The motor commands of this control loop, MINCOMMAND when not armed
+   */
+  void sendHILMotors() {
+    uint16_t command[8] = {MINCOMMAND, MINCOMMAND, MINCOMMAND, MINCOMMAND, MINCOMMAND, MINCOMMAND, MINCOMMAND, MINCOMMAND};
+    if (motorArmed == ON && safetyCheck == ON) {
+      for (byte motor = 0; motor < LASTMOTOR && motor < 8; motor++) {
+        command[motor] = motorCommand[motor];
+      }
+    }
+    mavlink_msg_servo_output_raw_pack(MAV_SYSTEM_ID, MAV_COMPONENT_ID, &msg, hilSampleTime, 0, command[0], command[1], command[2], command[3], command[4], command[5], command[6], command[7]);
+    len = mavlink_msg_to_send_buffer(buf, &msg);
+    SERIAL_PORT.write(buf, len);
+  }
+
+  /**
+   * Time from the loop() call that starts a control loop to the end of its tasks
+   */
+  void measureHILFrame(unsigned long frameTime) {
+    hilFrameSum += frameTime;
+    hilFrameCount++;
+    if (frameTime > hilFrameMax) {
+      hilFrameMax = frameTime;
+    }
+  }
+
+  void sendHILFrameTime() {
+    const int32_t value[3] = {(int32_t)(hilFrameCount ? hilFrameSum / hilFrameCount : 0), (int32_t)hilFrameMax, CONTROL_LOOP_PERIOD};
+    const char *name[3] = {"frameMean", "frameMax", "period"};
+    for (byte index = 0; index < 3; index++) {
+      mavlink_msg_named_value_int_pack(MAV_SYSTEM_ID, MAV_COMPONENT_ID, &msg, millis(), name[index], value[index]);
+      len = mavlink_msg_to_send_buffer(buf, &msg);
+      SERIAL_PORT.write(buf, len);
+    }
+    hilFrameSum = 0;
+    hilFrameMax = 0;
+    hilFrameCount = 0;
+  }
+#endif
+
 
 void sendQueuedParameters() {
   if(paramListPartIndicator >= 0 && paramListPartIndicator <= 4) {
@@ -64,26 +64,117 @@ struct PIDdata {
 // ALTITUDE = 8 (used for altitude hold)
 // ZDAMPENING = 9 (used in altitude hold to dampen vertical accelerations)
 float windupGuard; // Read in from EEPROM
-//// Modified from http://www.arduino.cc/playground/Main/BarebonesPIDForEspresso
-float updatePID(float targetPosition, float currentPosition, struct PIDdata *PIDparameters) {
 
-  // AKA PID experiments
-  const float deltaPIDTime = (currentTime - PIDparameters->previousPIDTime) / 1000000.0;
+// Engine settings and state beside the EEPROM backed PID[], one array per
+// field so a batch of controllers is a walk down a few arrays
+#define PID_BACK_CALCULATION_TIME 0.1   // s, time constant of the integrator unwind once the output saturates
+#ifndef PID_RATE_SETPOINT_WEIGHT
+  #define PID_RATE_SETPOINT_WEIGHT 1.0  // share of the target in the P term of the rate loop PIDs, 1 is plain error feedback
+#endif
+#ifndef PID_RATE_OUTPUT_LIMIT
+  #define PID_RATE_OUTPUT_LIMIT 0       // +/- saturation of the rate loop PIDs, 0 is none
+#endif
+#ifndef PID_RATE_D_FILTER_HZ
+  #define PID_RATE_D_FILTER_HZ 0        // derivative low pass of the rate loop PIDs, 0 is off
+#endif
 
-  PIDparameters->previousPIDTime = currentTime;  // AKA PID experiments
-  float error = targetPosition - currentPosition;
+float pidSetpointWeight[LAST_PID_IDX];  // b in P * (b * target - current), 1 is plain error feedback
+float pidDFilterTime[LAST_PID_IDX];     // s, RC time constant of the derivative low pass, 0 is off
+float pidOutputLimit[LAST_PID_IDX];     // +/- output saturation with back calculation, 0 is none
+float pidDerivative[LAST_PID_IDX];      // filtered derivative of the measurement
+
+// P, I and D contributions of the last update, for logging
+float pidTermP[LAST_PID_IDX];
+float pidTermI[LAST_PID_IDX];
+float pidTermD[LAST_PID_IDX];
+
+void initializePIDEngine() {
+  for (byte index = 0; index < LAST_PID_IDX; index++) {
+    pidSetpointWeight[index] = 1.0;
+    pidDFilterTime[index] = 0.0;
+    pidOutputLimit[index] = 0.0;
+    pidDerivative[index] = 0.0;
+  }
+  const byte rateLoop[] = {RATE_XAXIS_PID_IDX, RATE_YAXIS_PID_IDX, ZAXIS_PID_IDX, ATTITUDE_GYRO_XAXIS_PID_IDX, ATTITUDE_GYRO_YAXIS_PID_IDX};
+  for (byte i = 0; i < sizeof(rateLoop); i++) {
+    pidSetpointWeight[rateLoop[i]] = PID_RATE_SETPOINT_WEIGHT;
+    pidOutputLimit[rateLoop[i]] = PID_RATE_OUTPUT_LIMIT;
+    #if PID_RATE_D_FILTER_HZ > 0
+      pidDFilterTime[rateLoop[i]] = 1.0 / (2.0 * PI * PID_RATE_D_FILTER_HZ);
+    #endif
+  }
+}
+
+/**
+ * One controller step over dt seconds
+ * The derivative is taken on the measurement, so setpoint steps do not
+ * kick, and kept per 10ms as the D gains have always been tuned that way.
+ */
+float computePID(byte index, float targetPosition, float currentPosition, float dt) {
+  struct PIDdata *PIDparameters = &PID[index];
+  const float error = targetPosition - currentPosition;
+
+  float derivative = (currentPosition - PIDparameters->lastError) / (dt * 100); // dT fix from Honk
+  PIDparameters->lastError = currentPosition;
+  if (pidDFilterTime[index] > 0.0) {
+    derivative = pidDerivative[index] + dt / (pidDFilterTime[index] + dt) * (derivative - pidDerivative[index]);
+  }
+  pidDerivative[index] = derivative;
 
   if (inFlight) {
-    PIDparameters->integratedError += error * deltaPIDTime;
+    PIDparameters->integratedError += error * dt;
   }
   else {
     PIDparameters->integratedError = 0.0;
   }
   PIDparameters->integratedError = constrain(PIDparameters->integratedError, -PIDparameters->windupGuard, PIDparameters->windupGuard);
-  float dTerm = PIDparameters->D * (currentPosition - PIDparameters->lastError) / (deltaPIDTime * 100); // dT fix from Honk
-  PIDparameters->lastError = currentPosition;
 
-  return (PIDparameters->P * error) + (PIDparameters->I * PIDparameters->integratedError) + dTerm;
+  const float pTerm = PIDparameters->P * (pidSetpointWeight[index] * targetPosition - currentPosition);
+  const float dTerm = PIDparameters->D * derivative;
+  float iTerm = PIDparameters->I * PIDparameters->integratedError;
+  float output = pTerm + iTerm + dTerm;
+
+  const float limit = pidOutputLimit[index];
+  if (limit > 0.0 && (output > limit || output < -limit)) {
+    const float saturated = constrain(output, -limit, limit);
+    if (inFlight && PIDparameters->I > 0.0) {
+      // back calculation, bleed the excess out of the integrator but stop
+      // at zero, a P term saturating on its own must not wind it the other way
+      const float integrated = PIDparameters->integratedError;
+      PIDparameters->integratedError += (saturated - output) * dt / (PIDparameters->I * PID_BACK_CALCULATION_TIME);
+      if ((integrated > 0.0 && PIDparameters->integratedError < 0.0) || (integrated < 0.0 && PIDparameters->integratedError > 0.0) || integrated == 0.0) {
+        PIDparameters->integratedError = 0.0;
+      }
+      iTerm = PIDparameters->I * PIDparameters->integratedError;
+    }
+    output = saturated;
+  }
+
+  pidTermP[index] = pTerm;
+  pidTermI[index] = iTerm;
+  pidTermD[index] = dTerm;
+  return output;
+}
+
+//// Modified from http://www.arduino.cc/playground/Main/BarebonesPIDForEspresso
+float updatePID(float targetPosition, float currentPosition, struct PIDdata *PIDparameters) {
+
+  // AKA PID experiments
+  const float deltaPIDTime = (currentTime - PIDparameters->previousPIDTime) / 1000000.0;
+
+  PIDparameters->previousPIDTime = currentTime;  // AKA PID experiments
+  return computePID(PIDparameters - PID, targetPosition, currentPosition, deltaPIDTime);
+}
+
+/**
+ * Runs count controllers that are updated together, every control loop
+ * pass, with the dt of that pass
+ */
+void updatePIDs(const byte *index, const float *targetPosition, const float *currentPosition, float *output, byte count, float dt) {
+  for (byte i = 0; i < count; i++) {
+    PID[index[i]].previousPIDTime = currentTime;
+    output[i] = computePID(index[i], targetPosition[i], currentPosition[i], dt);
+  }
 }
 
 void zeroIntegralError() __attribute__ ((noinline));
@@ -91,6 +182,7 @@ void zeroIntegralError() {
   for (byte axis = 0; axis <= ATTITUDE_YAXIS_PID_IDX; axis++) {
     PID[axis].integratedError = 0;
     PID[axis].previousPIDTime = currentTime;
+    pidDerivative[axis] = 0.0;
   }
 }
 
@@ -62,15 +62,83 @@ void readSerialPID(unsigned char PIDid) {
 }
 
 void skipSerialValues(byte number) {
-  for(byte i=0; i<number; i++) {
-    readFloatSerial();
+  skipSerialCommandFields(number);
+}
+
+// Number of values each command carries, they are all received before the
+// command is applied. Every value is sent even when the feature is not built in.
+byte serialCommandFieldCount(char command) {
+  switch (command) {
+  case 'A': // rate PIDs, rotationSpeedFactor
+  case 'C': // yaw PIDs, headingHoldConfig
+    return 7;
+  case 'B': // attitude PIDs, windupGuard
+    return 13;
+  case 'D': // altitude hold
+    return 12;
+  case 'E':
+  case 'G':
+  case 'H':
+  case 'U':
+    return 2;
+  case 'F':
+    return 1 + LASTCHANNEL - XAXIS;
+  case 'K':
+    return 6;
+  case 'M':
+  case 'N':
+    return 3;
+  case 'O':
+    return 4;
+  case 'P':
+    #ifdef CameraTXControl
+      return 14;
+    #else
+      return 13;
+    #endif
+  case 'V':
+    return 9;
+  case 'R':
+  case 'Y':
+  case 'Z':
+  case '1':
+  case '2':
+  case '4':
+    return 1;
+  case '3': // the rest only follows a valid calibration key
+    return serialCommandParser.field[0].value == 123.45 ? 2 : 1;
+  case '5':
+    return serialCommandParser.field[0].value == 123.45 ? 1 + LASTMOTOR : 1;
+  }
+  return 0;
+}
+
+byte serialCommandFieldKind(char command, byte field) {
+  if (field >= serialCommandFieldCount(command)) {
+    return SERIAL_FIELD_NONE;
   }
+  return (command == 'O') ? SERIAL_FIELD_INTEGER : SERIAL_FIELD_FLOAT;
+}
+
+/**
+ * Takes the bytes waiting on the port, without waiting for more.
+ * Returns true once a whole command is ready for readSerialCommand().
+ */
+boolean parseSerialCommand() {
+  const unsigned long now = millis();
+  if (!isSerialCommandReady() && SERIAL_AVAILABLE() == 0) {
+    expireSerialCommand(now);
+  }
+  while (!isSerialCommandReady() && SERIAL_AVAILABLE()) {
+    parseSerialCommandByte(SERIAL_READ(), now);
+  }
+  return isSerialCommandReady();
 }
 
 void readSerialCommand() {
-  // Check for serial message
-  if (SERIAL_AVAILABLE()) {
-    queryType = SERIAL_READ();
+  // Apply a command once all its values are in
+  if (parseSerialCommand()) {
+    queryType = takeSerialCommand();
     switch (queryType) {
     case 'A': // Receive roll and pitch rate mode PID
       readSerialPID(RATE_XAXIS_PID_IDX);
@@ -174,6 +242,7 @@ void readSerialCommand() {
         magBias[XAXIS]  = readFloatSerial();
         magBias[YAXIS]  = readFloatSerial();
         magBias[ZAXIS]  = readFloatSerial();
+        initializeMagSoftIron(); // min/max calibration only knows the offset
         writeEEPROM();
       #else
         skipSerialValues(3);
@@ -198,9 +267,7 @@ void readSerialCommand() {
         waypoint[missionNbPoint].longitude = readIntegerSerial();
         waypoint[missionNbPoint].altitude = readIntegerSerial();
       #else
-        for(byte i = 0; i < 4; i++) {
-          readFloatSerial();
-        }
+        skipSerialValues(4);
       #endif
       break;
     case 'P': //  read Camera values
@@ -223,13 +290,27 @@ void readSerialCommand() {
         #endif
       #else
         #ifdef CameraTXControl
-          skipSerialValues(14)
+          skipSerialValues(14);
         #else
           skipSerialValues(13);
         #endif
       #endif
       break;
 
+    case 'R': // PID autotune gains, 1 = apply and save, 0 = drop
+      #if defined (PIDAutotune)
+        if ((int)readFloatSerial() == 1) {
+          applyAutotuneGains();
+          writeEEPROM();
+        }
+        else {
+          clearAutotune();
+        }
+      #else
+        skipSerialValues(1);
+      #endif
+      break;
+
     case 'U': // Range Finder
       #if defined (AltitudeHoldRangeFinder)
         maxRangeFinderRange = readFloatSerial();
@@ -258,6 +339,25 @@ void readSerialCommand() {
     case 'X': // Stop sending messages
       break;
 
+    case 'Y': // on board magnetometer calibration, 1 = start, 2 = finish and save, 0 = cancel
+      #if defined(HeadingMagHold) && !defined(COMPASS_CHR6DM)
+        switch ((int)readFloatSerial()) {
+        case 1:
+          startMagCalibration();
+          break;
+        case 2:
+          if (finishMagCalibration()) {
+            writeEEPROM();
+          }
+          break;
+        default:
+          cancelMagCalibration();
+        }
+      #else
+        skipSerialValues(1);
+      #endif
+      break;
+
     case '1': // Calibrate ESCS's by setting Throttle high on all channels
       validateCalibrateCommand(1);
       break;
@@ -301,41 +401,144 @@ void readSerialCommand() {
 //********************************* Serial Telemetry ************************************************
 //***************************************************************************************************
 
+// Telemetry is formatted into a line buffer and sent with one write per
+// line instead of a print() per value and comma
+#if defined(AeroQuadSTM32)
+  #define TELEMETRY_LINE_SIZE 256
+#else
+  #define TELEMETRY_LINE_SIZE 80
+#endif
+#define TELEMETRY_VALUE_SIZE 24       // room for any one value and its comma
+
+char telemetryLine[TELEMETRY_LINE_SIZE];
+byte telemetryLineLength = 0;
+
+void flushTelemetryLine() {
+  if (telemetryLineLength > 0) {
+    SERIAL_PORT.write((const uint8_t *)telemetryLine, telemetryLineLength);
+    telemetryLineLength = 0;
+  }
+}
+
+// Where the next value is written, a line longer than the buffer goes out in pieces
+char *reserveTelemetry() {
+  if (telemetryLineLength > TELEMETRY_LINE_SIZE - TELEMETRY_VALUE_SIZE) {
+    flushTelemetryLine();
+  }
+  return telemetryLine + telemetryLineLength;
+}
+
+void PrintValue(float val, byte digits) {
+  telemetryLineLength += formatFloat(reserveTelemetry(), val, digits);
+}
+
+void PrintValue(float val) {
+  PrintValue(val, 2);
+}
+
+void PrintValue(double val) {
+  PrintValue((float)val, 2);
+}
+
+void PrintValue(char val) {
+  *reserveTelemetry() = val;
+  telemetryLineLength++;
+}
+
+void PrintValue(int val) {
+  telemetryLineLength += formatInteger(reserveTelemetry(), val);
+}
+
+void PrintValue(unsigned long val) {
+  telemetryLineLength += formatUnsigned(reserveTelemetry(), val);
+}
+
+void PrintValue(byte val) {
+  telemetryLineLength += formatUnsigned(reserveTelemetry(), val);
+}
+
+void PrintValue(long int val) {
+  telemetryLineLength += formatInteger(reserveTelemetry(), val);
+}
+
+// Binary replies go through the same buffer, most significant byte first
+// like the fast telemetry
+void PrintBinaryValue(byte val) {
+  *reserveTelemetry() = val;
+  telemetryLineLength++;
+}
+
+void PrintBinaryValue(unsigned int val) {
+  char *data = reserveTelemetry();
+  data[0] = val >> 8;
+  data[1] = val;
+  telemetryLineLength += 2;
+}
+
+void PrintBinaryValue(float val) {
+  uint32_t bits;
+  memcpy(&bits, &val, sizeof(val));
+  char *data = reserveTelemetry();
+  data[0] = bits >> 24;
+  data[1] = bits >> 16;
+  data[2] = bits >> 8;
+  data[3] = bits;
+  telemetryLineLength += 4;
+}
+
+void PrintLine() {
+  reserveTelemetry();
+  telemetryLine[telemetryLineLength++] = '\r';
+  telemetryLine[telemetryLineLength++] = '\n';
+  flushTelemetryLine();
+}
+
+void PrintValueComma(float val, byte digits) {
+  PrintValue(val, digits);
+  comma();
+}
+
 void PrintValueComma(float val) {
-  SERIAL_PRINT(val);
+  PrintValue(val);
   comma();
 }
 
 void PrintValueComma(double val) {
-  SERIAL_PRINT(val);
+  PrintValue(val);
   comma();
 }
 
 void PrintValueComma(char val) {
-  SERIAL_PRINT(val);
+  PrintValue(val);
   comma();
 }
 
 void PrintValueComma(int val) {
-  SERIAL_PRINT(val);
+  PrintValue(val);
   comma();
 }
 
 void PrintValueComma(unsigned long val)
 {
-  SERIAL_PRINT(val);
+  PrintValue(val);
+  comma();
+}
+
+void PrintValueComma(unsigned int val)
+{
+  PrintValue((unsigned long)val);
   comma();
 }
 
 void PrintValueComma(byte val)
 {
-  SERIAL_PRINT(val);
+  PrintValue(val);
   comma();
 }
 
 void PrintValueComma(long int val)
 {
-  SERIAL_PRINT(val);
+  PrintValue(val);
   comma();
 }
 
@@ -375,7 +578,7 @@ void sendSerialTelemetry() {
     PrintPID(RATE_XAXIS_PID_IDX);
     PrintPID(RATE_YAXIS_PID_IDX);
     PrintValueComma(rotationSpeedFactor);
-    SERIAL_PRINTLN();
+    PrintLine();
     queryType = 'X';
     break;
 
@@ -384,14 +587,16 @@ void sendSerialTelemetry() {
     PrintPID(ATTITUDE_YAXIS_PID_IDX);
     PrintPID(ATTITUDE_GYRO_XAXIS_PID_IDX);
     PrintPID(ATTITUDE_GYRO_YAXIS_PID_IDX);
-    SERIAL_PRINTLN(windupGuard);
+    PrintValue(windupGuard);
+    PrintLine();
     queryType = 'X';
     break;
 
   case 'c': // Send yaw PID values
     PrintPID(ZAXIS_PID_IDX);
     PrintPID(HEADING_HOLD_PID_IDX);
-    SERIAL_PRINTLN((int)headingHoldConfig);
+    PrintValue((int)headingHoldConfig);
+    PrintLine();
     queryType = 'X';
     break;
 
@@ -412,13 +617,14 @@ void sendSerialTelemetry() {
     #else
       PrintDummyValues(10);
     #endif
-    SERIAL_PRINTLN();
+    PrintLine();
     queryType = 'X';
     break;
 
   case 'e': // miscellaneous config values
     PrintValueComma(aref);
-    SERIAL_PRINTLN(minArmedThrottle);
+    PrintValue(minArmedThrottle);
+    PrintLine();
     queryType = 'X';
     break;
 
@@ -428,25 +634,23 @@ void sendSerialTelemetry() {
       PrintValueComma(receiverSmoothFactor[axis]);
     }
     PrintDummyValues(10 - LASTCHANNEL);
-    SERIAL_PRINTLN();
+    PrintLine();
     queryType = 'X';
     break;
 
   case 'g': // Send transmitter calibration data
     for (byte axis = XAXIS; axis < LASTCHANNEL; axis++) {
-      Serial.print(receiverSlope[axis], 6);
-      Serial.print(',');
+      PrintValueComma(receiverSlope[axis], 6);
     }
-    SERIAL_PRINTLN();
+    PrintLine();
     queryType = 'X';
     break;
 
   case 'h': // Send transmitter calibration data
     for (byte axis = XAXIS; axis < LASTCHANNEL; axis++) {
-      Serial.print(receiverOffset[axis], 6);
-      Serial.print(',');
+      PrintValueComma(receiverOffset[axis], 6);
     }
-    SERIAL_PRINTLN();
+    PrintLine();
     queryType = 'X';
     break;
 
@@ -464,29 +668,26 @@ void sendSerialTelemetry() {
         PrintValueComma(0);
       #endif
     }
-    SERIAL_PRINTLN();
+    PrintLine();
     break;
 
   case 'j': // Send raw mag values
     #ifdef HeadingMagHold
       PrintValueComma(getMagnetometerRawData(XAXIS));
       PrintValueComma(getMagnetometerRawData(YAXIS));
-      SERIAL_PRINTLN(getMagnetometerRawData(ZAXIS));
+      PrintValue(getMagnetometerRawData(ZAXIS));
+      PrintLine();
     #endif
     break;
 
   case 'k': // Send accelerometer cal values
-    SERIAL_PRINT(accelScaleFactor[XAXIS], 6);
-    comma();
-    SERIAL_PRINT(runTimeAccelBias[XAXIS], 6);
-    comma();
-    SERIAL_PRINT(accelScaleFactor[YAXIS], 6);
-    comma();
-    SERIAL_PRINT(runTimeAccelBias[YAXIS], 6);
-    comma();
-    SERIAL_PRINT(accelScaleFactor[ZAXIS], 6);
-    comma();
-    SERIAL_PRINTLN(runTimeAccelBias[ZAXIS], 6);
+    PrintValueComma(accelScaleFactor[XAXIS], 6);
+    PrintValueComma(runTimeAccelBias[XAXIS], 6);
+    PrintValueComma(accelScaleFactor[YAXIS], 6);
+    PrintValueComma(runTimeAccelBias[YAXIS], 6);
+    PrintValueComma(accelScaleFactor[ZAXIS], 6);
+    PrintValue(runTimeAccelBias[ZAXIS], 6);
+    PrintLine();
     queryType = 'X';
     break;
 
@@ -496,18 +697,18 @@ void sendSerialTelemetry() {
     accelSample[XAXIS] = 0;
     PrintValueComma((int)(accelSample[YAXIS]/accelSampleCount));
     accelSample[YAXIS] = 0;
-    SERIAL_PRINTLN ((int)(accelSample[ZAXIS]/accelSampleCount));
+    PrintValue((int)(accelSample[ZAXIS]/accelSampleCount));
+    PrintLine();
     accelSample[ZAXIS] = 0;
     accelSampleCount = 0;
     break;
 
   case 'm': // Send magnetometer cal values
     #ifdef HeadingMagHold
-      SERIAL_PRINT(magBias[XAXIS], 6);
-      comma();
-      SERIAL_PRINT(magBias[YAXIS], 6);
-      comma();
-      SERIAL_PRINTLN(magBias[ZAXIS], 6);
+      PrintValueComma(magBias[XAXIS], 6);
+      PrintValueComma(magBias[YAXIS], 6);
+      PrintValue(magBias[ZAXIS], 6);
+      PrintLine();
     #endif
     queryType = 'X';
     break;
@@ -520,7 +721,7 @@ void sendSerialTelemetry() {
     #else
       PrintDummyValues(3);
     #endif
-    SERIAL_PRINTLN();
+    PrintLine();
     queryType = 'X';
     break;
 
@@ -535,7 +736,7 @@ void sendSerialTelemetry() {
     #else
       PrintDummyValues(4);
     #endif
-    SERIAL_PRINTLN();
+    PrintLine();
     queryType = 'X';
     break;
 
@@ -564,19 +765,21 @@ void sendSerialTelemetry() {
         PrintDummyValues(13);
       #endif
     #endif
-    SERIAL_PRINTLN();
+    PrintLine();
     queryType = 'X';
     break;
 
   case 'q': // Send Vehicle State Value
-    SERIAL_PRINTLN(vehicleState);
+    PrintValue(vehicleState);
+    PrintLine();
     queryType = 'X';
     break;
 
   case 'r': // Vehicle attitude
     PrintValueComma(kinematicsAngle[XAXIS]);
     PrintValueComma(kinematicsAngle[YAXIS]);
-    SERIAL_PRINTLN(getHeading());
+    PrintValue(getHeading());
+    PrintLine();
     break;
 
   case 's': // Send all flight data
@@ -611,23 +814,25 @@ void sendSerialTelemetry() {
       PrintValueComma(0);
     #endif
     PrintValueComma(flightMode);
-    SERIAL_PRINTLN();
+    PrintLine();
     break;
 
   case 't': // Send processed transmitter values
     for (byte axis = 0; axis < LASTCHANNEL; axis++) {
       PrintValueComma(receiverCommand[axis]);
     }
-    SERIAL_PRINTLN();
+    PrintLine();
     break;
 
   case 'u': // Send range finder values
     #if defined (AltitudeHoldRangeFinder)
       PrintValueComma(maxRangeFinderRange);
-      SERIAL_PRINTLN(minRangeFinderRange);
+      PrintValue(minRangeFinderRange);
+      PrintLine();
     #else
       PrintValueComma(0);
-      SERIAL_PRINTLN(0);
+      PrintValue(0);
+      PrintLine();
     #endif
     queryType = 'X';
     break;
@@ -641,7 +846,7 @@ void sendSerialTelemetry() {
     #else
       PrintDummyValues(9);
     #endif
-    SERIAL_PRINTLN();
+    PrintLine();
     queryType = 'X';
     break;
   case 'y': // send GPS info
@@ -660,7 +865,7 @@ void sendSerialTelemetry() {
     #else
       PrintDummyValues(11);
     #endif    
-    SERIAL_PRINTLN();
+    PrintLine();
     break;
  
   case 'z': // Send all Altitude data 
@@ -670,9 +875,11 @@ void sendSerialTelemetry() {
       PrintValueComma(0);
     #endif 
     #if defined (AltitudeHoldRangeFinder) 
-      SERIAL_PRINTLN(rangeFinderRange[ALTITUDE_RANGE_FINDER_INDEX]);
+      PrintValue(rangeFinderRange[ALTITUDE_RANGE_FINDER_INDEX]);
+      PrintLine();
     #else
-      SERIAL_PRINTLN(0); 
+      PrintValue(0);
+      PrintLine(); 
     #endif 
     break;
     
@@ -682,20 +889,49 @@ void sendSerialTelemetry() {
       #if defined (BM_EXTENDED)
         PrintValueComma((float)batteryData[0].current/100.0);
         PrintValueComma((float)batteryData[0].usedCapacity/1000.0);
+        PrintValueComma(batteryData[0].stateOfCharge*100.0);
+        PrintValueComma((unsigned long)batteryData[0].remainingCapacity);
+        PrintValueComma((unsigned long)batteryData[0].timeToEmpty);
       #else
-        PrintDummyValues(2);
+        PrintDummyValues(5);
       #endif
     #else
-      PrintDummyValues(3);
+      PrintDummyValues(6);
     #endif
-    SERIAL_PRINTLN();
+    PrintLine();
     break;
     
   case '%': // send RSSI
     #if defined (UseAnalogRSSIReader) || defined (UseEzUHFRSSIReader) || defined (UseSBUSRSSIReader)
-      SERIAL_PRINTLN(rssiRawValue);
+      PrintValue(rssiRawValue);
+      PrintLine();
+    #else
+      PrintValue(0);
+      PrintLine();
+    #endif
+    break;
+
+  case 'w': // Send on board magnetometer calibration state and result
+    #if defined(HeadingMagHold) && !defined(COMPASS_CHR6DM)
+      PrintValueComma(magCalibrationState);
+      PrintValueComma((unsigned long)magCalibrationSamples);
+      PrintValueComma(magCalibrationFitError);
+      for (byte axis = XAXIS; axis <= ZAXIS; axis++) {
+        PrintValueComma(magBias[axis]);
+      }
+      for (byte i = 0; i < 8; i++) {
+        PrintValueComma(magSoftIron[i / 3][i % 3], 6);
+      }
+      PrintValue(magSoftIron[ZAXIS][ZAXIS], 6);
+      PrintLine();
+      if (magCalibrationState != MAG_CAL_SAMPLING) {
+        queryType = 'X';
+      }
     #else
-      SERIAL_PRINTLN(0);
+      PrintDummyValues(14);
+      PrintValue(0);
+      PrintLine();
+      queryType = 'X';
     #endif
     break;
 
@@ -703,7 +939,8 @@ void sendSerialTelemetry() {
     break;
 
   case '!': // Send flight software version
-    SERIAL_PRINTLN(SOFTWARE_VERSION, 1);
+    PrintValue(SOFTWARE_VERSION, 1);
+    PrintLine();
     queryType = 'X';
     break;
 
@@ -716,7 +953,102 @@ void sendSerialTelemetry() {
     for (byte motor = 0; motor < LASTMOTOR; motor++) {
       PrintValueComma(motorCommand[motor]);
     }
-    SERIAL_PRINTLN();
+    PrintLine();
+    queryType = 'X';
+    break;
+
+  case '7': // Report sensor calibration stillness
+    #if defined(AeroQuadMega_CHR6DM) || defined(APM_OP_CHR6DM)
+      PrintDummyValues(5);
+      PrintValue(0);
+      PrintLine();
+    #else
+      PrintValueComma(gyroCalibrationQuality);
+      PrintValueComma((unsigned long)gyroCalibration.count);
+      PrintValueComma((unsigned long)gyroCalibration.restarts);
+      PrintValueComma(accelCalibrationQuality);
+      PrintValueComma((unsigned long)accelCalibration.count);
+      PrintValue((unsigned long)accelCalibration.restarts);
+      PrintLine();
+    #endif
+    queryType = 'X';
+    break;
+
+  case '9': // Report P, I and D contributions of every PID as a binary frame, streamed until 'X'
+    PrintBinaryValue(0x5555U); // start word
+    PrintBinaryValue((byte)LAST_PID_IDX);
+    for (byte index = 0; index < LAST_PID_IDX; index++) {
+      PrintBinaryValue(pidTermP[index]);
+      PrintBinaryValue(pidTermI[index]);
+      PrintBinaryValue(pidTermD[index]);
+    }
+    PrintBinaryValue(0x7FFFU); // stop word
+    flushTelemetryLine();
+    break;
+
+  case '0': // Report gyro vibration spectrum and notches, streamed until 'X'
+    #if defined(DynamicNotch)
+      PrintValueComma((int)VIBRATION_BINS);
+      PrintValueComma(vibrationBinFrequency(0));
+      PrintValueComma((float)CONTROL_LOOP_RATE / VIBRATION_BLOCK_SIZE);
+      for (byte axis = XAXIS; axis <= ZAXIS; axis++) {
+        for (byte notch = 0; notch < VIBRATION_NOTCHES; notch++) {
+          PrintValueComma(vibrationNotch[axis][notch].frequency);
+        }
+        for (byte bin = 0; bin < VIBRATION_BINS; bin++) {
+          PrintValueComma(vibrationAmplitude(axis, bin), 4);
+        }
+      }
+    #else
+      PrintDummyValues(VIBRATION_REPORT_FIELDS);
+    #endif
+    PrintLine();
+    break;
+
+  case '@': // Report PID autotune progress, identified plant and gains flown and staged
+    #if defined (PIDAutotune)
+      PrintValueComma((int)autotuneState);
+      PrintValueComma((int)autotuneStage);
+      PrintValueComma((int)autotuneStagesDone);
+      for (byte stage = 0; stage < AUTOTUNE_STAGES; stage++) {
+        PrintValueComma(autotuneUltimateGain[stage]);
+        PrintValueComma(autotuneUltimatePeriod[stage], 3);
+      }
+      for (byte slot = 0; slot < AUTOTUNE_PIDS; slot++) {
+        const struct AutotuneGains staged = getAutotuneGains(slot);
+        PrintValueComma(PID[autotunePIDIndex[slot]].P);
+        PrintValueComma(PID[autotunePIDIndex[slot]].I);
+        PrintValueComma(PID[autotunePIDIndex[slot]].D);
+        PrintValueComma(staged.P);
+        PrintValueComma(staged.I);
+        PrintValueComma(staged.D);
+      }
+    #else
+      PrintDummyValues(AUTOTUNE_REPORT_FIELDS);
+    #endif
+    PrintLine();
+    queryType = 'X';
+    break;
+
+  case '8': // Report I2C bus time and MPU6000 FIFO overflows since the last report
+    #if defined(AeroQuadSTM32)
+      PrintValueComma((int)Wire.isHardware());
+      PrintValueComma((unsigned long)Wire.getTransfers());
+      PrintValueComma((unsigned long)Wire.getErrors());
+      PrintValueComma((unsigned long)Wire.getBusTime());
+      Wire.resetBusTime();
+      #if defined(MPU6000_FIFO)
+        PrintValue((unsigned long)mpu6000FifoOverflows);
+        mpu6000FifoOverflows = 0;
+      #else
+        PrintValue(0);
+      #endif
+      PrintLine();
+    #else
+      PrintDummyValues(4);
+      PrintValue(0);
+      PrintLine();
+    #endif
     queryType = 'X';
     break;
 
@@ -730,46 +1062,20 @@ void sendSerialTelemetry() {
 #endif
 
   }
+  flushTelemetryLine();
 }
 
-void readValueSerial(char *data, byte size) {
-  byte index = 0;
-  byte timeout = 0;
-  data[0] = '\0';
-
-  do {
-    if (SERIAL_AVAILABLE() == 0) {
-      delay(1);
-      timeout++;
-    } else {
-      data[index] = SERIAL_READ();
-      timeout = 0;
-      index++;
-    }
-  } while ((index == 0 || data[index-1] != ';') && (timeout < 10) && (index < size-1));
-
-  data[index] = '\0';
-}
-
-
-// Used to read floating point values from the serial port
+// Next value of the command being applied
 float readFloatSerial() {
-  char data[15] = "";
-
-  readValueSerial(data, sizeof(data));
-  return atof(data);
+  return nextSerialCommandFloat();
 }
 
-// Used to read integer values from the serial port
 long readIntegerSerial() {
-  char data[16] = "";
-
-  readValueSerial(data, sizeof(data));
-  return atol(data);
+  return nextSerialCommandInteger();
 }
 
 void comma() {
-  SERIAL_PRINT(',');
+  PrintValue(',');
 }
 
 
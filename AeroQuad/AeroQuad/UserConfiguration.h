@@ -18,6 +18,9 @@
   along with this program. If not, see <http://www.gnu.org/licenses/>.
 */
 
+#ifndef _AEROQUAD_USER_CONFIGURATION_H_
+#define _AEROQUAD_USER_CONFIGURATION_H_
+
 /****************************************************************************
 				The AeroQuad Manual can be found here:
 		http://aeroquad.com/showwiki.php?title=Book:AeroQuad+Manual
@@ -94,6 +97,14 @@
 #define AltitudeHoldBaro			// Enables Barometer
 //#define AltitudeHoldRangeFinder	// Enables Altitude Hold with range finder, not displayed on the configurator (yet)
 //#define AutoLanding				// Enables auto landing on channel AUX3 of the remote, NEEDS AltitudeHoldBaro AND AltitudeHoldRangeFinder to be defined
+//#define GyroTempCompensation	// Learns the gyro zero versus temperature while disarmed and still, the boot gyro calibration is skipped once learned (ITG3200 and MPU6000 only)
+//#define MPU6000_FIFO          // AQ32 only, reads every 1kHz MPU6000 sample from its FIFO in batches instead of polling the latest one
+//#define CONTROL_LOOP_RATE 400 // AQ32 only, rate in Hz (100, 200, 400 or 500) of the gyro/accel, kinematics, PID and motor loop, other tasks keep their rate
+//#define DynamicNotch          // AQ32 only, needs CONTROL_LOOP_RATE 200 or more, follows the strongest motor vibration peaks of each gyro axis and notches them out before the PIDs
+//#define PIDAutotune           // Flies relay experiments while channel AUX3 of the remote is high in attitude mode and stages new rate and attitude PID gains, review and apply them with the Configurator, can't be used with AutoLanding, NEEDS LASTCHANNEL 8 or more
+//#define PID_RATE_SETPOINT_WEIGHT 0.7 // Share of the stick target in the P term of the rate PIDs, below 1 softens the kick of stick steps without slowing disturbance rejection
+//#define PID_RATE_OUTPUT_LIMIT 500.0  // Saturates the rate PIDs at the motor command that alone spans the mixer range and unwinds their integrator while saturated
+//#define PID_RATE_D_FILTER_HZ 80      // Low pass in Hz on the D term of the rate PIDs
 
 //
 // *******************************************************************************************************************************
@@ -115,6 +126,7 @@
 //
 // Advanced configuration. Please refer to the wiki for instructions.
 //#define BattCustomConfig DEFINE_BATTERY(0,A4,51.8,0,A3,180.3,0)
+//#define BattCapacity 2200      // mAh, NEED a current sensor in BattCustomConfig. Enables remaining capacity, time to empty and the charge based alarm
 
 //
 // *******************************************************************************************************************************
@@ -155,8 +167,12 @@
 //#define MavLink               // Enables the MavLink protocol
 //#define MAV_SYSTEM_ID 100		// Needs to be enabled when using MavLink, used to identify each of your copters using MavLink
 								// If you've only got one, leave the default value unchanged, otherwise make sure that each copter has a different ID 
+//#define MavLinkHIL            // Hardware in the loop, AeroQuad32 only, needs MavLink: the board flies the sensors and sticks a simulator sends
+                                // over MavLink and sends back its motor commands, the ESCs are kept stopped, see AeroQuadHost/AeroQuadHIL.cpp
 
 //#define CONFIG_BAUDRATE 19200 // overrides default baudrate for serial port (Configurator/MavLink/WirelessTelemetry)
+//#define SerialMux             // Frames the Configurator protocol, MavLink (when enabled) and binary logging onto the one serial port
+                                // The ground station needs a demultiplexer, see Libraries/AQ_SerialMux/SerialMux.h for the frame format
 
 //
 // *******************************************************************************************************************************
@@ -214,3 +230,5 @@
  ****************************************************************************
  ****************************************************************************
  ****************************************************************************/
+
+#endif // _AEROQUAD_USER_CONFIGURATION_H_
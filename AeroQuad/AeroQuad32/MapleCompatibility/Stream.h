@@ -0,0 +1,17 @@
+#ifndef Stream_h
+#define Stream_h
+
+// The Arduino Stream the AP_GPS classes keep their port as. The wirish
+// serials are only Print, the HIL GPS of MavLink.h never reads a port.
+
+#include "wirish.h"
+
+class Stream : public Print {
+  public:
+	virtual int available() = 0;
+	virtual int read() = 0;
+	virtual int peek() = 0;
+	virtual void flush() = 0;
+};
+
+#endif
@@ -119,7 +119,7 @@ void initPlatform() {
   pinMode(PLED4, OUTPUT);
 
   // I2C setup
-  Wire.begin(Port2Pin('B', 7), Port2Pin('B', 6)); // I2C1_SDA PB7, I2C1_SCL PB6
+  Wire.begin(Port2Pin('B', 7), Port2Pin('B', 6)); // I2C1_SDA PB7, I2C1_SCL PB6, hardware I2C1 at 400kHz
 
   #if !defined(USE_USB_SERIAL)
     SerialUSB.begin();
@@ -142,8 +142,14 @@ void initializePlatformSpecificAccelCalibration() {
 
 unsigned long previousMeasureCriticalSensorsTime = 0;
 void measureCriticalSensors() {
-  // read sensors not faster than every 1 ms
-  if (currentTime - previousMeasureCriticalSensorsTime >= 1000) {
+  #if defined(MPU6000_FIFO)
+    // the FIFO keeps every 1kHz sample, drain it in batches of two
+    const unsigned long measureInterval = 2000;
+  #else
+    // read sensors not faster than every 1 ms
+    const unsigned long measureInterval = 1000;
+  #endif
+  if (currentTime - previousMeasureCriticalSensorsTime >= measureInterval) {
     measureGyroSum();
     measureAccelSum();
     previousMeasureCriticalSensorsTime = currentTime;
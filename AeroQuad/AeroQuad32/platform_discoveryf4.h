@@ -102,7 +102,7 @@ void initPlatform() {
   #endif
 
   // I2C setup
-  Wire.begin(Port2Pin('B', 9), Port2Pin('B', 6)); // I2C1_SDA PB9, I2C1_SCL PB6
+  Wire.begin(Port2Pin('B', 9), Port2Pin('B', 6)); // I2C1_SDA PB9, I2C1_SCL PB6, hardware I2C1 at 400kHz
 
   HardCodedAxisCalibration();
 
@@ -125,8 +125,14 @@ void initializePlatformSpecificAccelCalibration() {
 
 unsigned long previousMeasureCriticalSensorsTime = 0;
 void measureCriticalSensors() {
-  // read sensors not faster than every 1 ms
-  if (currentTime - previousMeasureCriticalSensorsTime >= 1000) {
+  #if defined(MPU6000_FIFO)
+    // the FIFO keeps every 1kHz sample, drain it in batches of two
+    const unsigned long measureInterval = 2000;
+  #else
+    // read sensors not faster than every 1 ms
+    const unsigned long measureInterval = 1000;
+  #endif
+  if (currentTime - previousMeasureCriticalSensorsTime >= measureInterval) {
 	measureGyroSum();
 	measureAccelSum();
 
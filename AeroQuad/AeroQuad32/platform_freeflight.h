@@ -104,7 +104,7 @@
 
 
 	// I2C setup
-		Wire.begin(Port2Pin('B', 11), Port2Pin('B', 10)); // I2C1_SDA PB11, I2C1_SCL PB10
+		Wire.begin(Port2Pin('B', 11), Port2Pin('B', 10)); // I2C2_SDA PB11, I2C2_SCL PB10, hardware I2C2 at 400kHz
 
 
 		HardCodedAxisCalibration();
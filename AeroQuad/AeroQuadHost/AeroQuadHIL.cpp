@@ -0,0 +1,399 @@
+/*
+  AeroQuad v3.2 - Host build of the AeroQuad32 firmware
+  www.AeroQuad.com
+  Copyright (c) 2012 Ted Carancho.  All rights reserved.
+  An Open Source Arduino based multicopter.
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Closes the loop around a real AeroQuad32 built with MavLinkHIL
+//
+// The board flies with its own code and timing, this program stands in for
+// the vehicle and its sensors, in real time: the plant of VehiclePlant.h
+// moves with the motor commands of SERVO_OUTPUT_RAW, SensorModel.h turns
+// its state into RAW_IMU at 1kHz, SCALED_PRESSURE at 100Hz and GPS_RAW_INT
+// at 5Hz, the pilot of FlightScript.h sends HIL_RC_INPUTS_RAW at 50Hz. The
+// script starts with the first motor message, when setup() has ended, see
+// the protocol in MavLink.h.
+//
+// Each SERVO_OUTPUT_RAW carries the time of the RAW_IMU the control loop
+// flew on, which gives the sensor to motor latency of the board and the
+// link. The board measures its own control loop frames and sends them
+// every second, the headroom is what the longest frame leaves of the
+// control loop period.
+//
+//   AeroQuadHIL [-t seconds] [-o log] device
+//
+//   -t  ends the run after this long, 60s by default
+//   -o  one row per motor message, time, latency, motors and vehicle state
+//
+// The device is the board's MavLink port, /dev/ttyACM0 for the USB serial.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <termios.h>
+#include <unistd.h>
+#include "../Libraries/mavlink/include/mavlink/v1.0/common/mavlink.h"
+#include "SensorModel.h"
+#include "VehiclePlant.h"
+#include "FlightScript.h"
+
+#define SENSOR_STEP 1000          // us, the plant and RAW_IMU rate
+#define BOOT_TIMEOUT 30.0         // s, for the first motor message
+#define HEADING 0.5               // rad, on the ground
+#define SYSTEM_ID 250             // of the simulator on the link
+#define LATENCY_SAMPLES 600000    // ten minutes at 1kHz
+#define LATENCY_START 1.0         // s, the link first drains what piled up in setup()
+
+#define RUN_LANDED 0
+#define RUN_CRASHED 1
+#define RUN_TIMEOUT 2
+#define RUN_STOPPED 3             // ^C
+#define RUN_NO_BOARD 4            // setup() never ended or the link went quiet
+#define RUN_STATUS 5
+
+static const char *runStatus[RUN_STATUS] = {"landed", "crashed", "timed out", "stopped", "no answer from the board"};
+
+static volatile sig_atomic_t stopRequested;
+static int port;
+static unsigned long linkWriteErrors;
+
+static struct VehiclePlant plant;
+static struct ModelRandom sensorRandom;
+static struct ScriptPilot pilot;
+static int motorCommand[PLANT_MOTORS] = {1000, 1000, 1000, 1000};
+static int16_t magField[3];
+
+static uint32_t *latency;
+static unsigned long latencyCount;
+static unsigned long motorMessages;
+
+// the frame times of the board, over the run
+static double frameMeanSum;
+static unsigned long frameMeanCount;
+static long frameMax;
+static long framePeriod;
+
+static void stop(int) {
+  stopRequested = 1;
+}
+
+static uint64_t monotonicMicros() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+/**
+ * The port raw, the USB serial of the board ignores the baud rate
+ */
+static int openLink(const char *device) {
+  const int fd = open(device, O_RDWR | O_NOCTTY | O_NONBLOCK);
+  if (fd < 0) {
+    perror(device);
+    return -1;
+  }
+  struct termios settings;
+  if (tcgetattr(fd, &settings) == 0) {
+    cfmakeraw(&settings);
+    cfsetispeed(&settings, B115200);
+    cfsetospeed(&settings, B115200);
+    settings.c_cflag |= CLOCAL | CREAD;
+    tcsetattr(fd, TCSANOW, &settings);
+  }
+  tcflush(fd, TCIOFLUSH);
+  return fd;
+}
+
+static void sendMessage(mavlink_message_t *msg) {
+  uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+  const uint16_t length = mavlink_msg_to_send_buffer(buffer, msg);
+  uint16_t sent = 0;
+  while (sent < length) {
+    const ssize_t written = write(port, buffer + sent, length - sent);
+    if (written > 0) {
+      sent += written;
+    }
+    else if (written < 0 && errno == EAGAIN) {
+      struct pollfd writable = {port, POLLOUT, 0};
+      poll(&writable, 1, 10);
+    }
+    else if (written < 0 && errno != EINTR) {
+      linkWriteErrors++;
+      return;
+    }
+  }
+}
+
+/**
+ * The sensors of this plant step, time in us from the start of the run,
+ * stamp when they leave for the board
+ */
+static void sendSensors(uint64_t time, uint64_t stamp, const struct SensorNoise *noise) {
+  const struct Environment *environment = &modelDefaultEnvironment;
+  const double t = time / 1000000.0;
+  const bool spinning = motorCommand[0] > 1100 || motorCommand[1] > 1100 || motorCommand[2] > 1100 || motorCommand[3] > 1100;
+  mavlink_message_t msg;
+
+  if (time % 13000 == 0) {
+    modelHMC5883L(&plant.state, noise, environment, &sensorRandom, magField);
+  }
+  int16_t accel[3], gyro[3], temperature;
+  modelMPU6000(&plant.state, noise, &sensorRandom, spinning, t, accel, &temperature, gyro);
+  mavlink_msg_raw_imu_pack(SYSTEM_ID, 0, &msg, stamp, accel[0], accel[1], accel[2], gyro[0], gyro[1], gyro[2],
+                           magField[0], magField[1], magField[2]);
+  sendMessage(&msg);
+
+  if (time % 10000 == 0) {
+    const float pressure = modelPressure(&plant.state, noise, environment, &sensorRandom) / 100.0;
+    mavlink_msg_scaled_pressure_pack(SYSTEM_ID, 0, &msg, time / 1000, pressure, 0.0, (int16_t)(noise->temperature * 100.0));
+    sendMessage(&msg);
+  }
+  if (time % 20000 == 0) {
+    const int *stick = pilot.stick;
+    mavlink_msg_hil_rc_inputs_raw_pack(SYSTEM_ID, 0, &msg, time, stick[0], stick[1], stick[2], stick[3], stick[4], stick[5],
+                                       stick[6], stick[7], 1000, 1000, 0, 0, 255);
+    sendMessage(&msg);
+  }
+  if (time % 200000 == 0) {
+    struct HostGpsFix fix;
+    modelGps(&plant.state, noise, environment, &sensorRandom, 9, &fix);
+    const double speed = hypot(fix.velocity[0], fix.velocity[1]);
+    double course = atan2(fix.velocity[1], fix.velocity[0]) * 180.0 / M_PI;
+    course = course < 0.0 ? course + 360.0 : course;
+    mavlink_msg_gps_raw_int_pack(SYSTEM_ID, 0, &msg, time, fix.fix, fix.latitude, fix.longitude, fix.height,
+                                 fix.accuracy / 10, 65535, (uint16_t)speed, (uint16_t)(course * 100.0) % 36000, fix.sats);
+    sendMessage(&msg);
+  }
+}
+
+/**
+ * The messages of the board, received at now us
+ */
+static void receiveMessage(const mavlink_message_t *msg, uint64_t now, FILE *log, double t) {
+  if (msg->msgid == MAVLINK_MSG_ID_SERVO_OUTPUT_RAW) {
+    mavlink_servo_output_raw_t servo;
+    mavlink_msg_servo_output_raw_decode(msg, &servo);
+    motorCommand[0] = servo.servo1_raw;
+    motorCommand[1] = servo.servo2_raw;
+    motorCommand[2] = servo.servo3_raw;
+    motorCommand[3] = servo.servo4_raw;
+    motorMessages++;
+    // nothing to echo before the first RAW_IMU got there
+    if (servo.time_usec == 0) {
+      return;
+    }
+    const uint32_t age = (uint32_t)now - servo.time_usec;
+    if (t >= LATENCY_START && latencyCount < LATENCY_SAMPLES) {
+      latency[latencyCount++] = age;
+    }
+    if (log) {
+      const struct VehicleState *state = &plant.state;
+      fprintf(log, "%.4f %u %d %d %d %d %.3f %.3f %.3f %.4f %.4f %.4f\n", t, age,
+              motorCommand[0], motorCommand[1], motorCommand[2], motorCommand[3],
+              state->position[0], state->position[1], -state->position[2],
+              state->attitude[0], state->attitude[1], state->attitude[2]);
+    }
+  }
+  else if (msg->msgid == MAVLINK_MSG_ID_NAMED_VALUE_INT) {
+    mavlink_named_value_int_t named;
+    mavlink_msg_named_value_int_decode(msg, &named);
+    char name[11];
+    memcpy(name, named.name, 10);
+    name[10] = '\0';
+    if (strcmp(name, "frameMean") == 0) {
+      frameMeanSum += named.value;
+      frameMeanCount++;
+    }
+    else if (strcmp(name, "frameMax") == 0 && named.value > frameMax) {
+      frameMax = named.value;
+    }
+    else if (strcmp(name, "period") == 0) {
+      framePeriod = named.value;
+    }
+  }
+}
+
+static int compareLatency(const void *a, const void *b) {
+  const uint32_t first = *(const uint32_t *)a, second = *(const uint32_t *)b;
+  return first < second ? -1 : first > second;
+}
+
+// nearest rank
+static uint32_t percentile(const uint32_t *sorted, unsigned long count, double share) {
+  unsigned long rank = (unsigned long)ceil(share * count);
+  return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+static void printReport(int status, double t, unsigned long overruns, const mavlink_status_t *linkStatus) {
+  printf("%s at %.1fs, %lu motor messages\n", runStatus[status], t, motorMessages);
+  if (latencyCount > 0) {
+    qsort(latency, latencyCount, sizeof(uint32_t), compareLatency);
+    printf("sensor to motor latency, us: 50%% %u, 90%% %u, 99%% %u, max %u\n",
+           percentile(latency, latencyCount, 0.5), percentile(latency, latencyCount, 0.9),
+           percentile(latency, latencyCount, 0.99), latency[latencyCount - 1]);
+  }
+  if (frameMeanCount > 0 && framePeriod > 0) {
+    printf("control loop frame, us: mean %.0f, max %ld of %ld, headroom %.0f%%\n", frameMeanSum / frameMeanCount,
+           frameMax, framePeriod, (1.0 - (double)frameMax / framePeriod) * 100.0);
+  }
+  printf("%lu late sensor steps, %u messages dropped by the parser, %lu write errors\n",
+         overruns, linkStatus->packet_rx_drop_count, linkWriteErrors);
+}
+
+static void usage() {
+  fprintf(stderr, "usage: AeroQuadHIL [-t seconds] [-o log] device\n");
+  exit(2);
+}
+
+int main(int argc, char *argv[]) {
+  const char *deviceName = NULL;
+  const char *logName = NULL;
+  double runTime = 60.0;
+  for (int arg = 1; arg < argc; arg++) {
+    if (strcmp(argv[arg], "-t") == 0 && arg + 1 < argc) {
+      runTime = strtod(argv[++arg], NULL);
+    }
+    else if (strcmp(argv[arg], "-o") == 0 && arg + 1 < argc) {
+      logName = argv[++arg];
+    }
+    else if (argv[arg][0] != '-' && !deviceName) {
+      deviceName = argv[arg];
+    }
+    else {
+      usage();
+    }
+  }
+  if (!deviceName || runTime <= 0.0) {
+    usage();
+  }
+  FILE *log = NULL;
+  if (logName && !(log = fopen(logName, "w"))) {
+    fprintf(stderr, "can't write %s\n", logName);
+    return 2;
+  }
+  if ((port = openLink(deviceName)) < 0) {
+    return 2;
+  }
+  if (log) {
+    fprintf(log, "# t latency motor1 motor2 motor3 motor4 north east altitude roll pitch yaw\n");
+  }
+  signal(SIGINT, stop);
+  latency = (uint32_t *)malloc(LATENCY_SAMPLES * sizeof(uint32_t));
+
+  const struct SensorNoise *noise = &modelDefaultNoise;
+  seedModelRandom(&sensorRandom, 1);
+  initVehiclePlant(&plant, HEADING);
+  initScriptPilot(&pilot);
+  pilotSticks(&pilot, &plant, 0.0, 0.0);
+
+  const double dt = SENSOR_STEP / 1000000.0;
+  const uint64_t start = monotonicMicros();
+  uint64_t nextStep = start + SENSOR_STEP;
+  uint64_t sensorTime = 0;          // us, of the run, of the plant step
+  uint64_t scriptStart = 0;         // us, of the run, 0 before the first motor message
+  uint64_t lastMotorMessage = 0;
+  unsigned long overruns = 0;
+  int status = RUN_TIMEOUT;
+  mavlink_message_t msg;
+  mavlink_status_t linkStatus;
+  memset(&linkStatus, 0, sizeof(linkStatus));
+  printf("waiting for %s to end setup()\n", deviceName);
+  fflush(stdout);
+
+  while (!stopRequested) {
+    const uint64_t now = monotonicMicros();
+    if (now >= nextStep) {
+      // a step late by more than a few is dropped, the plant keeps real time
+      if (now - nextStep > 5 * SENSOR_STEP) {
+        overruns++;
+        const uint64_t skipped = (now - nextStep) / SENSOR_STEP;
+        nextStep += skipped * SENSOR_STEP;
+        sensorTime += skipped * SENSOR_STEP;
+      }
+      nextStep += SENSOR_STEP;
+      sensorTime += SENSOR_STEP;
+      const uint64_t stamp = now - start;
+      const double t = scriptStart ? (sensorTime - scriptStart) / 1000000.0 : 0.0;
+      if (scriptStart) {
+        pilotSticks(&pilot, &plant, t, dt);
+      }
+      const double calm[3] = {0.0, 0.0, 0.0};
+      stepVehiclePlant(&plant, &modelDefaultPlant, motorCommand, calm, dt);
+      sendSensors(sensorTime, stamp, noise);
+
+      const double quiet = (sensorTime - lastMotorMessage) / 1000000.0;
+      if ((!scriptStart && sensorTime / 1000000.0 > BOOT_TIMEOUT) || (scriptStart && quiet > 2.0)) {
+        status = RUN_NO_BOARD;
+        break;
+      }
+      if (plant.crashed) {
+        status = RUN_CRASHED;
+        break;
+      }
+      if (pilot.landedTime > 0.0 && t >= pilot.landedTime + 3.0) {
+        status = RUN_LANDED;
+        break;
+      }
+      if (t >= runTime) {
+        break;
+      }
+      continue;
+    }
+
+    // the board's answers are timed as they come, not at the next step
+    const uint64_t wait = nextStep - now;
+    const struct timespec timeout = {(time_t)(wait / 1000000), (long)(wait % 1000000) * 1000};
+    struct pollfd readable = {port, POLLIN, 0};
+    if (ppoll(&readable, 1, &timeout, NULL) <= 0 || !(readable.revents & POLLIN)) {
+      continue;
+    }
+    uint8_t data[512];
+    const ssize_t count = read(port, data, sizeof(data));
+    const uint64_t received = monotonicMicros() - start;
+    for (ssize_t index = 0; index < count; index++) {
+      if (mavlink_parse_char(MAVLINK_COMM_0, data[index], &msg, &linkStatus)) {
+        if (msg.msgid == MAVLINK_MSG_ID_SERVO_OUTPUT_RAW) {
+          if (!scriptStart) {
+            scriptStart = sensorTime;
+            printf("board flying, script started\n");
+            fflush(stdout);
+          }
+          lastMotorMessage = sensorTime;
+        }
+        receiveMessage(&msg, received, log, scriptStart ? (sensorTime - scriptStart) / 1000000.0 : 0.0);
+      }
+    }
+  }
+  if (stopRequested) {
+    status = RUN_STOPPED;
+  }
+
+  const double t = scriptStart ? (sensorTime - scriptStart) / 1000000.0 : 0.0;
+  printReport(status, status == RUN_LANDED ? pilot.landedTime : t, overruns, &linkStatus);
+  if (log) {
+    fclose(log);
+  }
+  close(port);
+  free(latency);
+  return status == RUN_LANDED ? 0 : 1;
+}
@@ -0,0 +1,522 @@
+/*
+  AeroQuad v3.2 - Host build of the AeroQuad32 firmware
+  www.AeroQuad.com
+  Copyright (c) 2012 Ted Carancho.  All rights reserved.
+  An Open Source Arduino based multicopter.
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Flies the AeroQuad32 firmware many times over, on every core
+//
+// Each flight closes the loop between the firmware and the plant of
+// VehiclePlant.h: the motor outputs move the vehicle, SensorModel.h turns
+// its state into the sensor samples and the pilot of FlightScript.h, who
+// sees the real state, works the sticks. The GPS has a fix from 2s and 9
+// satellites from 5s.
+//
+// The plant, noise, wind, motor failures and GPS glitches of each flight
+// are drawn from a scenario, see Scenario.h. The firmware keeps all its
+// state in globals, so every flight runs in a process of its own, forked
+// from this one before setup() ever ran, as many at once as there are
+// cores. Each returns its results through a pipe, a flight that kills its
+// process is counted as aborted, one whose setup() never ends, waiting for
+// a still gyro, as stuck. An aborted flight, or a control loop timed at a
+// median of 0 or a 99th percentile below it, makes the run exit with 1.
+//
+//   AeroQuadMonteCarlo [-j jobs] [-n flights] [-o results] scenario
+//
+//   -j  flights run at once, the number of cores by default
+//   -n  flights, instead of the number of the scenario
+//   -o  one row per flight to this file, parameters and results
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "Scenario.h"
+#include "VehiclePlant.h"
+#include "FlightScript.h"
+#include "HostProfiler.h"
+
+#include "HostConfiguration.h"
+#include <SerialMapping.h>
+#include <WProgram.h>
+
+#include "../AeroQuad/AeroQuad.ino"
+
+#define FLIGHT_STEP 1000          // us, the plant and MPU6000 rate
+#define LOOP_STEP 100             // us the clock moves between two calls of loop()
+#define FLIGHT_TIMEOUT 60.0       // s
+#define BOOT_TIMEOUT 20.0         // s, for setup()
+#define HEADING 0.5               // rad, on the ground
+#define STICK_ANGLE ATTITUDE_SCALING  // rad per us of roll and pitch stick
+
+#define FLIGHT_LANDED 0
+#define FLIGHT_CRASHED 1
+#define FLIGHT_LOST 2             // still in the air at FLIGHT_TIMEOUT
+#define FLIGHT_STUCK 3            // setup() did not end
+#define FLIGHT_ABORTED 4          // the process died
+#define FLIGHT_STATUS 5
+
+static const char *flightStatus[FLIGHT_STATUS] = {"landed", "crashed", "lost", "stuck", "aborted"};
+
+#define ATTITUDE_TRACKING 0
+#define ROLL_OVERSHOOT 1
+#define ATTITUDE_ESTIMATE 2
+#define ALTITUDE_HOLD 3
+#define POSITION_HOLD 4
+#define TOUCH_DOWN 5
+#define CONTROL_LOOP_MEAN 6
+#define CONTROL_LOOP_MEDIAN 7
+#define CONTROL_LOOP_99 8
+#define FLIGHT_METRICS 9
+
+static const char *flightMetric[FLIGHT_METRICS] = {
+  "attitude tracking, deg rms",
+  "roll step overshoot, %",
+  "attitude estimate, deg max",
+  "altitude hold, m max",
+  "position hold, m max",
+  "touch down, m/s",
+  "control loop mean, " PROFILE_UNIT,
+  "control loop median, " PROFILE_UNIT,
+  "control loop 99%, " PROFILE_UNIT
+};
+
+static const char *flightMetricColumn[FLIGHT_METRICS] = {
+  "tracking", "overshoot", "estimate", "altHold", "posHold", "touchDown", "loopMean", "loopMedian", "loop99"
+};
+
+struct FlightResult {
+  unsigned long flight;
+  int status;
+  int signal;               // that killed an aborted flight
+  double time;              // s, of the crash, the landing or the end of the boot
+  double metric[FLIGHT_METRICS];  // NAN when the flight did not get there
+};
+
+// one flight, in its own process
+static struct FlightResult flightResult;
+static int flightPipe;
+static bool flightBooted;
+static struct FlightParameters flightParameters;
+static struct VehiclePlant plant;
+static struct ModelRandom sensorRandom;
+static double gust[3];
+static unsigned long nextPlantTime;
+static struct ScriptPilot pilot;
+static bool altitudeHoldTrimmed;
+
+static double trackingError;
+static unsigned long trackingSamples;
+static double rollPeak;
+static double altitudeHoldTarget;
+static double positionHoldTarget[2];
+
+/**
+ * Hands the result to the parent process and ends this one
+ */
+static void endFlight() {
+  const bool written = write(flightPipe, &flightResult, sizeof(flightResult)) == (ssize_t)sizeof(flightResult);
+  _exit(written ? 0 : 1);
+}
+
+/**
+ * Sensor source, moves the plant and samples its sensors up to now
+ */
+static void flyVehicle(unsigned long now) {
+  const double dt = FLIGHT_STEP / 1000000.0;
+  while (nextPlantTime <= now) {
+    const unsigned long time = nextPlantTime;
+    const double t = time / 1000000.0;
+    nextPlantTime += FLIGHT_STEP;
+    if (!flightBooted && t > BOOT_TIMEOUT) {
+      flightResult.status = FLIGHT_STUCK;
+      flightResult.time = t;
+      endFlight();
+    }
+    pilotSticks(&pilot, &plant, t, dt);
+
+    // gusts as a first order random walk back to the steady wind, 1s long
+    double wind[3];
+    for (int axis = 0; axis < 3; axis++) {
+      const double deviation = axis == 2 ? 0.5 * flightParameters.windGust : flightParameters.windGust;
+      gust[axis] += -gust[axis] * dt + gaussianModelRandom(&sensorRandom, deviation * sqrt(2.0 * dt));
+      wind[axis] = flightParameters.wind[axis] + gust[axis];
+    }
+    if (flightParameters.failedMotor >= 0 && t >= flightParameters.motorFailureTime) {
+      plant.motorHealth[flightParameters.failedMotor] = 1.0 - flightParameters.motorLoss;
+    }
+    stepVehiclePlant(&plant, &flightParameters.plant, hostMotorOutput, wind, dt);
+
+    const struct SensorNoise *noise = &flightParameters.noise;
+    const struct Environment *environment = &modelDefaultEnvironment;
+    int16_t accel[3], gyro[3], temperature;
+    modelMPU6000(&plant.state, noise, &sensorRandom, motorArmed, t, accel, &temperature, gyro);
+    hostMPU6000Sample(accel, temperature, gyro);
+    if (time % 13000 == 0) {
+      int16_t field[3];
+      modelHMC5883L(&plant.state, noise, environment, &sensorRandom, field);
+      hostHMC5883LSample(field);
+    }
+    if (time % 10000 == 0) {
+      uint32_t d1, d2;
+      modelMS5611(&plant.state, noise, environment, &sensorRandom, &d1, &d2);
+      hostMS5611Sample(d1, d2);
+    }
+    if (time % 20000 == 0) {
+      hostReceiverSample(pilot.stick, SCRIPT_CHANNELS);
+    }
+    if (time % 200000 == 0 && t >= 2.0) {
+      struct VehicleState gpsState = plant.state;
+      if (t >= flightParameters.gpsGlitchTime && t < flightParameters.gpsGlitchTime + SCENARIO_GLITCH_DURATION) {
+        gpsState.position[0] += flightParameters.gpsGlitch[0];
+        gpsState.position[1] += flightParameters.gpsGlitch[1];
+      }
+      struct HostGpsFix fix;
+      modelGps(&gpsState, noise, environment, &sensorRandom, t >= 5.0 ? 9 : 5, &fix);
+      hostGpsSample(&fix);
+    }
+  }
+}
+
+static void keepLargest(double *metric, double value) {
+  if (isnan(*metric) || value > *metric) {
+    *metric = value;
+  }
+}
+
+/**
+ * Compares the firmware with the real state, once per plant step
+ */
+static void measureFlight(double t, struct FlightResult *result) {
+  const struct VehicleState *state = &plant.state;
+  if (plant.onGround) {
+    return;
+  }
+  const double degrees = 180.0 / M_PI;
+  const double estimateError = fmax(fabs(kinematicsAngle[XAXIS] - state->attitude[0]),
+                                    fabs(kinematicsAngle[YAXIS] - state->attitude[1]));
+  keepLargest(&result->metric[ATTITUDE_ESTIMATE], estimateError * degrees);
+
+  if (t >= 14.5 && t < 24.0) {
+    const double rollError = (pilot.stick[0] - 1500) * STICK_ANGLE - state->attitude[0];
+    // pitch stick down is nose up
+    const double pitchError = -(pilot.stick[1] - 1500) * STICK_ANGLE - state->attitude[1];
+    trackingError += rollError * rollError + pitchError * pitchError;
+    trackingSamples++;
+    result->metric[ATTITUDE_TRACKING] = sqrt(trackingError / (2.0 * trackingSamples)) * degrees;
+  }
+  if (t >= 16.5 && t < 17.5) {
+    rollPeak = fmax(rollPeak, state->attitude[0]);
+    const double step = 150 * STICK_ANGLE;
+    result->metric[ROLL_OVERSHOOT] = fmax(0.0, (rollPeak - step) / step * 100.0);
+  }
+
+  if (t >= 20.0 && t < 30.0 && altitudeHoldState == ON) {
+    if (!altitudeHoldTrimmed) {
+      altitudeHoldTarget = -state->position[2];
+      altitudeHoldTrimmed = true;
+    }
+    keepLargest(&result->metric[ALTITUDE_HOLD], fabs(-state->position[2] - altitudeHoldTarget));
+  }
+  if (t >= 24.0 && t < 30.0 && positionHoldState == ON) {
+    if (isnan(result->metric[POSITION_HOLD])) {
+      positionHoldTarget[0] = state->position[0];
+      positionHoldTarget[1] = state->position[1];
+      result->metric[POSITION_HOLD] = 0.0;
+    }
+    keepLargest(&result->metric[POSITION_HOLD], hypot(state->position[0] - positionHoldTarget[0],
+                                                      state->position[1] - positionHoldTarget[1]));
+  }
+}
+
+/**
+ * One whole flight, run in a fresh process, its result goes to the pipe
+ */
+static void runFlight(const struct Scenario *scenario, unsigned long flight, int pipe) {
+  struct FlightResult *result = &flightResult;
+  flightPipe = pipe;
+  drawFlightParameters(scenario, flight, &flightParameters);
+  seedModelRandom(&sensorRandom, flightParameters.seed);
+  initVehiclePlant(&plant, HEADING);
+  result->flight = flight;
+  for (int metric = 0; metric < FLIGHT_METRICS; metric++) {
+    result->metric[metric] = NAN;
+  }
+  nextPlantTime = FLIGHT_STEP;
+  initScriptPilot(&pilot);
+  pilotSticks(&pilot, &plant, 0.0, 0.0);
+
+  setHostSensorSource(flyVehicle);
+  setup();
+  flightBooted = true;
+  profileEnabled = true;
+  unsigned long nextMeasure = (getHostClock() / FLIGHT_STEP + 1) * FLIGHT_STEP;
+  result->status = FLIGHT_LOST;
+  while (getHostClock() < FLIGHT_TIMEOUT * 1000000) {
+    advanceHostClock(LOOP_STEP);
+    loop();
+    const double t = getHostClock() / 1000000.0;
+    if (getHostClock() >= nextMeasure) {
+      nextMeasure += FLIGHT_STEP;
+      measureFlight(t, result);
+    }
+    if (plant.crashed) {
+      result->status = FLIGHT_CRASHED;
+      result->time = t;
+      break;
+    }
+    if (pilot.landedTime > 0.0 && t >= pilot.landedTime + 3.0) {
+      result->status = FLIGHT_LANDED;
+      result->time = pilot.landedTime;
+      result->metric[TOUCH_DOWN] = plant.touchDownSpeed;
+      break;
+    }
+  }
+  profileEnabled = false;
+  struct ProfiledFunction *controlLoop = &profiledFunction[1];
+  if (controlLoop->calls > 0) {
+    result->metric[CONTROL_LOOP_MEAN] = profileMean(controlLoop, NULL);
+    result->metric[CONTROL_LOOP_MEDIAN] = profilePercentile(controlLoop, 0.5);
+    result->metric[CONTROL_LOOP_99] = profilePercentile(controlLoop, 0.99);
+  }
+  endFlight();
+}
+
+static int compareMetrics(const void *a, const void *b) {
+  const double first = *(const double *)a, second = *(const double *)b;
+  return first < second ? -1 : first > second;
+}
+
+// nearest rank
+static double percentile(const double *sorted, unsigned long count, double share) {
+  unsigned long rank = (unsigned long)ceil(share * count);
+  return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+static void printReport(const struct Scenario *scenario, const struct FlightResult *results, unsigned long flights) {
+  unsigned long count[FLIGHT_STATUS] = {0, 0, 0, 0, 0};
+  unsigned long motorFailures = 0, motorCrashes = 0, glitches = 0, glitchCrashes = 0;
+  for (unsigned long flight = 0; flight < flights; flight++) {
+    struct FlightParameters parameters;
+    drawFlightParameters(scenario, flight, &parameters);
+    const bool crashed = results[flight].status == FLIGHT_CRASHED || results[flight].status == FLIGHT_LOST;
+    count[results[flight].status]++;
+    if (parameters.failedMotor >= 0) {
+      motorFailures++;
+      motorCrashes += crashed;
+    }
+    if (parameters.gpsGlitchTime > 0.0) {
+      glitches++;
+      glitchCrashes += crashed;
+    }
+  }
+  for (int status = 0; status < FLIGHT_STATUS; status++) {
+    printf("%s %lu%s", flightStatus[status], count[status], status + 1 < FLIGHT_STATUS ? ", " : "\n");
+  }
+  printf("%lu flights with a failed motor, %lu of them crashed or lost\n", motorFailures, motorCrashes);
+  printf("%lu flights with a GPS glitch, %lu of them crashed or lost\n", glitches, glitchCrashes);
+
+  double *values = (double *)malloc(flights * sizeof(double));
+  printf("%-30s %8s %10s %10s %10s %10s\n", "", "flights", "50%", "90%", "99%", "max");
+  for (int metric = 0; metric < FLIGHT_METRICS; metric++) {
+    unsigned long measured = 0;
+    for (unsigned long flight = 0; flight < flights; flight++) {
+      if (!isnan(results[flight].metric[metric])) {
+        values[measured++] = results[flight].metric[metric];
+      }
+    }
+    if (measured == 0) {
+      printf("%-30s %8lu %10s %10s %10s %10s\n", flightMetric[metric], 0UL, "-", "-", "-", "-");
+      continue;
+    }
+    qsort(values, measured, sizeof(double), compareMetrics);
+    printf("%-30s %8lu %10.2f %10.2f %10.2f %10.2f\n", flightMetric[metric], measured,
+           percentile(values, measured, 0.5), percentile(values, measured, 0.9),
+           percentile(values, measured, 0.99), values[measured - 1]);
+  }
+  free(values);
+}
+
+static void writeResults(FILE *file, const struct Scenario *scenario, const struct FlightResult *results, unsigned long flights) {
+  fprintf(file, "# flight seed mass wind gust accelNoise gyroNoise vibration motor motorLoss failureTime glitch glitchTime status time");
+  for (int metric = 0; metric < FLIGHT_METRICS; metric++) {
+    fprintf(file, " %s", flightMetricColumn[metric]);
+  }
+  fprintf(file, "\n");
+  for (unsigned long flight = 0; flight < flights; flight++) {
+    struct FlightParameters parameters;
+    drawFlightParameters(scenario, flight, &parameters);
+    const struct FlightResult *result = &results[flight];
+    fprintf(file, "%lu %u %.3f %.2f %.2f %.3f %.4f %.2f %d %.2f %.2f %.1f %.2f %s %.2f", flight, parameters.seed,
+            parameters.plant.mass, hypot(parameters.wind[0], parameters.wind[1]), parameters.windGust,
+            parameters.noise.accel, parameters.noise.gyro, parameters.noise.vibration, parameters.failedMotor + 1, parameters.motorLoss, parameters.motorFailureTime,
+            hypot(parameters.gpsGlitch[0], parameters.gpsGlitch[1]), parameters.gpsGlitchTime,
+            flightStatus[result->status], result->time);
+    for (int metric = 0; metric < FLIGHT_METRICS; metric++) {
+      fprintf(file, " %.3f", result->metric[metric]);
+    }
+    fprintf(file, "\n");
+  }
+}
+
+static double wallClock() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec / 1.0e9;
+}
+
+static void usage() {
+  fprintf(stderr, "usage: AeroQuadMonteCarlo [-j jobs] [-n flights] [-o results] scenario\n");
+  exit(2);
+}
+
+struct FlightProcess {
+  pid_t pid;
+  int pipe;
+  unsigned long flight;
+};
+
+int main(int argc, char *argv[]) {
+  const char *scenarioName = NULL;
+  const char *resultsName = NULL;
+  long jobs = sysconf(_SC_NPROCESSORS_ONLN);
+  long flights = -1;
+  for (int arg = 1; arg < argc; arg++) {
+    if (strcmp(argv[arg], "-j") == 0 && arg + 1 < argc) {
+      jobs = strtol(argv[++arg], NULL, 10);
+    }
+    else if (strcmp(argv[arg], "-n") == 0 && arg + 1 < argc) {
+      flights = strtol(argv[++arg], NULL, 10);
+    }
+    else if (strcmp(argv[arg], "-o") == 0 && arg + 1 < argc) {
+      resultsName = argv[++arg];
+    }
+    else if (argv[arg][0] != '-' && !scenarioName) {
+      scenarioName = argv[arg];
+    }
+    else {
+      usage();
+    }
+  }
+  if (!scenarioName || jobs < 1 || flights == 0) {
+    usage();
+  }
+  struct Scenario scenario;
+  initScenario(&scenario);
+  if (!readScenario(scenarioName, &scenario)) {
+    return 2;
+  }
+  if (flights > 0) {
+    scenario.flights = flights;
+  }
+  FILE *resultsFile = NULL;
+  if (resultsName && !(resultsFile = fopen(resultsName, "w"))) {
+    fprintf(stderr, "can't write %s\n", resultsName);
+    return 2;
+  }
+
+  // measured once here, every flight process inherits it
+  PROFILE_FUNCTION(loop);
+  PROFILE_FUNCTION(processControlLoopTask);
+
+  struct FlightResult *results = (struct FlightResult *)calloc(scenario.flights, sizeof(struct FlightResult));
+  struct FlightProcess *running = (struct FlightProcess *)calloc(jobs, sizeof(struct FlightProcess));
+  long runningCount = 0;
+  unsigned long nextFlight = 0, finished = 0;
+  const double wallStart = wallClock();
+  fflush(stdout);
+  while (finished < scenario.flights) {
+    while (runningCount < jobs && nextFlight < scenario.flights) {
+      int channel[2];
+      if (pipe(channel) != 0) {
+        perror("pipe");
+        return 2;
+      }
+      const pid_t pid = fork();
+      if (pid < 0) {
+        perror("fork");
+        return 2;
+      }
+      if (pid == 0) {
+        close(channel[0]);
+        runFlight(&scenario, nextFlight, channel[1]);
+      }
+      close(channel[1]);
+      running[runningCount].pid = pid;
+      running[runningCount].pipe = channel[0];
+      running[runningCount].flight = nextFlight++;
+      runningCount++;
+    }
+
+    // results are smaller than a pipe buffer, they wait there for the exit
+    int status;
+    const pid_t pid = wait(&status);
+    if (pid < 0) {
+      perror("wait");
+      return 2;
+    }
+    long slot = 0;
+    while (slot < runningCount && running[slot].pid != pid) {
+      slot++;
+    }
+    if (slot == runningCount) {
+      continue;
+    }
+    struct FlightResult *result = &results[running[slot].flight];
+    const bool exited = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    if (!exited || read(running[slot].pipe, result, sizeof(*result)) != (ssize_t)sizeof(*result)) {
+      memset(result, 0, sizeof(*result));
+      result->flight = running[slot].flight;
+      result->status = FLIGHT_ABORTED;
+      result->signal = WIFSIGNALED(status) ? WTERMSIG(status) : 0;
+      for (int metric = 0; metric < FLIGHT_METRICS; metric++) {
+        result->metric[metric] = NAN;
+      }
+      printf("flight %lu aborted, signal %d\n", result->flight, result->signal);
+    }
+    close(running[slot].pipe);
+    running[slot] = running[--runningCount];
+    finished++;
+  }
+  const double wallTime = wallClock() - wallStart;
+
+  printf("%lu flights of %s in %.1fs on %ld processes, %.1f flights/s\n", scenario.flights, scenarioName,
+         wallTime, jobs, scenario.flights / wallTime);
+  printReport(&scenario, results, scenario.flights);
+  bool aborted = false;
+  unsigned long badTimings = 0;
+  for (unsigned long flight = 0; flight < scenario.flights; flight++) {
+    aborted |= results[flight].status == FLIGHT_ABORTED;
+    const double *metric = results[flight].metric;
+    if (!isnan(metric[CONTROL_LOOP_MEDIAN]) && (metric[CONTROL_LOOP_MEDIAN] <= 0.0 || metric[CONTROL_LOOP_99] < metric[CONTROL_LOOP_MEDIAN])) {
+      badTimings++;
+    }
+  }
+  if (badTimings > 0) {
+    printf("%lu flights timed the control loop at a median of 0 or a 99%% below the median\n", badTimings);
+  }
+  if (resultsFile) {
+    writeResults(resultsFile, &scenario, results, scenario.flights);
+    fclose(resultsFile);
+  }
+  free(running);
+  free(results);
+  return aborted || badTimings > 0 ? 1 : 0;
+}
@@ -0,0 +1,290 @@
+/*
+  AeroQuad v3.2 - Host build of the AeroQuad32 firmware
+  www.AeroQuad.com
+  Copyright (c) 2012 Ted Carancho.  All rights reserved.
+  An Open Source Arduino based multicopter.
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Runs the AeroQuad32 firmware on a sensor log, as fast as the PC goes
+//
+// The whole flight software is built into this program with the devices
+// of HostCompatibility, setup() and loop() run unchanged while the log
+// feeds the emulated sensors, receiver and GPS as the virtual clock passes
+// their time stamps. Every 100ms of log time a row of motor commands and
+// estimator states is written; compared with a golden output, any row out
+// of the tolerances fails the run. Time spent in the main firmware
+// functions is reported at the end, a function timed at a median of 0
+// fails the run too.
+//
+//   AeroQuadReplay [-o output] [-g golden] [-s step] [-q] log
+//
+//   -o  rows to this file, none otherwise
+//   -g  golden rows to compare with, exits with 1 when they differ
+//   -s  us the clock moves between two calls of loop(), 100 by default
+//   -q  no function cost report
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "ReplayLog.h"
+#include "HostProfiler.h"
+
+#include "HostConfiguration.h"
+#include <SerialMapping.h>
+#include <WProgram.h>
+
+#include "../AeroQuad/AeroQuad.ino"
+
+#define REPLAY_ROW_PERIOD 100000  // us
+#define REPLAY_COLUMNS 16
+#define REPLAY_MAX_DIFFERENCES 10
+
+static const char *replayColumn[REPLAY_COLUMNS] = {
+  "time", "motor1", "motor2", "motor3", "motor4", "roll", "pitch", "heading",
+  "zVelocity", "altitude", "throttle", "altHold", "posHold", "gpsRoll", "gpsPitch", "armed"
+};
+
+// what a different compiler or math library may move, the modes must match
+static const double replayTolerance[REPLAY_COLUMNS] = {
+  0.0, 3.0, 3.0, 3.0, 3.0, 0.005, 0.005, 0.005,
+  0.02, 0.05, 3.0, 0.0, 0.0, 3.0, 3.0, 0.0
+};
+
+#define REPLAY_HEADING_COLUMN 7
+
+static struct ReplayLog replayLog;
+static struct ReplayRecord replayNext;
+static bool replayPending = false;
+static bool replayDone = false;
+
+// sensor source, hands over every sample up to now
+static void feedReplayLog(unsigned long now) {
+  while (!replayDone) {
+    if (!replayPending) {
+      if (!readReplayRecord(&replayLog, &replayNext)) {
+        replayDone = true;
+        return;
+      }
+      replayPending = true;
+    }
+    if (replayNext.time > now) {
+      return;
+    }
+    applyReplayRecord(&replayNext);
+    replayPending = false;
+  }
+}
+
+static void collectReplayRow(double row[REPLAY_COLUMNS]) {
+  row[0] = getHostClock() / 1000000.0;
+  for (int motor = 0; motor < 4; motor++) {
+    row[1 + motor] = hostMotorOutput[motor];
+  }
+  row[5] = kinematicsAngle[XAXIS];
+  row[6] = kinematicsAngle[YAXIS];
+  row[7] = trueNorthHeading;
+  row[8] = estimatedZVelocity;
+  row[9] = getBaroAltitude();
+  row[10] = throttle;
+  row[11] = altitudeHoldState;
+  row[12] = positionHoldState;
+  row[13] = gpsRollAxisCorrection;
+  row[14] = gpsPitchAxisCorrection;
+  row[15] = motorArmed;
+}
+
+static void writeReplayRow(FILE *file, const double row[REPLAY_COLUMNS]) {
+  fprintf(file, "%.1f %.0f %.0f %.0f %.0f %.4f %.4f %.4f %.3f %.3f %.0f %.0f %.0f %.0f %.0f %.0f\n",
+          row[0], row[1], row[2], row[3], row[4], row[5], row[6], row[7],
+          row[8], row[9], row[10], row[11], row[12], row[13], row[14], row[15]);
+}
+
+// next row of the golden file, false at its end
+static bool readGoldenRow(FILE *file, double row[REPLAY_COLUMNS]) {
+  char line[REPLAY_LINE_SIZE];
+  while (fgets(line, sizeof(line), file)) {
+    if (line[0] == '#' || line[0] == '\n') {
+      continue;
+    }
+    char *text = line;
+    for (int column = 0; column < REPLAY_COLUMNS; column++) {
+      char *end;
+      row[column] = strtod(text, &end);
+      if (end == text) {
+        return false;
+      }
+      text = end;
+    }
+    return true;
+  }
+  return false;
+}
+
+// number of columns of the row out of tolerance, the first ones printed
+static int compareReplayRow(const double row[REPLAY_COLUMNS], const double golden[REPLAY_COLUMNS], int *printed) {
+  int differences = 0;
+  for (int column = 0; column < REPLAY_COLUMNS; column++) {
+    double difference = fabs(row[column] - golden[column]);
+    if (column == REPLAY_HEADING_COLUMN && difference > M_PI) {
+      difference = 2.0 * M_PI - difference;
+    }
+    // the rows are rounded when written, half a digit is allowed on top
+    if (difference > replayTolerance[column] + 0.00051) {
+      differences++;
+      if (*printed < REPLAY_MAX_DIFFERENCES) {
+        printf("  t=%.1f %s: %g, golden %g\n", row[0], replayColumn[column], row[column], golden[column]);
+        (*printed)++;
+      }
+    }
+  }
+  return differences;
+}
+
+static double wallClock() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec / 1.0e9;
+}
+
+static void usage() {
+  fprintf(stderr, "usage: AeroQuadReplay [-o output] [-g golden] [-s step] [-q] log\n");
+  exit(2);
+}
+
+int main(int argc, char *argv[]) {
+  const char *logName = NULL;
+  const char *outputName = NULL;
+  const char *goldenName = NULL;
+  unsigned long step = 100;
+  bool report = true;
+  for (int arg = 1; arg < argc; arg++) {
+    if (strcmp(argv[arg], "-o") == 0 && arg + 1 < argc) {
+      outputName = argv[++arg];
+    }
+    else if (strcmp(argv[arg], "-g") == 0 && arg + 1 < argc) {
+      goldenName = argv[++arg];
+    }
+    else if (strcmp(argv[arg], "-s") == 0 && arg + 1 < argc) {
+      step = strtoul(argv[++arg], NULL, 10);
+    }
+    else if (strcmp(argv[arg], "-q") == 0) {
+      report = false;
+    }
+    else if (argv[arg][0] != '-' && !logName) {
+      logName = argv[arg];
+    }
+    else {
+      usage();
+    }
+  }
+  if (!logName || step == 0) {
+    usage();
+  }
+  if (!openReplayLog(&replayLog, logName)) {
+    fprintf(stderr, "can't open %s\n", logName);
+    return 2;
+  }
+  FILE *output = NULL;
+  if (outputName && !(output = fopen(outputName, "w"))) {
+    fprintf(stderr, "can't write %s\n", outputName);
+    return 2;
+  }
+  FILE *golden = NULL;
+  if (goldenName && !(golden = fopen(goldenName, "r"))) {
+    fprintf(stderr, "can't open %s\n", goldenName);
+    return 2;
+  }
+
+  PROFILE_FUNCTION(loop);
+  PROFILE_FUNCTION(measureCriticalSensors);
+  PROFILE_FUNCTION(processControlLoopTask);
+  PROFILE_FUNCTION(processFlightControl);
+  PROFILE_FUNCTION(calculateKinematics);
+  PROFILE_FUNCTION(process100HzTask);
+  PROFILE_FUNCTION(processAttitudeControl);
+  PROFILE_FUNCTION(processHeading);
+  PROFILE_FUNCTION(processAltitudeHold);
+  PROFILE_FUNCTION(processPositionHold);
+  PROFILE_FUNCTION(updateGps);
+
+  setHostSensorSource(feedReplayLog);
+  const double wallStart = wallClock();
+  setup();
+
+  if (output) {
+    fprintf(output, "#");
+    for (int column = 0; column < REPLAY_COLUMNS; column++) {
+      fprintf(output, " %s", replayColumn[column]);
+    }
+    fprintf(output, "\n");
+  }
+  profileEnabled = true;
+  unsigned long nextRow = (getHostClock() / REPLAY_ROW_PERIOD + 1) * REPLAY_ROW_PERIOD;
+  unsigned long rows = 0, failedRows = 0;
+  int printed = 0;
+  bool goldenShort = false;
+  while (!replayDone) {
+    advanceHostClock(step);
+    loop();
+    if (getHostClock() >= nextRow) {
+      nextRow += REPLAY_ROW_PERIOD;
+      double row[REPLAY_COLUMNS];
+      collectReplayRow(row);
+      rows++;
+      if (output) {
+        writeReplayRow(output, row);
+      }
+      if (golden && !goldenShort) {
+        double expected[REPLAY_COLUMNS];
+        if (!readGoldenRow(golden, expected)) {
+          printf("  t=%.1f: golden ends here\n", row[0]);
+          goldenShort = true;
+          failedRows++;
+        }
+        else if (compareReplayRow(row, expected, &printed) > 0) {
+          failedRows++;
+        }
+      }
+    }
+  }
+  profileEnabled = false;
+  const double wallTime = wallClock() - wallStart;
+  const double flightTime = getHostClock() / 1000000.0;
+
+  if (output) {
+    fclose(output);
+  }
+  closeReplayLog(&replayLog);
+  bool failed = replayLog.error;
+  if (golden) {
+    double extra[REPLAY_COLUMNS];
+    if (!goldenShort && readGoldenRow(golden, extra)) {
+      printf("  golden has rows past t=%.1f\n", flightTime);
+      failedRows++;
+    }
+    fclose(golden);
+    printf("%lu rows, %lu out of tolerance against %s\n", rows, failedRows, goldenName);
+    failed |= failedRows > 0;
+  }
+  printf("%.1fs of flight in %.2fs, %.0f times real time\n", flightTime, wallTime, flightTime / wallTime);
+  if (report) {
+    printProfile(stdout);
+  }
+  failed |= !checkProfile(stdout);
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,121 @@
+/*
+  AeroQuad v3.2 - Host build of the AeroQuad32 firmware
+  www.AeroQuad.com
+  Copyright (c) 2012 Ted Carancho.  All rights reserved.
+  An Open Source Arduino based multicopter.
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// The scripted flight of the closed loop programs
+//
+// A pilot who sees the real state of the plant works the sticks:
+//
+//   0s    on the ground
+//   12s   armed, yaw stick right
+//   13.5s takes off and climbs to 6m with the throttle
+//   16.5s roll right, roll left, nose up
+//   20s   altitude hold, AUX1 middle, throttle left at the hover
+//   22s   yaw right
+//   24s   position hold, AUX1 low
+//   30s   holds off, descent at 0.5m/s, disarmed on the ground
+//
+// The sticks are receiver pulses in AeroQuad channel order, roll, pitch,
+// yaw, throttle, mode and AUX1 to AUX3.
+
+#ifndef _AEROQUAD_HOST_FLIGHT_SCRIPT_H_
+#define _AEROQUAD_HOST_FLIGHT_SCRIPT_H_
+
+#include <string.h>
+#include "VehiclePlant.h"
+
+#define SCRIPT_CHANNELS 8
+#define SCRIPT_HOVER_ALTITUDE 6.0   // m
+#define SCRIPT_LANDING_SPEED 0.5    // m/s
+
+struct ScriptPilot {
+  int stick[SCRIPT_CHANNELS];   // us
+  double trim;                  // us, of the throttle
+  double hoverThrottle;         // us
+  double landedTime;            // s, 0 until back on the ground
+};
+
+void initScriptPilot(struct ScriptPilot *pilot) {
+  memset(pilot, 0, sizeof(*pilot));
+}
+
+/**
+ * The sticks at t seconds into the script, dt since the last call
+ */
+void pilotSticks(struct ScriptPilot *pilot, const struct VehiclePlant *plant, double t, double dt) {
+  const struct VehicleState *state = &plant->state;
+  int *stick = pilot->stick;
+  stick[0] = 1500;
+  stick[1] = 1500;
+  stick[2] = 1500;
+  stick[3] = 1000;
+  stick[4] = 2000;   // attitude mode
+  stick[5] = 2000;
+  stick[6] = 2000;
+  stick[7] = 2000;
+
+  if (t >= 12.0 && t < 13.0) {
+    stick[2] = 2000;
+  }
+  if (t >= 13.5 && pilot->landedTime == 0.0) {
+    // climb rate to the hover, or the landing speed down, through the throttle
+    const double climb = -state->velocity[2];
+    double targetClimb = -SCRIPT_LANDING_SPEED;
+    if (t < 30.0) {
+      targetClimb = 0.8 * (SCRIPT_HOVER_ALTITUDE + state->position[2]);
+      targetClimb = targetClimb > 1.5 ? 1.5 : (targetClimb < -1.0 ? -1.0 : targetClimb);
+    }
+    if (t < 20.0 || t >= 30.0) {
+      pilot->trim += 60.0 * (targetClimb - climb) * dt;
+      pilot->hoverThrottle = 1500.0 + pilot->trim;
+      stick[3] = (int)(pilot->hoverThrottle + 120.0 * (targetClimb - climb));
+    }
+    else {
+      stick[3] = (int)pilot->hoverThrottle;   // stick left at the hover in the holds
+    }
+    stick[3] = stick[3] > 1900 ? 1900 : (stick[3] < 1100 ? 1100 : stick[3]);
+  }
+  if (t >= 30.0 && plant->onGround && pilot->landedTime == 0.0) {
+    pilot->landedTime = t;
+  }
+  if (pilot->landedTime > 0.0 && t >= pilot->landedTime + 1.0 && t < pilot->landedTime + 2.0) {
+    stick[2] = 1000;
+  }
+
+  if (t >= 16.5 && t < 17.5) {
+    stick[0] = 1650;
+  }
+  else if (t >= 17.5 && t < 18.5) {
+    stick[0] = 1350;
+  }
+  else if (t >= 18.5 && t < 19.5) {
+    stick[1] = 1350;
+  }
+  if (t >= 20.0 && t < 24.0) {
+    stick[5] = 1500;
+  }
+  else if (t >= 24.0 && t < 30.0) {
+    stick[5] = 1000;
+  }
+  if (t >= 22.0 && t < 23.0) {
+    stick[2] = 1700;
+  }
+}
+
+#endif
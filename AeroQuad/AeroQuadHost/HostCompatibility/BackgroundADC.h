@@ -0,0 +1,60 @@
+/*
+  AeroQuad v3.2 - Host build of the AeroQuad32 firmware
+  www.AeroQuad.com
+  Copyright (c) 2012 Ted Carancho.  All rights reserved.
+  An Open Source Arduino based multicopter.
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// BackgroundADC.h for the host, the background conversions are analogRead()
+// of hostAnalogInput[]
+
+#ifndef _AEROQUAD_BACKGROUND_ADC_H_
+#define _AEROQUAD_BACKGROUND_ADC_H_
+
+#include "Arduino.h"
+
+#define BACKGROUND_ADC_MAX_CHANNELS 4
+
+byte backgroundADCPin[BACKGROUND_ADC_MAX_CHANNELS];
+byte backgroundADCChannels = 0;
+boolean backgroundADCRunning = false;
+
+byte attachBackgroundADC(byte pin) {
+  for (byte channel = 0; channel < backgroundADCChannels; channel++) {
+    if (backgroundADCPin[channel] == pin) {
+      return channel;
+    }
+  }
+  if (backgroundADCRunning || backgroundADCChannels >= BACKGROUND_ADC_MAX_CHANNELS) {
+    return 0;
+  }
+  backgroundADCPin[backgroundADCChannels] = pin;
+  return backgroundADCChannels++;
+}
+
+void startBackgroundADC() {
+  backgroundADCRunning = backgroundADCChannels > 0;
+}
+
+unsigned int getBackgroundADC(byte channel) {
+  return analogRead(backgroundADCPin[channel]);
+}
+
+unsigned int analogReadShared(byte pin) {
+  return analogRead(pin);
+}
+
+#endif
@@ -0,0 +1,44 @@
+/*
+  AeroQuad v3.2 - Host build of the AeroQuad32 firmware
+  www.AeroQuad.com
+  Copyright (c) 2012 Ted Carancho.  All rights reserved.
+  An Open Source Arduino based multicopter.
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Byte wide EEPROM in memory, erased at start, so every run boots like a
+// new board and takes the defaults of DataStorage.h
+
+#ifndef __EEPROM_H
+#define __EEPROM_H
+
+#include "WProgram.h"
+
+#define HOST_EEPROM_SIZE 4096
+
+class EEPROMClass {
+  public:
+    EEPROMClass();
+    uint8 read(int address);
+    void write(int address, uint8 data);
+    void erase();
+
+  private:
+    uint8 data[HOST_EEPROM_SIZE];
+};
+
+extern EEPROMClass EEPROM;
+
+#endif /* __EEPROM_H */
@@ -0,0 +1,706 @@
+/*
+  AeroQuad v3.2 - Host build of the AeroQuad32 firmware
+  www.AeroQuad.com
+  Copyright (c) 2012 Ted Carancho.  All rights reserved.
+  An Open Source Arduino based multicopter.
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Virtual clock, serial ports, EEPROM, I2C bus and emulated devices
+
+#include "WProgram.h"
+#include "Wire.h"
+#include "EEPROM.h"
+
+//********************************************************
+//************************ CLOCK *************************
+//********************************************************
+
+static unsigned long hostClock = 0;
+static HostSensorSource hostSensorSource = NULL;
+
+void setHostSensorSource(HostSensorSource source) {
+  hostSensorSource = source;
+}
+
+void advanceHostClock(unsigned long us) {
+  hostClock += us;
+  if (hostSensorSource) {
+    hostSensorSource(hostClock);
+  }
+}
+
+unsigned long getHostClock() {
+  return hostClock;
+}
+
+unsigned long micros() {
+  return hostClock;
+}
+
+unsigned long millis() {
+  return hostClock / 1000;
+}
+
+void delay(unsigned long ms) {
+  advanceHostClock(ms * 1000);
+}
+
+void delayMicroseconds(unsigned int us) {
+  advanceHostClock(us);
+}
+
+//********************************************************
+//************************* PINS *************************
+//********************************************************
+
+uint16_t hostAnalogInput[HOST_MAX_PINS];
+uint8_t hostDigitalOutput[HOST_MAX_PINS];
+
+void pinMode(uint8 pin, uint8 mode) {
+}
+
+void digitalWrite(uint8 pin, uint8 value) {
+  if (pin < HOST_MAX_PINS) {
+    hostDigitalOutput[pin] = value;
+  }
+}
+
+uint32 digitalRead(uint8 pin) {
+  return (pin < HOST_MAX_PINS) ? hostDigitalOutput[pin] : LOW;
+}
+
+uint16 analogRead(uint8 pin) {
+  return (pin < HOST_MAX_PINS) ? hostAnalogInput[pin] : 0;
+}
+
+void analogWrite(uint8 pin, int value) {
+}
+
+void noInterrupts() {
+}
+
+void interrupts() {
+}
+
+uint16_t makeWord(uint16_t w) {
+  return w;
+}
+
+uint16_t makeWord(byte h, byte l) {
+  return (h << 8) | l;
+}
+
+// same sequence on every run
+static unsigned long hostRandomState = 1;
+
+long random(long howBig) {
+  if (howBig <= 0) {
+    return 0;
+  }
+  hostRandomState = hostRandomState * 1103515245UL + 12345UL;
+  return (long)((hostRandomState >> 16) & 0x7FFFFFFF) % howBig;
+}
+
+long random(long howSmall, long howBig) {
+  if (howSmall >= howBig) {
+    return howSmall;
+  }
+  return random(howBig - howSmall) + howSmall;
+}
+
+void randomSeed(unsigned int seed) {
+  hostRandomState = seed;
+}
+
+long map(long x, long inMin, long inMax, long outMin, long outMax) {
+  return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+//********************************************************
+//************************ PRINT *************************
+//********************************************************
+
+void Print::write(const void *buffer, uint32 size) {
+  const uint8 *data = (const uint8 *)buffer;
+  while (size--) {
+    write(*data++);
+  }
+}
+
+void Print::write(const char *text) {
+  write(text, strlen(text));
+}
+
+void Print::printNumber(unsigned long long data, int base, bool negative) {
+  char buffer[68];
+  char *text = &buffer[sizeof(buffer) - 1];
+  *text = 0;
+  if (base < 2) {
+    base = DEC;
+  }
+  do {
+    const int digit = data % base;
+    *--text = digit < 10 ? '0' + digit : 'A' + digit - 10;
+    data /= base;
+  } while (data);
+  if (negative) {
+    *--text = '-';
+  }
+  write(text);
+}
+
+void Print::print(char data) {
+  write((uint8)data);
+}
+
+void Print::print(const char *text) {
+  write(text);
+}
+
+void Print::print(int data, int base) {
+  print((long long)data, base);
+}
+
+void Print::print(unsigned int data, int base) {
+  printNumber(data, base, false);
+}
+
+void Print::print(long data, int base) {
+  print((long long)data, base);
+}
+
+void Print::print(unsigned long data, int base) {
+  printNumber(data, base, false);
+}
+
+void Print::print(long long data, int base) {
+  if (base == DEC && data < 0) {
+    printNumber(-(unsigned long long)data, base, true);
+  }
+  else {
+    printNumber((unsigned long long)data, base, false);
+  }
+}
+
+void Print::print(unsigned long long data, int base) {
+  printNumber(data, base, false);
+}
+
+void Print::print(double data, int digits) {
+  char buffer[64];
+  snprintf(buffer, sizeof(buffer), "%.*f", digits, data);
+  write(buffer);
+}
+
+void Print::println() {
+  write("\r\n");
+}
+
+void Print::println(char data) {
+  print(data);
+  println();
+}
+
+void Print::println(const char *text) {
+  print(text);
+  println();
+}
+
+void Print::println(int data, int base) {
+  print(data, base);
+  println();
+}
+
+void Print::println(unsigned int data, int base) {
+  print(data, base);
+  println();
+}
+
+void Print::println(long data, int base) {
+  print(data, base);
+  println();
+}
+
+void Print::println(unsigned long data, int base) {
+  print(data, base);
+  println();
+}
+
+void Print::println(long long data, int base) {
+  print(data, base);
+  println();
+}
+
+void Print::println(unsigned long long data, int base) {
+  print(data, base);
+  println();
+}
+
+void Print::println(double data, int digits) {
+  print(data, digits);
+  println();
+}
+
+//********************************************************
+//************************ SERIAL ************************
+//********************************************************
+
+HostSerial::HostSerial() : rxHead(0), rxTail(0), txHead(0), txTail(0), captured(false), baud(0) {
+}
+
+void HostSerial::begin(uint32 baudRate) {
+  baud = baudRate;
+}
+
+void HostSerial::end() {
+}
+
+uint32 HostSerial::available() {
+  return (rxHead - rxTail) % HOST_SERIAL_BUFFER_SIZE;
+}
+
+int HostSerial::read() {
+  if (rxHead == rxTail) {
+    return -1;
+  }
+  const uint8 data = rxBuffer[rxTail];
+  rxTail = (rxTail + 1) % HOST_SERIAL_BUFFER_SIZE;
+  return data;
+}
+
+int HostSerial::peek() {
+  return (rxHead == rxTail) ? -1 : rxBuffer[rxTail];
+}
+
+void HostSerial::flush() {
+}
+
+void HostSerial::write(uint8 data) {
+  if (!captured) {
+    return;
+  }
+  const uint32 next = (txHead + 1) % HOST_SERIAL_BUFFER_SIZE;
+  if (next != txTail) {
+    txBuffer[txHead] = data;
+    txHead = next;
+  }
+}
+
+uint32 HostSerial::inject(const uint8 *data, uint32 size) {
+  uint32 queued = 0;
+  while (queued < size) {
+    const uint32 next = (rxHead + 1) % HOST_SERIAL_BUFFER_SIZE;
+    if (next == rxTail) {
+      break;  // overrun, the rest is lost like on the UART
+    }
+    rxBuffer[rxHead] = data[queued++];
+    rxHead = next;
+  }
+  return queued;
+}
+
+uint32 HostSerial::pending() {
+  return (txHead - txTail) % HOST_SERIAL_BUFFER_SIZE;
+}
+
+uint32 HostSerial::take(uint8 *data, uint32 size) {
+  uint32 taken = 0;
+  while (taken < size && txTail != txHead) {
+    data[taken++] = txBuffer[txTail];
+    txTail = (txTail + 1) % HOST_SERIAL_BUFFER_SIZE;
+  }
+  return taken;
+}
+
+void HostSerial::capture(boolean enable) {
+  captured = enable;
+  txHead = txTail = 0;
+}
+
+uint32 HostSerial::baudRate() {
+  return baud;
+}
+
+HostSerial SerialUSB;
+HostSerial Serial1;
+HostSerial Serial2;
+HostSerial Serial3;
+
+//********************************************************
+//************************ EEPROM ************************
+//********************************************************
+
+EEPROMClass::EEPROMClass() {
+  erase();
+}
+
+uint8 EEPROMClass::read(int address) {
+  return (address >= 0 && address < HOST_EEPROM_SIZE) ? data[address] : 0xFF;
+}
+
+void EEPROMClass::write(int address, uint8 value) {
+  if (address >= 0 && address < HOST_EEPROM_SIZE) {
+    data[address] = value;
+  }
+}
+
+void EEPROMClass::erase() {
+  memset(data, 0xFF, sizeof(data));
+}
+
+EEPROMClass EEPROM;
+
+//********************************************************
+//************************ MPU6000 ***********************
+//********************************************************
+
+struct HostMPU6000 hostMPU6000;
+
+void hostMPU6000Sample(const int16_t accel[3], int16_t temperature, const int16_t gyro[3]) {
+  for (byte axis = 0; axis < 3; axis++) {
+    hostMPU6000.accel[axis] = accel[axis];
+    hostMPU6000.gyro[axis] = gyro[axis];
+    hostMPU6000.fifoAccel[axis] += accel[axis];
+    hostMPU6000.fifoGyro[axis] += gyro[axis];
+  }
+  hostMPU6000.temperature = temperature;
+  hostMPU6000.fifoSamples++;
+  hostMPU6000.sampleCount++;
+}
+
+//********************************************************
+//*********************** HMC5883L ***********************
+//********************************************************
+
+#define HMC5883L_ADDRESS 0x1E
+#define HMC5883L_REGISTERS 13
+
+static uint8 hmc5883lRegister[HMC5883L_REGISTERS] = {
+  0x10, 0x20, 0x01,           // configuration A and B, mode
+  0, 0, 0, 0, 0, 0,           // X, Z and Y data
+  0x01,                       // status, data ready
+  'H', '4', '3'               // identification
+};
+static uint8 hmc5883lPointer = 0;
+
+void hostHMC5883LSample(const int16_t field[3]) {
+  // the data registers come in X, Z, Y order
+  hmc5883lRegister[3] = (uint16_t)field[0] >> 8;
+  hmc5883lRegister[4] = field[0] & 0xFF;
+  hmc5883lRegister[5] = (uint16_t)field[2] >> 8;
+  hmc5883lRegister[6] = field[2] & 0xFF;
+  hmc5883lRegister[7] = (uint16_t)field[1] >> 8;
+  hmc5883lRegister[8] = field[1] & 0xFF;
+}
+
+static void hmc5883lWrite(const uint8 *data, int length) {
+  if (length == 0) {
+    return;
+  }
+  hmc5883lPointer = data[0];
+  for (int i = 1; i < length; i++) {
+    if (hmc5883lPointer < 3) {
+      hmc5883lRegister[hmc5883lPointer] = data[i];
+    }
+    hmc5883lPointer = (hmc5883lPointer + 1) % HMC5883L_REGISTERS;
+  }
+}
+
+static int hmc5883lRead(uint8 *data, int length) {
+  for (int i = 0; i < length; i++) {
+    data[i] = hmc5883lRegister[hmc5883lPointer];
+    hmc5883lPointer = (hmc5883lPointer + 1) % HMC5883L_REGISTERS;
+  }
+  return length;
+}
+
+//********************************************************
+//************************ MS5611 ************************
+//********************************************************
+
+#define MS5611_ADDRESS 0x76
+
+// calibration of the example of the datasheet, CRC added at start
+static uint16_t ms5611Prom[8] = {0, 40127, 36924, 23317, 23282, 33464, 28312, 0};
+static uint32_t ms5611D1 = 0, ms5611D2 = 0;
+static uint32_t ms5611Conversion = 0;
+static uint8 ms5611Command = 0;
+static boolean ms5611PromValid = false;
+
+// AN520
+static uint8 ms5611Crc4(const uint16_t prom[8]) {
+  uint16_t copy[8];
+  memcpy(copy, prom, sizeof(copy));
+  copy[7] &= 0xFF00;
+  uint16_t remainder = 0;
+  for (int cnt = 0; cnt < 16; cnt++) {
+    remainder ^= (cnt % 2 == 1) ? (copy[cnt >> 1] & 0x00FF) : (copy[cnt >> 1] >> 8);
+    for (int bit = 8; bit > 0; bit--) {
+      remainder = (remainder & 0x8000) ? (remainder << 1) ^ 0x3000 : (remainder << 1);
+    }
+  }
+  return (remainder >> 12) & 0xF;
+}
+
+void hostMS5611Prom(uint16_t prom[8]) {
+  if (!ms5611PromValid) {
+    ms5611Prom[7] = (ms5611Prom[7] & 0xFFF0) | ms5611Crc4(ms5611Prom);
+    ms5611PromValid = true;
+  }
+  memcpy(prom, ms5611Prom, sizeof(ms5611Prom));
+}
+
+void hostMS5611Sample(uint32_t d1, uint32_t d2) {
+  ms5611D1 = d1;
+  ms5611D2 = d2;
+}
+
+static void ms5611Write(const uint8 *data, int length) {
+  if (length == 0) {
+    return;
+  }
+  uint16_t prom[8];
+  hostMS5611Prom(prom);
+  ms5611Command = data[0];
+  // a conversion takes the value at its start, the next ADC read returns it
+  if ((ms5611Command & 0xF0) == 0x40) {
+    ms5611Conversion = ms5611D1;
+  }
+  else if ((ms5611Command & 0xF0) == 0x50) {
+    ms5611Conversion = ms5611D2;
+  }
+}
+
+static int ms5611Read(uint8 *data, int length) {
+  if (ms5611Command >= 0xA0 && ms5611Command <= 0xAE) {
+    const uint16_t value = ms5611Prom[(ms5611Command - 0xA0) / 2];
+    const uint8 bytes[2] = {(uint8)(value >> 8), (uint8)(value & 0xFF)};
+    for (int i = 0; i < length && i < 2; i++) {
+      data[i] = bytes[i];
+    }
+    return min(length, 2);
+  }
+  if (ms5611Command == 0x00) {
+    const uint8 bytes[3] = {(uint8)(ms5611Conversion >> 16), (uint8)(ms5611Conversion >> 8), (uint8)ms5611Conversion};
+    for (int i = 0; i < length && i < 3; i++) {
+      data[i] = bytes[i];
+    }
+    ms5611Conversion = 0;   // read once, like the device
+    return min(length, 3);
+  }
+  return 0;
+}
+
+//********************************************************
+//************************** I2C *************************
+//********************************************************
+
+#define I2C_BYTE_TIME 23    // us, 9 bits at 400kHz
+
+TwoWire::TwoWire() : rx_buf_idx(0), rx_buf_len(0), tx_addr(0), tx_buf_idx(0), tx_buf_overflow(false),
+                     bus_time(0), transfers(0), errors(0) {
+}
+
+void TwoWire::begin() {
+}
+
+void TwoWire::begin(uint8 sda, uint8 scl) {
+}
+
+void TwoWire::beginTransmission(uint8 address) {
+  tx_addr = address;
+  tx_buf_idx = 0;
+  tx_buf_overflow = false;
+}
+
+void TwoWire::beginTransmission(int address) {
+  beginTransmission((uint8)address);
+}
+
+uint8 TwoWire::endTransmission(void) {
+  if (tx_buf_overflow) {
+    errors++;
+    return EDATA;
+  }
+  transfers++;
+  bus_time += (tx_buf_idx + 1) * I2C_BYTE_TIME;
+  if (tx_addr == HMC5883L_ADDRESS) {
+    hmc5883lWrite(tx_buf, tx_buf_idx);
+  }
+  else if (tx_addr == MS5611_ADDRESS) {
+    ms5611Write(tx_buf, tx_buf_idx);
+  }
+  else {
+    errors++;
+    return ENACKADDR;
+  }
+  tx_buf_idx = 0;
+  return SUCCESS;
+}
+
+uint8 TwoWire::requestFrom(uint8 address, int length) {
+  if (length > WIRE_BUFSIZ) {
+    length = WIRE_BUFSIZ;
+  }
+  rx_buf_idx = 0;
+  rx_buf_len = 0;
+  transfers++;
+  bus_time += (length + 1) * I2C_BYTE_TIME;
+  if (address == HMC5883L_ADDRESS) {
+    rx_buf_len = hmc5883lRead(rx_buf, length);
+  }
+  else if (address == MS5611_ADDRESS) {
+    rx_buf_len = ms5611Read(rx_buf, length);
+  }
+  else {
+    errors++;
+  }
+  return rx_buf_len;
+}
+
+uint8 TwoWire::requestFrom(int address, int length) {
+  return requestFrom((uint8)address, length);
+}
+
+void TwoWire::send(uint8 data) {
+  if (tx_buf_idx == WIRE_BUFSIZ) {
+    tx_buf_overflow = true;
+    return;
+  }
+  tx_buf[tx_buf_idx++] = data;
+}
+
+void TwoWire::send(uint8 *data, int length) {
+  for (int i = 0; i < length; i++) {
+    send(data[i]);
+  }
+}
+
+void TwoWire::send(int data) {
+  send((uint8)data);
+}
+
+uint8 TwoWire::available() {
+  return rx_buf_len - rx_buf_idx;
+}
+
+uint8 TwoWire::receive() {
+  if (rx_buf_idx == rx_buf_len) {
+    return 0;
+  }
+  return rx_buf[rx_buf_idx++];
+}
+
+TwoWire Wire;
+
+//********************************************************
+//*********************** RECEIVER ***********************
+//********************************************************
+
+int hostReceiverPulse[HOST_MAX_CHANNELS] = {1500, 1500, 1500, 1000, 1000, 1000, 1000, 1000, 1000, 1000};
+
+void hostReceiverSample(const int *pulse, int channels) {
+  for (int channel = 0; channel < channels && channel < HOST_MAX_CHANNELS; channel++) {
+    hostReceiverPulse[channel] = pulse[channel];
+  }
+}
+
+//********************************************************
+//************************* MOTORS ***********************
+//********************************************************
+
+int hostMotorOutput[HOST_MAX_MOTORS];
+int hostMotorCount = 0;
+unsigned long hostMotorWriteTime = 0;
+unsigned long hostMotorWrites = 0;
+
+//********************************************************
+//************************** GPS *************************
+//********************************************************
+
+static void ubloxSend(uint8 messageId, const uint8 *payload, uint16_t length) {
+  uint8 frame[6 + 52 + 2];
+  frame[0] = 0xB5;
+  frame[1] = 0x62;
+  frame[2] = 0x01;                  // NAV
+  frame[3] = messageId;
+  frame[4] = length & 0xFF;
+  frame[5] = length >> 8;
+  memcpy(&frame[6], payload, length);
+  uint8 ckA = 0, ckB = 0;
+  for (int i = 2; i < 6 + length; i++) {
+    ckA += frame[i];
+    ckB += ckA;
+  }
+  frame[6 + length] = ckA;
+  frame[7 + length] = ckB;
+  Serial2.inject(frame, 8 + length);
+}
+
+static void putU16(uint8 *payload, int offset, uint16_t value) {
+  payload[offset] = value & 0xFF;
+  payload[offset + 1] = value >> 8;
+}
+
+static void putU32(uint8 *payload, int offset, uint32_t value) {
+  for (int i = 0; i < 4; i++) {
+    payload[offset + i] = (value >> (8 * i)) & 0xFF;
+  }
+}
+
+void hostGpsSample(const struct HostGpsFix *fix) {
+  const uint32_t iTow = (getHostClock() / 1000) % 604800000UL;
+  uint8 payload[52];
+
+  memset(payload, 0, sizeof(payload));          // NAV-STATUS
+  putU32(payload, 0, iTow);
+  payload[4] = fix->fix;
+  payload[5] = fix->fix >= 2 ? 0x01 : 0x00;
+  ubloxSend(0x03, payload, 16);
+
+  memset(payload, 0, sizeof(payload));          // NAV-SOL
+  putU32(payload, 0, iTow);
+  payload[10] = fix->fix;
+  putU16(payload, 44, 150);
+  payload[47] = fix->sats;
+  ubloxSend(0x06, payload, 52);
+
+  memset(payload, 0, sizeof(payload));          // NAV-VELNED
+  const double groundSpeed = sqrt((double)fix->velocity[0] * fix->velocity[0] + (double)fix->velocity[1] * fix->velocity[1]);
+  const double speed = sqrt(groundSpeed * groundSpeed + (double)fix->velocity[2] * fix->velocity[2]);
+  double heading = atan2((double)fix->velocity[1], (double)fix->velocity[0]) * RAD_TO_DEG;
+  if (heading < 0.0) {
+    heading += 360.0;
+  }
+  putU32(payload, 0, iTow);
+  putU32(payload, 4, fix->velocity[0]);
+  putU32(payload, 8, fix->velocity[1]);
+  putU32(payload, 12, fix->velocity[2]);
+  putU32(payload, 16, (uint32_t)(speed + 0.5));
+  putU32(payload, 20, (uint32_t)(groundSpeed + 0.5));
+  putU32(payload, 24, (int32_t)(heading * 1.0e5));
+  ubloxSend(0x12, payload, 36);
+
+  memset(payload, 0, sizeof(payload));          // NAV-POSLLH, the fix time is taken from it
+  putU32(payload, 0, iTow);
+  putU32(payload, 4, fix->longitude);
+  putU32(payload, 8, fix->latitude);
+  putU32(payload, 12, fix->height);
+  putU32(payload, 16, fix->height);
+  putU32(payload, 20, fix->accuracy);
+  putU32(payload, 24, fix->accuracy * 2);
+  ubloxSend(0x02, payload, 28);
+}
@@ -0,0 +1,97 @@
+/*
+  AeroQuad v3.2 - Host build of the AeroQuad32 firmware
+  www.AeroQuad.com
+  Copyright (c) 2012 Ted Carancho.  All rights reserved.
+  An Open Source Arduino based multicopter.
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Emulated AeroQuad32 peripherals
+//
+// The program driving the firmware, a log replay or a simulation, hands
+// each new device sample to the functions below, in the units the device
+// itself gives: MPU6000 and HMC5883L registers, MS5611 conversions,
+// receiver pulses in us and GPS fixes, sent as the UBlox binary messages
+// GpsAdapter.h parses. The firmware then reads them through its own
+// drivers, over the emulated I2C bus for the compass and barometer.
+//
+// Samples must be handed over in time order as the clock passes them.
+// The driving program registers a source with setHostSensorSource(), it is
+// called with the new time whenever the clock moves, from delay() too, and
+// feeds everything up to that time.
+
+#ifndef _AEROQUAD_HOST_DEVICES_H_
+#define _AEROQUAD_HOST_DEVICES_H_
+
+#include <stdint.h>
+
+#define HOST_MAX_MOTORS 8
+#define HOST_MAX_CHANNELS 10
+#define HOST_MAX_PINS 128
+
+// Clock
+typedef void (*HostSensorSource)(unsigned long now);
+void setHostSensorSource(HostSensorSource source);
+void advanceHostClock(unsigned long us);
+unsigned long getHostClock();
+
+// MPU6000, registers as read, accel then gyro
+void hostMPU6000Sample(const int16_t accel[3], int16_t temperature, const int16_t gyro[3]);
+struct HostMPU6000 {
+  int16_t accel[3];
+  int16_t temperature;
+  int16_t gyro[3];
+  // every sample since the last FIFO drain, for MPU6000_FIFO
+  long fifoAccel[3];
+  long fifoGyro[3];
+  unsigned int fifoSamples;
+  unsigned long sampleCount;
+};
+extern struct HostMPU6000 hostMPU6000;
+
+// HMC5883L, the X, Y and Z data registers
+void hostHMC5883LSample(const int16_t field[3]);
+
+// MS5611, the D1 (pressure) and D2 (temperature) conversion results
+void hostMS5611Sample(uint32_t d1, uint32_t d2);
+void hostMS5611Prom(uint16_t prom[8]);
+
+// Receiver, pulse widths in us
+void hostReceiverSample(const int *pulse, int channels);
+extern int hostReceiverPulse[HOST_MAX_CHANNELS];
+
+// GPS, written to Serial2 as NAV-POSLLH, NAV-STATUS, NAV-SOL and NAV-VELNED
+struct HostGpsFix {
+  uint8_t fix;              // 0 none, 2 2D, 3 3D
+  uint8_t sats;
+  int32_t latitude;         // 1e-7 degrees
+  int32_t longitude;        // 1e-7 degrees
+  int32_t height;           // mm
+  int32_t velocity[3];      // cm/s north, east, down
+  uint32_t accuracy;        // mm
+};
+void hostGpsSample(const struct HostGpsFix *fix);
+
+// Motor outputs, as last written by writeMotors() or commandAllMotors()
+extern int hostMotorOutput[HOST_MAX_MOTORS];
+extern int hostMotorCount;
+extern unsigned long hostMotorWriteTime;  // us
+extern unsigned long hostMotorWrites;
+
+// Analog inputs, in 12 bit ADC counts, and digital outputs
+extern uint16_t hostAnalogInput[HOST_MAX_PINS];
+extern uint8_t hostDigitalOutput[HOST_MAX_PINS];
+
+#endif
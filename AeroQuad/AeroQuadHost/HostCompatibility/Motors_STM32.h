@@ -0,0 +1,64 @@
+/*
+  AeroQuad v3.2 - Host build of the AeroQuad32 firmware
+  www.AeroQuad.com
+  Copyright (c) 2012 Ted Carancho.  All rights reserved.
+  An Open Source Arduino based multicopter.
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Motors_STM32.h for the host, commands go to hostMotorOutput[]
+
+#ifndef _AEROQUAD_MOTORS_STM32_H_
+#define _AEROQUAD_MOTORS_STM32_H_
+
+#if defined(AeroQuadSTM32)
+
+#include "Motors.h"
+
+static int _stm32_motor_number;
+
+void initializeMotors(NB_Motors numbers) {
+  _stm32_motor_number = sizeof(stm32_motor_mapping)/sizeof(stm32_motor_mapping[0]);
+  if(numbers < _stm32_motor_number) {
+    _stm32_motor_number = numbers;
+  }
+  hostMotorCount = _stm32_motor_number;
+  commandAllMotors(1000);
+}
+
+void writeMotors(void) {
+  #if defined(MavLinkHIL)
+    return;
+  #endif
+  for(int motor=0; motor < _stm32_motor_number; motor++) {
+    hostMotorOutput[motor] = motorCommand[motor];
+  }
+  hostMotorWriteTime = micros();
+  hostMotorWrites++;
+}
+
+void commandAllMotors(int _motorCommand) {
+  #if defined(MavLinkHIL)
+    _motorCommand = MINCOMMAND;
+  #endif
+  for(int motor=0; motor < _stm32_motor_number; motor++) {
+    hostMotorOutput[motor] = _motorCommand;
+  }
+  hostMotorWriteTime = micros();
+  hostMotorWrites++;
+}
+
+#endif
+#endif
@@ -0,0 +1,125 @@
+/*
+  AeroQuad v3.2 - Host build of the AeroQuad32 firmware
+  www.AeroQuad.com
+  Copyright (c) 2012 Ted Carancho.  All rights reserved.
+  An Open Source Arduino based multicopter.
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Platform_MPU6000.h for the host, MPU6000 holds the last sample handed to
+// hostMPU6000Sample(), with MPU6000_FIFO the batch sums hold every sample
+// since the previous read, as the FIFO drain would
+
+#ifndef _AEROQUAD_PLATFORM_MPU6000_H_
+#define _AEROQUAD_PLATFORM_MPU6000_H_
+
+#include "Arduino.h"
+#include <SensorsStatus.h>
+
+typedef struct {
+  short x;
+  short y;
+  short z;
+} tAxis;
+
+union uMPU6000 {
+  unsigned char rawByte[14];
+  unsigned short rawWord[7];
+  struct {
+	tAxis accel;
+	short temperature;
+	tAxis gyro;
+  } data;
+} MPU6000;
+
+#if defined(MavLinkHIL)
+  #if defined(MPU6000_FIFO)
+    #error "MavLinkHIL replaces single samples, it can't be used with MPU6000_FIFO"
+  #endif
+  void readHILMPU6000(tAxis *accel, tAxis *gyro);
+#endif
+
+#if defined(MPU6000_FIFO)
+  #define MPU6000_FIFO_SAMPLE_PERIOD 1000   // us, 1kHz sample rate
+
+  long mpu6000BatchGyro[3] = {0,0,0};
+  byte mpu6000BatchGyroSamples = 0;
+  long mpu6000BatchAccel[3] = {0,0,0};
+  byte mpu6000BatchAccelSamples = 0;
+  unsigned long mpu6000BatchTime = 0;
+  unsigned int mpu6000FifoOverflows = 0;
+#endif
+
+bool initializeMPU6000SensorsDone = false;
+void initializeMPU6000Sensors()
+{
+  if(initializeMPU6000SensorsDone) {
+	return;
+  }
+  initializeMPU6000SensorsDone = true;
+  vehicleState |= GYRO_DETECTED;
+  vehicleState |= ACCEL_DETECTED;
+}
+
+void readMPU6000Sensors()
+{
+  MPU6000.data.accel.x = hostMPU6000.accel[0];
+  MPU6000.data.accel.y = hostMPU6000.accel[1];
+  MPU6000.data.accel.z = hostMPU6000.accel[2];
+  MPU6000.data.temperature = hostMPU6000.temperature;
+  MPU6000.data.gyro.x = hostMPU6000.gyro[0];
+  MPU6000.data.gyro.y = hostMPU6000.gyro[1];
+  MPU6000.data.gyro.z = hostMPU6000.gyro[2];
+  #if defined(MPU6000_FIFO)
+    for (byte axis = 0; axis < 3; axis++) {
+      mpu6000BatchGyro[axis] += hostMPU6000.fifoGyro[axis];
+      mpu6000BatchAccel[axis] += hostMPU6000.fifoAccel[axis];
+    }
+    mpu6000BatchGyroSamples += hostMPU6000.fifoSamples;
+    mpu6000BatchAccelSamples += hostMPU6000.fifoSamples;
+    mpu6000BatchTime = hostMPU6000.sampleCount * MPU6000_FIFO_SAMPLE_PERIOD;
+  #endif
+  for (byte axis = 0; axis < 3; axis++) {
+    hostMPU6000.fifoGyro[axis] = 0;
+    hostMPU6000.fifoAccel[axis] = 0;
+  }
+  hostMPU6000.fifoSamples = 0;
+  #if defined(MavLinkHIL)
+    readHILMPU6000(&MPU6000.data.accel, &MPU6000.data.gyro);
+  #endif
+}
+
+int readMPU6000Count=0;
+int readMPU6000AccelCount=0;
+int readMPU6000GyroCount=0;
+
+void readMPU6000Accel()
+{
+  readMPU6000AccelCount++;
+  if(readMPU6000AccelCount != readMPU6000Count) {
+    readMPU6000Sensors();
+    readMPU6000Count++;
+  }
+}
+
+void readMPU6000Gyro()
+{
+  readMPU6000GyroCount++;
+  if(readMPU6000GyroCount != readMPU6000Count) {
+    readMPU6000Sensors();
+    readMPU6000GyroCount++;
+  }
+}
+#endif
@@ -0,0 +1,51 @@
+/*
+  AeroQuad v3.2 - Host build of the AeroQuad32 firmware
+  www.AeroQuad.com
+  Copyright (c) 2012 Ted Carancho.  All rights reserved.
+  An Open Source Arduino based multicopter.
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Receiver_STM32.h for the host, pulses come from hostReceiverPulse[]
+
+#ifndef _AEROQUAD_RECEIVER_STM32_H_
+#define _AEROQUAD_RECEIVER_STM32_H_
+
+#if defined(AeroQuadSTM32)
+
+#include "Receiver.h"
+
+static byte ReceiverChannelMap[] = {0, 1, 2, 3, 4, 5, 6, 7}; // default mapping
+
+void initializeReceiver(int nbChannel = 8) {
+  initializeReceiverParam(nbChannel);
+}
+
+int getRawChannelValue(const byte channel) {
+  int chan = ReceiverChannelMap[channel];
+  // the board has a pulse input per receiverPin[]
+  if(chan < (int)sizeof(receiverPin) && chan < HOST_MAX_CHANNELS) {
+    return hostReceiverPulse[chan];
+  } else {
+    return 1500;
+  }
+}
+
+void setChannelValue(byte channel,int value) {
+}
+
+#endif
+
+#endif
@@ -0,0 +1,190 @@
+/*
+  AeroQuad v3.2 - Host build of the AeroQuad32 firmware
+  www.AeroQuad.com
+  Copyright (c) 2012 Ted Carancho.  All rights reserved.
+  An Open Source Arduino based multicopter.
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// The part of wirish the flight software uses, on a PC
+//
+// Takes the place of MapleCompatibility/WProgram.h and libmaple. Time is
+// virtual, micros() only moves when the program driving the firmware
+// advances it or the firmware waits in delay(), so a run gives the same
+// results whatever the speed of the PC. Serial ports are byte queues the
+// driving program fills and drains, see HostDevices.h for the sensors.
+
+#ifndef WProgram_h
+#define WProgram_h
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+
+extern void setup();
+extern void loop();
+
+typedef uint8_t byte;
+typedef bool boolean;
+typedef uint8_t uint8;
+typedef uint16_t uint16;
+typedef uint32_t uint32;
+typedef int8_t int8;
+typedef int16_t int16;
+typedef int32_t int32;
+typedef int64_t int64;
+typedef uint64_t uint64;
+typedef void (*voidFuncPtr)(void);
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_ANALOG 2
+#define PWM 3
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+#define PI 3.1415926535897932384626433832795
+#define HALF_PI 1.5707963267948966192313216916398
+#define TWO_PI 6.283185307179586476925286766559
+#define DEG_TO_RAD 0.017453292519943295769236907684886
+#define RAD_TO_DEG 57.295779513082320876798154814105
+
+#define min(a,b) ((a)<(b)?(a):(b))
+#define max(a,b) ((a)>(b)?(a):(b))
+#define abs(x) ((x)>0?(x):-(x))
+#define constrain(amt,low,high) ((amt)<(low)?(low):((amt)>(high)?(high):(amt)))
+#define radians(deg) ((deg)*DEG_TO_RAD)
+#define degrees(rad) ((rad)*RAD_TO_DEG)
+#define sq(x) ((x)*(x))
+
+#define lowByte(w) ((w) & 0xff)
+#define highByte(w) (((w) >> 8) & 0xff)
+#define BIT(shift) (1UL << (shift))
+
+// pin numbers only index the host tables, the letter and bit are kept apart
+#define Port2Pin(port, bit) ((byte)(((port) - 'A') * 16 + (bit)))
+
+unsigned long micros();
+unsigned long millis();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+void pinMode(uint8 pin, uint8 mode);
+void digitalWrite(uint8 pin, uint8 value);
+uint32 digitalRead(uint8 pin);
+uint16 analogRead(uint8 pin);
+void analogWrite(uint8 pin, int value);
+
+void noInterrupts();
+void interrupts();
+#define cli()     noInterrupts()
+#define sei()     interrupts()
+
+uint16_t makeWord(uint16_t w);
+uint16_t makeWord(byte h, byte l);
+#define word(...) makeWord(__VA_ARGS__)
+
+long random(long);
+long random(long, long);
+void randomSeed(unsigned int);
+long map(long, long, long, long, long);
+
+// print() and println() of wirish, formatted with the C library
+class Print {
+  public:
+    virtual ~Print() {}
+    virtual void write(uint8 data) = 0;
+    virtual void write(const void *buffer, uint32 size);
+    void write(const char *text);
+
+    void print(char data);
+    void print(const char *text);
+    void print(int data, int base = DEC);
+    void print(unsigned int data, int base = DEC);
+    void print(long data, int base = DEC);
+    void print(unsigned long data, int base = DEC);
+    void print(long long data, int base = DEC);
+    void print(unsigned long long data, int base = DEC);
+    void print(double data, int digits = 2);
+    void println();
+    void println(char data);
+    void println(const char *text);
+    void println(int data, int base = DEC);
+    void println(unsigned int data, int base = DEC);
+    void println(long data, int base = DEC);
+    void println(unsigned long data, int base = DEC);
+    void println(long long data, int base = DEC);
+    void println(unsigned long long data, int base = DEC);
+    void println(double data, int digits = 2);
+
+  private:
+    void printNumber(unsigned long long data, int base, bool negative);
+};
+
+#define HOST_SERIAL_BUFFER_SIZE 4096
+
+/**
+ * A serial port as two byte queues, the firmware reads what the program
+ * driving it queued with inject(), what it writes is kept for take()
+ * when the port is captured, dropped otherwise
+ */
+class HostSerial : public Print {
+  public:
+    HostSerial();
+    void begin(uint32 baud = 115200);
+    void end();
+    uint32 available();
+    int read();
+    int peek();
+    void flush();
+    using Print::write;
+    virtual void write(uint8 data);
+
+    // driving program side
+    uint32 inject(const uint8 *data, uint32 size);
+    uint32 pending();
+    uint32 take(uint8 *data, uint32 size);
+    void capture(boolean enable);
+    uint32 baudRate();
+
+  private:
+    uint8 rxBuffer[HOST_SERIAL_BUFFER_SIZE];
+    uint32 rxHead, rxTail;
+    uint8 txBuffer[HOST_SERIAL_BUFFER_SIZE];
+    uint32 txHead, txTail;
+    boolean captured;
+    uint32 baud;
+};
+
+typedef HostSerial tSerial;
+#define SERIAL_VAR SerialUSB
+
+extern tSerial &Serial;
+extern HostSerial SerialUSB;
+extern HostSerial Serial1;
+extern HostSerial Serial2;
+extern HostSerial Serial3;
+
+#include "HostDevices.h"
+
+#endif
@@ -0,0 +1,78 @@
+/*
+  AeroQuad v3.2 - Host build of the AeroQuad32 firmware
+  www.AeroQuad.com
+  Copyright (c) 2012 Ted Carancho.  All rights reserved.
+  An Open Source Arduino based multicopter.
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// The libmaple Wire interface in front of the emulated I2C devices of
+// HostDevices.h, transfers are instant and bus time is counted at 400kHz
+
+#ifndef _WIRE_H_
+#define _WIRE_H_
+
+#include "WProgram.h"
+
+#define WIRE_BUFSIZ 32
+
+#define SUCCESS   0        /* transmission was successful */
+#define EDATA     1        /* too much data */
+#define ENACKADDR 2        /* received nack on transmit of address */
+#define ENACKTRNS 3        /* received nack on transmit of data */
+#define EOTHER    4        /* other error */
+
+class TwoWire {
+  private:
+    uint8 rx_buf[WIRE_BUFSIZ];
+    uint8 rx_buf_idx;
+    uint8 rx_buf_len;
+    uint8 tx_addr;
+    uint8 tx_buf[WIRE_BUFSIZ];
+    uint8 tx_buf_idx;
+    boolean tx_buf_overflow;
+    uint32 bus_time;
+    uint32 transfers;
+    uint32 errors;
+
+  public:
+    TwoWire();
+    void begin();
+    void begin(uint8, uint8);
+    void beginTransmission(uint8);
+    void beginTransmission(int);
+    uint8 endTransmission(void);
+    uint8 requestFrom(uint8, int);
+    uint8 requestFrom(int, int);
+    void send(uint8);
+    void send(uint8*, int);
+    void send(int);
+    uint8 available();
+    uint8 receive();
+    uint8 read() { return receive(); };
+    void write(uint8 data) { send(data); };
+    void write(uint8* buf, int len) { send(buf, len); };
+    void write(int data) { send(data); };
+
+    boolean isHardware() { return true; };
+    uint32 getBusTime() { return bus_time; };
+    uint32 getTransfers() { return transfers; };
+    uint32 getErrors() { return errors; };
+    void resetBusTime() { bus_time = 0; transfers = 0; errors = 0; };
+};
+
+extern TwoWire Wire;
+
+#endif // _WIRE_H_
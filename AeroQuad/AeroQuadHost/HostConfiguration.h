@@ -0,0 +1,45 @@
+/*
+  AeroQuad v3.2 - Host build of the AeroQuad32 firmware
+  www.AeroQuad.com
+  Copyright (c) 2012 Ted Carancho.  All rights reserved.
+  An Open Source Arduino based multicopter.
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// UserConfiguration.h of the host build
+//
+// Replaces AeroQuad/UserConfiguration.h, whose include guard it defines, so
+// the replay always runs the same firmware whatever the sketch is set to.
+// The options are the ones of an AeroQuad32 quad flying the estimators and
+// the hold modes the replay checks.
+
+#ifndef _AEROQUAD_USER_CONFIGURATION_H_
+#define _AEROQUAD_USER_CONFIGURATION_H_
+
+#define AeroQuadSTM32
+
+#define quadXConfig
+#define USE_400HZ_ESC
+
+#define HeadingMagHold
+#define AltitudeHoldBaro
+#define CONTROL_LOOP_RATE 400
+
+#define UseGPSUBLOX
+#define UseGPSNavigator
+
+#define LASTCHANNEL 8
+
+#endif // _AEROQUAD_USER_CONFIGURATION_H_
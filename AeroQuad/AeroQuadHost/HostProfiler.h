@@ -0,0 +1,212 @@
+/*
+  AeroQuad v3.2 - Host build of the AeroQuad32 firmware
+  www.AeroQuad.com
+  Copyright (c) 2012 Ted Carancho.  All rights reserved.
+  An Open Source Arduino based multicopter.
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Time spent in chosen firmware functions
+//
+// The firmware is built with -finstrument-functions, the compiler then
+// calls the hooks below at the entry and exit of a function, inlined ones
+// too. The Makefile excludes every function a program does not register,
+// so the hooks only fire around the registered ones and the time between
+// them is the uninstrumented code, plus the hooks of registered functions
+// nested inside. The time stamp counter is read on x86, the monotonic
+// clock in ns elsewhere. Every call is kept for the median and
+// percentiles, the mean leaves out the calls the PC itself held up far
+// beyond the 99th percentile.
+
+#ifndef _AEROQUAD_HOST_PROFILER_H_
+#define _AEROQUAD_HOST_PROFILER_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+#if defined(__i386__) || defined(__x86_64__)
+  #include <x86intrin.h>
+  #define PROFILE_UNIT "cycles"
+#else
+  #define PROFILE_UNIT "ns"
+#endif
+
+#define PROFILE_NO_HOOK __attribute__((no_instrument_function))
+
+#define PROFILE_MAX_FUNCTIONS 16
+#define PROFILE_MAX_DEPTH 32
+#define PROFILE_OUTLIER_FACTOR 10   // times the 99th percentile a call is left out of the mean
+
+struct ProfiledFunction {
+  void *address;
+  const char *name;
+  unsigned long calls;
+  uint32_t *samples;
+  unsigned long capacity;
+  bool sorted;
+};
+
+struct ProfileFrame {
+  int function;
+  uint64_t start;
+};
+
+struct ProfiledFunction profiledFunction[PROFILE_MAX_FUNCTIONS];
+int profiledFunctions = 0;
+struct ProfileFrame profileStack[PROFILE_MAX_DEPTH];
+int profileDepth = 0;
+bool profileEnabled = false;
+
+PROFILE_NO_HOOK static inline uint64_t readProfileClock() {
+  #if defined(__i386__) || defined(__x86_64__)
+    return __rdtsc();
+  #else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+  #endif
+}
+
+extern "C" {
+
+PROFILE_NO_HOOK __attribute__((noinline)) void __cyg_profile_func_enter(void *function, void *caller) {
+  if (!profileEnabled || profileDepth == PROFILE_MAX_DEPTH) {
+    return;
+  }
+  for (int index = 0; index < profiledFunctions; index++) {
+    if (profiledFunction[index].address == function) {
+      struct ProfileFrame *frame = &profileStack[profileDepth++];
+      frame->function = index;
+      frame->start = readProfileClock();
+      return;
+    }
+  }
+}
+
+PROFILE_NO_HOOK __attribute__((noinline)) void __cyg_profile_func_exit(void *function, void *caller) {
+  const uint64_t stop = readProfileClock();
+  if (profileDepth == 0) {
+    return;
+  }
+  struct ProfileFrame *frame = &profileStack[profileDepth - 1];
+  struct ProfiledFunction *profiled = &profiledFunction[frame->function];
+  if (profiled->address != function) {
+    return;
+  }
+  profileDepth--;
+  const uint64_t elapsed = stop - frame->start;
+  if (profiled->calls == profiled->capacity) {
+    profiled->capacity = profiled->capacity ? 2 * profiled->capacity : 1024;
+    profiled->samples = (uint32_t *)realloc(profiled->samples, profiled->capacity * sizeof(uint32_t));
+  }
+  profiled->samples[profiled->calls++] = elapsed < 0xFFFFFFFF ? (uint32_t)elapsed : 0xFFFFFFFF;
+  profiled->sorted = false;
+}
+
+}
+
+PROFILE_NO_HOOK void registerProfiledFunction(void *address, const char *name) {
+  if (profiledFunctions < PROFILE_MAX_FUNCTIONS) {
+    struct ProfiledFunction *profiled = &profiledFunction[profiledFunctions++];
+    profiled->address = address;
+    profiled->name = name;
+    profiled->calls = 0;
+    profiled->samples = NULL;
+    profiled->capacity = 0;
+    profiled->sorted = true;
+  }
+}
+
+#define PROFILE_FUNCTION(function) registerProfiledFunction((void *)&function, #function)
+
+PROFILE_NO_HOOK static int compareProfileSamples(const void *a, const void *b) {
+  const uint32_t first = *(const uint32_t *)a, second = *(const uint32_t *)b;
+  return first < second ? -1 : first > second;
+}
+
+/**
+ * Sample at share of the calls, 0.5 for the median, of a function that
+ * has been called
+ */
+PROFILE_NO_HOOK uint32_t profilePercentile(struct ProfiledFunction *profiled, double share) {
+  if (!profiled->sorted) {
+    qsort(profiled->samples, profiled->calls, sizeof(uint32_t), compareProfileSamples);
+    profiled->sorted = true;
+  }
+  return profiled->samples[(unsigned long)(share * (profiled->calls - 1))];
+}
+
+/**
+ * Mean of the calls up to PROFILE_OUTLIER_FACTOR times the 99th
+ * percentile, through outliers how many were left out
+ */
+PROFILE_NO_HOOK double profileMean(struct ProfiledFunction *profiled, unsigned long *outliers) {
+  const double limit = (double)PROFILE_OUTLIER_FACTOR * profilePercentile(profiled, 0.99);
+  double sum = 0.0;
+  unsigned long kept = 0;
+  for (unsigned long call = 0; call < profiled->calls; call++) {
+    if (profiled->samples[call] <= limit) {
+      sum += profiled->samples[call];
+      kept++;
+    }
+  }
+  if (outliers) {
+    *outliers = profiled->calls - kept;
+  }
+  return kept ? sum / kept : 0.0;
+}
+
+PROFILE_NO_HOOK void printProfile(FILE *file) {
+  fprintf(file, "%-26s %10s %10s %10s %10s %10s %8s\n", "function", "calls", "mean", "median", "99%", "max", "outliers");
+  for (int index = 0; index < profiledFunctions; index++) {
+    struct ProfiledFunction *profiled = &profiledFunction[index];
+    if (profiled->calls == 0) {
+      fprintf(file, "%-26s %10lu %10s %10s %10s %10s %8s\n", profiled->name, 0UL, "-", "-", "-", "-", "-");
+      continue;
+    }
+    unsigned long outliers;
+    const double mean = profileMean(profiled, &outliers);
+    fprintf(file, "%-26s %10lu %10.0f %10u %10u %10u %8lu\n", profiled->name, profiled->calls, mean,
+            profilePercentile(profiled, 0.5), profilePercentile(profiled, 0.99), profilePercentile(profiled, 1.0), outliers);
+  }
+  fprintf(file, "(%s, the mean leaves out the outliers above %d times the 99%%)\n", PROFILE_UNIT, PROFILE_OUTLIER_FACTOR);
+}
+
+/**
+ * False, with the reason printed, when a called function has a median of
+ * 0 or a 99th percentile below it, the hooks then time nothing real
+ */
+PROFILE_NO_HOOK bool checkProfile(FILE *file) {
+  bool sane = true;
+  for (int index = 0; index < profiledFunctions; index++) {
+    struct ProfiledFunction *profiled = &profiledFunction[index];
+    if (profiled->calls == 0) {
+      continue;
+    }
+    const uint32_t median = profilePercentile(profiled, 0.5);
+    if (median == 0) {
+      fprintf(file, "  %s: median of 0 %s\n", profiled->name, PROFILE_UNIT);
+      sane = false;
+    }
+    if (profilePercentile(profiled, 0.99) < median) {
+      fprintf(file, "  %s: 99%% below the median\n", profiled->name);
+      sane = false;
+    }
+  }
+  return sane;
+}
+
+#endif
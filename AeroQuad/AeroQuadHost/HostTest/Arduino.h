@@ -0,0 +1,24 @@
+/*
+ * The little of Arduino.h the library headers need to build their host
+ * tests on a PC, the test Makefiles put this directory on the include path
+ */
+
+#ifndef _AEROQUAD_HOST_TEST_ARDUINO_H_
+#define _AEROQUAD_HOST_TEST_ARDUINO_H_
+
+#include <stdint.h>
+#include <math.h>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define PI 3.1415926535897932384626433832795
+#define DEG_TO_RAD 0.017453292519943295769236907684886
+#define min(a,b) ((a)<(b)?(a):(b))
+#define max(a,b) ((a)>(b)?(a):(b))
+#define abs(x) ((x)>0?(x):-(x))
+#define constrain(amt,low,high) ((amt)<(low)?(low):((amt)>(high)?(high):(amt)))
+
+static inline unsigned int word(byte high, byte low) { return (high << 8) | low; }
+
+#endif
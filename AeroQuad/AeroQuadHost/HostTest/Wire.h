@@ -0,0 +1,4 @@
+/*
+ * The library headers include Wire.h for their I2C devices, the host tests
+ * do not reach the bus
+ */
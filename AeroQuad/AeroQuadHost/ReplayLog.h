@@ -0,0 +1,217 @@
+/*
+  AeroQuad v3.2 - Host build of the AeroQuad32 firmware
+  www.AeroQuad.com
+  Copyright (c) 2012 Ted Carancho.  All rights reserved.
+  An Open Source Arduino based multicopter.
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Sensor logs of the host build
+//
+// A log is a text file with one device sample per line, in time order:
+//
+//   I <us> <accel x> <accel y> <accel z> <temperature> <gyro x> <gyro y> <gyro z>
+//   M <us> <x> <y> <z>
+//   B <us> <d1> <d2>
+//   R <us> <channel 1> ... <channel n>
+//   G <us> <fix> <sats> <latitude> <longitude> <height> <vel north> <vel east> <vel down> <accuracy>
+//
+// with the values in the units of HostDevices.h: MPU6000 and HMC5883L
+// registers, MS5611 conversions, receiver pulses in us and GPS fixes in
+// 1e-7 degrees, mm and cm/s. Lines starting with # are comments.
+
+#ifndef _AEROQUAD_HOST_REPLAY_LOG_H_
+#define _AEROQUAD_HOST_REPLAY_LOG_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "HostDevices.h"
+
+#define REPLAY_IMU 'I'
+#define REPLAY_MAG 'M'
+#define REPLAY_BARO 'B'
+#define REPLAY_RECEIVER 'R'
+#define REPLAY_GPS 'G'
+
+#define REPLAY_LINE_SIZE 256
+
+struct ReplayRecord {
+  char type;
+  unsigned long time;       // us
+  int16_t accel[3];
+  int16_t temperature;
+  int16_t gyro[3];
+  int16_t mag[3];
+  uint32_t d1, d2;
+  int channels;
+  int pulse[HOST_MAX_CHANNELS];
+  struct HostGpsFix gps;
+};
+
+struct ReplayLog {
+  FILE *file;
+  unsigned long line;
+  bool error;
+};
+
+bool openReplayLog(struct ReplayLog *log, const char *name) {
+  log->file = fopen(name, "r");
+  log->line = 0;
+  log->error = false;
+  return log->file != NULL;
+}
+
+void closeReplayLog(struct ReplayLog *log) {
+  if (log->file) {
+    fclose(log->file);
+    log->file = NULL;
+  }
+}
+
+/**
+ * Next record of the log, false at the end or on a bad line, error tells
+ */
+bool readReplayRecord(struct ReplayLog *log, struct ReplayRecord *record) {
+  char line[REPLAY_LINE_SIZE];
+  while (fgets(line, sizeof(line), log->file)) {
+    log->line++;
+    if (line[0] == '#' || line[0] == '\n' || line[0] == '\r') {
+      continue;
+    }
+    memset(record, 0, sizeof(*record));
+    record->type = line[0];
+    int values = 0;
+    int fix = 0, sats = 0;
+    int accel[3], temperature, gyro[3], mag[3];
+    switch (record->type) {
+    case REPLAY_IMU:
+      values = sscanf(line + 1, "%lu %d %d %d %d %d %d %d", &record->time, &accel[0], &accel[1], &accel[2],
+                      &temperature, &gyro[0], &gyro[1], &gyro[2]);
+      for (int axis = 0; axis < 3; axis++) {
+        record->accel[axis] = accel[axis];
+        record->gyro[axis] = gyro[axis];
+      }
+      record->temperature = temperature;
+      if (values == 8) {
+        return true;
+      }
+      break;
+    case REPLAY_MAG:
+      values = sscanf(line + 1, "%lu %d %d %d", &record->time, &mag[0], &mag[1], &mag[2]);
+      for (int axis = 0; axis < 3; axis++) {
+        record->mag[axis] = mag[axis];
+      }
+      if (values == 4) {
+        return true;
+      }
+      break;
+    case REPLAY_BARO:
+      values = sscanf(line + 1, "%lu %u %u", &record->time, &record->d1, &record->d2);
+      if (values == 3) {
+        return true;
+      }
+      break;
+    case REPLAY_RECEIVER: {
+      char *text = line + 1;
+      char *end;
+      record->time = strtoul(text, &end, 10);
+      if (end == text) {
+        break;
+      }
+      text = end;
+      while (record->channels < HOST_MAX_CHANNELS) {
+        const long pulse = strtol(text, &end, 10);
+        if (end == text) {
+          break;
+        }
+        record->pulse[record->channels++] = pulse;
+        text = end;
+      }
+      if (record->channels > 0) {
+        return true;
+      }
+      break;
+    }
+    case REPLAY_GPS:
+      values = sscanf(line + 1, "%lu %d %d %d %d %d %d %d %d %u", &record->time, &fix, &sats,
+                      &record->gps.latitude, &record->gps.longitude, &record->gps.height,
+                      &record->gps.velocity[0], &record->gps.velocity[1], &record->gps.velocity[2],
+                      &record->gps.accuracy);
+      record->gps.fix = fix;
+      record->gps.sats = sats;
+      if (values == 10) {
+        return true;
+      }
+      break;
+    }
+    fprintf(stderr, "line %lu: bad record\n", log->line);
+    log->error = true;
+    return false;
+  }
+  return false;
+}
+
+void writeReplayRecord(FILE *file, const struct ReplayRecord *record) {
+  switch (record->type) {
+  case REPLAY_IMU:
+    fprintf(file, "I %lu %d %d %d %d %d %d %d\n", record->time, record->accel[0], record->accel[1], record->accel[2],
+            record->temperature, record->gyro[0], record->gyro[1], record->gyro[2]);
+    break;
+  case REPLAY_MAG:
+    fprintf(file, "M %lu %d %d %d\n", record->time, record->mag[0], record->mag[1], record->mag[2]);
+    break;
+  case REPLAY_BARO:
+    fprintf(file, "B %lu %u %u\n", record->time, record->d1, record->d2);
+    break;
+  case REPLAY_RECEIVER:
+    fprintf(file, "R %lu", record->time);
+    for (int channel = 0; channel < record->channels; channel++) {
+      fprintf(file, " %d", record->pulse[channel]);
+    }
+    fprintf(file, "\n");
+    break;
+  case REPLAY_GPS:
+    fprintf(file, "G %lu %d %d %d %d %d %d %d %d %u\n", record->time, record->gps.fix, record->gps.sats,
+            record->gps.latitude, record->gps.longitude, record->gps.height,
+            record->gps.velocity[0], record->gps.velocity[1], record->gps.velocity[2], record->gps.accuracy);
+    break;
+  }
+}
+
+/**
+ * Hands the sample to its emulated device
+ */
+void applyReplayRecord(const struct ReplayRecord *record) {
+  switch (record->type) {
+  case REPLAY_IMU:
+    hostMPU6000Sample(record->accel, record->temperature, record->gyro);
+    break;
+  case REPLAY_MAG:
+    hostHMC5883LSample(record->mag);
+    break;
+  case REPLAY_BARO:
+    hostMS5611Sample(record->d1, record->d2);
+    break;
+  case REPLAY_RECEIVER:
+    hostReceiverSample(record->pulse, record->channels);
+    break;
+  case REPLAY_GPS:
+    hostGpsSample(&record->gps);
+    break;
+  }
+}
+
+#endif
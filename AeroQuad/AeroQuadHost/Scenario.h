@@ -0,0 +1,253 @@
+/*
+  AeroQuad v3.2 - Host build of the AeroQuad32 firmware
+  www.AeroQuad.com
+  Copyright (c) 2012 Ted Carancho.  All rights reserved.
+  An Open Source Arduino based multicopter.
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Monte-Carlo scenarios of the host build
+//
+// A scenario is a text file with one parameter per line, the name then the
+// smallest and largest value, each flight draws its own value uniformly in
+// between. One value fixes the parameter, probabilities take one value.
+//
+//   flights         number of flights
+//   seed            first seed, flight n draws from seed + n
+//   mass            kg
+//   windSpeed       m/s, steady wind from a random direction
+//   windGust        m/s, standard deviation of the gusts on top
+//   accelNoise      m/s^2, the SensorNoise of SensorModel.h
+//   gyroNoise       rad/s
+//   gyroBias        rad/s, on each axis, either way
+//   vibration       m/s^2
+//   magNoise        Gauss
+//   baroNoise       Pa
+//   gpsNoise        m
+//   motorFailure    probability a motor loses thrust in the hover
+//   motorLoss       share of the thrust it loses, 1 is a dead motor
+//   gpsGlitch       probability the GPS position jumps in the position hold
+//   gpsGlitchSize   m
+//
+// Parameters left out keep the vehicle of VehiclePlant.h and the noise of
+// SensorModel.h. Lines starting with # are comments.
+
+#ifndef _AEROQUAD_HOST_SCENARIO_H_
+#define _AEROQUAD_HOST_SCENARIO_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "SensorModel.h"
+#include "VehiclePlant.h"
+
+#define SCENARIO_LINE_SIZE 256
+
+struct ScenarioRange {
+  double minimum;
+  double maximum;
+};
+
+struct Scenario {
+  unsigned long flights;
+  uint32_t seed;
+  struct ScenarioRange mass;
+  struct ScenarioRange windSpeed;
+  struct ScenarioRange windGust;
+  struct ScenarioRange accelNoise;
+  struct ScenarioRange gyroNoise;
+  struct ScenarioRange gyroBias;
+  struct ScenarioRange vibration;
+  struct ScenarioRange magNoise;
+  struct ScenarioRange baroNoise;
+  struct ScenarioRange gpsNoise;
+  struct ScenarioRange motorFailure;
+  struct ScenarioRange motorLoss;
+  struct ScenarioRange gpsGlitch;
+  struct ScenarioRange gpsGlitchSize;
+};
+
+// what one flight got from the scenario
+struct FlightParameters {
+  unsigned long flight;
+  uint32_t seed;
+  struct PlantParameters plant;
+  struct SensorNoise noise;
+  double wind[3];           // m/s, NED
+  double windGust;          // m/s
+  int failedMotor;          // -1 for none
+  double motorLoss;
+  double motorFailureTime;  // s
+  double gpsGlitch[2];      // m, north and east, 0 for none
+  double gpsGlitchTime;     // s, lasts SCENARIO_GLITCH_DURATION
+};
+
+// flight times the draws use, they follow the script of AeroQuadMonteCarlo.cpp
+#define SCENARIO_FAILURE_START 20.0
+#define SCENARIO_FAILURE_END 28.0
+#define SCENARIO_GLITCH_START 25.0
+#define SCENARIO_GLITCH_END 28.0
+#define SCENARIO_GLITCH_DURATION 2.0
+
+void initScenario(struct Scenario *scenario) {
+  memset(scenario, 0, sizeof(*scenario));
+  scenario->flights = 100;
+  scenario->seed = 1;
+  const struct ScenarioRange mass = {modelDefaultPlant.mass, modelDefaultPlant.mass};
+  scenario->mass = mass;
+  const struct ScenarioRange accel = {modelDefaultNoise.accel, modelDefaultNoise.accel};
+  scenario->accelNoise = accel;
+  const struct ScenarioRange gyro = {modelDefaultNoise.gyro, modelDefaultNoise.gyro};
+  scenario->gyroNoise = gyro;
+  const struct ScenarioRange vibration = {modelDefaultNoise.vibration, modelDefaultNoise.vibration};
+  scenario->vibration = vibration;
+  const struct ScenarioRange mag = {modelDefaultNoise.mag, modelDefaultNoise.mag};
+  scenario->magNoise = mag;
+  const struct ScenarioRange baro = {modelDefaultNoise.baro, modelDefaultNoise.baro};
+  scenario->baroNoise = baro;
+  const struct ScenarioRange gps = {modelDefaultNoise.gpsPosition, modelDefaultNoise.gpsPosition};
+  scenario->gpsNoise = gps;
+  const struct ScenarioRange loss = {1.0, 1.0};
+  scenario->motorLoss = loss;
+}
+
+/**
+ * Reads a scenario over the defaults of initScenario(), errors go to
+ * stderr with their line
+ */
+bool readScenario(const char *name, struct Scenario *scenario) {
+  struct {
+    const char *name;
+    struct ScenarioRange *range;
+  } parameters[] = {
+    {"mass", &scenario->mass},
+    {"windSpeed", &scenario->windSpeed},
+    {"windGust", &scenario->windGust},
+    {"accelNoise", &scenario->accelNoise},
+    {"gyroNoise", &scenario->gyroNoise},
+    {"gyroBias", &scenario->gyroBias},
+    {"vibration", &scenario->vibration},
+    {"magNoise", &scenario->magNoise},
+    {"baroNoise", &scenario->baroNoise},
+    {"gpsNoise", &scenario->gpsNoise},
+    {"motorFailure", &scenario->motorFailure},
+    {"motorLoss", &scenario->motorLoss},
+    {"gpsGlitch", &scenario->gpsGlitch},
+    {"gpsGlitchSize", &scenario->gpsGlitchSize}
+  };
+  const int parameterCount = sizeof(parameters) / sizeof(parameters[0]);
+
+  FILE *file = fopen(name, "r");
+  if (!file) {
+    fprintf(stderr, "can't open %s\n", name);
+    return false;
+  }
+  char line[SCENARIO_LINE_SIZE];
+  unsigned long lineNumber = 0;
+  bool ok = true;
+  while (ok && fgets(line, sizeof(line), file)) {
+    lineNumber++;
+    char key[SCENARIO_LINE_SIZE];
+    double values[2];
+    const int fields = sscanf(line, "%255s %lf %lf", key, &values[0], &values[1]);
+    if (fields <= 0 || key[0] == '#') {
+      continue;
+    }
+    if (fields == 1 || (fields == 3 && values[1] < values[0])) {
+      ok = false;
+    }
+    else if (strcmp(key, "flights") == 0) {
+      scenario->flights = (unsigned long)values[0];
+    }
+    else if (strcmp(key, "seed") == 0) {
+      scenario->seed = (uint32_t)values[0];
+    }
+    else {
+      int parameter = 0;
+      while (parameter < parameterCount && strcmp(key, parameters[parameter].name) != 0) {
+        parameter++;
+      }
+      if (parameter == parameterCount) {
+        ok = false;
+      }
+      else {
+        parameters[parameter].range->minimum = values[0];
+        parameters[parameter].range->maximum = fields == 3 ? values[1] : values[0];
+      }
+    }
+    if (!ok) {
+      fprintf(stderr, "%s:%lu: bad parameter %s", name, lineNumber, line);
+    }
+  }
+  fclose(file);
+  return ok;
+}
+
+double drawScenarioRange(struct ModelRandom *random, const struct ScenarioRange *range) {
+  return range->minimum + (range->maximum - range->minimum) * uniformModelRandom(random);
+}
+
+/**
+ * Draws the parameters of a flight, they only depend on the scenario and
+ * the flight number
+ */
+void drawFlightParameters(const struct Scenario *scenario, unsigned long flight, struct FlightParameters *parameters) {
+  struct ModelRandom random;
+  seedModelRandom(&random, (scenario->seed + flight) * 2654435761u);
+  for (int warmUp = 0; warmUp < 8; warmUp++) {
+    uniformModelRandom(&random);
+  }
+  memset(parameters, 0, sizeof(*parameters));
+  parameters->flight = flight;
+  parameters->seed = scenario->seed + flight;
+
+  // heavier vehicles carry the extra mass at the center, same motors
+  parameters->plant = modelDefaultPlant;
+  parameters->plant.mass = drawScenarioRange(&random, &scenario->mass);
+
+  parameters->noise = modelDefaultNoise;
+  parameters->noise.accel = drawScenarioRange(&random, &scenario->accelNoise);
+  parameters->noise.gyro = drawScenarioRange(&random, &scenario->gyroNoise);
+  for (int axis = 0; axis < 3; axis++) {
+    const double bias = drawScenarioRange(&random, &scenario->gyroBias);
+    parameters->noise.gyroBias[axis] = uniformModelRandom(&random) < 0.5 ? -bias : bias;
+  }
+  parameters->noise.vibration = drawScenarioRange(&random, &scenario->vibration);
+  parameters->noise.mag = drawScenarioRange(&random, &scenario->magNoise);
+  parameters->noise.baro = drawScenarioRange(&random, &scenario->baroNoise);
+  parameters->noise.gpsPosition = drawScenarioRange(&random, &scenario->gpsNoise);
+
+  const double windSpeed = drawScenarioRange(&random, &scenario->windSpeed);
+  const double windDirection = 2.0 * M_PI * uniformModelRandom(&random);
+  parameters->wind[0] = windSpeed * cos(windDirection);
+  parameters->wind[1] = windSpeed * sin(windDirection);
+  parameters->windGust = drawScenarioRange(&random, &scenario->windGust);
+
+  parameters->failedMotor = -1;
+  if (uniformModelRandom(&random) < drawScenarioRange(&random, &scenario->motorFailure)) {
+    parameters->failedMotor = (int)(uniformModelRandom(&random) * PLANT_MOTORS);
+    parameters->motorLoss = drawScenarioRange(&random, &scenario->motorLoss);
+    parameters->motorFailureTime = SCENARIO_FAILURE_START + (SCENARIO_FAILURE_END - SCENARIO_FAILURE_START) * uniformModelRandom(&random);
+  }
+  if (uniformModelRandom(&random) < drawScenarioRange(&random, &scenario->gpsGlitch)) {
+    const double size = drawScenarioRange(&random, &scenario->gpsGlitchSize);
+    const double direction = 2.0 * M_PI * uniformModelRandom(&random);
+    parameters->gpsGlitch[0] = size * cos(direction);
+    parameters->gpsGlitch[1] = size * sin(direction);
+    parameters->gpsGlitchTime = SCENARIO_GLITCH_START + (SCENARIO_GLITCH_END - SCENARIO_GLITCH_START) * uniformModelRandom(&random);
+  }
+}
+
+#endif
@@ -0,0 +1,229 @@
+/*
+  AeroQuad v3.2 - Host build of the AeroQuad32 firmware
+  www.AeroQuad.com
+  Copyright (c) 2012 Ted Carancho.  All rights reserved.
+  An Open Source Arduino based multicopter.
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// What the AeroQuad32 sensors give for a vehicle state
+//
+// The state is in the NED frame of the firmware: position in meters from
+// home, north, east and down, attitude as roll, pitch and yaw (ZYX Euler
+// angles), body rates about the forward, right and down axes. The outputs
+// are the raw values HostDevices.h takes, mounted as on the AQ32 board, so
+// the firmware drivers turn them back into the state with their default
+// calibration. Noise comes from a seeded generator, a given seed always
+// gives the same samples.
+
+#ifndef _AEROQUAD_HOST_SENSOR_MODEL_H_
+#define _AEROQUAD_HOST_SENSOR_MODEL_H_
+
+#include <math.h>
+#include <stdint.h>
+#include "HostDevices.h"
+
+#define MODEL_GRAVITY 9.80665
+#define MODEL_EARTH_RADIUS 6371000.0                  // m
+#define MODEL_ACCEL_LSB (8192.0 / MODEL_GRAVITY)      // MPU6000 at +/-4g, per m/s^2
+#define MODEL_GYRO_LSB (65536.0 / 2000.0 * 180.0 / M_PI)  // MPU6000 at +/-1000deg/s, per rad/s
+#define MODEL_MAG_LSB 1090.0                          // HMC5883L at +/-1.0Ga, per Gauss
+
+// the magnetometer bias of platform_aeroquad32.h, the model sensor has the
+// hard iron it corrects
+static const double modelMagBias[3] = {152.0, 24.0, 16.5};
+
+// MS5611 calibration, the one hostMS5611Prom() serves
+static const double modelProm[7] = {0, 40127, 36924, 23317, 23282, 33464, 28312};
+
+struct VehicleState {
+  double position[3];       // m, north, east, down
+  double velocity[3];       // m/s
+  double acceleration[3];   // m/s^2, kinematic, gravity not included
+  double attitude[3];       // rad, roll, pitch, yaw
+  double rate[3];           // rad/s, body
+};
+
+struct SensorNoise {
+  double accel;             // m/s^2, standard deviation of every sample
+  double gyro;              // rad/s
+  double gyroBias[3];       // rad/s, left after the boot calibration
+  double vibration;         // m/s^2, amplitude of the motor vibration when spinning
+  double vibrationFrequency;// Hz
+  double mag;               // Gauss
+  double baro;              // Pa
+  double gpsPosition;       // m
+  double gpsVelocity;       // m/s
+  double temperature;       // deg C
+};
+
+struct Environment {
+  double groundElevation;   // m above sea level
+  double magneticField[3];  // Gauss, north, east, down
+  double homeLatitude;      // deg
+  double homeLongitude;     // deg
+};
+
+static const struct SensorNoise modelDefaultNoise = {
+  0.05, 0.002, {0.0, 0.0, 0.0}, 0.3, 180.0, 0.002, 2.0, 0.5, 0.1, 35.0
+};
+
+static const struct Environment modelDefaultEnvironment = {
+  100.0, {0.21, -0.04, 0.43}, 45.5, -73.6
+};
+
+// xorshift, small and the same everywhere
+struct ModelRandom {
+  uint32_t state;
+};
+
+void seedModelRandom(struct ModelRandom *random, uint32_t seed) {
+  random->state = seed ? seed : 0x12345678;
+}
+
+double uniformModelRandom(struct ModelRandom *random) {
+  uint32_t x = random->state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  random->state = x;
+  return (x >> 8) / 16777216.0;
+}
+
+// sum of four uniforms, close enough to normal and never far out
+double gaussianModelRandom(struct ModelRandom *random, double deviation) {
+  double sum = 0.0;
+  for (int i = 0; i < 4; i++) {
+    sum += uniformModelRandom(random);
+  }
+  return (sum - 2.0) * sqrt(3.0) * deviation;
+}
+
+int16_t modelSaturate16(double value) {
+  value = floor(value + 0.5);
+  if (value > 32767.0) {
+    return 32767;
+  }
+  if (value < -32768.0) {
+    return -32768;
+  }
+  return (int16_t)value;
+}
+
+// world (NED) to body, transpose of the ZYX rotation
+void modelWorldToBody(const double attitude[3], const double world[3], double body[3]) {
+  const double sr = sin(attitude[0]), cr = cos(attitude[0]);
+  const double sp = sin(attitude[1]), cp = cos(attitude[1]);
+  const double sy = sin(attitude[2]), cy = cos(attitude[2]);
+  body[0] = cp * cy * world[0] + cp * sy * world[1] - sp * world[2];
+  body[1] = (sr * sp * cy - cr * sy) * world[0] + (sr * sp * sy + cr * cy) * world[1] + sr * cp * world[2];
+  body[2] = (cr * sp * cy + sr * sy) * world[0] + (cr * sp * sy - sr * cy) * world[1] + cr * cp * world[2];
+}
+
+void modelBodyToWorld(const double attitude[3], const double body[3], double world[3]) {
+  const double sr = sin(attitude[0]), cr = cos(attitude[0]);
+  const double sp = sin(attitude[1]), cp = cos(attitude[1]);
+  const double sy = sin(attitude[2]), cy = cos(attitude[2]);
+  world[0] = cp * cy * body[0] + (sr * sp * cy - cr * sy) * body[1] + (cr * sp * cy + sr * sy) * body[2];
+  world[1] = cp * sy * body[0] + (sr * sp * sy + cr * cy) * body[1] + (cr * sp * sy - sr * cy) * body[2];
+  world[2] = -sp * body[0] + sr * cp * body[1] + cr * cp * body[2];
+}
+
+/**
+ * MPU6000 registers, the chip axes are forward, left and up
+ * vibrating is true while the motors spin, time in seconds gives the phase
+ */
+void modelMPU6000(const struct VehicleState *state, const struct SensorNoise *noise, struct ModelRandom *random,
+                  bool vibrating, double time, int16_t accel[3], int16_t *temperature, int16_t gyro[3]) {
+  const double specificWorld[3] = {
+    state->acceleration[0], state->acceleration[1], state->acceleration[2] - MODEL_GRAVITY
+  };
+  double specific[3];
+  modelWorldToBody(state->attitude, specificWorld, specific);
+  const double sign[3] = {1.0, -1.0, -1.0};
+  for (int axis = 0; axis < 3; axis++) {
+    double value = specific[axis] + gaussianModelRandom(random, noise->accel);
+    if (vibrating) {
+      value += noise->vibration * sin(2.0 * M_PI * noise->vibrationFrequency * time + axis);
+    }
+    accel[axis] = modelSaturate16(sign[axis] * value * MODEL_ACCEL_LSB);
+    const double rate = state->rate[axis] + noise->gyroBias[axis] + gaussianModelRandom(random, noise->gyro);
+    gyro[axis] = modelSaturate16(sign[axis] * rate * MODEL_GYRO_LSB);
+  }
+  *temperature = modelSaturate16((noise->temperature - 36.53) * 340.0);
+}
+
+/**
+ * HMC5883L data registers, X, Y and Z, the board has them as right,
+ * forward and up
+ */
+void modelHMC5883L(const struct VehicleState *state, const struct SensorNoise *noise, const struct Environment *environment,
+                   struct ModelRandom *random, int16_t field[3]) {
+  double body[3];
+  modelWorldToBody(state->attitude, environment->magneticField, body);
+  double counts[3];
+  for (int axis = 0; axis < 3; axis++) {
+    counts[axis] = (body[axis] + gaussianModelRandom(random, noise->mag)) * MODEL_MAG_LSB - modelMagBias[axis];
+  }
+  field[0] = modelSaturate16(counts[1]);
+  field[1] = modelSaturate16(counts[0]);
+  field[2] = modelSaturate16(-counts[2]);
+}
+
+/**
+ * Static pressure in Pa, standard atmosphere
+ */
+double modelPressure(const struct VehicleState *state, const struct SensorNoise *noise, const struct Environment *environment,
+                     struct ModelRandom *random) {
+  const double altitude = environment->groundElevation - state->position[2];
+  return 101325.0 * pow(1.0 - altitude / 44330.0, 5.255) + gaussianModelRandom(random, noise->baro);
+}
+
+/**
+ * MS5611 D1 and D2, the first order compensation of the datasheet solved
+ * for the conversions
+ */
+void modelMS5611(const struct VehicleState *state, const struct SensorNoise *noise, const struct Environment *environment,
+                 struct ModelRandom *random, uint32_t *d1, uint32_t *d2) {
+  const double pressure = modelPressure(state, noise, environment, random);
+  const int64_t dT = (int64_t)floor((noise->temperature * 100.0 - 2000.0) * 8388608.0 / modelProm[6] + 0.5);
+  const int64_t offset = ((int64_t)modelProm[2] << 16) + (((int64_t)modelProm[4] * dT) >> 7);
+  const int64_t sensitivity = ((int64_t)modelProm[1] << 15) + (((int64_t)modelProm[3] * dT) >> 8);
+  *d2 = (uint32_t)(dT + ((int64_t)modelProm[5] << 8));
+  *d1 = (uint32_t)floor((pressure * 32768.0 + offset) * 2097152.0 / sensitivity + 0.5);
+}
+
+/**
+ * GPS fix, 3D with the satellites given, none when sats is 0
+ */
+void modelGps(const struct VehicleState *state, const struct SensorNoise *noise, const struct Environment *environment,
+              struct ModelRandom *random, uint8_t sats, struct HostGpsFix *fix) {
+  const double north = state->position[0] + gaussianModelRandom(random, noise->gpsPosition);
+  const double east = state->position[1] + gaussianModelRandom(random, noise->gpsPosition);
+  const double latitude = environment->homeLatitude + north / MODEL_EARTH_RADIUS * 180.0 / M_PI;
+  const double longitude = environment->homeLongitude +
+                           east / (MODEL_EARTH_RADIUS * cos(environment->homeLatitude * M_PI / 180.0)) * 180.0 / M_PI;
+  fix->fix = sats > 0 ? 3 : 0;
+  fix->sats = sats;
+  fix->latitude = (int32_t)floor(latitude * 1.0e7 + 0.5);
+  fix->longitude = (int32_t)floor(longitude * 1.0e7 + 0.5);
+  fix->height = (int32_t)floor((environment->groundElevation - state->position[2]) * 1000.0 + 0.5);
+  for (int axis = 0; axis < 3; axis++) {
+    fix->velocity[axis] = (int32_t)floor((state->velocity[axis] + gaussianModelRandom(random, noise->gpsVelocity)) * 100.0 + 0.5);
+  }
+  fix->accuracy = (uint32_t)(noise->gpsPosition * 3000.0);
+}
+
+#endif
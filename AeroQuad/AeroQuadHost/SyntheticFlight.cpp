@@ -0,0 +1,218 @@
+/*
+  AeroQuad v3.2 - Host build of the AeroQuad32 firmware
+  www.AeroQuad.com
+  Copyright (c) 2012 Ted Carancho.  All rights reserved.
+  An Open Source Arduino based multicopter.
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Writes the log of a made up flight, in the format of ReplayLog.h
+//
+// The vehicle follows the sticks without any physics: the attitude tracks
+// the stick angles through a lag, the altitude a profile and the thrust
+// tilt moves it around. That is enough for the firmware estimators, the
+// hold modes and the PIDs to run through everything a flight does:
+//
+//   0s    on the ground, GPS fix from 2s, 9 satellites from 5s
+//   12s   armed, yaw stick right
+//   13.5s throttle up, climb to 6m
+//   16.5s roll right, roll left, pitch forward
+//   20s   altitude hold, AUX1 middle
+//   22s   yaw right
+//   24s   position hold, AUX1 low
+//   28s   holds off, descent
+//   32s   landed, throttle down, disarmed at 33s
+//
+//   SyntheticFlight [seed] > flight.log
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "SensorModel.h"
+#include "ReplayLog.h"
+
+#define FLIGHT_DURATION 36.0    // s
+#define FLIGHT_STEP 1000        // us, the MPU6000 sample rate
+#define ATTITUDE_LAG 0.2        // s
+#define MAX_STICK_ANGLE 0.5     // rad
+#define MAX_STICK_YAW_RATE 2.0  // rad/s
+#define HOVER_ALTITUDE 6.0      // m
+#define DRAG 0.4                // 1/s
+#define LANDING_SPEED 0.5       // m/s
+
+// pulses of the 8 channels, roll, pitch, yaw, throttle, mode, AUX1, AUX2, AUX3
+void flightSticks(double t, int pulse[8]) {
+  pulse[0] = 1500;
+  pulse[1] = 1500;
+  pulse[2] = 1500;
+  pulse[3] = 1000;
+  pulse[4] = 2000;   // attitude mode
+  pulse[5] = 2000;
+  pulse[6] = 2000;
+  pulse[7] = 2000;
+
+  if (t >= 12.0 && t < 13.0) {
+    pulse[2] = 2000;
+  }
+  if (t >= 13.5 && t < 15.5) {
+    pulse[3] = 1000 + (int)((t - 13.5) / 2.0 * 600.0);
+  }
+  else if (t >= 15.5 && t < 28.0) {
+    pulse[3] = 1600;
+  }
+  else if (t >= 28.0 && t < 32.0) {
+    pulse[3] = 1450;
+  }
+  if (t >= 16.5 && t < 17.5) {
+    pulse[0] = 1650;
+  }
+  else if (t >= 17.5 && t < 18.5) {
+    pulse[0] = 1350;
+  }
+  else if (t >= 18.5 && t < 19.5) {
+    pulse[1] = 1350;
+  }
+  if (t >= 20.0 && t < 24.0) {
+    pulse[5] = 1500;
+  }
+  else if (t >= 24.0 && t < 28.0) {
+    pulse[5] = 1000;
+  }
+  if (t >= 22.0 && t < 23.0) {
+    pulse[2] = 1700;
+  }
+  if (t >= 33.0 && t < 34.0) {
+    pulse[2] = 1000;
+  }
+}
+
+double flightAltitude(double t) {
+  if (t < 14.0 || t >= 31.5) {
+    return 0.0;
+  }
+  if (t < 17.0) {
+    return HOVER_ALTITUDE * 0.5 * (1.0 - cos(M_PI * (t - 14.0) / 3.0));
+  }
+  if (t < 28.0) {
+    return HOVER_ALTITUDE + 0.3 * sin(2.0 * M_PI * (t - 17.0) / 8.0);
+  }
+  return HOVER_ALTITUDE * 0.5 * (1.0 + cos(M_PI * (t - 28.0) / 3.5));
+}
+
+int main(int argc, char *argv[]) {
+  const uint32_t seed = argc > 1 ? strtoul(argv[1], NULL, 0) : 1;
+  struct ModelRandom random;
+  seedModelRandom(&random, seed);
+  const struct SensorNoise *noise = &modelDefaultNoise;
+  const struct Environment *environment = &modelDefaultEnvironment;
+
+  struct VehicleState state;
+  memset(&state, 0, sizeof(state));
+  state.attitude[2] = 30.0 * M_PI / 180.0;
+  double attitudeRate[3] = {0.0, 0.0, 0.0};
+
+  printf("# AeroQuadHost synthetic flight, seed %u\n", seed);
+  struct ReplayRecord record;
+  const double dt = FLIGHT_STEP / 1000000.0;
+  for (unsigned long time = FLIGHT_STEP; time <= (unsigned long)(FLIGHT_DURATION * 1000000); time += FLIGHT_STEP) {
+    const double t = time / 1000000.0;
+    int pulse[8];
+    flightSticks(t, pulse);
+    const double altitude = flightAltitude(t);
+    const bool airborne = altitude > 0.0 || state.position[2] < -0.01;
+
+    // attitude follows the sticks once in the air
+    double target[3] = {0.0, 0.0, 0.0};
+    double yawRate = 0.0;
+    if (airborne) {
+      target[0] = (pulse[0] - 1500) / 500.0 * MAX_STICK_ANGLE;
+      target[1] = (pulse[1] - 1500) / 500.0 * MAX_STICK_ANGLE;
+      if (pulse[3] > 1100) {   // no yaw authority at idle
+        yawRate = (pulse[2] - 1500) / 500.0 * MAX_STICK_YAW_RATE;
+      }
+    }
+    for (int axis = 0; axis < 2; axis++) {
+      attitudeRate[axis] = (target[axis] - state.attitude[axis]) / ATTITUDE_LAG;
+    }
+    attitudeRate[2] += (yawRate - attitudeRate[2]) * dt / ATTITUDE_LAG;
+    for (int axis = 0; axis < 3; axis++) {
+      state.attitude[axis] += attitudeRate[axis] * dt;
+    }
+    const double sr = sin(state.attitude[0]), cr = cos(state.attitude[0]);
+    const double sp = sin(state.attitude[1]), cp = cos(state.attitude[1]);
+    state.rate[0] = attitudeRate[0] - attitudeRate[2] * sp;
+    state.rate[1] = attitudeRate[1] * cr + attitudeRate[2] * cp * sr;
+    state.rate[2] = -attitudeRate[1] * sr + attitudeRate[2] * cp * cr;
+
+    // thrust holds the altitude profile, its tilt moves the vehicle
+    if (airborne) {
+      // down at a steady rate to the ground once the profile is done
+      const double verticalAcceleration = altitude > 0.0 ? 4.0 * (-altitude - state.position[2]) - 4.0 * state.velocity[2]
+                                                         : 4.0 * (LANDING_SPEED - state.velocity[2]);
+      const double thrust = (MODEL_GRAVITY - verticalAcceleration) / (cr * cp);
+      const double body[3] = {0.0, 0.0, -thrust};
+      double world[3];
+      modelBodyToWorld(state.attitude, body, world);
+      state.acceleration[0] = world[0] - DRAG * state.velocity[0];
+      state.acceleration[1] = world[1] - DRAG * state.velocity[1];
+      state.acceleration[2] = world[2] + MODEL_GRAVITY;
+      for (int axis = 0; axis < 3; axis++) {
+        state.velocity[axis] += state.acceleration[axis] * dt;
+        state.position[axis] += state.velocity[axis] * dt;
+      }
+      if (state.position[2] > 0.0) {
+        state.position[2] = 0.0;
+        state.velocity[2] = 0.0;
+      }
+    }
+    else {
+      for (int axis = 0; axis < 3; axis++) {
+        state.velocity[axis] = 0.0;
+        state.acceleration[axis] = 0.0;
+      }
+      state.position[2] = 0.0;
+    }
+
+    const bool spinning = t >= 12.0 && t < 33.0;
+    record.type = REPLAY_IMU;
+    record.time = time;
+    modelMPU6000(&state, noise, &random, spinning, t, record.accel, &record.temperature, record.gyro);
+    writeReplayRecord(stdout, &record);
+
+    if (time % 13000 == 0) {
+      record.type = REPLAY_MAG;
+      modelHMC5883L(&state, noise, environment, &random, record.mag);
+      writeReplayRecord(stdout, &record);
+    }
+    if (time % 10000 == 0) {
+      record.type = REPLAY_BARO;
+      modelMS5611(&state, noise, environment, &random, &record.d1, &record.d2);
+      writeReplayRecord(stdout, &record);
+    }
+    if (time % 20000 == 0) {
+      record.type = REPLAY_RECEIVER;
+      record.channels = 8;
+      for (int channel = 0; channel < 8; channel++) {
+        record.pulse[channel] = pulse[channel];
+      }
+      writeReplayRecord(stdout, &record);
+    }
+    if (time % 200000 == 0 && t >= 2.0) {
+      record.type = REPLAY_GPS;
+      modelGps(&state, noise, environment, &random, t >= 5.0 ? 9 : 5, &record.gps);
+      writeReplayRecord(stdout, &record);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,174 @@
+/*
+  AeroQuad v3.2 - Host build of the AeroQuad32 firmware
+  www.AeroQuad.com
+  Copyright (c) 2012 Ted Carancho.  All rights reserved.
+  An Open Source Arduino based multicopter.
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Rigid body quad X flown by the emulated motor outputs
+//
+// The motors are numbered as in FlightControlQuadX.h, front left, front
+// right, rear right and rear left, the front left and rear right ones
+// spinning clockwise. Each motor speed follows its ESC pulse through a
+// first order lag, thrust goes with the square of the speed. The vehicle
+// state is the one of SensorModel.h, so its outputs feed the sensor
+// models directly. The ground holds the vehicle up, touching it too fast
+// or too tilted is a crash and the plant stops moving, so is pitching up
+// or down past PLANT_LOST_PITCH in the air.
+
+#ifndef _AEROQUAD_HOST_VEHICLE_PLANT_H_
+#define _AEROQUAD_HOST_VEHICLE_PLANT_H_
+
+#include <math.h>
+#include <string.h>
+#include "SensorModel.h"
+
+#define PLANT_MOTORS 4
+#define PLANT_CRASH_SPEED 2.5     // m/s, down at touch down
+#define PLANT_CRASH_TILT 0.8      // rad, roll or pitch at touch down
+#define PLANT_LOST_PITCH 1.4      // rad, pitch in the air the Euler angles can't follow
+
+struct PlantParameters {
+  double mass;              // kg
+  double armLength;         // m, center to motor
+  double inertia[3];        // kg m^2, about the body axes
+  double maxThrust;         // N, of one motor at full pulse
+  double motorLag;          // s
+  double yawTorque;         // m, yaw torque of a motor per N of thrust
+  double drag;              // 1/s, per m/s of air speed
+  double angularDrag;       // Nm per rad/s
+};
+
+// a 1.4kg 450 class quad, hovering a little above half throttle
+static const struct PlantParameters modelDefaultPlant = {
+  1.4, 0.225, {0.015, 0.015, 0.028}, 8.6, 0.04, 0.016, 0.3, 0.002
+};
+
+struct VehiclePlant {
+  struct VehicleState state;
+  double motorSpeed[PLANT_MOTORS];  // 0 to 1
+  double motorHealth[PLANT_MOTORS]; // share of the thrust left
+  bool onGround;
+  bool crashed;
+  double touchDownSpeed;            // m/s, of the last touch down
+};
+
+void initVehiclePlant(struct VehiclePlant *plant, double heading) {
+  memset(plant, 0, sizeof(*plant));
+  plant->state.attitude[2] = heading;
+  for (int motor = 0; motor < PLANT_MOTORS; motor++) {
+    plant->motorHealth[motor] = 1.0;
+  }
+  plant->onGround = true;
+}
+
+/**
+ * Moves the plant by dt seconds, motorCommand are the ESC pulses in us and
+ * wind the air speed in the NED frame
+ */
+void stepVehiclePlant(struct VehiclePlant *plant, const struct PlantParameters *parameters,
+                      const int motorCommand[PLANT_MOTORS], const double wind[3], double dt) {
+  if (plant->crashed) {
+    return;
+  }
+  struct VehicleState *state = &plant->state;
+
+  // motor x, y and yaw direction
+  static const double motorSide[PLANT_MOTORS][3] = {
+    {1.0, -1.0, -1.0}, {1.0, 1.0, 1.0}, {-1.0, 1.0, -1.0}, {-1.0, -1.0, 1.0}
+  };
+  const double arm = parameters->armLength * M_SQRT1_2;
+  double thrust = 0.0;
+  double torque[3] = {0.0, 0.0, 0.0};
+  for (int motor = 0; motor < PLANT_MOTORS; motor++) {
+    double command = (motorCommand[motor] - 1000) / 1000.0;
+    command = command < 0.0 ? 0.0 : (command > 1.0 ? 1.0 : command);
+    plant->motorSpeed[motor] += (command - plant->motorSpeed[motor]) * dt / parameters->motorLag;
+    const double motorThrust = parameters->maxThrust * plant->motorHealth[motor] *
+                               plant->motorSpeed[motor] * plant->motorSpeed[motor];
+    thrust += motorThrust;
+    torque[0] -= motorSide[motor][1] * arm * motorThrust;
+    torque[1] += motorSide[motor][0] * arm * motorThrust;
+    torque[2] += motorSide[motor][2] * parameters->yawTorque * motorThrust;
+  }
+
+  // rotation, Euler's equations in the body frame
+  double *rate = state->rate;
+  const double *inertia = parameters->inertia;
+  const double angularAcceleration[3] = {
+    (torque[0] - parameters->angularDrag * rate[0] - (inertia[2] - inertia[1]) * rate[1] * rate[2]) / inertia[0],
+    (torque[1] - parameters->angularDrag * rate[1] - (inertia[0] - inertia[2]) * rate[2] * rate[0]) / inertia[1],
+    (torque[2] - parameters->angularDrag * rate[2] - (inertia[1] - inertia[0]) * rate[0] * rate[1]) / inertia[2]
+  };
+
+  // translation, thrust along body down, drag against the air speed
+  const double body[3] = {0.0, 0.0, -thrust / parameters->mass};
+  double world[3];
+  modelBodyToWorld(state->attitude, body, world);
+  for (int axis = 0; axis < 3; axis++) {
+    world[axis] -= parameters->drag * (state->velocity[axis] - wind[axis]);
+  }
+  world[2] += MODEL_GRAVITY;
+
+  if (plant->onGround && world[2] >= 0.0) {
+    for (int axis = 0; axis < 3; axis++) {
+      state->velocity[axis] = 0.0;
+      state->acceleration[axis] = 0.0;
+      state->rate[axis] = 0.0;
+    }
+    return;
+  }
+  plant->onGround = false;
+
+  for (int axis = 0; axis < 3; axis++) {
+    rate[axis] += angularAcceleration[axis] * dt;
+    state->acceleration[axis] = world[axis];
+    state->velocity[axis] += world[axis] * dt;
+    state->position[axis] += state->velocity[axis] * dt;
+  }
+  const double sr = sin(state->attitude[0]), cr = cos(state->attitude[0]);
+  const double cp = cos(state->attitude[1]), tp = tan(state->attitude[1]);
+  state->attitude[0] += (rate[0] + (rate[1] * sr + rate[2] * cr) * tp) * dt;
+  state->attitude[1] += (rate[1] * cr - rate[2] * sr) * dt;
+  state->attitude[2] += (rate[1] * sr + rate[2] * cr) / cp * dt;
+  state->attitude[0] = remainder(state->attitude[0], 2.0 * M_PI);
+  state->attitude[2] = remainder(state->attitude[2], 2.0 * M_PI);
+  if (fabs(state->attitude[1]) > PLANT_LOST_PITCH) {
+    plant->crashed = true;
+    return;
+  }
+
+  if (state->position[2] >= 0.0) {
+    plant->touchDownSpeed = state->velocity[2];
+    if (state->velocity[2] > PLANT_CRASH_SPEED ||
+        fabs(state->attitude[0]) > PLANT_CRASH_TILT || fabs(state->attitude[1]) > PLANT_CRASH_TILT) {
+      plant->crashed = true;
+    }
+    else {
+      state->attitude[0] = 0.0;
+      state->attitude[1] = 0.0;
+    }
+    plant->onGround = true;
+    state->position[2] = 0.0;
+    for (int axis = 0; axis < 3; axis++) {
+      state->velocity[axis] = 0.0;
+      state->acceleration[axis] = 0.0;
+      state->rate[axis] = 0.0;
+    }
+  }
+}
+
+#endif
@@ -393,7 +393,10 @@ void i2c_init(i2c_dev *dev) {
  *              I2C_REMAP: Remap I2C1 to SCL/PB8 SDA/PB9.
  */
 void i2c_master_enable(i2c_dev *dev, uint32 flags) {
-#define I2C_CLK                (STM32_PCLK1/1000000)
+    /* APB1 as the RCC set it up, 36MHz on F1 but 42MHz on a 168MHz F4,
+     * where STM32_PCLK1 would still say 36MHz */
+    const uint32 pclk1 = rcc_dev_clk_speed(dev->clk_id);
+    const uint32 pclk1_mhz = pclk1/1000000;
     uint32 ccr   = 0;
     uint32 trise = 0;
 
@@ -416,8 +419,8 @@ void i2c_master_enable(i2c_dev *dev, uint32 flags) {
     gpio_set_mode(dev->gpio_port, dev->sda_pin, GPIO_AF_OUTPUT_OD);
     gpio_set_mode(dev->gpio_port, dev->scl_pin, GPIO_AF_OUTPUT_OD);
 
-    /* I2C1 and I2C2 are fed from APB1, clocked at 36MHz */
-    i2c_set_input_clk(dev, I2C_CLK);
+    /* I2C1 and I2C2 are fed from APB1 */
+    i2c_set_input_clk(dev, pclk1_mhz);
 
     if (flags & I2C_FAST_MODE) {
         ccr |= I2C_CCR_FS;
@@ -425,17 +428,17 @@ void i2c_master_enable(i2c_dev *dev, uint32 flags) {
         if (flags & I2C_DUTY_16_9) {
             /* Tlow/Thigh = 16/9 */
             ccr |= I2C_CCR_DUTY;
-            ccr |= STM32_PCLK1/(400000 * 25);
+            ccr |= pclk1/(400000 * 25);
         } else {
             /* Tlow/Thigh = 2 */
-            ccr |= STM32_PCLK1/(400000 * 3);
+            ccr |= pclk1/(400000 * 3);
         }
 
-        trise = (300 * (I2C_CLK)/1000) + 1;
+        trise = (300 * pclk1_mhz/1000) + 1;
     } else {
         /* Tlow/Thigh = 1 */
-        ccr = STM32_PCLK1/(100000 * 2);
-        trise = I2C_CLK + 1;
+        ccr = pclk1/(100000 * 2);
+        trise = pclk1_mhz + 1;
     }
 
     /* Set minimum required value if CCR < 1*/
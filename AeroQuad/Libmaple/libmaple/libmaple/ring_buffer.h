@@ -89,6 +89,14 @@ static inline uint16 rb_full_count(ring_buffer *rb) {
     return (uint16)size;
 }
 
+/**
+ * @brief Return the number of elements that can still be inserted.
+ * @param rb Buffer to check.
+ */
+static inline uint16 rb_space(ring_buffer *rb) {
+    return rb->size - rb_full_count(rb);
+}
+
 /**
  * @brief Returns true if and only if the ring buffer is full.
  * @param rb Buffer to test.
@@ -153,6 +161,32 @@ static inline int rb_safe_insert(ring_buffer *rb, uint8 element) {
     return 1;
 }
 
+/**
+ * @brief Insert as many elements as fit in one pass.
+ *
+ * The tail only moves once every element is in place, so a reader in
+ * an interrupt handler never sees a partly written run.
+ *
+ * @param rb Buffer to insert into.
+ * @param elements Values to insert.
+ * @param len Number of values.
+ * @return Number of elements inserted, less than len if rb filled up.
+ */
+static inline uint32 rb_safe_insert_bulk(ring_buffer *rb, const uint8 *elements, uint32 len) {
+    uint32 space = rb_space(rb);
+    uint16 tail = rb->tail;
+    uint32 i;
+    if (len > space) {
+        len = space;
+    }
+    for (i = 0; i < len; i++) {
+        rb->buf[tail] = elements[i];
+        tail = (tail == rb->size) ? 0 : tail + 1;
+    }
+    ((__io ring_buffer*)rb)->tail = tail;
+    return len;
+}
+
 /**
  * @brief Append an item onto the end of a non-full ring buffer.
  *
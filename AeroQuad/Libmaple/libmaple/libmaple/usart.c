@@ -32,33 +32,85 @@
  */
 
 #include "usart.h"
-#define USART_TX_IRQ
+
+/*
+ * Ring buffer sizes
+ */
+
+#ifndef USART1_RX_BUF_SIZE
+#define USART1_RX_BUF_SIZE USART_RX_BUF_SIZE
+#endif
+#ifndef USART1_TX_BUF_SIZE
+#define USART1_TX_BUF_SIZE USART_TX_BUF_SIZE
+#endif
+#ifndef USART2_RX_BUF_SIZE
+#define USART2_RX_BUF_SIZE USART_RX_BUF_SIZE
+#endif
+#ifndef USART2_TX_BUF_SIZE
+#define USART2_TX_BUF_SIZE USART_TX_BUF_SIZE
+#endif
+#ifndef USART3_RX_BUF_SIZE
+#define USART3_RX_BUF_SIZE USART_RX_BUF_SIZE
+#endif
+#ifndef USART3_TX_BUF_SIZE
+#define USART3_TX_BUF_SIZE USART_TX_BUF_SIZE
+#endif
+#ifndef UART4_RX_BUF_SIZE
+#define UART4_RX_BUF_SIZE USART_RX_BUF_SIZE
+#endif
+#ifndef UART4_TX_BUF_SIZE
+#define UART4_TX_BUF_SIZE USART_TX_BUF_SIZE
+#endif
+#ifndef UART5_RX_BUF_SIZE
+#define UART5_RX_BUF_SIZE USART_RX_BUF_SIZE
+#endif
+#ifndef UART5_TX_BUF_SIZE
+#define UART5_TX_BUF_SIZE USART_TX_BUF_SIZE
+#endif
 
 /*
  * Devices
  */
 
+static uint8 usart1_rx_buf[USART1_RX_BUF_SIZE];
+static uint8 usart1_tx_buf[USART1_TX_BUF_SIZE];
 static usart_dev usart1 = {
     .regs     = USART1_BASE,
     .max_baud = 4500000UL,
+    .rx_buf   = usart1_rx_buf,
+    .tx_buf   = usart1_tx_buf,
+    .rx_buf_size = USART1_RX_BUF_SIZE,
+    .tx_buf_size = USART1_TX_BUF_SIZE,
     .clk_id   = RCC_USART1,
     .irq_num  = NVIC_USART1
 };
 /** USART1 device */
 usart_dev *USART1 = &usart1;
 
+static uint8 usart2_rx_buf[USART2_RX_BUF_SIZE];
+static uint8 usart2_tx_buf[USART2_TX_BUF_SIZE];
 static usart_dev usart2 = {
     .regs     = USART2_BASE,
     .max_baud = 2250000UL,
+    .rx_buf   = usart2_rx_buf,
+    .tx_buf   = usart2_tx_buf,
+    .rx_buf_size = USART2_RX_BUF_SIZE,
+    .tx_buf_size = USART2_TX_BUF_SIZE,
     .clk_id   = RCC_USART2,
     .irq_num  = NVIC_USART2
 };
 /** USART2 device */
 usart_dev *USART2 = &usart2;
 
+static uint8 usart3_rx_buf[USART3_RX_BUF_SIZE];
+static uint8 usart3_tx_buf[USART3_TX_BUF_SIZE];
 static usart_dev usart3 = {
     .regs     = USART3_BASE,
     .max_baud = 2250000UL,
+    .rx_buf   = usart3_rx_buf,
+    .tx_buf   = usart3_tx_buf,
+    .rx_buf_size = USART3_RX_BUF_SIZE,
+    .tx_buf_size = USART3_TX_BUF_SIZE,
     .clk_id   = RCC_USART3,
     .irq_num  = NVIC_USART3
 };
@@ -66,18 +118,30 @@ static usart_dev usart3 = {
 usart_dev *USART3 = &usart3;
 
 #ifdef STM32_HIGH_DENSITY
+static uint8 uart4_rx_buf[UART4_RX_BUF_SIZE];
+static uint8 uart4_tx_buf[UART4_TX_BUF_SIZE];
 static usart_dev uart4 = {
     .regs     = UART4_BASE,
     .max_baud = 2250000UL,
+    .rx_buf   = uart4_rx_buf,
+    .tx_buf   = uart4_tx_buf,
+    .rx_buf_size = UART4_RX_BUF_SIZE,
+    .tx_buf_size = UART4_TX_BUF_SIZE,
     .clk_id   = RCC_UART4,
     .irq_num  = NVIC_UART4
 };
 /** UART4 device */
 usart_dev *UART4 = &uart4;
 
+static uint8 uart5_rx_buf[UART5_RX_BUF_SIZE];
+static uint8 uart5_tx_buf[UART5_TX_BUF_SIZE];
 static usart_dev uart5 = {
     .regs     = UART5_BASE,
     .max_baud = 2250000UL,
+    .rx_buf   = uart5_rx_buf,
+    .tx_buf   = uart5_tx_buf,
+    .rx_buf_size = UART5_RX_BUF_SIZE,
+    .tx_buf_size = UART5_TX_BUF_SIZE,
     .clk_id   = RCC_UART5,
     .irq_num  = NVIC_UART5
 };
@@ -90,8 +154,8 @@ usart_dev *UART5 = &uart5;
  * @param dev         Serial port to be initialized
  */
 void usart_init(usart_dev *dev) {
-    rb_init(&dev->rbRX, USART_RX_BUF_SIZE, dev->rx_buf);
-    rb_init(&dev->rbTX, USART_TX_BUF_SIZE, dev->tx_buf);
+    rb_init(&dev->rbRX, dev->rx_buf_size, dev->rx_buf);
+    rb_init(&dev->rbTX, dev->tx_buf_size, dev->tx_buf);
     rcc_clk_enable(dev->clk_id);
     nvic_irq_enable(dev->irq_num);
 }
@@ -202,9 +266,9 @@ void usart_foreach(void (*fn)(usart_dev*)) {
 uint32 usart_tx(usart_dev *dev, const uint8 *buf, uint32 len) {
     uint32 txed = 0;
 #ifdef USART_TX_IRQ
-    while (txed < len && rb_safe_insert(&dev->rbTX, buf[txed])) {
+    txed = rb_safe_insert_bulk(&dev->rbTX, buf, len);
+    if (txed) {
     	usart_tx_irq_enable(dev);
-    	txed++;
     }
 
 #else
@@ -217,6 +281,27 @@ uint32 usart_tx(usart_dev *dev, const uint8 *buf, uint32 len) {
     return txed;
 }
 
+/**
+ * @brief Blocking USART transmit
+ *
+ * Waits for room in the TX ring whenever it fills up, and counts the
+ * call in tx_overflow if it had to.
+ *
+ * @param dev Serial port to transmit over
+ * @param buf Buffer to transmit
+ * @param len Number of bytes to transmit
+ */
+void usart_puts(usart_dev *dev, const uint8 *buf, uint32 len) {
+    uint32 txed = usart_tx(dev, buf, len);
+    if (txed == len) {
+        return;
+    }
+    dev->tx_overflow++;
+    while (txed < len) {
+        txed += usart_tx(dev, buf + txed, len - txed);
+    }
+}
+
 /**
  * @brief Transmit an unsigned integer to the specified serial port in
  *        decimal format.
@@ -250,10 +335,14 @@ static inline void usart_irq(usart_dev *dev) {
 #ifdef USART_SAFE_INSERT
 		/* If the buffer is full and the user defines USART_SAFE_INSERT,
 		 * ignore new bytes. */
-		rb_safe_insert(&dev->rbRX, (uint8)dev->regs->DR);
+		if (!rb_safe_insert(&dev->rbRX, (uint8)dev->regs->DR)) {
+			dev->rx_overflow++;
+		}
 #else
 		/* By default, push bytes around in the ring buffer. */
-		rb_push_insert(&dev->rbRX, (uint8)dev->regs->DR);
+		if (rb_push_insert(&dev->rbRX, (uint8)dev->regs->DR) != -1) {
+			dev->rx_overflow++;
+		}
 #endif
 
 #ifdef USART_TX_IRQ
@@ -234,6 +234,18 @@ typedef struct usart_reg_map {
  * Devices
  */
 
+/*
+ * Transmit is interrupt driven out of rbTX unless USART_TX_POLLED is
+ * defined, in which case bytes are written to DR while TXE is set.
+ */
+#ifndef USART_TX_POLLED
+#define USART_TX_IRQ
+#endif
+
+/*
+ * Ring sizes, USARTn_RX_BUF_SIZE / USARTn_TX_BUF_SIZE (UARTn_... for 4
+ * and 5) override the defaults for one port.
+ */
 #ifndef USART_RX_BUF_SIZE
 #define USART_RX_BUF_SIZE               256
 #endif
@@ -246,13 +258,14 @@ typedef struct usart_reg_map {
 typedef struct usart_dev {
     usart_reg_map *regs;             /**< Register map */
     ring_buffer rbRX;                 /**< RX ring buffer */
-    ring_buffer rbTX;                 /**< RX ring buffer */
+    ring_buffer rbTX;                 /**< TX ring buffer */
     uint32 max_baud;                 /**< Maximum baud */
-    uint8 rx_buf[USART_RX_BUF_SIZE]; /**< @brief Deprecated.
-                                      * Actual RX buffer used by rb.
-                                      * This field will be removed in
-                                      * a future release. */
-    uint8 tx_buf[USART_TX_BUF_SIZE];
+    uint8 *rx_buf;                   /**< Storage of rbRX */
+    uint8 *tx_buf;                   /**< Storage of rbTX */
+    uint16 rx_buf_size;              /**< Size of rx_buf */
+    uint16 tx_buf_size;              /**< Size of tx_buf */
+    volatile uint32 rx_overflow;     /**< Received bytes lost to a full rbRX */
+    uint32 tx_overflow;              /**< Writes that found rbTX full */
     rcc_clk_id clk_id;               /**< RCC clock information */
     nvic_irq_num irq_num;            /**< USART NVIC interrupt */
 } usart_dev;
@@ -272,6 +285,7 @@ void usart_disable(usart_dev *dev);
 void usart_foreach(void (*fn)(usart_dev *dev));
 uint32 usart_tx(usart_dev *dev, const uint8 *buf, uint32 len);
 void usart_putudec(usart_dev *dev, uint32 val);
+void usart_puts(usart_dev *dev, const uint8 *buf, uint32 len);
 
 /**
  * @brief Disable all serial ports.
@@ -290,6 +304,10 @@ static inline void usart_disable_all(void) {
  * @param byte Byte to transmit.
  */
 static inline void usart_putc(usart_dev* dev, uint8 byte) {
+    if (usart_tx(dev, &byte, 1)) {
+        return;
+    }
+    dev->tx_overflow++;
     while (!usart_tx(dev, &byte, 1))
         ;
 }
@@ -305,8 +323,9 @@ static inline void usart_putc(usart_dev* dev, uint8 byte) {
 static inline void usart_putstr(usart_dev *dev, const char* str) {
     uint32 i = 0;
     while (str[i] != '\0') {
-        usart_putc(dev, str[i++]);
+        i++;
     }
+    usart_puts(dev, (const uint8*)str, i);
 }
 
 /**
@@ -341,6 +360,18 @@ static inline uint32 usart_data_pending(usart_dev *dev) {
     return rb_full_count(&dev->rbTX);
 }
 
+/**
+ * @brief Return how many bytes usart_tx() can take without blocking.
+ * @param dev Serial port to check
+ */
+static inline uint32 usart_tx_space(usart_dev *dev) {
+#ifdef USART_TX_IRQ
+    return rb_space(&dev->rbTX);
+#else
+    return (dev->regs->SR & USART_SR_TXE) ? 1 : 0;
+#endif
+}
+
 /**
  * @brief Discard the contents of a serial port's RX buffer.
  * @param dev Serial port whose buffer to empty.
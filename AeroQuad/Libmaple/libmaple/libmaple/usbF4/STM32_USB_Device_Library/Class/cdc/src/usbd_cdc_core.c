@@ -178,6 +178,8 @@ volatile int APP_Rx_ptr_out = 0;
 uint32_t APP_Rx_length  = 0;
 
 uint8_t  USB_Tx_State = 0;
+volatile uint32_t USB_Tx_Stalls = 0;
+static uint32_t USB_Tx_StallFrames = 0;
 
 static uint32_t cdcCmd = 0xFF;
 static uint32_t cdcLen = 0;
@@ -666,6 +668,7 @@ static uint8_t  usbd_cdc_DataIn (void *pdev, uint8_t epnum)
   uint16_t USB_Tx_ptr;
   uint16_t USB_Tx_length;
 
+  USB_Tx_StallFrames = 0;
   if (USB_Tx_State == 1)
   {
     if (APP_Rx_length == 0)
@@ -751,6 +754,27 @@ static uint8_t  usbd_cdc_SOF (void *pdev)
 {      
   static uint32_t FrameCount = 0;
   
+  /* An IN transfer pending for CDC_IN_STALL_FRAMES means the host stopped
+     reading (port closed, configurator hung). What is buffered is stale by
+     then, drop it so the newest data goes out once the host reads again
+     and writers never find the buffer full for long. */
+  if (USB_Tx_State == 1)
+  {
+    if (++USB_Tx_StallFrames % CDC_IN_STALL_FRAMES == 0)
+    {
+      if (USB_Tx_StallFrames == CDC_IN_STALL_FRAMES)
+      {
+        USB_Tx_Stalls++;
+      }
+      APP_Rx_length = 0;
+      APP_Rx_ptr_out = APP_Rx_ptr_in;
+    }
+  }
+  else
+  {
+    USB_Tx_StallFrames = 0;
+  }
+
   if (FrameCount++ == CDC_IN_FRAME_INTERVAL)
   {
     /* Reset the frame counter */
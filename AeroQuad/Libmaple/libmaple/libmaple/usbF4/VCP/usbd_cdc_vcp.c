@@ -24,6 +24,7 @@
 #endif /* USB_OTG_HS_INTERNAL_DMA_ENABLED */
 
 /* Includes ------------------------------------------------------------------*/
+#include <string.h>
 #include "usbd_cdc_vcp.h"
 //#include  "stm32f4_discovery.h"
 
@@ -58,6 +59,7 @@ volatile int UsbRecRead = 0;
 volatile int UsbRecWrite = 0;
 volatile int VCP_DTRHIGH = 0;
 uint8_t UsbTXBlock = 0;
+volatile uint32_t VCPTxDropped = 0;
 
 uint32_t VCPBytesAvailable(void) {
 	return (UsbRecWrite - UsbRecRead + UsbRecBufferSize) % UsbRecBufferSize;
@@ -75,6 +77,15 @@ uint8_t VCPGetByte(void) {
 	}
 }
 
+/* Free bytes in APP_Rx_Buffer, the CDC core wraps its read pointer lazily */
+uint32_t VCPTxSpace(void) {
+	int out = APP_Rx_ptr_out;
+	if(out == APP_RX_DATA_SIZE) {
+		out = 0;
+	}
+	return (out - APP_Rx_ptr_in - 1 + APP_RX_DATA_SIZE) % APP_RX_DATA_SIZE;
+}
+
 /* Private function prototypes -----------------------------------------------*/
 static uint16_t VCP_Init     (void);
 static uint16_t VCP_DeInit   (void);
@@ -208,24 +219,35 @@ static uint16_t VCP_Ctrl (uint32_t Cmd, uint8_t* Buf, uint32_t Len)
   */
 uint16_t VCP_DataTx (uint8_t* Buf, uint32_t Len)
 {
-	while(Len-- > 0) {
-		if(UsbTXBlock) {
-			while ((APP_Rx_ptr_in - APP_Rx_ptr_out + APP_RX_DATA_SIZE) % APP_RX_DATA_SIZE + 1 >= APP_RX_DATA_SIZE)
-				;
-		} else {
-			if ((APP_Rx_ptr_in - APP_Rx_ptr_out + APP_RX_DATA_SIZE) % APP_RX_DATA_SIZE + 1 >= APP_RX_DATA_SIZE) {
-				return USBD_BUSY;
-			}
-		}
+	if(Len >= APP_RX_DATA_SIZE) {
+		VCPTxDropped += Len;
+		return USBD_BUSY;
+	}
 
+	if(UsbTXBlock) {
+		/* the SOF stall check frees the buffer if the host stops reading */
+		while (VCPTxSpace() < Len)
+			;
+	} else if (VCPTxSpace() < Len) {
+		/* all or nothing, a slow host loses whole writes rather than
+		   the middle of a message */
+		VCPTxDropped += Len;
+		return USBD_BUSY;
+	}
 
-		APP_Rx_Buffer[APP_Rx_ptr_in++] = *Buf++;
-		  /* To avoid buffer overflow */
-		  if(APP_Rx_ptr_in == APP_RX_DATA_SIZE)
-		  {
-		    APP_Rx_ptr_in = 0;
-		  }
+	/* the IN interrupt only sees the data once APP_Rx_ptr_in moves */
+	int in = APP_Rx_ptr_in;
+	uint32_t first = APP_RX_DATA_SIZE - in;
+	if(first > Len) {
+		first = Len;
+	}
+	memcpy(&APP_Rx_Buffer[in], Buf, first);
+	memcpy(APP_Rx_Buffer, Buf + first, Len - first);
+	in += Len;
+	if(in >= APP_RX_DATA_SIZE) {
+		in -= APP_RX_DATA_SIZE;
 	}
+	APP_Rx_ptr_in = in;
 	return USBD_OK;
 }
 
@@ -294,12 +316,15 @@ static uint16_t VCP_DataRx (uint8_t* Buf, uint32_t Len)
 	}
 	VCP_DTRHIGH = 0;
 	while(Len-- > 0) {
-		UsbRecBuffer[UsbRecWrite] = *Buf++;
-		if(UsbRecWrite == UsbRecBufferSize) {
-			UsbRecWrite = 0;
-		} else {
-			UsbRecWrite ++;
+		int next = UsbRecWrite + 1;
+		if(next == UsbRecBufferSize) {
+			next = 0;
+		}
+		if(next == UsbRecRead) {
+			break; /* receive buffer full, drop the rest of the packet */
 		}
+		UsbRecBuffer[UsbRecWrite] = *Buf++;
+		UsbRecWrite = next;
 	}
 
   return USBD_OK;
@@ -57,6 +57,9 @@
                                                 APP_RX_DATA_SIZE*8/MAX_BAUDARATE*1000 should be > CDC_IN_FRAME_INTERVAL */
 #endif /* USE_USB_OTG_HS */
 
+#define CDC_IN_STALL_FRAMES             100  /* Frames without IN progress before the host is taken as stalled
+                                                and the buffered IN data is dropped */
+
 #define APP_FOPS                        VCP_fops
 /**
   * @}
@@ -41,12 +41,30 @@ extern uint16_t VCP_DataTx (uint8_t* Buf, uint32_t Len);
 extern void     VCP_SetUSBTxBlocking(uint8_t mode);
 extern uint32_t VCPBytesAvailable(void);
 extern uint8_t  VCPGetByte(void);
+extern uint32_t VCPTxSpace(void);
+extern volatile uint32_t VCPTxDropped;
+extern volatile uint32_t USB_Tx_Stalls;
 
+/* Queues all of sendBuf for the IN endpoint interrupt or none of it */
 uint32_t usbSendBytes(const uint8_t* sendBuf, uint32_t len) {
-	VCP_DataTx((uint8_t*)sendBuf, len);
+	if (VCP_DataTx((uint8_t*)sendBuf, len) != USBD_OK) {
+		return 0;
+	}
 	return len;
 }
 
+uint32_t usbTxSpace(void) {
+	return VCPTxSpace();
+}
+
+uint32_t usbTxDropped(void) {
+	return VCPTxDropped;
+}
+
+uint32_t usbTxStalls(void) {
+	return USB_Tx_Stalls;
+}
+
 void usbEnableBlockingTx(void) {
 	VCP_SetUSBTxBlocking(1);
 }
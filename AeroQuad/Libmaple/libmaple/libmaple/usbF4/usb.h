@@ -30,6 +30,9 @@ void usbEnbISR(void);
 
 void   usbBlockingSendByte(char ch);
 uint32_t usbSendBytes(const uint8_t* sendBuf,uint32_t len);
+uint32_t usbTxSpace(void);
+uint32_t usbTxDropped(void);
+uint32_t usbTxStalls(void);
 uint32_t usbBytesAvailable(void);
 uint32_t usbReceiveBytes(uint8_t* recvBuf, uint32_t len);
 uint8_t usbGetDTR(void);
@@ -137,6 +137,10 @@ TwoWire::TwoWire() {
 	tx_addr = 0;
 	tx_buf_idx = 0;
 	tx_buf_overflow = false;
+	dev = NULL;
+	bus_time = 0;
+	transfers = 0;
+	errors = 0;
 }
 
 /*
@@ -154,6 +158,21 @@ void TwoWire::begin() {
 void TwoWire::begin(uint8 sda, uint8 scl) {
 	port.sda = sda;
 	port.scl = scl;
+
+	dev = hardwareFor(sda, scl);
+	if (dev) {
+		if (dev->state != I2C_STATE_DISABLED) {
+			i2c_disable(dev);
+		}
+#ifdef STM32F2
+		/* i2c_master_enable() only sets the pin mode, AF4 routes them to I2C1..3 */
+		gpio_set_af_mode(dev->gpio_port, dev->sda_pin, 4);
+		gpio_set_af_mode(dev->gpio_port, dev->scl_pin, 4);
+#endif
+		i2c_master_enable(dev, I2C_FAST_MODE | I2C_BUS_RESET);
+		return;
+	}
+
 	pinMode(scl, OUTPUT_OPEN_DRAIN);
 	pinMode(sda, OUTPUT_OPEN_DRAIN);
 	digitalWrite(scl, HIGH);
@@ -183,6 +202,26 @@ void TwoWire::beginTransmission(int slave_address) {
 uint8 TwoWire::endTransmission(void) {
 	if (tx_buf_overflow) return EDATA;
 
+	uint32 start = micros();
+	uint8 ret;
+	if (dev) {
+		if (tx_buf_idx == 0) {
+			/* the interrupt handler cannot send an address only message */
+			ret = EOTHER;
+		} else {
+			ret = hardwareXfer(tx_addr, 0, tx_buf, tx_buf_idx) ? ENACKADDR : SUCCESS;
+		}
+		tx_buf_idx = 0;
+	} else {
+		ret = softEndTransmission();
+	}
+	bus_time += micros() - start;
+	transfers++;
+	if (ret != SUCCESS) errors++;
+	return ret;
+}
+
+uint8 TwoWire::softEndTransmission(void) {
 	i2c_start(port);
 
 	i2c_shift_out(port, (tx_addr << 1) | I2C_WRITE);
@@ -229,7 +268,23 @@ uint8 TwoWire::requestFrom(uint8 address, int num_bytes) {
 
 	rx_buf_idx = 0;
 	rx_buf_len = 0;
+	if (num_bytes <= 0) return 0;
+
+	uint32 start = micros();
+	if (dev) {
+		if (hardwareXfer(address, I2C_MSG_READ, rx_buf, num_bytes) == 0) {
+			rx_buf_len = num_bytes;
+		}
+	} else {
+		softRequestFrom(address, num_bytes);
+	}
+	bus_time += micros() - start;
+	transfers++;
+	if (rx_buf_len == 0) errors++;
+	return rx_buf_len;
+}
 
+uint8 TwoWire::softRequestFrom(uint8 address, int num_bytes) {
 	i2c_start(port);
 
 	i2c_shift_out(port, (address << 1) | I2C_READ);
@@ -318,6 +373,59 @@ uint8 TwoWire::readOneByte(uint8 address, uint8 *byte) {
 	return SUCCESS;      // no real way of knowing, but be optimistic!
 }
 
+/*
+* Returns the I2C peripheral wired to these pins, NULL to bit-bang them.
+*/
+i2c_dev *TwoWire::hardwareFor(uint8 sda, uint8 scl) {
+#ifdef WIRE_BIT_BANG
+	return NULL;
+#else
+	if (PIN_MAP[sda].gpio_device != GPIOB || PIN_MAP[scl].gpio_device != GPIOB) {
+		return NULL;
+	}
+	uint8 sda_bit = PIN_MAP[sda].gpio_bit;
+	uint8 scl_bit = PIN_MAP[scl].gpio_bit;
+
+	i2c_dev *hw;
+#ifdef STM32F2
+	if ((sda_bit == 7 || sda_bit == 9) && (scl_bit == 6 || scl_bit == 8)) {
+#else
+	/* the PB8/PB9 remap moves both pins together, leave it to i2c_master_enable() */
+	if (sda_bit == 7 && scl_bit == 6) {
+#endif
+		hw = I2C1;
+	} else if (sda_bit == 11 && scl_bit == 10) {
+		hw = I2C2;
+	} else {
+		return NULL;
+	}
+	hw->sda_pin = sda_bit;
+	hw->scl_pin = scl_bit;
+	return hw;
+#endif
+}
+
+/*
+* One message through the interrupt driven master, 0 on success.
+* An error or timeout leaves the peripheral mid transfer with its
+* interrupts off, so it is reset and any hung slave clocked out.
+*/
+int32 TwoWire::hardwareXfer(uint8 address, uint8 flags, uint8 *data, uint16 length) {
+	i2c_msg msg;
+	msg.addr = address;
+	msg.flags = flags;
+	msg.length = length;
+	msg.xferred = 0;
+	msg.data = data;
+
+	int32 rc = i2c_master_xfer(dev, &msg, 1, WIRE_TIMEOUT);
+	if (rc != 0) {
+		i2c_disable(dev);
+		i2c_master_enable(dev, I2C_FAST_MODE | I2C_BUS_RESET);
+	}
+	return rc;
+}
+
 // Declare the instance that the users of the library can use
 TwoWire Wire;
 
@@ -28,6 +28,7 @@
  */
 
 #include "wirish.h"
+#include "i2c.h"
 
 #ifndef _WIRE_H_
 #define _WIRE_H_
@@ -53,6 +54,14 @@ typedef struct {
 #define I2C_WRITE 0
 #define I2C_READ  1
 
+/*
+ * begin(sda, scl) on the pins of an I2C peripheral (I2C1 on PB6/PB8 and
+ * PB7/PB9, I2C2 on PB10 and PB11) runs the interrupt driven hardware
+ * master of libmaple at 400kHz, any other pins use the bit-banged
+ * master. Define WIRE_BIT_BANG to always bit-bang.
+ */
+#define WIRE_TIMEOUT 5          /* ms without bus progress before a transfer is aborted */
+
 #if (F_CPU == 168000000)
 	#define I2C_DELAY_SCL delay_ns100(6) 
 	#define I2C_DELAY_SDA delay_ns100(2)
@@ -72,8 +81,16 @@ class TwoWire {
     uint8 tx_buf_idx;               /* next idx available in tx_buf, -1 overflow */
     boolean tx_buf_overflow;
     Port port;
+    i2c_dev *dev;                   /* hardware master, NULL when bit-banging */
+    uint32 bus_time;                /* us spent in transfers */
+    uint32 transfers;
+    uint32 errors;
     uint8 writeOneByte(uint8);
     uint8 readOneByte(uint8, uint8*);
+    uint8 softEndTransmission(void);
+    uint8 softRequestFrom(uint8, int);
+    i2c_dev *hardwareFor(uint8, uint8);
+    int32 hardwareXfer(uint8, uint8, uint8*, uint16);
  public:
     TwoWire();
     void begin();
@@ -97,6 +114,13 @@ class TwoWire {
     void write(int data) { send(data); };
     void write(int* buf, int len) { send(buf, len); };
     void write(char* buf) { send(buf); };
+
+    /* bus time statistics, to compare the hardware and bit-banged masters */
+    boolean isHardware() { return dev != NULL; };
+    uint32 getBusTime() { return bus_time; };
+    uint32 getTransfers() { return transfers; };
+    uint32 getErrors() { return errors; };
+    void resetBusTime() { bus_time = 0; transfers = 0; errors = 0; };
 };
 
 void    i2c_start(Port port);
@@ -144,6 +144,19 @@ void HardwareSerial::write(unsigned char ch) {
     usart_putc(usart_device, ch);
 }
 
+void HardwareSerial::write(const char *str) {
+    usart_putstr(usart_device, str);
+}
+
+/* One copy into the TX ring instead of a usart_putc() per byte */
+void HardwareSerial::write(const void *buf, uint32 len) {
+    usart_puts(usart_device, (const uint8*)buf, len);
+}
+
+uint32 HardwareSerial::txSpace(void) {
+    return usart_tx_space(usart_device);
+}
+
 void HardwareSerial::flush(void) {
     usart_reset_rx(usart_device);
 }
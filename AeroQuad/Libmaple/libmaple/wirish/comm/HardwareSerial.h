@@ -63,8 +63,17 @@ public:
     int read(void);
     void flush(void);
     virtual void write(unsigned char);
+    virtual void write(const char *str);
+    virtual void write(const void *buf, uint32 len);
     using Print::write;
 
+    /* Transmit room, so producers can skip output instead of blocking */
+    uint32 txSpace(void);
+
+    /* Received bytes lost to a full RX ring, writes that had to wait */
+    uint32 getRxOverflow(void) { return usart_device->rx_overflow; }
+    uint32 getTxOverflow(void) { return usart_device->tx_overflow; }
+
     /* Pin accessors */
     int txPin(void) { return this->tx_pin; }
     int rxPin(void) { return this->rx_pin; }
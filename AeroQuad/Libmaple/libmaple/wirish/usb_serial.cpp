@@ -64,6 +64,12 @@ void USBSerial::write(const void *buf, uint32 len) {
         return;
     }
 
+#ifdef STM32F2
+    /* Copied into the CDC transmit buffer and sent from the USB interrupt.
+     * A write that does not fit is dropped and counted, never waited on,
+     * so a slow or stalled host cannot hold up the caller. */
+    usbSendBytes((const uint8*)buf, len);
+#else
     uint32 txed = 0;
     uint32 old_txed = 0;
     uint32 start = millis();
@@ -75,28 +81,52 @@ void USBSerial::write(const void *buf, uint32 len) {
         }
         old_txed = txed;
     }
+#endif
+}
+
+/* Bytes a write() can queue right now without being dropped */
+uint32 USBSerial::txSpace(void) {
+#ifdef STM32F2
+    return usbTxSpace();
+#else
+    return 0xFFFFFFFF; /* blocking transmit, takes everything */
+#endif
+}
+
+/* Bytes dropped because the transmit buffer was full */
+uint32 USBSerial::getTxDropped(void) {
+#ifdef STM32F2
+    return usbTxDropped();
+#else
+    return 0;
+#endif
+}
+
+/* Times the host stopped reading and the transmit buffer was flushed */
+uint32 USBSerial::getTxStalls(void) {
+#ifdef STM32F2
+    return usbTxStalls();
+#else
+    return 0;
+#endif
 }
 
 uint32 USBSerial::available(void) {
     return usbBytesAvailable();
 }
 
+/* Returns at once with at most len of the bytes already received */
 uint32 USBSerial::read(void *buf, uint32 len) {
     if (!buf) {
         return 0;
     }
 
-    uint32 rxed = 0;
-    while (rxed < len) {
-        rxed += usbReceiveBytes((uint8*)buf + rxed, len - rxed);
-    }
-
-    return rxed;
+    return usbReceiveBytes((uint8*)buf, len);
 }
 
-/* Blocks forever until 1 byte is received */
+/* Returns 0 if nothing has been received, check available() first */
 uint8 USBSerial::read(void) {
-    uint8 buf[1];
+    uint8 buf[1] = {0};
     this->read(buf, 1);
     return buf[0];
 }
@@ -122,7 +152,7 @@ void USBSerial::enableBlockingTx(void) {
 }
 
 void USBSerial::disableBlockingTx(void) {
-	usbEnableBlockingTx();
+	usbDisableBlockingTx();
 }
 
 USBSerial SerialUSB;
@@ -53,6 +53,10 @@ public:
     void write(const char *str);
     void write(const void*, uint32);
 
+    uint32 txSpace(void);
+    uint32 getTxDropped(void);
+    uint32 getTxStalls(void);
+
     uint8 getRTS();
     uint8 getDTR();
     uint8 isConnected();
@@ -0,0 +1,249 @@
+/*
+  AeroQuad v3.2 - Background ADC sampling
+  www.AeroQuad.com
+  Copyright (c) 2012 Ted Carancho.  All rights reserved.
+  An Open Source Arduino based multicopter.
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Analog inputs sampled without the CPU waiting for conversions
+//
+// Channels are attached once at startup, startBackgroundADC() then keeps
+// converting them in the background and getBackgroundADC() returns the
+// average of the latest samples, in the same units as analogRead().
+//
+// On AQ32 (F4), ADC2 scans the channels continuously and DMA2 stream 2
+// writes them into a circular buffer, analogRead() keeps ADC1 for itself.
+// The F1 boards have no DMA streams, there getBackgroundADC() falls back
+// to analogRead().
+// On AVR, the single ADC is auto triggered by the Timer0 overflow (about
+// 1kHz, shared by the channels) and the conversion complete interrupt sums
+// the result. Other analogRead() users must go through analogReadShared()
+// so their conversion does not mix with the background one.
+
+#ifndef _AEROQUAD_BACKGROUND_ADC_H_
+#define _AEROQUAD_BACKGROUND_ADC_H_
+
+#include "Arduino.h"
+
+#define BACKGROUND_ADC_MAX_CHANNELS 4
+
+byte backgroundADCPin[BACKGROUND_ADC_MAX_CHANNELS];
+byte backgroundADCChannels = 0;
+boolean backgroundADCRunning = false;
+
+/**
+ * Adds a pin to the scan, before startBackgroundADC()
+ * Returns the channel to pass to getBackgroundADC(), an already attached
+ * pin gets its existing channel
+ */
+byte attachBackgroundADC(byte pin) {
+  for (byte channel = 0; channel < backgroundADCChannels; channel++) {
+    if (backgroundADCPin[channel] == pin) {
+      return channel;
+    }
+  }
+  if (backgroundADCRunning || backgroundADCChannels >= BACKGROUND_ADC_MAX_CHANNELS) {
+    return 0;
+  }
+  backgroundADCPin[backgroundADCChannels] = pin;
+  return backgroundADCChannels++;
+}
+
+#if defined(AeroQuadSTM32) && defined(STM32F2)
+
+  #include <adc.h>
+  #include <dma.h>
+
+  #define BACKGROUND_ADC_SAMPLES 16    // per channel in the circular buffer
+  #define BACKGROUND_ADC_CR2_DDS BIT(9)  // keep issuing DMA requests after the last transfer
+  #define BACKGROUND_ADC_SMPR_480 7      // longest sample time, about 12us per conversion
+
+  volatile uint16 backgroundADCBuffer[BACKGROUND_ADC_SAMPLES * BACKGROUND_ADC_MAX_CHANNELS];
+
+  void startBackgroundADC() {
+    if (backgroundADCChannels == 0 || backgroundADCRunning) {
+      return;
+    }
+    // seed the buffer so averages are right before the first scan is written
+    for (byte channel = 0; channel < backgroundADCChannels; channel++) {
+      const uint16 value = analogRead(backgroundADCPin[channel]);
+      for (byte sample = 0; sample < BACKGROUND_ADC_SAMPLES; sample++) {
+        backgroundADCBuffer[sample * backgroundADCChannels + channel] = value;
+      }
+    }
+
+    adc_reg_map *regs = ADC2->regs;
+    // left powered on by the board setup, only the conversion mode changes
+    regs->CR2 &= ~(ADC_CR2_CONT | ADC_CR2_DMA | BACKGROUND_ADC_CR2_DDS);
+    regs->CR1 |= ADC_CR1_SCAN;
+    uint32 sqr3 = 0;
+    uint32 smpr1 = regs->SMPR1;
+    uint32 smpr2 = regs->SMPR2;
+    for (byte channel = 0; channel < backgroundADCChannels; channel++) {
+      const uint8 adcChannel = PIN_MAP[backgroundADCPin[channel]].adc_channel;
+      sqr3 |= (uint32)adcChannel << (5 * channel);
+      if (adcChannel < 10) {
+        smpr2 = (smpr2 & ~(7UL << (3 * adcChannel))) | ((uint32)BACKGROUND_ADC_SMPR_480 << (3 * adcChannel));
+      }
+      else {
+        smpr1 = (smpr1 & ~(7UL << (3 * (adcChannel - 10)))) | ((uint32)BACKGROUND_ADC_SMPR_480 << (3 * (adcChannel - 10)));
+      }
+    }
+    regs->SMPR1 = smpr1;
+    regs->SMPR2 = smpr2;
+    regs->SQR3 = sqr3;
+    adc_set_reg_seqlen(ADC2, backgroundADCChannels);
+
+    // ADC2 is on DMA2 stream 2 channel 1
+    dma_init(DMA2);
+    dma_disable(DMA2, DMA_STREAM2);
+    dma_setup_transfer(DMA2, DMA_STREAM2, &regs->DR, (void *)backgroundADCBuffer, NULL,
+                       DMA_CR_CH1 | DMA_CR_PL_LOW | DMA_CR_MSIZE_16BITS | DMA_CR_PSIZE_16BITS |
+                       DMA_CR_MINC | DMA_CR_CIRC | DMA_CR_DIR_P2M, 0);
+    dma_set_num_transfers(DMA2, DMA_STREAM2, BACKGROUND_ADC_SAMPLES * backgroundADCChannels);
+    dma_clear_isr_bits(DMA2, DMA_STREAM2);
+    dma_enable(DMA2, DMA_STREAM2);
+
+    regs->CR2 |= ADC_CR2_CONT | ADC_CR2_DMA | BACKGROUND_ADC_CR2_DDS;
+    regs->CR2 |= ADC_CR2_SWSTART;
+    backgroundADCRunning = true;
+  }
+
+  /**
+   * Average of the last BACKGROUND_ADC_SAMPLES conversions of the channel
+   */
+  unsigned int getBackgroundADC(byte channel) {
+    unsigned long sum = 0;
+    for (byte sample = 0; sample < BACKGROUND_ADC_SAMPLES; sample++) {
+      sum += backgroundADCBuffer[sample * backgroundADCChannels + channel];
+    }
+    return (sum + BACKGROUND_ADC_SAMPLES / 2) / BACKGROUND_ADC_SAMPLES;
+  }
+
+  unsigned int analogReadShared(byte pin) {
+    return analogRead(pin);
+  }
+
+#elif defined(AeroQuadSTM32)
+
+  void startBackgroundADC() {
+    backgroundADCRunning = backgroundADCChannels > 0;
+  }
+
+  unsigned int getBackgroundADC(byte channel) {
+    return analogRead(backgroundADCPin[channel]);
+  }
+
+  unsigned int analogReadShared(byte pin) {
+    return analogRead(pin);
+  }
+
+#else
+
+  #include <avr/interrupt.h>
+
+  #define BACKGROUND_ADC_TRIGGER_TIMER0 (_BV(ADTS2))
+
+  volatile unsigned long backgroundADCSum[BACKGROUND_ADC_MAX_CHANNELS];
+  volatile unsigned int backgroundADCCount[BACKGROUND_ADC_MAX_CHANNELS];
+  unsigned int backgroundADCValue[BACKGROUND_ADC_MAX_CHANNELS];
+  volatile byte backgroundADCCurrent = 0;
+
+  byte backgroundADCChannelNumber(byte pin) {
+    #if defined(__AVR_ATmega1280__) || defined(__AVR_ATmega2560__)
+      return (pin >= A0) ? pin - A0 : pin;
+    #else
+      return (pin >= A0) ? pin - A0 : pin & 0x07;
+    #endif
+  }
+
+  // same reference as analogRead(), which uses DEFAULT unless told otherwise
+  void selectBackgroundADCChannel(byte channel) {
+    const byte adcChannel = backgroundADCChannelNumber(backgroundADCPin[channel]);
+    #if defined(MUX5)
+      ADCSRB = (ADCSRB & ~_BV(MUX5)) | ((adcChannel >> 3) ? _BV(MUX5) : 0);
+    #endif
+    ADMUX = (DEFAULT << 6) | (adcChannel & 0x07);
+  }
+
+  ISR(ADC_vect) {
+    const byte channel = backgroundADCCurrent;
+    backgroundADCSum[channel] += ADC;
+    backgroundADCCount[channel]++;
+    // the next trigger is about 1ms away, plenty of time to switch
+    const byte next = (channel + 1 < backgroundADCChannels) ? channel + 1 : 0;
+    backgroundADCCurrent = next;
+    selectBackgroundADCChannel(next);
+  }
+
+  void startBackgroundADC() {
+    if (backgroundADCChannels == 0 || backgroundADCRunning) {
+      return;
+    }
+    for (byte channel = 0; channel < backgroundADCChannels; channel++) {
+      backgroundADCValue[channel] = analogRead(backgroundADCPin[channel]);
+      backgroundADCSum[channel] = 0;
+      backgroundADCCount[channel] = 0;
+    }
+    noInterrupts();
+    backgroundADCCurrent = 0;
+    selectBackgroundADCChannel(0);
+    ADCSRB = (ADCSRB & ~(_BV(ADTS2) | _BV(ADTS1) | _BV(ADTS0))) | BACKGROUND_ADC_TRIGGER_TIMER0;
+    ADCSRA |= _BV(ADIF) | _BV(ADIE) | _BV(ADATE);
+    backgroundADCRunning = true;
+    interrupts();
+  }
+
+  /**
+   * Average of the samples converted since the last call, or the
+   * previous average if there are none yet
+   */
+  unsigned int getBackgroundADC(byte channel) {
+    noInterrupts();
+    const unsigned long sum = backgroundADCSum[channel];
+    const unsigned int count = backgroundADCCount[channel];
+    backgroundADCSum[channel] = 0;
+    backgroundADCCount[channel] = 0;
+    interrupts();
+    if (count > 0) {
+      backgroundADCValue[channel] = (sum + count / 2) / count;
+    }
+    return backgroundADCValue[channel];
+  }
+
+  /**
+   * analogRead() for everything outside the scan, the background
+   * conversion in flight, if any, is dropped
+   */
+  unsigned int analogReadShared(byte pin) {
+    if (!backgroundADCRunning) {
+      return analogRead(pin);
+    }
+    noInterrupts();
+    ADCSRA = (ADCSRA & ~(_BV(ADIE) | _BV(ADATE))) | _BV(ADIF);
+    interrupts();
+    while (ADCSRA & _BV(ADSC));
+    const unsigned int value = analogRead(pin);
+    noInterrupts();
+    selectBackgroundADCChannel(backgroundADCCurrent);
+    ADCSRA |= _BV(ADIF) | _BV(ADIE) | _BV(ADATE);
+    interrupts();
+    return value;
+  }
+
+#endif
+
+#endif
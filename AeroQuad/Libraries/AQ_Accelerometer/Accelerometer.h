@@ -23,20 +23,66 @@
 
 #include "Arduino.h"
 #include "GlobalDefined.h"
+#include <StreamingCalibration.h>
 
 #define SAMPLECOUNT 400.0
 
+#define ACCEL_CALIBRATION_MIN_SAMPLES 50
+#define ACCEL_CALIBRATION_STD_ERROR 0.005  // m/s2, standard error of the bias
+#define ACCEL_CALIBRATION_MOTION 0.5       // m/s2 from the mean taken as motion
+
 float accelScaleFactor[3] = {0.0,0.0,0.0};
 float runTimeAccelBias[3] = {0, 0, 0};
 float accelOneG = 0.0;
 float meterPerSecSec[3] = {0.0,0.0,0.0};
 long accelSample[3] = {0,0,0};
 byte accelSampleCount = 0;
+struct StreamingCalibration accelCalibration;
+byte accelCalibrationQuality = 0;
   
 void initializeAccel();
 void measureAccel();
 void measureAccelSum();
 void evaluateMetersPerSec();
 void computeAccelBias();
+
+void startAccelCalibration() {
+  initStreamingCalibration(&accelCalibration);
+  for (byte axis = XAXIS; axis <= ZAXIS; axis++) {
+    accelSample[axis] = 0;
+  }
+  accelSampleCount = 0;
+}
+
+/**
+ * Feeds the average of what measureAccelSum() just accumulated, a single
+ * sample or a FIFO batch, returns true once the bias is known well enough
+ */
+boolean updateAccelCalibration() {
+  if (accelSampleCount == 0) {
+    return false;
+  }
+  float sample[3];
+  for (byte axis = XAXIS; axis <= ZAXIS; axis++) {
+    sample[axis] = (float)accelSample[axis] / accelSampleCount * accelScaleFactor[axis];
+    accelSample[axis] = 0;
+  }
+  accelSampleCount = 0;
+  addStreamingCalibrationSample(&accelCalibration, sample, ACCEL_CALIBRATION_MOTION);
+  return isStreamingCalibrationDone(&accelCalibration, ACCEL_CALIBRATION_MIN_SAMPLES, ACCEL_CALIBRATION_STD_ERROR);
+}
+
+void finishAccelCalibration() {
+  for (byte axis = XAXIS; axis <= ZAXIS; axis++) {
+    meterPerSecSec[axis] = accelCalibration.mean[axis];
+  }
+
+  runTimeAccelBias[XAXIS] = -meterPerSecSec[XAXIS];
+  runTimeAccelBias[YAXIS] = -meterPerSecSec[YAXIS];
+  runTimeAccelBias[ZAXIS] = -9.8065 - meterPerSecSec[ZAXIS];
+
+  accelOneG = fabs(meterPerSecSec[ZAXIS] + runTimeAccelBias[ZAXIS]);
+  accelCalibrationQuality = getStreamingCalibrationQuality(&accelCalibration, ACCEL_CALIBRATION_MOTION);
+}
   
 #endif
\ No newline at end of file
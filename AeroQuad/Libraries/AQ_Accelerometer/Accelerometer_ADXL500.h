@@ -23,6 +23,7 @@
 
 #include <Accelerometer.h>
 #include <SensorsStatus.h>
+#include <BackgroundADC.h>
 
 void initializeAccel() {
   vehicleState |= ACCEL_DETECTED;
@@ -30,16 +31,16 @@ void initializeAccel() {
 
 void measureAccel() {
 
-  meterPerSecSec[XAXIS] = analogRead(0) * accelScaleFactor[XAXIS] + runTimeAccelBias[XAXIS];
-  meterPerSecSec[YAXIS] = analogRead(1) * accelScaleFactor[YAXIS] + runTimeAccelBias[YAXIS];
-  meterPerSecSec[ZAXIS] = analogRead(2) * accelScaleFactor[ZAXIS] + runTimeAccelBias[ZAXIS];
+  meterPerSecSec[XAXIS] = analogReadShared(0) * accelScaleFactor[XAXIS] + runTimeAccelBias[XAXIS];
+  meterPerSecSec[YAXIS] = analogReadShared(1) * accelScaleFactor[YAXIS] + runTimeAccelBias[YAXIS];
+  meterPerSecSec[ZAXIS] = analogReadShared(2) * accelScaleFactor[ZAXIS] + runTimeAccelBias[ZAXIS];
 }
 
 void measureAccelSum() {
   
-  accelSample[XAXIS] += analogRead(0);
-  accelSample[YAXIS] += analogRead(1);
-  accelSample[ZAXIS] += analogRead(2);
+  accelSample[XAXIS] += analogReadShared(0);
+  accelSample[YAXIS] += analogReadShared(1);
+  accelSample[ZAXIS] += analogReadShared(2);
   accelSampleCount++;
 }
 
@@ -48,23 +49,15 @@ void evaluateMetersPerSec() {
 }
 
 void computeAccelBias() {
-  
+  startAccelCalibration();
   for (int samples = 0; samples < SAMPLECOUNT; samples++) {
     measureAccelSum();
+    if (updateAccelCalibration()) {
+      break;
+    }
     delayMicroseconds(2500);
   }
-
-  for (byte axis = 0; axis < 3; axis++) {
-    meterPerSecSec[axis] = (float(accelSample[axis])/SAMPLECOUNT) * accelScaleFactor[axis];
-    accelSample[axis] = 0;
-  }
-  accelSampleCount = 0;
-
-  runTimeAccelBias[XAXIS] = -meterPerSecSec[XAXIS];
-  runTimeAccelBias[YAXIS] = -meterPerSecSec[YAXIS];
-  runTimeAccelBias[ZAXIS] = -9.8065 - meterPerSecSec[ZAXIS];
-
-  accelOneG = fabs(meterPerSecSec[ZAXIS] + runTimeAccelBias[ZAXIS]);
+  finishAccelCalibration();
 }
 
 #endif
@@ -109,23 +109,15 @@ void evaluateMetersPerSec() {
 }
 
 void computeAccelBias() {
-  
+  startAccelCalibration();
   for (int samples = 0; samples < SAMPLECOUNT; samples++) {
     measureAccelSum();
+    if (updateAccelCalibration()) {
+      break;
+    }
     delayMicroseconds(2500);
   }
-
-  for (byte axis = 0; axis < 3; axis++) {
-    meterPerSecSec[axis] = (float(accelSample[axis])/SAMPLECOUNT) * accelScaleFactor[axis];
-    accelSample[axis] = 0;
-  }
-  accelSampleCount = 0;
-
-  runTimeAccelBias[XAXIS] = -meterPerSecSec[XAXIS];
-  runTimeAccelBias[YAXIS] = -meterPerSecSec[YAXIS];
-  runTimeAccelBias[ZAXIS] = -9.8065 - meterPerSecSec[ZAXIS];
-
-  accelOneG = fabs(meterPerSecSec[ZAXIS] + runTimeAccelBias[ZAXIS]);
+  finishAccelCalibration();
 }
 
 #endif
@@ -39,14 +39,26 @@ void measureAccel() {
 
 void measureAccelSum() {
   readMPU6000Accel();
-  accelSample[XAXIS] += MPU6000.data.accel.x;
-  accelSample[YAXIS] += MPU6000.data.accel.y;
-  accelSample[ZAXIS] += MPU6000.data.accel.z;
-
-  accelSampleCount++;
+  #if defined(MPU6000_FIFO)
+    for (byte axis = XAXIS; axis <= ZAXIS; axis++) {
+      accelSample[axis] += mpu6000BatchAccel[axis];
+      mpu6000BatchAccel[axis] = 0;
+    }
+    accelSampleCount += mpu6000BatchAccelSamples;
+    mpu6000BatchAccelSamples = 0;
+  #else
+    accelSample[XAXIS] += MPU6000.data.accel.x;
+    accelSample[YAXIS] += MPU6000.data.accel.y;
+    accelSample[ZAXIS] += MPU6000.data.accel.z;
+
+    accelSampleCount++;
+  #endif
 }
 
 void evaluateMetersPerSec() {
+  if (accelSampleCount == 0) {
+    return;
+  }
   for (byte axis = XAXIS; axis <= ZAXIS; axis++) {
     meterPerSecSec[axis] = (accelSample[axis] / accelSampleCount) * accelScaleFactor[axis] + runTimeAccelBias[axis];
   	accelSample[axis] = 0;
@@ -55,23 +67,16 @@ void evaluateMetersPerSec() {
 }
 
 void computeAccelBias() {
+  startAccelCalibration();
   for (int samples = 0; samples < SAMPLECOUNT; samples++) {
-	readMPU6000Sensors();
+    readMPU6000Sensors();
     measureAccelSum();
+    if (updateAccelCalibration()) {
+      break;
+    }
     delayMicroseconds(2500);
   }
-
-  for (byte axis = 0; axis < 3; axis++) {
-    meterPerSecSec[axis] = (float(accelSample[axis])/SAMPLECOUNT) * accelScaleFactor[axis];
-    accelSample[axis] = 0;
-  }
-  accelSampleCount = 0;
-
-  runTimeAccelBias[XAXIS] = -meterPerSecSec[XAXIS];
-  runTimeAccelBias[YAXIS] = -meterPerSecSec[YAXIS];
-  runTimeAccelBias[ZAXIS] = -9.8065 - meterPerSecSec[ZAXIS];
-
-  accelOneG = abs(meterPerSecSec[ZAXIS] + runTimeAccelBias[ZAXIS]);
+  finishAccelCalibration();
 }
 
 #endif
@@ -25,6 +25,7 @@
 #include <GlobalDefined.h>
 #include <APM_ADC.h>
 #include <AQMath.h>
+#include <BackgroundADC.h>     // Arduino IDE bug, needed because the analog sensors share the ADC through it
 #include <Accelerometer_ADXL500.h>
 
 
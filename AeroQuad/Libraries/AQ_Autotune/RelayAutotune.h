@@ -0,0 +1,194 @@
+/*
+  AeroQuad v3.2 - Relay feedback identification and PID tuning rules
+  www.AeroQuad.com
+  Copyright (c) 2012 Ted Carancho.  All rights reserved.
+  An Open Source Arduino based multicopter.
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Relay feedback experiment (Astrom and Hagglund)
+//
+// In place of a controller, a relay drives the plant with +-amplitude
+// depending on the sign of the error, with some hysteresis against noise.
+// Any plant with enough lag settles into a limit cycle close to the
+// frequency where it turns the phase by 180 degrees, the oscillation gives
+// the ultimate period Tu. The relay output is a square wave whose
+// fundamental is 4 / PI * amplitude, so the error averaged against the
+// sign of the output gives the real part of the plant response there and
+// the gain a proportional controller would need to sustain the
+// oscillation, the ultimate gain Ku:
+//
+//   Ku = 8 * amplitude / (PI^2 * mean(error * sign(output)))
+//
+// Gyro noise does not correlate with the output, so unlike the error
+// peaks it does not bias the result, and the hysteresis is accounted for.
+// The first cycles scale the relay amplitude towards the error swing asked
+// for, the following ones are left to settle, then measured with it fixed
+// and averaged.
+
+#ifndef _AQ_RELAY_AUTOTUNE_H_
+#define _AQ_RELAY_AUTOTUNE_H_
+
+#include "Arduino.h"
+
+#define RELAY_ADAPTING_CYCLES 3           // cycles the amplitude is scaled on
+#define RELAY_SETTLING_CYCLES 2           // cycles left for the last amplitude to settle
+#define RELAY_MEASURED_CYCLES 8           // cycles averaged afterwards
+#define RELAY_TIMEOUT 2000000UL           // us without a full cycle before giving up
+
+// Rules from Ku and Tu, as fractions of them
+#define RELAY_RATE_P 0.35                 // P of the rate loop, of Ku
+#define RELAY_RATE_I_TIME 2.0             // integral time of the rate loop, of Tu
+#define RELAY_RATE_D_TIME 0.12            // derivative time of the rate loop, of Tu
+#define RELAY_ATTITUDE_P 0.3              // P of the attitude loop, of Ku
+
+enum {
+  RELAY_RUNNING = 0,
+  RELAY_DONE,
+  RELAY_FAILED
+};
+
+struct RelayExperiment {
+  float amplitude;                        // relay output, adapted in the first cycles
+  float minAmplitude, maxAmplitude;
+  float hysteresis;                       // error band the relay does not switch in
+  float targetSwing;                      // half peak to peak error wanted
+  float output;
+  float errorMax, errorMin;               // of the cycle under way
+  float correlation;                      // sum of error * sign(output), cycle under way
+  int samples;                            // of the cycle under way
+  unsigned long cycleStart;               // us, last switch to +amplitude
+  byte risingSwitches;                    // switches to +amplitude so far
+  byte cycles;                            // complete cycles so far
+  byte state;
+  float correlationSum, periodSum;        // of the measured cycles
+  long samplesSum;
+  float ultimateGain, ultimatePeriod;     // once RELAY_DONE, period in s
+};
+
+void startRelayExperiment(struct RelayExperiment *relay, float amplitude, float minAmplitude, float maxAmplitude,
+                          float hysteresis, float targetSwing, unsigned long now) {
+  relay->amplitude = amplitude;
+  relay->minAmplitude = minAmplitude;
+  relay->maxAmplitude = maxAmplitude;
+  relay->hysteresis = hysteresis;
+  relay->targetSwing = targetSwing;
+  relay->output = amplitude;
+  relay->errorMax = -1.0e30;
+  relay->errorMin = 1.0e30;
+  relay->correlation = 0.0;
+  relay->samples = 0;
+  relay->cycleStart = now;
+  relay->risingSwitches = 0;
+  relay->cycles = 0;
+  relay->state = RELAY_RUNNING;
+  relay->correlationSum = 0.0;
+  relay->periodSum = 0.0;
+  relay->samplesSum = 0;
+  relay->ultimateGain = 0.0;
+  relay->ultimatePeriod = 0.0;
+}
+
+// The cycle from cycleStart to now is over, the one up to the first
+// switch to +amplitude is the start transient and is not counted
+void closeRelayCycle(struct RelayExperiment *relay, unsigned long now) {
+  const float swing = (relay->errorMax - relay->errorMin) * 0.5;
+  const float period = (now - relay->cycleStart) * 1.0e-6;
+  const float correlation = relay->correlation;
+  const int samples = relay->samples;
+  relay->errorMax = -1.0e30;
+  relay->errorMin = 1.0e30;
+  relay->correlation = 0.0;
+  relay->samples = 0;
+  relay->cycleStart = now;
+  if (relay->risingSwitches++ == 0) {
+    return;
+  }
+
+  relay->cycles++;
+  if (relay->cycles <= RELAY_ADAPTING_CYCLES) {
+    if (swing > 0.0) {
+      const float scaled = relay->amplitude * constrain(relay->targetSwing / swing, 0.5, 2.0);
+      relay->amplitude = constrain(scaled, relay->minAmplitude, relay->maxAmplitude);
+    }
+    return;
+  }
+  if (relay->cycles <= RELAY_ADAPTING_CYCLES + RELAY_SETTLING_CYCLES) {
+    return;
+  }
+  relay->correlationSum += correlation;
+  relay->samplesSum += samples;
+  relay->periodSum += period;
+  if (relay->cycles == RELAY_ADAPTING_CYCLES + RELAY_SETTLING_CYCLES + RELAY_MEASURED_CYCLES) {
+    const float meanCorrelation = relay->correlationSum / relay->samplesSum;
+    if (meanCorrelation <= 0.0) {
+      relay->state = RELAY_FAILED;
+      return;
+    }
+    relay->ultimateGain = 8.0 * relay->amplitude / (PI * PI * meanCorrelation);
+    relay->ultimatePeriod = relay->periodSum / RELAY_MEASURED_CYCLES;
+    relay->state = RELAY_DONE;
+  }
+}
+
+/**
+ * Takes the error, target minus measured, at now in us, returns the relay
+ * output to apply in place of the controller
+ */
+float updateRelayExperiment(struct RelayExperiment *relay, float error, unsigned long now) {
+  if (relay->state != RELAY_RUNNING) {
+    return 0.0;
+  }
+  if (error > relay->errorMax) {
+    relay->errorMax = error;
+  }
+  if (error < relay->errorMin) {
+    relay->errorMin = error;
+  }
+
+  // the error sample sits between the output held up to now and the one
+  // held from now on, half of it goes to each
+  relay->correlation += (relay->output > 0.0) ? error * 0.5 : -error * 0.5;
+  if (relay->output > 0.0 && error < -relay->hysteresis) {
+    relay->output = -relay->amplitude;
+  }
+  else if (relay->output < 0.0 && error > relay->hysteresis) {
+    closeRelayCycle(relay, now);
+    relay->output = relay->amplitude;
+  }
+  relay->correlation += (relay->output > 0.0) ? error * 0.5 : -error * 0.5;
+  relay->samples++;
+  if (relay->state == RELAY_RUNNING && now - relay->cycleStart > RELAY_TIMEOUT) {
+    relay->state = RELAY_FAILED;
+  }
+  return (relay->state == RELAY_RUNNING) ? relay->output : 0.0;
+}
+
+/**
+ * Rate loop PID in the units of PID.h: I per second of integrated error,
+ * D on the measurement and per 10ms, hence negative
+ */
+void computeRelayRatePID(float ultimateGain, float ultimatePeriod, float *P, float *I, float *D) {
+  *P = RELAY_RATE_P * ultimateGain;
+  *I = *P / (RELAY_RATE_I_TIME * ultimatePeriod);
+  *D = -*P * RELAY_RATE_D_TIME * ultimatePeriod * 100.0;
+}
+
+// Attitude loop, a P controller on an integrating plant
+float computeRelayAttitudeP(float ultimateGain) {
+  return RELAY_ATTITUDE_P * ultimateGain;
+}
+
+#endif
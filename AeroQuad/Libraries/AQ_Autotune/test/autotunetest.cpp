@@ -0,0 +1,416 @@
+/*
+ * Closed loop simulation of the in flight PID autotune
+ *
+ * A rigid body, one inertia per axis, is driven through first order motor
+ * lag by the motor axis commands, and seen through a 98Hz gyro low pass
+ * with noise and random gusts. The attitude and rate loops of
+ * FlightControlProcessor.h are rebuilt around the real PID.h, with the
+ * autotune hooks where the flight code has them, the outer loop at 100Hz
+ * and the rate loop at the control loop rate. For a few airframes and loop
+ * rates the autotune is flown from hover to the end, then:
+ *   - the Ku and Tu of the rate experiments are compared with the ones
+ *     the frequency response of the simulated plant gives, at 400Hz
+ *   - the staged gains are applied and an attitude step and gusts are
+ *     flown, against the default gains of DataStorage.h
+ * Moving a stick in the middle of an experiment is also checked to hand
+ * the axis back to its PID at once.
+ *
+ *   make check
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <complex>
+#include "Arduino.h"
+
+/* the flight controller globals the headers take */
+#define XAXIS 0
+#define YAXIS 1
+#define ZAXIS 2
+unsigned long currentTime = 0;
+boolean inFlight = true;
+float gyroRate[3] = {0.0, 0.0, 0.0};
+float kinematicsAngle[3] = {0.0, 0.0, 0.0};
+int receiverZero[3] = {1500, 1500, 1500};
+int receiverCommand[10] = {1500, 1500, 1500, 1500, 1000, 1000, 1000, 1000, 1000, 1000};
+float rotationSpeedFactor = 1.0;
+
+#include "PID.h"
+#include "RelayAutotune.h"
+#include "AutotuneProcessor.h"
+
+#define PHYSICS_RATE 8000
+#define OUTER_RATE 100
+#define GYRO_LOW_PASS 98.0    /* Hz */
+#define GYRO_NOISE 0.005      /* rad/s rms */
+#define GUST 1.0              /* rad/s^2 rms of the gust acceleration */
+#define GUST_TIME 0.3         /* s, correlation time of the gusts */
+
+static int failures = 0;
+
+struct Airframe {
+  const char *name;
+  double gain[3];             /* rad/s^2 per motor axis command unit */
+  double motorLag;            /* s */
+  double damping;             /* 1/s, aerodynamic rate damping */
+};
+
+static const Airframe airframes[] = {
+  {"450 quad", {0.30, 0.30, 0.080}, 0.030, 0.5},
+  {"heavy hexa", {0.12, 0.10, 0.030}, 0.050, 0.3},
+  {"250 racer", {0.80, 0.70, 0.200}, 0.015, 0.8},
+};
+static const double axisSign[3] = {1.0, -1.0, 1.0};   /* pitch PIDs see -gyroRate[YAXIS] */
+
+static double gaussian() {
+  const double u = (rand() + 1.0) / (RAND_MAX + 2.0);
+  const double v = (rand() + 1.0) / (RAND_MAX + 2.0);
+  return sqrt(-2.0 * log(u)) * cos(2.0 * M_PI * v);
+}
+
+struct Plant {
+  const Airframe *frame;
+  double rate[3], angle[3], motor[3], gyro[3], gust[3];
+  double gustLevel;
+};
+
+static void resetPlant(Plant &plant, const Airframe *frame, double gustLevel) {
+  memset(&plant, 0, sizeof(plant));
+  plant.frame = frame;
+  plant.gustLevel = gustLevel;
+}
+
+static void stepPlant(Plant &plant, const double *command, double dt) {
+  const double gustDecay = exp(-dt / GUST_TIME);
+  const double gustDrive = plant.gustLevel * sqrt(1.0 - gustDecay * gustDecay);
+  const double gyroAlpha = 1.0 - exp(-2.0 * M_PI * GYRO_LOW_PASS * dt);
+  for (int axis = 0; axis < 3; axis++) {
+    plant.gust[axis] = gustDecay * plant.gust[axis] + gustDrive * gaussian();
+    plant.motor[axis] += (command[axis] - plant.motor[axis]) * dt / plant.frame->motorLag;
+    const double acceleration = axisSign[axis] * plant.frame->gain[axis] * plant.motor[axis]
+                              - plant.frame->damping * plant.rate[axis] + plant.gust[axis];
+    plant.rate[axis] += acceleration * dt;
+    plant.angle[axis] += plant.rate[axis] * dt;
+    plant.gyro[axis] += (plant.rate[axis] - plant.gyro[axis]) * gyroAlpha;
+  }
+}
+
+/* Attitude mode as in FlightControlProcessor.h, heading hold off */
+struct FlightLoop {
+  int loopRate;
+  long tick;
+  float setpoint[3];
+  double pidCommand[3];       /* what the rate PIDs asked for */
+  double command[3];          /* what was flown */
+};
+
+static void resetFlightLoop(FlightLoop &loop, int loopRate) {
+  memset(&loop, 0, sizeof(loop));
+  loop.loopRate = loopRate;
+  for (byte index = 0; index < LAST_PID_IDX; index++) {
+    PID[index].integratedError = 0.0;
+    PID[index].lastError = 0.0;
+    PID[index].previousPIDTime = currentTime;
+  }
+  initializePIDEngine();
+}
+
+static void flyControlLoop(FlightLoop &loop, Plant &plant, const double *targetAngle) {
+  for (int axis = 0; axis < 3; axis++) {
+    gyroRate[axis] = plant.gyro[axis] + GYRO_NOISE * gaussian();
+    kinematicsAngle[axis] = plant.angle[axis];
+  }
+
+  /* processAttitudeControl(), at 100Hz */
+  if (loop.tick % (loop.loopRate / OUTER_RATE) == 0) {
+    updateAutotune();
+    const float rollTarget = targetAngle[XAXIS], pitchTarget = targetAngle[YAXIS];
+    loop.setpoint[XAXIS] = updatePID(rollTarget, kinematicsAngle[XAXIS], &PID[ATTITUDE_XAXIS_PID_IDX]);
+    loop.setpoint[YAXIS] = updatePID(pitchTarget, -kinematicsAngle[YAXIS], &PID[ATTITUDE_YAXIS_PID_IDX]);
+    loop.setpoint[XAXIS] = getAutotuneRateSetpoint(XAXIS, rollTarget - kinematicsAngle[XAXIS], loop.setpoint[XAXIS]);
+    loop.setpoint[YAXIS] = getAutotuneRateSetpoint(YAXIS, pitchTarget + kinematicsAngle[YAXIS], loop.setpoint[YAXIS]);
+    loop.setpoint[ZAXIS] = 0.0;
+  }
+
+  /* calculateFlightError() */
+  const byte index[3] = {ATTITUDE_GYRO_XAXIS_PID_IDX, ATTITUDE_GYRO_YAXIS_PID_IDX, ZAXIS_PID_IDX};
+  const float measured[3] = {gyroRate[XAXIS], -gyroRate[YAXIS], gyroRate[ZAXIS]};
+  float command[3];
+  updatePIDs(index, loop.setpoint, measured, command, 3, 1.0 / loop.loopRate);
+  for (int axis = 0; axis < 3; axis++) {
+    loop.pidCommand[axis] = command[axis];
+    loop.command[axis] = getAutotuneRateCommand(axis, measured[axis], command[axis]);
+  }
+  loop.tick++;
+}
+
+/* one control loop period of flight, the commands held over it */
+static void fly(FlightLoop &loop, Plant &plant, const double *targetAngle) {
+  currentTime += 1000000UL / loop.loopRate;
+  flyControlLoop(loop, plant, targetAngle);
+  const int substeps = PHYSICS_RATE / loop.loopRate;
+  for (int i = 0; i < substeps; i++) {
+    stepPlant(plant, loop.command, 1.0 / PHYSICS_RATE);
+  }
+}
+
+static void setDefaultGains() {
+  /* as initializeEEPROM() in DataStorage.h */
+  PID[RATE_XAXIS_PID_IDX].P = 100.0;
+  PID[RATE_XAXIS_PID_IDX].I = 150.0;
+  PID[RATE_XAXIS_PID_IDX].D = -350.0;
+  PID[RATE_YAXIS_PID_IDX] = PID[RATE_XAXIS_PID_IDX];
+  PID[ATTITUDE_XAXIS_PID_IDX].P = 3.5;
+  PID[ATTITUDE_XAXIS_PID_IDX].I = 0.0;
+  PID[ATTITUDE_XAXIS_PID_IDX].D = 0.0;
+  PID[ATTITUDE_YAXIS_PID_IDX] = PID[ATTITUDE_XAXIS_PID_IDX];
+  PID[ZAXIS_PID_IDX].P = 200.0;
+  PID[ZAXIS_PID_IDX].I = 5.0;
+  PID[ZAXIS_PID_IDX].D = 0.0;
+  PID[HEADING_HOLD_PID_IDX].P = 3.0;
+  PID[HEADING_HOLD_PID_IDX].I = 0.1;
+  PID[HEADING_HOLD_PID_IDX].D = 0.0;
+  PID[ATTITUDE_GYRO_XAXIS_PID_IDX].P = 100.0;
+  PID[ATTITUDE_GYRO_XAXIS_PID_IDX].I = 0.0;
+  PID[ATTITUDE_GYRO_XAXIS_PID_IDX].D = -350.0;
+  PID[ATTITUDE_GYRO_YAXIS_PID_IDX] = PID[ATTITUDE_GYRO_XAXIS_PID_IDX];
+  for (byte index = 0; index < LAST_PID_IDX; index++) {
+    PID[index].windupGuard = 1000.0;
+  }
+}
+
+/*
+ * What the relay of a rate experiment sees: the motor axis command through
+ * the hold, motor lag, body and gyro low pass. Returns the response at
+ * w rad/s.
+ */
+static std::complex<double> ratePlant(const Airframe *frame, int axis, int loopRate, double w) {
+  const std::complex<double> s(0.0, w);
+  const double hold = 1.0 / loopRate;
+  const std::complex<double> zeroOrderHold = (1.0 - exp(-s * hold)) / (s * hold);
+  const std::complex<double> body = zeroOrderHold / (frame->motorLag * s + 1.0) * frame->gain[axis] / (s + frame->damping);
+  return body / (s / (2.0 * M_PI * GYRO_LOW_PASS) + 1.0);
+}
+
+/*
+ * Ku and Tu the relay of a stage should find on the plant. With hysteresis
+ * e, error swing a and output d, the relay locks on the frequency where
+ *   G(jw) = -PI / (4 * d) * (sqrt(a^2 - e^2) + j * e)
+ * so where the phase is short of -180 degrees by atan(PI * e * Ku / (4 * d)),
+ * and its Ku is -1 / Re(G) there. With no hysteresis this is the phase
+ * crossover.
+ */
+static void relayPoint(const Airframe *frame, int axis, int loopRate, double lead, double *ultimateGain, double *ultimatePeriod) {
+  const std::complex<double> rotate = std::polar(1.0, -lead);
+  /* first frequency the phase goes below -180 + lead, then bisected */
+  double low = 1.0, high = 1.0;
+  while ((ratePlant(frame, axis, loopRate, high) * rotate).imag() < 0.0) {
+    low = high;
+    high *= 1.02;
+  }
+  for (int i = 0; i < 60; i++) {
+    const double w = sqrt(low * high);
+    if ((ratePlant(frame, axis, loopRate, w) * rotate).imag() < 0.0) {
+      low = w;
+    }
+    else {
+      high = w;
+    }
+  }
+  *ultimateGain = -1.0 / ratePlant(frame, axis, loopRate, low).real();
+  *ultimatePeriod = 2.0 * M_PI / low;
+}
+
+/* relay of each stage once it is done, for relayPoint() */
+static RelayExperiment finishedRelay[AUTOTUNE_STAGES];
+
+/* Flies until the autotune completes, seconds or -1 */
+static double flyAutotune(FlightLoop &loop, Plant &plant, double limit) {
+  const double level[2] = {0.0, 0.0};
+  startAutotune();
+  const long ticks = (long)(limit * loop.loopRate);
+  for (long i = 0; i < ticks; i++) {
+    fly(loop, plant, level);
+    if (autotuneState == AUTOTUNE_RUNNING && autotuneRelay.state == RELAY_DONE) {
+      finishedRelay[autotuneStage] = autotuneRelay;
+    }
+    if (autotuneState == AUTOTUNE_COMPLETE) {
+      return (double)i / loop.loopRate;
+    }
+    if (fabs(plant.angle[XAXIS]) > 1.0 || fabs(plant.angle[YAXIS]) > 1.0) {
+      return -1.0;
+    }
+  }
+  return -1.0;
+}
+
+struct StepResult {
+  double overshoot;           /* % of the step */
+  double riseTime;            /* s, 10 to 90% */
+  double settlingTime;        /* s, into 5% for good */
+  double gustError;           /* rad rms of the roll and pitch angle in gusts */
+  bool stable;
+};
+
+static StepResult flyStep(const Airframe *frame, int loopRate) {
+  StepResult result = {0.0, 0.0, 0.0, 0.0, true};
+  const double step = 0.2;
+  Plant plant;
+  FlightLoop loop;
+  resetPlant(plant, frame, 0.0);
+  resetFlightLoop(loop, loopRate);
+  const double level[2] = {0.0, 0.0};
+  const double target[2] = {step, 0.0};
+  for (int i = 0; i < loopRate; i++) {
+    fly(loop, plant, level);
+  }
+  double peak = 0.0, rise10 = -1.0, rise90 = -1.0, settled = 0.0;
+  const int ticks = 3 * loopRate;
+  for (int i = 0; i < ticks; i++) {
+    fly(loop, plant, target);
+    const double t = (double)(i + 1) / loopRate;
+    const double angle = plant.angle[XAXIS];
+    peak = fmax(peak, angle);
+    if (rise10 < 0.0 && angle >= 0.1 * step) rise10 = t;
+    if (rise90 < 0.0 && angle >= 0.9 * step) rise90 = t;
+    if (fabs(angle - step) > 0.05 * step) settled = t;
+    if (!std::isfinite(angle) || fabs(angle) > 2.0) {
+      result.stable = false;
+      return result;
+    }
+  }
+  result.overshoot = 100.0 * (peak - step) / step;
+  result.riseTime = (rise10 >= 0.0 && rise90 >= 0.0) ? rise90 - rise10 : 99.0;
+  result.settlingTime = settled;
+  result.stable = settled < ticks / (double)loopRate - 0.5;
+
+  /* gusts, level flight */
+  resetPlant(plant, frame, GUST);
+  resetFlightLoop(loop, loopRate);
+  double sum = 0.0;
+  const int gustTicks = 20 * loopRate;
+  for (int i = 0; i < gustTicks; i++) {
+    fly(loop, plant, level);
+    sum += plant.angle[XAXIS] * plant.angle[XAXIS] + plant.angle[YAXIS] * plant.angle[YAXIS];
+  }
+  result.gustError = sqrt(sum / (2.0 * gustTicks));
+  if (!std::isfinite(result.gustError) || result.gustError > 0.5) {
+    result.stable = false;
+  }
+  return result;
+}
+
+static void printStep(const char *what, const StepResult &result) {
+  if (!result.stable) {
+    printf("    %-8s unstable\n", what);
+    return;
+  }
+  printf("    %-8s 0.2rad step: overshoot %5.1f%%, rise %.3fs, within 5%% after %.2fs; gusts %.2f deg rms\n",
+         what, result.overshoot, result.riseTime, result.settlingTime, result.gustError * 180.0 / M_PI);
+}
+
+static void tuneAirframe(const Airframe *frame, int loopRate) {
+  printf("%s at %dHz:\n", frame->name, loopRate);
+  setDefaultGains();
+  clearAutotune();
+  const StepResult before = flyStep(frame, loopRate);
+
+  Plant plant;
+  FlightLoop loop;
+  resetPlant(plant, frame, GUST * 0.3);
+  resetFlightLoop(loop, loopRate);
+  setDefaultGains();
+  const double seconds = flyAutotune(loop, plant, 120.0);
+  if (seconds < 0.0) {
+    printf("  FAIL: autotune did not complete\n");
+    failures++;
+    return;
+  }
+  printf("  autotune complete after %.1fs\n", seconds);
+
+  /* at 100Hz the limit cycle is only 6 to 14 samples long and the relay
+     only switches on them, the describing function is too coarse there to
+     hold the identification to a bound, only the tuned response is */
+  const bool checkIdentification = loopRate >= 400;
+  static const char *const stageName[AUTOTUNE_STAGES] = {"roll rate", "roll attitude", "pitch rate", "pitch attitude", "yaw rate"};
+  for (byte stage = 0; stage < AUTOTUNE_STAGES; stage++) {
+    printf("  %-14s Ku %8.3f  Tu %.3fs", stageName[stage], autotuneUltimateGain[stage], autotuneUltimatePeriod[stage]);
+    if (!isAutotuneAttitudeStage(stage)) {
+      double ultimateGain, ultimatePeriod;
+      const RelayExperiment *relay = &finishedRelay[stage];
+      const double lead = atan(M_PI * relay->hysteresis * relay->ultimateGain / (4.0 * relay->amplitude));
+      relayPoint(frame, getAutotuneAxis(stage), loopRate, lead, &ultimateGain, &ultimatePeriod);
+      const double gainError = 100.0 * (autotuneUltimateGain[stage] - ultimateGain) / ultimateGain;
+      const double periodError = 100.0 * (autotuneUltimatePeriod[stage] - ultimatePeriod) / ultimatePeriod;
+      printf("   plant Ku %8.3f  Tu %.3fs   (%+5.1f%%, %+5.1f%%)", ultimateGain, ultimatePeriod, gainError, periodError);
+      if (checkIdentification && (fabs(gainError) > 20.0 || fabs(periodError) > 20.0)) {
+        printf("\n  FAIL: identification off by more than 20%%");
+        failures++;
+      }
+    }
+    printf("\n");
+  }
+
+  setDefaultGains();
+  applyAutotuneGains();
+  printf("  staged: rate P %.1f I %.1f D %.1f, attitude P %.2f, yaw P %.1f I %.1f\n",
+         PID[ATTITUDE_GYRO_XAXIS_PID_IDX].P, PID[RATE_XAXIS_PID_IDX].I, PID[ATTITUDE_GYRO_XAXIS_PID_IDX].D,
+         PID[ATTITUDE_XAXIS_PID_IDX].P, PID[ZAXIS_PID_IDX].P, PID[ZAXIS_PID_IDX].I);
+  const StepResult after = flyStep(frame, loopRate);
+  printStep("default", before);
+  printStep("tuned", after);
+  if (!after.stable || after.overshoot > 25.0 || after.settlingTime > 1.0) {
+    printf("  FAIL: tuned response\n");
+    failures++;
+  }
+}
+
+/* A stick moved in the middle of a rate experiment hands the axis back */
+static void stickInterrupt() {
+  const Airframe *frame = &airframes[0];
+  const int loopRate = 400;
+  Plant plant;
+  FlightLoop loop;
+  const double level[2] = {0.0, 0.0};
+  setDefaultGains();
+  clearAutotune();
+  resetPlant(plant, frame, 0.0);
+  resetFlightLoop(loop, loopRate);
+  startAutotune();
+  while (autotuneState != AUTOTUNE_RUNNING) {
+    fly(loop, plant, level);
+  }
+  for (int i = 0; i < loopRate / 20; i++) {
+    fly(loop, plant, level);
+  }
+  receiverCommand[XAXIS] = 1600;
+  for (int i = 0; i < loopRate / OUTER_RATE; i++) {
+    fly(loop, plant, level);
+  }
+  const bool handedBack = autotuneState == AUTOTUNE_SETTLING && loop.command[XAXIS] == loop.pidCommand[XAXIS];
+  receiverCommand[XAXIS] = 1500;
+  const double seconds = flyAutotune(loop, plant, 120.0);
+  printf("stick moved during the roll rate experiment: %s, autotune %s\n",
+         handedBack ? "PID back in control" : "relay kept on", seconds >= 0.0 ? "completed afterwards" : "did not complete");
+  if (!handedBack || seconds < 0.0) {
+    printf("FAIL: stick interrupt\n");
+    failures++;
+  }
+}
+
+int main() {
+  srand(1);
+  for (unsigned int i = 0; i < sizeof(airframes) / sizeof(airframes[0]); i++) {
+    tuneAirframe(&airframes[i], 100);
+    tuneAirframe(&airframes[i], 400);
+  }
+  stickInterrupt();
+  printf(failures ? "FAILED\n" : "PASSED\n");
+  return failures ? 1 : 0;
+}
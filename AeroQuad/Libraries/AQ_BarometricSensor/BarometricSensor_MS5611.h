@@ -169,10 +169,17 @@ void requestRawPressure()
   sendByteI2C(MS5611_I2C_ADDRESS, MS561101BA_D1_Pressure + MS561101BA_OSR_4096);
 }
 
+#if defined(MavLinkHIL)
+  float readHILPressure();  // MavLink.h, the simulator's pressure in Pa
+#endif
+
 float readRawPressure()
 {
   MS5611lastRawPressure = MS5611readConversion(MS5611_I2C_ADDRESS);
 
+  #if defined(MavLinkHIL)
+    return readHILPressure();
+  #endif
   return (((( MS5611lastRawPressure * MS5611_sens) >> 21) - MS5611_offset) >> (15-5)) / ((float)(1<<5));
 }
 
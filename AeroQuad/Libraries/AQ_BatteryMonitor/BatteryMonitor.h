@@ -22,6 +22,8 @@
 #define _AQ_BATTERY_MONITOR_
 
 #include <BatteryMonitorTypes.h>
+#include <BackgroundADC.h>
+#include <BatteryStateEstimator.h>
 
 #define BM_WARNING_RATIO 1.1
 
@@ -49,6 +51,7 @@ void resetBattery(byte batno) {
     batteryData[batno].current      = 0;
     batteryData[batno].maxCurrent   = 0;
     batteryData[batno].usedCapacity = 0;
+    resetBatteryStateEstimator(batno);
 #endif
   }
 }
@@ -57,6 +60,15 @@ void initializeBatteryMonitor(byte nb, float alarmVoltage) {
 
   numberOfBatteries = nb;
   setBatteryCellVoltageThreshold(alarmVoltage);
+  for (int i = 0; i < numberOfBatteries; i++) {
+    batteryData[i].vChannel = attachBackgroundADC(batteryData[i].vPin);
+#ifdef BM_EXTENDED
+    if (batteryData[i].cPin != BM_NOPIN) {
+      batteryData[i].cChannel = attachBackgroundADC(batteryData[i].cPin);
+    }
+#endif
+  }
+  startBackgroundADC();
   for (int i = 0; i < numberOfBatteries; i++) {
     resetBattery(i);
   }
@@ -78,19 +90,48 @@ byte batteryGetCellCount(byte batNo) {
   }
 }
 
+// Estimated charge left in percent, -1 when not known
+int batteryRemainingPercent() {
+#ifdef BM_EXTENDED
+  if (numberOfBatteries > 0 && batteryData[0].stateOfCharge >= 0.0) {
+    return batteryData[0].stateOfCharge * 100.0 + 0.5;
+  }
+#endif
+  return -1;
+}
+
+// Voltage with the sag under load taken out when there is a current sensor
+unsigned short batteryRestingVoltage(byte batNo) {
+#ifdef BM_EXTENDED
+  return batteryData[batNo].openCircuitVoltage;
+#else
+  return batteryData[batNo].voltage;
+#endif
+}
+
 boolean batteryIsAlarm(byte batNo) {
 
-  if (batteryData[batNo].voltage < batteryGetCellCount(batNo) * batteryAlarmCellVoltage) {
+  if (batteryRestingVoltage(batNo) < batteryGetCellCount(batNo) * batteryAlarmCellVoltage) {
+    return true;
+  }
+#ifdef BM_EXTENDED
+  if (batteryStateOfChargeIsAlarm(batNo)) {
     return true;
   }
+#endif
   return false;
 }
 
 boolean batteryIsWarning(byte batNo) {
 
-  if (batteryData[batNo].voltage < batteryGetCellCount(batNo) * batteryWarningCellVoltage) {
+  if (batteryRestingVoltage(batNo) < batteryGetCellCount(batNo) * batteryWarningCellVoltage) {
     return true;
   }
+#ifdef BM_EXTENDED
+  if (batteryStateOfChargeIsWarning(batNo)) {
+    return true;
+  }
+#endif
   return false;
 }
 
@@ -99,19 +140,20 @@ void measureBatteryVoltage(unsigned short deltaTime) {
   batteryAlarm = false;  
   batteryWarning = false;
   for (int i = 0; i < numberOfBatteries; i++) {
-    batteryData[i].voltage = (long)analogRead(batteryData[i].vPin) * batteryData[i].vScale / (1L<<ADC_NUMBER_OF_BITS) + batteryData[i].vBias;
+    batteryData[i].voltage = (long)getBackgroundADC(batteryData[i].vChannel) * batteryData[i].vScale / (1L<<ADC_NUMBER_OF_BITS) + batteryData[i].vBias;
 #ifdef BM_EXTENDED
     if (batteryData[i].voltage < batteryData[i].minVoltage) {
       batteryData[i].minVoltage = batteryData[i].voltage;
     }
     if (batteryData[i].cPin != BM_NOPIN) {
-      batteryData[i].current = (long)analogRead(batteryData[i].cPin) * batteryData[i].cScale * 10 / (1L<<ADC_NUMBER_OF_BITS) + batteryData[i].cBias * 10;
+      batteryData[i].current = (long)getBackgroundADC(batteryData[i].cChannel) * batteryData[i].cScale * 10 / (1L<<ADC_NUMBER_OF_BITS) + batteryData[i].cBias * 10;
       if (batteryData[i].current > batteryData[i].maxCurrent) { 
         batteryData[i].maxCurrent = batteryData[i].current;
       }
       // current in 10mA , time in ms -> usedCapacity in uAh  // i.e. / 360 <=> * ( 91 / 32768 )
       batteryData[i].usedCapacity += (long)batteryData[i].current * (long)deltaTime * 91 / 32768;
     }
+    updateBatteryStateEstimator(i, deltaTime, batteryGetCellCount(i));
 #endif
     if (batteryIsAlarm(i)) {
       batteryAlarm = true;
@@ -26,6 +26,7 @@
 #endif
 
 #define BM_NOPIN 255
+#define BM_UNKNOWN_TIME 0xFFFF
 
 struct BatteryData {
   byte  vPin;                   // A/D pin for voltage sensor
@@ -39,7 +40,16 @@ struct BatteryData {
   short current;          // Current battery current (in 10mA:s)
   short maxCurrent;       // Maximum current since reset
   long  usedCapacity;     // Capacity used since reset (in uAh)
+  unsigned short openCircuitVoltage; // Voltage corrected for the sag under load (in 10mV:s)
+  float resistance;       // Estimated internal resistance (in ohm)
+  float averageCurrent;   // Slowly filtered current for the time to empty (in A)
+  float stateOfCharge;    // Estimated charge left, 0..1, negative until the first measurement
+  float stateOfChargeVariance;
+  unsigned short remainingCapacity; // Estimated capacity left (in mAh), needs BattCapacity
+  unsigned short timeToEmpty;       // At the average current (in s), BM_UNKNOWN_TIME if not known
+  byte  cChannel;         // background ADC channel of cPin
 #endif
+  byte  vChannel;         // background ADC channel of vPin
 };
 
 extern struct BatteryData batteryData[];       // BatteryMonitor config, !! MUST BE DEFINED BY MAIN SKETCH !!
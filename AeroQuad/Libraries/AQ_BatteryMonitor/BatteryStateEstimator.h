@@ -0,0 +1,160 @@
+/*
+  AeroQuad v3.2 - Battery state of charge estimator
+  www.AeroQuad.com
+  Copyright (c) 2012 Ted Carancho.  All rights reserved.
+  An Open Source Arduino based multicopter.
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Remaining charge from coulomb counting corrected by the resting voltage
+//
+// The voltage under load is raised by current * internal resistance to get
+// the open circuit voltage, the resistance being learned from the voltage
+// change across every large current step. A LiPo open circuit voltage curve
+// turns it into a state of charge, which a one state Kalman filter merges
+// with the charge counted out of the battery: the counted charge carries
+// the estimate, the voltage pulls it back where the curve is steep and is
+// almost ignored on the flat middle part. Without a current sensor or a
+// known capacity only the filtered voltage estimate is available.
+
+#ifndef _AQ_BATTERY_STATE_ESTIMATOR_
+#define _AQ_BATTERY_STATE_ESTIMATOR_
+
+#include <BatteryMonitorTypes.h>
+#include <BackgroundADC.h>
+
+#ifdef BM_EXTENDED
+
+#define BATTERY_DEFAULT_CELL_RESISTANCE 0.010  // ohm, until learned
+#define BATTERY_MAX_CELL_RESISTANCE 0.100      // ohm, larger steps are not taken as resistance
+#define BATTERY_RESISTANCE_MIN_STEP 2.0        // A of current change needed to learn from
+#define BATTERY_RESISTANCE_FILTER 0.1
+#define BATTERY_OCV_CELL_ERROR 0.03            // V, open circuit voltage model error per cell
+#define BATTERY_COUNTING_NOISE 1.0e-7          // state of charge variance added per update
+#define BATTERY_CURRENT_TIME_CONSTANT 10.0     // s, averaging of the current for the time to empty
+#define BATTERY_VOLTAGE_ONLY_FILTER 0.02       // state of charge low pass without coulomb counting
+#define BATTERY_ALARM_STATE_OF_CHARGE 0.15
+#define BATTERY_WARNING_STATE_OF_CHARGE 0.25
+
+// LiPo cell open circuit voltage at 0, 10, ... 100% charge
+#define BATTERY_OCV_POINTS 11
+const float batteryCellOCV[BATTERY_OCV_POINTS] = {3.27, 3.69, 3.73, 3.77, 3.80, 3.84, 3.87, 3.95, 4.02, 4.11, 4.20};
+
+#ifdef BattCapacity
+  float batteryCapacity = BattCapacity;   // mAh
+#else
+  float batteryCapacity = 0.0;
+#endif
+
+float batteryLastVoltage[BACKGROUND_ADC_MAX_CHANNELS];
+float batteryLastCurrent[BACKGROUND_ADC_MAX_CHANNELS];
+
+/**
+ * State of charge for a cell open circuit voltage, and through slope its
+ * change per volt at that point
+ */
+float batteryStateOfChargeFromOCV(float cellVoltage, float *slope) {
+  if (cellVoltage <= batteryCellOCV[0]) {
+    *slope = 0.1 / (batteryCellOCV[1] - batteryCellOCV[0]);
+    return 0.0;
+  }
+  for (byte i = 1; i < BATTERY_OCV_POINTS; i++) {
+    if (cellVoltage < batteryCellOCV[i]) {
+      *slope = 0.1 / (batteryCellOCV[i] - batteryCellOCV[i-1]);
+      return 0.1 * (i - 1) + (cellVoltage - batteryCellOCV[i-1]) * *slope;
+    }
+  }
+  *slope = 0.1 / (batteryCellOCV[BATTERY_OCV_POINTS-1] - batteryCellOCV[BATTERY_OCV_POINTS-2]);
+  return 1.0;
+}
+
+void resetBatteryStateEstimator(byte batNo) {
+  batteryData[batNo].stateOfCharge = -1.0;
+  batteryData[batNo].resistance = 0.0;
+  batteryData[batNo].averageCurrent = 0.0;
+  batteryData[batNo].openCircuitVoltage = batteryData[batNo].voltage;
+  batteryData[batNo].remainingCapacity = 0;
+  batteryData[batNo].timeToEmpty = BM_UNKNOWN_TIME;
+}
+
+/**
+ * Called with every new voltage and current measurement
+ * deltaTime in ms, cells as detected by the battery monitor
+ */
+void updateBatteryStateEstimator(byte batNo, unsigned short deltaTime, byte cells) {
+  struct BatteryData *battery = &batteryData[batNo];
+  const boolean hasCurrent = battery->cPin != BM_NOPIN;
+  const float voltage = battery->voltage / 100.0;
+  const float current = hasCurrent ? battery->current / 100.0 : 0.0;
+  const float dt = deltaTime / 1000.0;
+
+  if (battery->resistance == 0.0) {
+    battery->resistance = BATTERY_DEFAULT_CELL_RESISTANCE * cells;
+  }
+  else if (hasCurrent && fabs(current - batteryLastCurrent[batNo]) > BATTERY_RESISTANCE_MIN_STEP) {
+    const float resistance = (batteryLastVoltage[batNo] - voltage) / (current - batteryLastCurrent[batNo]);
+    if (resistance > 0.0 && resistance < BATTERY_MAX_CELL_RESISTANCE * cells) {
+      battery->resistance += BATTERY_RESISTANCE_FILTER * (resistance - battery->resistance);
+    }
+  }
+  batteryLastVoltage[batNo] = voltage;
+  batteryLastCurrent[batNo] = current;
+
+  const float openCircuitVoltage = voltage + current * battery->resistance;
+  battery->openCircuitVoltage = openCircuitVoltage * 100.0;
+  float slope;
+  const float measuredStateOfCharge = batteryStateOfChargeFromOCV(openCircuitVoltage / cells, &slope);
+  const float measurementError = BATTERY_OCV_CELL_ERROR * slope;
+
+  if (battery->stateOfCharge < 0.0) {
+    battery->stateOfCharge = measuredStateOfCharge;
+    battery->stateOfChargeVariance = measurementError * measurementError;
+    battery->averageCurrent = current;
+  }
+  else if (hasCurrent && batteryCapacity > 0.0) {
+    // predict with the charge drawn, correct with the voltage
+    battery->stateOfCharge -= current * dt / 3.6 / batteryCapacity;
+    battery->stateOfChargeVariance += BATTERY_COUNTING_NOISE;
+    const float gain = battery->stateOfChargeVariance / (battery->stateOfChargeVariance + measurementError * measurementError);
+    battery->stateOfCharge += gain * (measuredStateOfCharge - battery->stateOfCharge);
+    battery->stateOfChargeVariance *= 1.0 - gain;
+  }
+  else {
+    battery->stateOfCharge += BATTERY_VOLTAGE_ONLY_FILTER * (measuredStateOfCharge - battery->stateOfCharge);
+  }
+  battery->stateOfCharge = constrain(battery->stateOfCharge, 0.0, 1.0);
+
+  battery->averageCurrent += min(dt / BATTERY_CURRENT_TIME_CONSTANT, 1.0) * (current - battery->averageCurrent);
+  battery->remainingCapacity = battery->stateOfCharge * batteryCapacity;
+  if (batteryCapacity > 0.0 && battery->averageCurrent > 0.5) {
+    battery->timeToEmpty = min(battery->remainingCapacity * 3.6 / battery->averageCurrent, (float)(BM_UNKNOWN_TIME - 1));
+  }
+  else {
+    battery->timeToEmpty = BM_UNKNOWN_TIME;
+  }
+}
+
+boolean batteryStateOfChargeIsAlarm(byte batNo) {
+  return batteryCapacity > 0.0 && batteryData[batNo].cPin != BM_NOPIN &&
+         batteryData[batNo].stateOfCharge >= 0.0 && batteryData[batNo].stateOfCharge < BATTERY_ALARM_STATE_OF_CHARGE;
+}
+
+boolean batteryStateOfChargeIsWarning(byte batNo) {
+  return batteryCapacity > 0.0 && batteryData[batNo].cPin != BM_NOPIN &&
+         batteryData[batNo].stateOfCharge >= 0.0 && batteryData[batNo].stateOfCharge < BATTERY_WARNING_STATE_OF_CHARGE;
+}
+
+#endif
+#endif
@@ -0,0 +1,136 @@
+/*
+ * Flight simulation of the battery state of charge estimator
+ *
+ * A 3S LiPo rests on the ground for 10s, then is discharged by a hover
+ * load with throttle steps. It is read as the battery monitor would,
+ * every 100ms in its 10mV and 10mA units with sensor noise. The pack
+ * differs from what the estimator knows: its resistance is 18mohm per
+ * cell against the 10mohm it starts from, its cells sit 15mV above the
+ * open circuit voltage curve, and its capacity is 2600mAh while
+ * BattCapacity says 2200mAh. The real updateBatteryStateEstimator() is
+ * run on it and
+ *   - the learned resistance must be within RESISTANCE_TOLERANCE
+ *   - after SETTLE_TIME of flight the charge estimate must stay within
+ *     CHARGE_TOLERANCE of the truth, counting alone drifts by 17%
+ *   - the alarm must trip between ALARM_EARLIEST and ALARM_LATEST true
+ *     charge
+ * The pack has no polarization: the estimator only models the ohmic
+ * drop, a sag that keeps building under load is read as lost charge.
+ *
+ *   make check
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "Arduino.h"
+
+/* the estimator only needs the channel count of BackgroundADC.h */
+#define _AEROQUAD_BACKGROUND_ADC_H_
+#define BACKGROUND_ADC_MAX_CHANNELS 4
+
+#define BattCapacity 2200
+#include "BatteryMonitorTypes.h"
+struct BatteryData batteryData[1];
+#include "BatteryStateEstimator.h"
+
+#define CELLS 3
+#define TRUE_CAPACITY 2600.0          // mAh
+#define CELL_RESISTANCE 0.018         // ohm, ohmic
+#define CELL_OCV_OFFSET 0.015         // V, the pack against the curve of the estimator
+#define UPDATE_TIME 100               // ms, as measureBatteryVoltage() is called
+#define TAKEOFF_TIME 10.0             // s on the ground
+#define SETTLE_TIME 60.0              // s of flight before the charge bound applies
+
+#define RESISTANCE_TOLERANCE 0.05
+#define CHARGE_TOLERANCE 0.09
+#define ALARM_EARLIEST 0.15
+#define ALARM_LATEST 0.08
+
+/* xorshift, the same flight on every host */
+static uint32_t randomState = 2463534242u;
+static float nextNoise() {
+  randomState ^= randomState << 13;
+  randomState ^= randomState >> 17;
+  randomState ^= randomState << 5;
+  return (randomState & 0xFFFF) / 32768.0 - 1.0;
+}
+
+/* cell open circuit voltage of the simulated pack, the estimator's curve moved by the offset */
+static float cellOpenCircuitVoltage(float stateOfCharge) {
+  const float position = constrain(stateOfCharge, 0.0, 1.0) * (BATTERY_OCV_POINTS - 1);
+  const int i = min((int)position, BATTERY_OCV_POINTS - 2);
+  return batteryCellOCV[i] + (position - i) * (batteryCellOCV[i + 1] - batteryCellOCV[i]) + CELL_OCV_OFFSET;
+}
+
+/* 0.5A on the ground, then hover at 15A with throttle steps up to 23A every few seconds */
+static float loadCurrent(float time) {
+  if (time < TAKEOFF_TIME) {
+    return 0.5;
+  }
+  const int step = (int)(time / 4.0);
+  const float level[] = {15.0, 23.0, 17.0, 15.0, 21.0, 16.0, 19.0, 15.0};
+  return level[step % 8];
+}
+
+int main() {
+  batteryData[0].cPin = 0;
+  resetBatteryStateEstimator(0);
+
+  float trueCharge = 1.0;
+  float countedCharge = 1.0;
+  float worstEstimate = 0.0;
+  float worstCounting = 0.0;
+  float alarmCharge = -1.0;
+  float time = 0.0;
+  const float dt = UPDATE_TIME / 1000.0;
+
+  while (trueCharge > 0.05) {
+    const float current = loadCurrent(time);
+    trueCharge -= current * dt / 3.6 / TRUE_CAPACITY;
+    const float voltage = CELLS * cellOpenCircuitVoltage(trueCharge) - current * CELL_RESISTANCE * CELLS;
+    time += dt;
+
+    batteryData[0].voltage = (unsigned short)lround((voltage + 0.02 * nextNoise()) * 100.0);
+    batteryData[0].current = (short)lround((current + 0.2 * nextNoise()) * 100.0);
+    updateBatteryStateEstimator(0, UPDATE_TIME, CELLS);
+    countedCharge -= batteryData[0].current / 100.0 * dt / 3.6 / BattCapacity;
+
+    if (time >= TAKEOFF_TIME + SETTLE_TIME) {
+      worstEstimate = max(worstEstimate, fabs(batteryData[0].stateOfCharge - trueCharge));
+      worstCounting = max(worstCounting, fabs(countedCharge - trueCharge));
+    }
+    if (alarmCharge < 0.0 && batteryStateOfChargeIsAlarm(0)) {
+      alarmCharge = trueCharge;
+    }
+  }
+
+  const float trueResistance = CELL_RESISTANCE * CELLS;
+  const float resistanceError = fabs(batteryData[0].resistance - trueResistance) / trueResistance;
+  printf("%.0fs flight, 3S %.0fmAh pack configured as %dmAh\n", time, TRUE_CAPACITY, BattCapacity);
+  printf("resistance  %.4f ohm learned, %.4f ohm ohmic, %.1f%% off\n", batteryData[0].resistance, trueResistance, resistanceError * 100.0);
+  printf("charge      estimate at most %.1f%% off, counting alone %.1f%%\n", worstEstimate * 100.0, worstCounting * 100.0);
+  printf("alarm       at %.1f%% true charge\n", alarmCharge * 100.0);
+
+  int failures = 0;
+  if (resistanceError > RESISTANCE_TOLERANCE) {
+    printf("  the learned resistance is more than %.0f%% off\n", RESISTANCE_TOLERANCE * 100.0);
+    failures++;
+  }
+  if (worstEstimate > CHARGE_TOLERANCE) {
+    printf("  the charge estimate is more than %.0f%% off\n", CHARGE_TOLERANCE * 100.0);
+    failures++;
+  }
+  if (alarmCharge > ALARM_EARLIEST || alarmCharge < ALARM_LATEST) {
+    printf("  the alarm must trip between %.0f%% and %.0f%% true charge\n", ALARM_EARLIEST * 100.0, ALARM_LATEST * 100.0);
+    failures++;
+  }
+  printf(failures ? "FAILED\n" : "PASSED\n");
+  return failures ? 1 : 0;
+}
@@ -33,9 +33,20 @@ float measuredMagZ = 0.0;
 float measuredMag[3] = {0.0,0.0,0.0};
 float rawMag[3] = {0.0,0.0,0.0};
 float magBias[3] = {0.0,0.0,0.0};
+float magSoftIron[3][3] = {{1.0,0.0,0.0},{0.0,1.0,0.0},{0.0,0.0,1.0}};  // applied after magBias
+
+void initializeMagSoftIron() {
+  for (byte i = 0; i < 3; i++) {
+    for (byte j = 0; j < 3; j++) {
+      magSoftIron[i][j] = (i == j) ? 1.0 : 0.0;
+    }
+  }
+}
 
 void initializeMagnetometer();
 void measureMagnetometer(float roll, float pitch);
+// same with the tilt trig already at hand, e.g. kinematicsSinAngle/kinematicsCosAngle
+void measureMagnetometer(float sinRoll, float cosRoll, float sinPitch, float cosPitch);
 
 const float getHdgXY(byte axis) {
   if (axis == XAXIS) {
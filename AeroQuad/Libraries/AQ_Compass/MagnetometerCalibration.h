@@ -0,0 +1,296 @@
+/*
+  AeroQuad v3.0.1 - February 2012
+  www.AeroQuad.com
+  Copyright (c) 2012 Ted Carancho.  All rights reserved.
+  An Open Source Arduino based multicopter.
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// On board hard and soft iron calibration
+//
+// While active, every raw magnetometer sample updates a recursive least
+// squares fit of the general ellipsoid
+//   A x^2 + B y^2 + C z^2 + 2D xy + 2E xz + 2F yz + 2G x + 2H y + 2I z = 1
+// When finished, the ellipsoid is turned into an offset (magBias) and a
+// symmetric correction matrix (magSoftIron) mapping it back onto a sphere,
+// so measureMagnetometer() only needs one matrix-vector multiply.
+
+#ifndef _AEROQUAD_MAGNETOMETER_CALIBRATION_H_
+#define _AEROQUAD_MAGNETOMETER_CALIBRATION_H_
+
+#include "Compass.h"
+#include "Arduino.h"
+
+#define MAG_CAL_PARAMETERS 9
+#define MAG_CAL_INITIAL_COVARIANCE 1000.0
+#define MAG_CAL_MIN_SAMPLES 150
+#define MAG_CAL_MIN_AXIS_SPAN 1.0      // per axis sample spread, in units of the first sample magnitude
+#define MAG_CAL_MAX_AXIS_RATIO 2.0     // longest / shortest ellipsoid semi axis
+#define MAG_CAL_ERROR_SMOOTH_FACTOR 0.02
+
+#define MAG_CAL_IDLE 0
+#define MAG_CAL_SAMPLING 1
+#define MAG_CAL_DONE 2
+#define MAG_CAL_FAILED 3
+
+byte magCalibrationState = MAG_CAL_IDLE;
+unsigned int magCalibrationSamples = 0;
+float magCalibrationFitError = 0.0;    // rms radius error of the fit, in percent
+
+float magCalScale = 0.0;
+float magCalTheta[MAG_CAL_PARAMETERS];
+float magCalP[MAG_CAL_PARAMETERS][MAG_CAL_PARAMETERS];
+float magCalMin[3];
+float magCalMax[3];
+float magCalErrorSquare = 0.0;
+
+void startMagCalibration() {
+  for (byte i = 0; i < MAG_CAL_PARAMETERS; i++) {
+    magCalTheta[i] = 0.0;
+    for (byte j = 0; j < MAG_CAL_PARAMETERS; j++) {
+      magCalP[i][j] = (i == j) ? MAG_CAL_INITIAL_COVARIANCE : 0.0;
+    }
+  }
+  for (byte axis = XAXIS; axis <= ZAXIS; axis++) {
+    magCalMin[axis] = 1.0e6;
+    magCalMax[axis] = -1.0e6;
+  }
+  magCalScale = 0.0;
+  magCalErrorSquare = 0.0;
+  magCalibrationFitError = 0.0;
+  magCalibrationSamples = 0;
+  magCalibrationState = MAG_CAL_SAMPLING;
+}
+
+void cancelMagCalibration() {
+  magCalibrationState = MAG_CAL_IDLE;
+}
+
+/**
+ * One RLS step with the raw sample, called by measureMagnetometer()
+ * Samples are divided by the magnitude of the first one to keep the
+ * regressors around 1 so the single precision covariance stays healthy.
+ */
+void updateMagCalibration(const float *sample) {
+  if (magCalibrationState != MAG_CAL_SAMPLING) {
+    return;
+  }
+  if (magCalScale == 0.0) {
+    magCalScale = sqrt(sample[XAXIS] * sample[XAXIS] + sample[YAXIS] * sample[YAXIS] + sample[ZAXIS] * sample[ZAXIS]);
+    if (magCalScale == 0.0) {
+      return;
+    }
+  }
+
+  const float x = sample[XAXIS] / magCalScale;
+  const float y = sample[YAXIS] / magCalScale;
+  const float z = sample[ZAXIS] / magCalScale;
+  float phi[MAG_CAL_PARAMETERS];
+  phi[0] = x * x;
+  phi[1] = y * y;
+  phi[2] = z * z;
+  phi[3] = 2.0 * x * y;
+  phi[4] = 2.0 * x * z;
+  phi[5] = 2.0 * y * z;
+  phi[6] = 2.0 * x;
+  phi[7] = 2.0 * y;
+  phi[8] = 2.0 * z;
+
+  float Pphi[MAG_CAL_PARAMETERS];
+  float error = 1.0;
+  float denominator = 1.0;
+  for (byte i = 0; i < MAG_CAL_PARAMETERS; i++) {
+    float sum = 0.0;
+    for (byte j = 0; j < MAG_CAL_PARAMETERS; j++) {
+      sum += magCalP[i][j] * phi[j];
+    }
+    Pphi[i] = sum;
+    error -= magCalTheta[i] * phi[i];
+    denominator += phi[i] * sum;
+  }
+
+  for (byte i = 0; i < MAG_CAL_PARAMETERS; i++) {
+    const float gain = Pphi[i] / denominator;
+    magCalTheta[i] += gain * error;
+    // P is symmetric, update the upper triangle and mirror it
+    for (byte j = i; j < MAG_CAL_PARAMETERS; j++) {
+      magCalP[i][j] -= gain * Pphi[j];
+      magCalP[j][i] = magCalP[i][j];
+    }
+  }
+
+  const float normalized[3] = {x, y, z};
+  for (byte axis = XAXIS; axis <= ZAXIS; axis++) {
+    magCalMin[axis] = min(magCalMin[axis], normalized[axis]);
+    magCalMax[axis] = max(magCalMax[axis], normalized[axis]);
+  }
+
+  // a priori error, only meaningful once the fit has settled
+  magCalibrationSamples++;
+  if (magCalibrationSamples > MAG_CAL_MIN_SAMPLES / 2) {
+    magCalErrorSquare += MAG_CAL_ERROR_SMOOTH_FACTOR * (error * error - magCalErrorSquare);
+  }
+}
+
+/**
+ * Eigen decomposition of a symmetric 3x3 matrix with cyclic Jacobi rotations
+ * a is destroyed, its diagonal holds the eigenvalues, columns of v the vectors
+ */
+void magCalEigen(float a[3][3], float v[3][3]) {
+  for (byte i = 0; i < 3; i++) {
+    for (byte j = 0; j < 3; j++) {
+      v[i][j] = (i == j) ? 1.0 : 0.0;
+    }
+  }
+  for (byte sweep = 0; sweep < 10; sweep++) {
+    const float offDiagonal = fabs(a[0][1]) + fabs(a[0][2]) + fabs(a[1][2]);
+    if (offDiagonal < 1.0e-9) {
+      return;
+    }
+    for (byte p = 0; p < 2; p++) {
+      for (byte q = p + 1; q < 3; q++) {
+        if (a[p][q] == 0.0) {
+          continue;
+        }
+        const float theta = (a[q][q] - a[p][p]) / (2.0 * a[p][q]);
+        float t = 1.0 / (fabs(theta) + sqrt(theta * theta + 1.0));
+        if (theta < 0.0) {
+          t = -t;
+        }
+        const float c = 1.0 / sqrt(t * t + 1.0);
+        const float s = t * c;
+        for (byte k = 0; k < 3; k++) {
+          const float akp = a[k][p];
+          const float akq = a[k][q];
+          a[k][p] = c * akp - s * akq;
+          a[k][q] = s * akp + c * akq;
+        }
+        for (byte k = 0; k < 3; k++) {
+          const float apk = a[p][k];
+          const float aqk = a[q][k];
+          a[p][k] = c * apk - s * aqk;
+          a[q][k] = s * apk + c * aqk;
+        }
+        for (byte k = 0; k < 3; k++) {
+          const float vkp = v[k][p];
+          const float vkq = v[k][q];
+          v[k][p] = c * vkp - s * vkq;
+          v[k][q] = s * vkp + c * vkq;
+        }
+      }
+    }
+  }
+}
+
+/**
+ * Turn the fitted ellipsoid into magBias and magSoftIron
+ * The correction matrix keeps the volume of the ellipsoid, so corrected
+ * samples have about the same magnitude as before and existing gains
+ * or thresholds built on raw counts still hold.
+ * Returns false and leaves the current calibration untouched if the
+ * samples do not cover enough of the sphere or the fit is not an ellipsoid.
+ */
+boolean finishMagCalibration() {
+  if (magCalibrationState != MAG_CAL_SAMPLING) {
+    return false;
+  }
+  magCalibrationState = MAG_CAL_FAILED;
+
+  if (magCalibrationSamples < MAG_CAL_MIN_SAMPLES) {
+    return false;
+  }
+  for (byte axis = XAXIS; axis <= ZAXIS; axis++) {
+    if (magCalMax[axis] - magCalMin[axis] < MAG_CAL_MIN_AXIS_SPAN) {
+      return false;
+    }
+  }
+
+  float m[3][3] = {{magCalTheta[0], magCalTheta[3], magCalTheta[4]},
+                   {magCalTheta[3], magCalTheta[1], magCalTheta[5]},
+                   {magCalTheta[4], magCalTheta[5], magCalTheta[2]}};
+  const float v[3] = {magCalTheta[6], magCalTheta[7], magCalTheta[8]};
+
+  // center = -inverse(m) * v, using the adjugate
+  const float c00 = m[1][1] * m[2][2] - m[1][2] * m[2][1];
+  const float c01 = m[0][2] * m[2][1] - m[0][1] * m[2][2];
+  const float c02 = m[0][1] * m[1][2] - m[0][2] * m[1][1];
+  const float c11 = m[0][0] * m[2][2] - m[0][2] * m[2][0];
+  const float c12 = m[0][2] * m[1][0] - m[0][0] * m[1][2];
+  const float c22 = m[0][0] * m[1][1] - m[0][1] * m[1][0];
+  const float determinant = m[0][0] * c00 + m[0][1] * c01 + m[0][2] * c02;
+  if (determinant <= 0.0) {
+    return false;
+  }
+  float center[3];
+  center[XAXIS] = -(c00 * v[0] + c01 * v[1] + c02 * v[2]) / determinant;
+  center[YAXIS] = -(c01 * v[0] + c11 * v[1] + c12 * v[2]) / determinant;
+  center[ZAXIS] = -(c02 * v[0] + c12 * v[1] + c22 * v[2]) / determinant;
+
+  // (x - center)' m (x - center) = k
+  float k = 1.0;
+  for (byte i = 0; i < 3; i++) {
+    for (byte j = 0; j < 3; j++) {
+      k += center[i] * m[i][j] * center[j];
+    }
+  }
+  if (k <= 0.0) {
+    return false;
+  }
+  for (byte i = 0; i < 3; i++) {
+    for (byte j = 0; j < 3; j++) {
+      m[i][j] /= k;
+    }
+  }
+
+  float vectors[3][3];
+  magCalEigen(m, vectors);
+  float minEigen = m[0][0];
+  float maxEigen = m[0][0];
+  float radius = 1.0;
+  for (byte i = 0; i < 3; i++) {
+    minEigen = min(minEigen, m[i][i]);
+    maxEigen = max(maxEigen, m[i][i]);
+    radius *= m[i][i];
+  }
+  // semi axes are 1/sqrt(eigenvalue)
+  if (minEigen <= 0.0 || sqrt(maxEigen / minEigen) > MAG_CAL_MAX_AXIS_RATIO) {
+    return false;
+  }
+  radius = pow(radius, -1.0 / 6.0);
+
+  float sqrtEigen[3];
+  for (byte i = 0; i < 3; i++) {
+    sqrtEigen[i] = radius * sqrt(m[i][i]);
+  }
+  for (byte i = 0; i < 3; i++) {
+    for (byte j = 0; j < 3; j++) {
+      float sum = 0.0;
+      for (byte e = 0; e < 3; e++) {
+        sum += vectors[i][e] * sqrtEigen[e] * vectors[j][e];
+      }
+      magSoftIron[i][j] = sum;
+    }
+  }
+  for (byte axis = XAXIS; axis <= ZAXIS; axis++) {
+    magBias[axis] = -center[axis] * magCalScale;
+  }
+
+  // the quadric error is about 2k times the relative radius error
+  magCalibrationFitError = 100.0 * sqrt(magCalErrorSquare) / (2.0 * k);
+  magCalibrationState = MAG_CAL_DONE;
+  return true;
+}
+
+#endif
@@ -40,5 +40,9 @@ void measureMagnetometer(float roll, float pitch) {
   else absoluteHeading = heading;
 }
 
+void measureMagnetometer(float sinRoll, float cosRoll, float sinPitch, float cosPitch) {
+  measureMagnetometer(0.0, 0.0);
+}
+
 
 #endif
\ No newline at end of file
@@ -23,6 +23,7 @@
 #define _AEROQUAD_MAGNETOMETER_HMC58XX_H_
 
 #include "Compass.h"
+#include "MagnetometerCalibration.h"
 #include <SensorsStatus.h>
 
 #include "Arduino.h"
@@ -40,6 +41,9 @@
 //#define SENSOR_GAIN 0xE0  // +/- 6.5 Ga (not recommended)
 
 void readSpecificMag(float *rawMag);
+#if defined(MavLinkHIL)
+  void readHILMag(float *rawMag);  // MavLink.h, the simulator's field
+#endif
 
 
 void initializeMagnetometer() {
@@ -58,28 +62,32 @@ void initializeMagnetometer() {
   measureMagnetometer(0.0, 0.0);  // Assume 1st measurement at 0 degrees roll and 0 degrees pitch
 }
 
-void measureMagnetometer(float roll, float pitch) {
+void measureMagnetometer(float sinRoll, float cosRoll, float sinPitch, float cosPitch) {
     
   sendByteI2C(COMPASS_ADDRESS, 0x03);
   Wire.requestFrom(COMPASS_ADDRESS, 6);
 
   readSpecificMag(rawMag);
+  #if defined(MavLinkHIL)
+    readHILMag(rawMag);
+  #endif
 
   updateRegisterI2C(COMPASS_ADDRESS, 0x02, 0x01); // start single conversion
 
-  measuredMagX = rawMag[XAXIS] + magBias[XAXIS];
-  measuredMagY = rawMag[YAXIS] + magBias[YAXIS];
-  measuredMagZ = rawMag[ZAXIS] + magBias[ZAXIS];
+  updateMagCalibration(rawMag);
+
+  const float biasedMagX = rawMag[XAXIS] + magBias[XAXIS];
+  const float biasedMagY = rawMag[YAXIS] + magBias[YAXIS];
+  const float biasedMagZ = rawMag[ZAXIS] + magBias[ZAXIS];
+
+  measuredMagX = magSoftIron[XAXIS][XAXIS] * biasedMagX + magSoftIron[XAXIS][YAXIS] * biasedMagY + magSoftIron[XAXIS][ZAXIS] * biasedMagZ;
+  measuredMagY = magSoftIron[YAXIS][XAXIS] * biasedMagX + magSoftIron[YAXIS][YAXIS] * biasedMagY + magSoftIron[YAXIS][ZAXIS] * biasedMagZ;
+  measuredMagZ = magSoftIron[ZAXIS][XAXIS] * biasedMagX + magSoftIron[ZAXIS][YAXIS] * biasedMagY + magSoftIron[ZAXIS][ZAXIS] * biasedMagZ;
   
   measuredMag[XAXIS] = measuredMagX;
   measuredMag[YAXIS] = measuredMagY;
   measuredMag[ZAXIS] = measuredMagZ;
   
-  const float cosRoll =  cos(roll);
-  const float sinRoll =  sin(roll);
-  const float cosPitch = cos(pitch);
-  const float sinPitch = sin(pitch);
-
   const float magX = (float)measuredMagX * cosPitch + 
                      (float)measuredMagY * sinRoll * sinPitch + 
                      (float)measuredMagZ * cosRoll * sinPitch;
@@ -93,4 +101,8 @@ void measureMagnetometer(float roll, float pitch) {
   hdgY = -magY / tmp;
 }
 
+void measureMagnetometer(float roll, float pitch) {
+  measureMagnetometer(sin(roll), cos(roll), sin(pitch), cos(pitch));
+}
+
 #endif
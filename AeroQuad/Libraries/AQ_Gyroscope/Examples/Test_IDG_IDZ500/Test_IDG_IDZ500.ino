@@ -22,6 +22,7 @@
 
 #include <AQMath.h>
 #include <Device_I2C.h>
+#include <BackgroundADC.h>     // Arduino IDE bug, needed because the analog sensors share the ADC through it
 #include <Gyroscope_IDG_IDZ500.h>
 #include <GlobalDefined.h>
 
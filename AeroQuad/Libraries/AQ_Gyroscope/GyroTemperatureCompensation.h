@@ -0,0 +1,179 @@
+/*
+  AeroQuad v3.0.1 - February 2012
+  www.AeroQuad.com
+  Copyright (c) 2012 Ted Carancho.  All rights reserved.
+  An Open Source Arduino based multicopter.
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Gyro zero versus temperature model, learned while the craft sits still
+//
+// Every 100Hz gyro average goes into a one second window. When the window
+// shows the craft still and disarmed, its mean is a bias measurement at the
+// current temperature and updates an exponentially weighted linear fit
+//   gyroZero(t) = mean bias + covariance / variance * (t - mean temperature)
+// per axis. Once enough still time has been seen and the current temperature
+// is inside the learned range, gyroZero follows the fit and the boot
+// calibration can be skipped.
+
+#ifndef _AEROQUAD_GYRO_TEMPERATURE_COMPENSATION_H_
+#define _AEROQUAD_GYRO_TEMPERATURE_COMPENSATION_H_
+
+#include "Arduino.h"
+#include "Gyroscope.h"
+
+#define GYRO_TEMP_MAX_WEIGHT 3600.0      // one hour of still time, older data fades out past that
+#define GYRO_TEMP_MIN_WEIGHT 60.0        // one minute of still time before the model replaces the boot calibration
+#define GYRO_TEMP_MIN_VARIANCE 1.0       // deg C^2 of temperature spread needed to trust the slope
+#define GYRO_TEMP_RANGE_MARGIN 5.0       // deg C the model may be extrapolated outside the learned range
+#define GYRO_TEMP_STILL_RATE radians(0.5)      // max standard deviation of a still window, rad/s
+#define GYRO_TEMP_MAX_DEVIATION radians(3.0)   // max distance of a still window from the current zero, rad/s
+#define GYRO_TEMP_SAVE_INTERVAL 300      // learned windows between EEPROM saves
+
+// persisted model
+float gyroTempWeight = 0.0;
+float gyroTempMean = 0.0;
+float gyroTempVariance = 0.0;
+float gyroTempMin = 0.0;
+float gyroTempMax = 0.0;
+float gyroTempBias[3] = {0.0,0.0,0.0};
+float gyroTempCovariance[3] = {0.0,0.0,0.0};
+
+float gyroTempWindowSum[3] = {0.0,0.0,0.0};
+float gyroTempWindowSquareSum[3] = {0.0,0.0,0.0};
+unsigned int gyroTempWindowCount = 0;
+unsigned int gyroTempUnsavedCount = 0;
+
+void resetGyroTempCompensation() {
+  gyroTempWeight = 0.0;
+  gyroTempMean = 0.0;
+  gyroTempVariance = 0.0;
+  gyroTempMin = 0.0;
+  gyroTempMax = 0.0;
+  for (byte axis = XAXIS; axis <= ZAXIS; axis++) {
+    gyroTempBias[axis] = 0.0;
+    gyroTempCovariance[axis] = 0.0;
+  }
+}
+
+/**
+ * Called by evaluateGyroRate() with the raw average of the samples
+ * summed since the last call, before gyroSample is cleared
+ */
+void accumulateGyroTempWindow() {
+  if (gyroSampleCount == 0) {
+    return;
+  }
+  // kept relative to gyroZero so the variance does not cancel out in single precision
+  for (byte axis = XAXIS; axis <= ZAXIS; axis++) {
+    const float offset = (float)gyroSample[axis] / gyroSampleCount - gyroZero[axis];
+    gyroTempWindowSum[axis] += offset;
+    gyroTempWindowSquareSum[axis] += offset * offset;
+  }
+  gyroTempWindowCount++;
+}
+
+boolean isGyroTempCompensationValid() {
+  return gyroTempWeight >= GYRO_TEMP_MIN_WEIGHT &&
+         gyroTemperature >= gyroTempMin - GYRO_TEMP_RANGE_MARGIN &&
+         gyroTemperature <= gyroTempMax + GYRO_TEMP_RANGE_MARGIN;
+}
+
+float getGyroTempZero(byte axis) {
+  if (gyroTempVariance < GYRO_TEMP_MIN_VARIANCE) {
+    return gyroTempBias[axis];
+  }
+  return gyroTempBias[axis] + gyroTempCovariance[axis] / gyroTempVariance * (gyroTemperature - gyroTempMean);
+}
+
+/**
+ * Reads the temperature and moves gyroZero to the model
+ * Returns false, leaving gyroZero alone, while the model does not cover
+ * the current temperature
+ */
+boolean applyGyroTempCompensation() {
+  readGyroTemp();
+  if (!isGyroTempCompensationValid()) {
+    return false;
+  }
+  for (byte axis = XAXIS; axis <= ZAXIS; axis++) {
+    gyroZero[axis] = (int)floor(getGyroTempZero(axis) + 0.5);
+  }
+  return true;
+}
+
+void learnGyroTempBias(const float *bias) {
+  if (gyroTempWeight == 0.0) {
+    gyroTempMin = gyroTemperature;
+    gyroTempMax = gyroTemperature;
+  }
+  gyroTempMin = min(gyroTempMin, gyroTemperature);
+  gyroTempMax = max(gyroTempMax, gyroTemperature);
+
+  gyroTempWeight = min(gyroTempWeight + 1.0, GYRO_TEMP_MAX_WEIGHT);
+  const float alpha = 1.0 / gyroTempWeight;
+  const float temperatureDelta = gyroTemperature - gyroTempMean;
+  gyroTempMean += alpha * temperatureDelta;
+  gyroTempVariance = (1.0 - alpha) * (gyroTempVariance + alpha * temperatureDelta * temperatureDelta);
+  for (byte axis = XAXIS; axis <= ZAXIS; axis++) {
+    const float biasDelta = bias[axis] - gyroTempBias[axis];
+    gyroTempBias[axis] += alpha * biasDelta;
+    gyroTempCovariance[axis] = (1.0 - alpha) * (gyroTempCovariance[axis] + alpha * temperatureDelta * biasDelta);
+  }
+}
+
+/**
+ * 1Hz update, closes the window, learns from it if the craft was still
+ * and follows the model
+ * Returns true when enough has been learned since the last save that
+ * the model should be written to EEPROM
+ */
+boolean processGyroTempCompensation(boolean learningAllowed) {
+  boolean learned = false;
+  if (learningAllowed && gyroTempWindowCount > 1) {
+    float bias[3];
+    boolean still = true;
+    for (byte axis = XAXIS; axis <= ZAXIS; axis++) {
+      const float offset = gyroTempWindowSum[axis] / gyroTempWindowCount;
+      const float variance = gyroTempWindowSquareSum[axis] / gyroTempWindowCount - offset * offset;
+      if (variance * gyroScaleFactor * gyroScaleFactor > GYRO_TEMP_STILL_RATE * GYRO_TEMP_STILL_RATE ||
+          fabs(offset) * gyroScaleFactor > GYRO_TEMP_MAX_DEVIATION) {
+        still = false;
+      }
+      bias[axis] = gyroZero[axis] + offset;
+    }
+    readGyroTemp();
+    if (still) {
+      learnGyroTempBias(bias);
+      gyroTempUnsavedCount++;
+      learned = true;
+    }
+  }
+  for (byte axis = XAXIS; axis <= ZAXIS; axis++) {
+    gyroTempWindowSum[axis] = 0.0;
+    gyroTempWindowSquareSum[axis] = 0.0;
+  }
+  gyroTempWindowCount = 0;
+
+  applyGyroTempCompensation();
+
+  if (learned && gyroTempUnsavedCount >= GYRO_TEMP_SAVE_INTERVAL) {
+    gyroTempUnsavedCount = 0;
+    return true;
+  }
+  return false;
+}
+
+#endif
@@ -23,16 +23,24 @@
 
 #include "Arduino.h"
 #include "GlobalDefined.h"
+#include <StreamingCalibration.h>
 
 #define FINDZERO 49
 
+#define GYRO_CALIBRATION_MIN_SAMPLES 16
+#define GYRO_CALIBRATION_MAX_SAMPLES 150
+#define GYRO_CALIBRATION_STD_ERROR radians(0.02)  // rad/s, standard error of the zero
+
 float gyroRate[3] = {0.0,0.0,0.0};
 int   gyroZero[3] = {0,0,0};
 long  gyroSample[3] = {0,0,0};
 float gyroScaleFactor = 0.0;
 float gyroHeading = 0.0;
+float gyroTemperature = 0.0;  // deg C, updated by readGyroTemp()
 unsigned long gyroLastMesuredTime = 0;
 byte gyroSampleCount = 0;
+struct StreamingCalibration gyroCalibration;
+byte gyroCalibrationQuality = 0;
 
 void measureGyroSum();
 void evaluateGyroRate();
@@ -41,4 +49,24 @@ void measureGyro();
 boolean calibrateGyro();
 void readGyroTemp();
 
+void startGyroCalibration() {
+  initStreamingCalibration(&gyroCalibration);
+}
+
+/**
+ * Feeds one raw sample, in gyroZero order, returns true once the zero
+ * is known well enough
+ */
+boolean updateGyroCalibration(const float *sample, float motionLimit) {
+  addStreamingCalibrationSample(&gyroCalibration, sample, motionLimit);
+  return isStreamingCalibrationDone(&gyroCalibration, GYRO_CALIBRATION_MIN_SAMPLES, GYRO_CALIBRATION_STD_ERROR / gyroScaleFactor);
+}
+
+void finishGyroCalibration(float motionLimit) {
+  for (byte axis = XAXIS; axis <= ZAXIS; axis++) {
+    gyroZero[axis] = (int)floor(gyroCalibration.mean[axis] + 0.5);
+  }
+  gyroCalibrationQuality = getStreamingCalibrationQuality(&gyroCalibration, motionLimit);
+}
+
 #endif
\ No newline at end of file
@@ -23,6 +23,7 @@
 
 #include <Gyroscope.h>
 #include <SensorsStatus.h>
+#include <BackgroundADC.h>
 
 #define GYRO_CALIBRATION_TRESHOLD 4
 
@@ -57,9 +58,9 @@ void measureGyro() {
   int gyroADC;
   for (byte axis = XAXIS; axis <= ZAXIS; axis++) {
     if (axis == YAXIS)
-      gyroADC = analogRead(gyroChannel[axis]) - gyroZero[axis];
+      gyroADC = analogReadShared(gyroChannel[axis]) - gyroZero[axis];
     else
-      gyroADC = gyroZero[axis] - analogRead(gyroChannel[axis]);
+      gyroADC = gyroZero[axis] - analogReadShared(gyroChannel[axis]);
     gyroRate[axis] = gyroADC * gyroScaleFactor;
   }
  
@@ -89,7 +90,7 @@ boolean calibrateGyro() {
   int diff = 0;
   for (byte calAxis = XAXIS; calAxis <= ZAXIS; calAxis++) {
     for (int i=0; i<FINDZERO; i++) {
-      findZero[i] = analogRead(gyroChannel[calAxis]);
+      findZero[i] = analogReadShared(gyroChannel[calAxis]);
 	}
 	int tmp = findMedianIntWithDiff(findZero, FINDZERO, &diff);
 	if (diff <= GYRO_CALIBRATION_TRESHOLD) { // 4 = 0.27826087 degrees during 49*10ms measurements (490ms). 0.57deg/s difference between first and last.
@@ -22,6 +22,7 @@
 #define _AEROQUAD_GYROSCOPE_ITG3200_COMMON_H_
 
 #include <Gyroscope.h>
+#include <GyroTemperatureCompensation.h>
 
 #ifdef ITG3200_ADDRESS_ALTERNATE
   #define ITG3200_ADDRESS					0x68
@@ -45,7 +46,6 @@
 #define ITG3200_TEMPERATURE_ADDRESS     0x1B
 
 
-float gyroTempBias[3] = {0.0,0.0,0.0};
 void measureSpecificGyroADC(int *gyroADC);
 void measureSpecificGyroSum();
 void evaluateSpecificGyroRate(int *gyroADC);
@@ -92,6 +92,9 @@ void measureGyroSum() {
 void evaluateGyroRate() {
   int gyroADC[3];
   evaluateSpecificGyroRate(gyroADC);
+  #if defined(GyroTempCompensation)
+    accumulateGyroTempWindow();
+  #endif
   gyroSample[XAXIS] = 0;
   gyroSample[YAXIS] = 0;
   gyroSample[ZAXIS] = 0;
@@ -109,6 +112,35 @@ void evaluateGyroRate() {
   gyroLastMesuredTime = currentTime;
 }
 
+boolean calibrateGyro() {
+  //Finds gyro drift.
+  //Returns false if during calibration there was movement of board. 
+  // 10ms between samples matches the 10Hz low pass filter, so they are close to independent
+  startGyroCalibration();
+  for (int i = 0; i < GYRO_CALIBRATION_MAX_SAMPLES; i++) {
+    for (byte axis = XAXIS; axis <= ZAXIS; axis++) {
+      gyroSample[axis] = 0;
+    }
+    measureGyroSum();
+    gyroSampleCount = 0;
+
+    float sample[3];
+    for (byte axis = XAXIS; axis <= ZAXIS; axis++) {
+      sample[axis] = gyroSample[axis];
+      gyroSample[axis] = 0;
+    }
+    if (updateGyroCalibration(sample, GYRO_CALIBRATION_TRESHOLD)) {
+      finishGyroCalibration(GYRO_CALIBRATION_TRESHOLD);
+      return true; //Calibration successfull.
+    }
+    delay(10);
+  }
+  return false; //Calibration failed.
+}
 
+void readGyroTemp() {
+  sendByteI2C(ITG3200_ADDRESS, ITG3200_TEMPERATURE_ADDRESS);
+  gyroTemperature = 35.0 + (readShortI2C(ITG3200_ADDRESS) + 13200) / 280.0;  // 280 LSB/deg C, -13200 at 35 deg C
+}
 
 #endif
@@ -22,9 +22,13 @@
 #define _AEROQUAD_GYROSCOPE_MPU6000_COMMON_H_
 
 int gyroRaw[3] = {0,0,0};
+#if defined(MPU6000_FIFO)
+  unsigned long gyroSampleTime = 0;   // us of MPU6000 time at the last sample summed in gyroSample
+#endif
 
 #include <Platform_MPU6000.h>
 #include <Gyroscope.h>
+#include <GyroTemperatureCompensation.h>
 
 #define GYRO_CALIBRATION_TRESHOLD 25
 
@@ -61,18 +65,38 @@ void measureGyro() {
 
 void measureGyroSum() {
   readMPU6000Gyro();
-  gyroSample[XAXIS] += (gyroRaw[XAXIS]=MPU6000.data.gyro.x);
-  gyroSample[YAXIS] += (gyroRaw[YAXIS]=MPU6000.data.gyro.y);
-  gyroSample[ZAXIS] += (gyroRaw[ZAXIS]=MPU6000.data.gyro.z);
-
-  gyroSampleCount++;
+  #if defined(MPU6000_FIFO)
+    // every sample the FIFO delivered since the last call
+    gyroRaw[XAXIS] = MPU6000.data.gyro.x;
+    gyroRaw[YAXIS] = MPU6000.data.gyro.y;
+    gyroRaw[ZAXIS] = MPU6000.data.gyro.z;
+    for (byte axis = XAXIS; axis <= ZAXIS; axis++) {
+      gyroSample[axis] += mpu6000BatchGyro[axis];
+      mpu6000BatchGyro[axis] = 0;
+    }
+    gyroSampleCount += mpu6000BatchGyroSamples;
+    mpu6000BatchGyroSamples = 0;
+    gyroSampleTime = mpu6000BatchTime;
+  #else
+    gyroSample[XAXIS] += (gyroRaw[XAXIS]=MPU6000.data.gyro.x);
+    gyroSample[YAXIS] += (gyroRaw[YAXIS]=MPU6000.data.gyro.y);
+    gyroSample[ZAXIS] += (gyroRaw[ZAXIS]=MPU6000.data.gyro.z);
+
+    gyroSampleCount++;
+  #endif
 }
 
 void evaluateGyroRate() {
+  if (gyroSampleCount == 0) {
+    return;  // FIFO not drained since the last call, keep the previous rate
+  }
   int gyroADC[3];
   gyroADC[XAXIS] = (gyroSample[XAXIS] / gyroSampleCount) - gyroZero[XAXIS];
   gyroADC[YAXIS] = gyroZero[YAXIS] - (gyroSample[YAXIS] / gyroSampleCount);
   gyroADC[ZAXIS] = gyroZero[ZAXIS] - (gyroSample[ZAXIS] / gyroSampleCount);
+  #if defined(GyroTempCompensation)
+    accumulateGyroTempWindow();
+  #endif
 
   gyroSample[XAXIS] = 0;
   gyroSample[YAXIS] = 0;
@@ -87,33 +111,27 @@ void evaluateGyroRate() {
 }
 
 
+void readGyroTemp() {
+  readMPU6000Sensors();
+  gyroTemperature = MPU6000.data.temperature / 340.0 + 36.53;
+}
+
+
 boolean calibrateGyro() {
-  
-  int findZero[FINDZERO];
-  int diff = 0; 
-  for (byte axis = 0; axis < 3; axis++) {
-    for (int i=0; i<FINDZERO; i++) {
-      readMPU6000Sensors();
-      if(axis == XAXIS) {
-    	findZero[i] = MPU6000.data.gyro.x;
-      } 
-	  else if(axis == YAXIS) {
-    	findZero[i] = MPU6000.data.gyro.y;
-      } 
-	  else {
-    	findZero[i] = MPU6000.data.gyro.z;
-      }
-      delay(10);
+  startGyroCalibration();
+  for (int i = 0; i < GYRO_CALIBRATION_MAX_SAMPLES; i++) {
+    readMPU6000Sensors();
+    float sample[3];
+    sample[XAXIS] = MPU6000.data.gyro.x;
+    sample[YAXIS] = MPU6000.data.gyro.y;
+    sample[ZAXIS] = MPU6000.data.gyro.z;
+    if (updateGyroCalibration(sample, GYRO_CALIBRATION_TRESHOLD)) {
+      finishGyroCalibration(GYRO_CALIBRATION_TRESHOLD);
+      return true;
     }
-    int tmp = findMedianIntWithDiff(findZero, FINDZERO, &diff);
-	if (diff <= GYRO_CALIBRATION_TRESHOLD) { 
-	  gyroZero[axis] = tmp;
-	} 
-	else {
-		return false; //Calibration failed.
-	}
+    delay(5);
   }
-  return true;
+  return false;
 }
 
 #endif
@@ -185,7 +185,7 @@ void calculateHeading(float rollRate,            float pitchRate,      float yaw
   normalize();
   driftCorrection(longitudinalAccel, lateralAccel, verticalAccel, oneG, magX, magY);
   
-  trueNorthHeading =  atan2(dcmMatrix[3], dcmMatrix[0]);
+  trueNorthHeading =  fastAtan2(dcmMatrix[3], dcmMatrix[0]);
   #if defined UseGPS
     if( compassDeclination != 0.0 ) {
 	
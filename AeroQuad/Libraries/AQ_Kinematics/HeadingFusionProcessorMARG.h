@@ -124,9 +124,9 @@ void headingUpdate(float gx, float gy, float gz, float ax, float ay, float az, f
   
 void headingEulerAngles()
 {
-  headingAngle[XAXIS] = atan2(2 * (lq0*lq1 + lq2*lq3), 1 - 2 *(lq1*lq1 + lq2*lq2));
-  headingAngle[YAXIS] = asin(2 * (lq0*lq2 - lq1*lq3));
-  headingAngle[ZAXIS] = atan2(2 * (lq0*lq3 + lq1*lq2), 1 - 2 *(lq2*lq2 + lq3*lq3));
+  headingAngle[XAXIS] = fastAtan2(2 * (lq0*lq1 + lq2*lq3), 1 - 2 *(lq1*lq1 + lq2*lq2));
+  headingAngle[YAXIS] = fastAsin(2 * (lq0*lq2 - lq1*lq3));
+  headingAngle[ZAXIS] = fastAtan2(2 * (lq0*lq3 + lq1*lq2), 1 - 2 *(lq2*lq2 + lq3*lq3));
 }
 
 void initializeBaseHeadingParam(float rollAngle, float pitchAngle, float yawAngle) {
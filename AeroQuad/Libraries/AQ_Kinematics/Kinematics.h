@@ -22,6 +22,7 @@
 #define _AQ_KINEMATICS_
 
 #include "GlobalDefined.h"
+#include "FastTrig.h"
 
 #define CF 0
 #define KF 1
@@ -38,6 +39,16 @@ float earthAccel[3] = {0.0,0.0,0.0};
 
 float accelCutoff = 0.0;
 
+// sin and cos of the roll and pitch kinematicsAngle, refreshed with them
+// once per control loop pass for every other consumer of the attitude
+float kinematicsSinAngle[2] = {0.0,0.0};
+float kinematicsCosAngle[2] = {1.0,1.0};
+
+void updateKinematicsTrig() {
+  fastSinCos(kinematicsAngle[XAXIS], &kinematicsSinAngle[XAXIS], &kinematicsCosAngle[XAXIS]);
+  fastSinCos(kinematicsAngle[YAXIS], &kinematicsSinAngle[YAXIS], &kinematicsCosAngle[YAXIS]);
+}
+
 void initializeBaseKinematicsParam() {
 
   for (byte axis = XAXIS; axis <= ZAXIS; axis++) {
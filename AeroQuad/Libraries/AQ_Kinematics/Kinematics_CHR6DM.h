@@ -46,6 +46,7 @@ void calculateKinematics(float rollRate,           float pitchRate,     float ya
   kinematicsAngle[YAXIS] =  kinematicsChr6dm->data.pitch - zeroPitch;
   CHR_RollAngle = kinematicsAngle[XAXIS]; //ugly since gotta access through accel class
   CHR_PitchAngle = kinematicsAngle[YAXIS];
+  updateKinematicsTrig();
 }
   
  void calibrateKinematics() {
@@ -157,9 +157,10 @@ void margUpdate(float gx, float gy, float gz, float ax, float ay, float az, floa
   
 void eulerAngles(void)
 {
-  kinematicsAngle[XAXIS]  = atan2(2 * (q0*q1 + q2*q3), 1 - 2 *(q1*q1 + q2*q2));
-  kinematicsAngle[YAXIS] = asin(2 * (q0*q2 - q1*q3));
-  trueNorthHeading = kinematicsAngle[ZAXIS]   = atan2(2 * (q0*q3 + q1*q2), 1 - 2 *(q2*q2 + q3*q3));
+  kinematicsAngle[XAXIS]  = fastAtan2(2 * (q0*q1 + q2*q3), 1 - 2 *(q1*q1 + q2*q2));
+  kinematicsAngle[YAXIS] = fastAsin(2 * (q0*q2 - q1*q3));
+  trueNorthHeading = kinematicsAngle[ZAXIS]   = fastAtan2(2 * (q0*q3 + q1*q2), 1 - 2 *(q2*q2 + q3*q3));
+  updateKinematicsTrig();
 }
 
   
@@ -0,0 +1,171 @@
+#!/usr/bin/env python
+#
+#  AeroQuad v3.2 - magnetic declination table generator
+#  www.AeroQuad.com
+#  An Open Source Arduino based multicopter.
+#
+#  This program is free software: you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published by
+#  the Free Software Foundation, either version 3 of the License, or
+#  (at your option) any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program. If not, see <http://www.gnu.org/licenses/>.
+#
+#  Builds MagnetometerDeclinationData.h from a 5 degree declination grid.
+#
+#  Input is a text file with one "latitude,longitude,declination" triple
+#  per line, in degrees, covering latitude -90..90 and longitude -180..180
+#  in 5 degree steps (37 x 73 points). Lines starting with '#' are ignored.
+#  Any WMM calculator can produce it, e.g. NOAA's grid calculator with a
+#  5 degree step, keeping only those three columns.
+#
+#  usage: generate_declination_db.py <grid.csv> <epoch> [output.h]
+#
+
+import sys
+
+LAT_ROWS = 37
+LON_COLS = 73
+
+# Rows kept uncompressed, they must match the exception test in
+# getLookupValue() of MagnetometerDeclinationDB.h
+FIRST_COMPRESSED_ROW = 7
+LAST_COMPRESSED_ROW = 33
+
+MAX_ABS_OFFSET = 15
+MAX_REPEATS = 7
+
+
+def read_grid(path):
+    grid = [[None] * LON_COLS for _ in range(LAT_ROWS)]
+    for line in open(path):
+        line = line.strip()
+        if not line or line.startswith('#'):
+            continue
+        lat, lon, dec = [float(v) for v in line.split(',')[:3]]
+        x = int(round((lat + 90) / 5))
+        y = int(round((lon + 180) / 5))
+        if 0 <= x < LAT_ROWS and 0 <= y < LON_COLS:
+            grid[x][y] = int(round(dec))
+    for x in range(LAT_ROWS):
+        for y in range(LON_COLS):
+            if grid[x][y] is None:
+                sys.exit('missing grid point lat %d lon %d' % (x * 5 - 90, y * 5 - 180))
+    return grid
+
+
+def encode_row(x, row):
+    # The decoder adds one offset per virtual index starting at index 0,
+    # so the first delta is always the row start to itself
+    deltas = [0] + [row[y] - row[y - 1] for y in range(1, LON_COLS)]
+
+    # The decoder holds the last value once a row runs out of entries
+    while len(deltas) > 1 and deltas[-1] == 0:
+        deltas.pop()
+
+    entries = []
+    for d in deltas:
+        if abs(d) > MAX_ABS_OFFSET:
+            sys.exit('row lat %d has a %d degree step, too large to compress' % (x * 5 - 90, d))
+        if entries and entries[-1][0] == d and entries[-1][1] < MAX_REPEATS:
+            entries[-1][1] += 1
+        else:
+            entries.append([d, 0])
+    return [(abs(d), 1 if d < 0 else 0, r) for d, r in entries]
+
+
+def exception_rows():
+    return list(range(0, FIRST_COMPRESSED_ROW)) + list(range(LAST_COMPRESSED_ROW + 1, LAT_ROWS))
+
+
+def generate(grid, epoch, out):
+    exceptions = [grid[x] for x in exception_rows()]
+    signs = []
+    for row in exceptions:
+        bits = [0] * 10
+        for y, v in enumerate(row):
+            if v < 0:
+                bits[y // 8] |= 0x80 >> (y % 8)
+        signs.append(bits)
+
+    starts = []
+    lengths = []
+    offsets = []
+    values = []
+    index = 0
+    for x in range(FIRST_COMPRESSED_ROW, LAST_COMPRESSED_ROW + 1):
+        if not -128 <= grid[x][0] <= 127:
+            sys.exit('row start for lat %d out of range' % (x * 5 - 90))
+        row = encode_row(x, grid[x])
+        starts.append(grid[x][0])
+        lengths.append(len(row))
+        offsets.append(index)
+        values.append(row)
+        index += len(row)
+    flat = sum(values, [])
+
+    w = out.write
+    w('/*\n')
+    w('  AeroQuad v3.2 - magnetic declination data\n')
+    w('  www.AeroQuad.com\n')
+    w('  An Open Source Arduino based multicopter.\n')
+    w(' \n')
+    w('  This program is free software: you can redistribute it and/or modify \n')
+    w('  it under the terms of the GNU General Public License as published by \n')
+    w('  the Free Software Foundation, either version 3 of the License, or \n')
+    w('  (at your option) any later version. \n')
+    w('\n')
+    w('  This program is distributed in the hope that it will be useful, \n')
+    w('  but WITHOUT ANY WARRANTY; without even the implied warranty of \n')
+    w('  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the \n')
+    w('  GNU General Public License for more details. \n')
+    w('\n')
+    w('  You should have received a copy of the GNU General Public License \n')
+    w('  along with this program. If not, see <http://www.gnu.org/licenses/>. \n')
+    w('*/\n')
+    w('\n')
+    w('// Generated by Tools/generate_declination_db.py, do not edit by hand\n')
+    w('\n')
+    w('#ifndef _AQ_DECLINATION_DATA_\n')
+    w('#define _AQ_DECLINATION_DATA_\n')
+    w('\n')
+    w('#define MAG_DECLINATION_DB_EPOCH %s\n' % epoch)
+    w('\n')
+    w('// %d bytes\n' % (len(exceptions) * LON_COLS))
+    w('static const uint8_t exceptions[%d][%d] MAGDB_PROGMEM = { \n' % (len(exceptions), LON_COLS))
+    w(', \n'.join('  {%s}' % ','.join(str(abs(v)) for v in row) for row in exceptions))
+    w(' \n};\n\n')
+    w('// %d bytes\n' % (len(signs) * 10))
+    w('static const uint8_t exception_signs[%d][10] MAGDB_PROGMEM = { \n' % len(signs))
+    w(', \n'.join('  {%s}' % ','.join(str(b) for b in row) for row in signs))
+    w(' \n};\n\n')
+    w('// %d bytes\n' % (len(starts) * 2))
+    w('static const int8_t declination_keys[2][%d] MAGDB_PROGMEM = \n' % len(starts))
+    w('{ \n')
+    w('  // Row start values\n')
+    w('  {%s}, \n' % ','.join(str(v) for v in starts))
+    w('  // Row length values\n')
+    w('  {%s} \n' % ','.join(str(v) for v in lengths))
+    w('};\n\n')
+    w('// %d bytes, index of the first declination_values entry of each row\n' % (len(offsets) * 2))
+    w('static const uint16_t declination_row_offsets[%d] MAGDB_PROGMEM = \n' % len(offsets))
+    w('  {%s};\n\n' % ','.join(str(v) for v in offsets))
+    w('// %d total values @ 1 byte each = %d bytes\n' % (len(flat), len(flat)))
+    w('static const row_value declination_values[] MAGDB_PROGMEM = { \n')
+    w(', \n'.join('  %s' % ','.join('{%d,%d,%d}' % e for e in row) for row in values))
+    w(' \n};\n\n')
+    w('#endif\n')
+
+
+if __name__ == '__main__':
+    if len(sys.argv) < 3:
+        sys.exit('usage: %s <grid.csv> <epoch> [output.h]' % sys.argv[0])
+    grid = read_grid(sys.argv[1])
+    out = open(sys.argv[3], 'w') if len(sys.argv) > 3 else sys.stdout
+    generate(grid, sys.argv[2], out)
@@ -0,0 +1,297 @@
+/*
+  AeroQuad v3.2 - Gyro vibration spectrum and dynamic notch filters
+  www.AeroQuad.com
+  Copyright (c) 2012 Ted Carancho.  All rights reserved.
+  An Open Source Arduino based multicopter.
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Vibration spectrum of the gyros and notch filters that follow its peaks
+//
+// Every control loop gyro sample is Hann windowed and fed to one Goertzel
+// resonator per spectrum bin, VIBRATION_BLOCK_SIZE samples make a spectrum.
+// The work is the same every loop, the end of a block only stores the bin
+// powers and the peak search of each axis runs on one of the next loops.
+// Bins go from VIBRATION_MIN_FREQUENCY to below half CONTROL_LOOP_RATE.
+// Faster vibration is aliased by the sampling and is tracked where it
+// lands, which is also where the PIDs see it.
+//
+// The VIBRATION_NOTCHES strongest peaks of each axis standing
+// VIBRATION_PEAK_RATIO above the mean power of the other bins, and above
+// VIBRATION_MIN_AMPLITUDE, are located between the bins and a biquad notch
+// is moved onto each, a notch keeps to the peak nearest to it. A notch
+// whose peak is gone for VIBRATION_NOTCH_HOLD spectra passes the gyro
+// through unchanged.
+
+#ifndef _AQ_DYNAMIC_NOTCH_H_
+#define _AQ_DYNAMIC_NOTCH_H_
+
+#include "Arduino.h"
+#include "FastTrig.h"
+#include "DynamicNotchLayout.h"
+
+#define VIBRATION_PEAK_RATIO 10.0         // peak over the mean power of the bins away from peaks
+#define VIBRATION_MIN_AMPLITUDE 0.02      // rad/s, weaker peaks are left alone
+#define VIBRATION_PEAK_SPACING 3          // bins at least between two tracked peaks
+#define VIBRATION_NOTCH_Q 3.0             // notch center frequency over its -3dB width
+#define VIBRATION_NOTCH_HOLD 4            // spectra a notch waits for its peak to come back
+#define VIBRATION_TRACKING 0.8            // share of the distance to its peak a notch moves per spectrum
+
+struct BiquadFilter {
+  float b0, b1, b2, a1, a2;
+  float x1, x2, y1, y2;
+};
+
+struct VibrationNotch {
+  struct BiquadFilter filter;
+  float frequency;                        // Hz, 0 while passing through
+  byte missed;                            // spectra since its peak was last seen
+};
+
+struct VibrationSpectrum {
+  float goertzel[3][VIBRATION_BINS][2];
+  float power[3][VIBRATION_BINS];         // of the last complete block
+  byte sample;                            // in the block being taken
+  unsigned long spectra;
+} vibrationSpectrum;
+
+float vibrationWindow[VIBRATION_BLOCK_SIZE / 2 + 1];
+float vibrationBinCoefficient[VIBRATION_BINS];
+struct VibrationNotch vibrationNotch[3][VIBRATION_NOTCHES];
+
+void setPassThroughBiquad(struct BiquadFilter *filter) {
+  filter->b0 = 1.0;
+  filter->b1 = 0.0;
+  filter->b2 = 0.0;
+  filter->a1 = 0.0;
+  filter->a2 = 0.0;
+}
+
+// RBJ cookbook notch, the delay line is kept so it can be moved while running
+void setNotchBiquad(struct BiquadFilter *filter, float frequency, float q, float sampleRate) {
+  float sinW, cosW;
+  fastSinCos(2.0 * FAST_TRIG_PI * frequency / sampleRate, &sinW, &cosW);
+  const float alpha = sinW / (2.0 * q);
+  const float a0 = 1.0 + alpha;
+  filter->b0 = 1.0 / a0;
+  filter->b1 = -2.0 * cosW / a0;
+  filter->b2 = filter->b0;
+  filter->a1 = filter->b1;
+  filter->a2 = (1.0 - alpha) / a0;
+}
+
+void resetBiquad(struct BiquadFilter *filter) {
+  filter->x1 = 0.0;
+  filter->x2 = 0.0;
+  filter->y1 = 0.0;
+  filter->y2 = 0.0;
+}
+
+// Direct form I, it takes coefficient changes without a jump
+float computeBiquad(float input, struct BiquadFilter *filter) {
+  const float output = filter->b0 * input + filter->b1 * filter->x1 + filter->b2 * filter->x2
+                     - filter->a1 * filter->y1 - filter->a2 * filter->y2;
+  filter->x2 = filter->x1;
+  filter->x1 = input;
+  filter->y2 = filter->y1;
+  filter->y1 = output;
+  return output;
+}
+
+float vibrationBinFrequency(float bin) {
+  return (VIBRATION_FIRST_BIN + bin) * (float)CONTROL_LOOP_RATE / VIBRATION_BLOCK_SIZE;
+}
+
+// Amplitude of a sine in the bin, in gyro units
+float vibrationAmplitude(byte axis, byte bin) {
+  // the Hann window halves the sum a sine of amplitude A leaves, A * N / 4
+  return sqrt(vibrationSpectrum.power[axis][bin]) * (4.0 / VIBRATION_BLOCK_SIZE);
+}
+
+void initializeDynamicNotch() {
+  for (byte n = 0; n <= VIBRATION_BLOCK_SIZE / 2; n++) {
+    vibrationWindow[n] = 0.5 - 0.5 * cos(2.0 * M_PI * n / VIBRATION_BLOCK_SIZE);
+  }
+  for (byte bin = 0; bin < VIBRATION_BINS; bin++) {
+    vibrationBinCoefficient[bin] = 2.0 * cos(2.0 * M_PI * (VIBRATION_FIRST_BIN + bin) / VIBRATION_BLOCK_SIZE);
+  }
+  for (byte axis = 0; axis < 3; axis++) {
+    for (byte bin = 0; bin < VIBRATION_BINS; bin++) {
+      vibrationSpectrum.goertzel[axis][bin][0] = 0.0;
+      vibrationSpectrum.goertzel[axis][bin][1] = 0.0;
+      vibrationSpectrum.power[axis][bin] = 0.0;
+    }
+    for (byte notch = 0; notch < VIBRATION_NOTCHES; notch++) {
+      setPassThroughBiquad(&vibrationNotch[axis][notch].filter);
+      resetBiquad(&vibrationNotch[axis][notch].filter);
+      vibrationNotch[axis][notch].frequency = 0.0;
+      vibrationNotch[axis][notch].missed = VIBRATION_NOTCH_HOLD;
+    }
+  }
+  vibrationSpectrum.sample = 0;
+  vibrationSpectrum.spectra = 0;
+}
+
+// Within VIBRATION_PEAK_SPACING bins of a peak already found
+boolean isNearVibrationPeak(int bin, const int *found, byte foundCount) {
+  for (byte i = 0; i < foundCount; i++) {
+    if (abs(bin - found[i]) < VIBRATION_PEAK_SPACING) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * Finds the strongest bin of the axis at least VIBRATION_PEAK_SPACING bins
+ * from the peaks already found, returns its frequency between the bins or 0
+ * when it does not stand VIBRATION_PEAK_RATIO above the mean of the bins
+ * away from the peaks, or is below minPower, the bin is added to found
+ */
+float findVibrationPeak(byte axis, int *found, byte foundCount, float minPower) {
+  const float *power = vibrationSpectrum.power[axis];
+  int best = -1;
+  for (int bin = 0; bin < VIBRATION_BINS; bin++) {
+    if (!isNearVibrationPeak(bin, found, foundCount) && (best < 0 || power[bin] > power[best])) {
+      best = bin;
+    }
+  }
+  if (best < 0 || power[best] <= minPower) {
+    return 0.0;
+  }
+  found[foundCount] = best;
+
+  float floorPower = 0.0;
+  byte floorBins = 0;
+  for (int bin = 0; bin < VIBRATION_BINS; bin++) {
+    if (!isNearVibrationPeak(bin, found, foundCount + 1)) {
+      floorPower += power[bin];
+      floorBins++;
+    }
+  }
+  if (power[best] <= VIBRATION_PEAK_RATIO * floorPower / max(floorBins, 1)) {
+    return 0.0;
+  }
+
+  // parabola through the log powers of the peak and its neighbours, exact
+  // for a Gaussian and within a few hundredths of a bin for the Hann window
+  float offset = 0.0;
+  if (best > 0 && best < VIBRATION_BINS - 1 && power[best - 1] > 0.0 && power[best + 1] > 0.0) {
+    const float left = log(power[best - 1]);
+    const float center = log(power[best]);
+    const float right = log(power[best + 1]);
+    const float curvature = left - 2.0 * center + right;
+    if (curvature < 0.0) {
+      offset = constrain(0.5 * (left - right) / curvature, -0.5, 0.5);
+    }
+  }
+  return vibrationBinFrequency(best + offset);
+}
+
+void updateVibrationNotches(byte axis) {
+  // the power a sine of the minimum amplitude leaves in its bin
+  const float minPower = VIBRATION_MIN_AMPLITUDE * VIBRATION_MIN_AMPLITUDE * (VIBRATION_BLOCK_SIZE * VIBRATION_BLOCK_SIZE / 16.0);
+
+  int found[VIBRATION_NOTCHES];
+  boolean assigned[VIBRATION_NOTCHES];
+  for (byte notch = 0; notch < VIBRATION_NOTCHES; notch++) {
+    assigned[notch] = false;
+  }
+  const float binWidth = (float)CONTROL_LOOP_RATE / VIBRATION_BLOCK_SIZE;
+
+  // strongest peak first, each to the closest running notch or else a free one
+  for (byte peak = 0; peak < VIBRATION_NOTCHES; peak++) {
+    const float frequency = findVibrationPeak(axis, found, peak, minPower);
+    if (frequency == 0.0) {
+      break;
+    }
+    int closest = -1;
+    float closestDistance = 0.0;
+    for (byte notch = 0; notch < VIBRATION_NOTCHES; notch++) {
+      if (assigned[notch]) {
+        continue;
+      }
+      const float distance = (vibrationNotch[axis][notch].frequency == 0.0) ?
+                             (float)CONTROL_LOOP_RATE : fabs(vibrationNotch[axis][notch].frequency - frequency);
+      if (closest < 0 || distance < closestDistance) {
+        closest = notch;
+        closestDistance = distance;
+      }
+    }
+    struct VibrationNotch *notch = &vibrationNotch[axis][closest];
+    assigned[closest] = true;
+    if (closestDistance > VIBRATION_PEAK_SPACING * binWidth) {
+      notch->frequency = frequency;       // new peak, or the old one jumped
+    }
+    else {
+      notch->frequency += VIBRATION_TRACKING * (frequency - notch->frequency);
+    }
+    notch->missed = 0;
+    setNotchBiquad(&notch->filter, notch->frequency, VIBRATION_NOTCH_Q, CONTROL_LOOP_RATE);
+  }
+
+  for (byte notch = 0; notch < VIBRATION_NOTCHES; notch++) {
+    if (!assigned[notch] && vibrationNotch[axis][notch].frequency != 0.0) {
+      if (++vibrationNotch[axis][notch].missed >= VIBRATION_NOTCH_HOLD) {
+        vibrationNotch[axis][notch].frequency = 0.0;
+        setPassThroughBiquad(&vibrationNotch[axis][notch].filter);
+      }
+    }
+  }
+}
+
+/**
+ * Adds the gyro sample of this control loop to the spectrum and replaces
+ * it by its notch filtered value
+ */
+void computeDynamicNotch(float *gyro) {
+  const byte n = vibrationSpectrum.sample;
+  const float window = vibrationWindow[n <= VIBRATION_BLOCK_SIZE / 2 ? n : VIBRATION_BLOCK_SIZE - n];
+
+  // the peaks of the block just taken, one axis per loop
+  if (n < 3 && vibrationSpectrum.spectra > 0) {
+    updateVibrationNotches(n);
+  }
+
+  for (byte axis = 0; axis < 3; axis++) {
+    const float windowed = gyro[axis] * window;
+    float (*state)[2] = vibrationSpectrum.goertzel[axis];
+    for (byte bin = 0; bin < VIBRATION_BINS; bin++) {
+      const float s = windowed + vibrationBinCoefficient[bin] * state[bin][0] - state[bin][1];
+      state[bin][1] = state[bin][0];
+      state[bin][0] = s;
+    }
+
+    for (byte notch = 0; notch < VIBRATION_NOTCHES; notch++) {
+      gyro[axis] = computeBiquad(gyro[axis], &vibrationNotch[axis][notch].filter);
+    }
+  }
+
+  if (++vibrationSpectrum.sample == VIBRATION_BLOCK_SIZE) {
+    for (byte axis = 0; axis < 3; axis++) {
+      for (byte bin = 0; bin < VIBRATION_BINS; bin++) {
+        float *state = vibrationSpectrum.goertzel[axis][bin];
+        vibrationSpectrum.power[axis][bin] = state[0] * state[0] + state[1] * state[1]
+                                           - vibrationBinCoefficient[bin] * state[0] * state[1];
+        state[0] = 0.0;
+        state[1] = 0.0;
+      }
+    }
+    vibrationSpectrum.sample = 0;
+    vibrationSpectrum.spectra++;
+  }
+}
+
+#endif
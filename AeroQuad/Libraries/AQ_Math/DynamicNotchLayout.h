@@ -0,0 +1,41 @@
+/*
+  AeroQuad v3.2 - Gyro vibration spectrum layout
+  www.AeroQuad.com
+  Copyright (c) 2012 Ted Carancho.  All rights reserved.
+  An Open Source Arduino based multicopter.
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Size of the spectrum of DynamicNotch.h, apart from it so the '0' query
+// of SerialCom.h sends as many values without DynamicNotch
+
+#ifndef _AQ_DYNAMIC_NOTCH_LAYOUT_H_
+#define _AQ_DYNAMIC_NOTCH_LAYOUT_H_
+
+#ifndef VIBRATION_MIN_FREQUENCY
+  #define VIBRATION_MIN_FREQUENCY 30      // Hz, lowest bin, above what the craft itself does
+#endif
+#ifndef VIBRATION_NOTCHES
+  #define VIBRATION_NOTCHES 2             // tracked peaks per axis
+#endif
+
+#define VIBRATION_BLOCK_SIZE 64           // samples per spectrum
+#define VIBRATION_FIRST_BIN ((VIBRATION_MIN_FREQUENCY * VIBRATION_BLOCK_SIZE + CONTROL_LOOP_RATE - 1) / CONTROL_LOOP_RATE)
+#define VIBRATION_BINS (VIBRATION_BLOCK_SIZE / 2 - VIBRATION_FIRST_BIN)
+
+// bin count, first bin and bin spacing, then notches and bins of each axis
+#define VIBRATION_REPORT_FIELDS (3 + 3 * (VIBRATION_NOTCHES + VIBRATION_BINS))
+
+#endif
@@ -0,0 +1,95 @@
+/*
+  AeroQuad v3.0.1 - February 2012
+  www.AeroQuad.com
+  Copyright (c) 2012 Ted Carancho.  All rights reserved.
+  An Open Source Arduino based multicopter.
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+// Times the libm functions against FastTrig.h on the board it runs on and
+// reports the largest error seen, results go to the serial port at 115200
+
+#include <GlobalDefined.h>
+#include <AQMath.h>
+#include <FastTrig.h>
+
+#define SAMPLES 1000
+
+volatile float sink;  // keeps the compiler from dropping the loops
+
+unsigned long timeLoop(byte function, boolean fast) {
+  const unsigned long start = micros();
+  for (int i = 0; i < SAMPLES; i++) {
+    const float x = (i - SAMPLES / 2) * (2.0 / SAMPLES);  // -1 to 1
+    float s, c;
+    switch (function) {
+    case 0:
+      if (fast) { fastSinCos(x * 3.0, &s, &c); } else { s = sin(x * 3.0); c = cos(x * 3.0); }
+      sink = s + c;
+      break;
+    case 1:
+      sink = fast ? fastAtan2(x, 0.5) : atan2(x, 0.5);
+      break;
+    case 2:
+      sink = fast ? fastAsin(x) : asin(x);
+      break;
+    }
+  }
+  return micros() - start;
+}
+
+float maxError(byte function) {
+  float error = 0.0;
+  for (int i = 0; i < SAMPLES; i++) {
+    const float x = (i - SAMPLES / 2) * (2.0 / SAMPLES);
+    float s, c;
+    switch (function) {
+    case 0:
+      fastSinCos(x * 3.0, &s, &c);
+      error = max(error, max(fabs(s - sin(x * 3.0)), fabs(c - cos(x * 3.0))));
+      break;
+    case 1:
+      error = max(error, fabs(fastAtan2(x, 0.5) - atan2(x, 0.5)));
+      break;
+    case 2:
+      error = max(error, fabs(fastAsin(x) - asin(x)));
+      break;
+    }
+  }
+  return error;
+}
+
+void setup() {
+  Serial.begin(115200);
+  Serial.println("FastTrig library test");
+}
+
+void loop() {
+  const char *names[] = {"sin+cos", "atan2", "asin"};
+  for (byte function = 0; function < 3; function++) {
+    const unsigned long libm = timeLoop(function, false);
+    const unsigned long fast = timeLoop(function, true);
+    Serial.print(names[function]);
+    Serial.print(" libm us: ");
+    Serial.print((float)libm / SAMPLES);
+    Serial.print(" fast us: ");
+    Serial.print((float)fast / SAMPLES);
+    Serial.print(" max error: ");
+    Serial.println(maxError(function), 7);
+  }
+  Serial.println();
+  delay(2000);
+}
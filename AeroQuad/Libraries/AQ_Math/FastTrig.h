@@ -0,0 +1,123 @@
+/*
+  AeroQuad v3.0.1 - February 2012
+  www.AeroQuad.com
+  Copyright (c) 2012 Ted Carancho.  All rights reserved.
+  An Open Source Arduino based multicopter.
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+// Single precision sin, cos, atan2 and asin for the flight loop
+//
+// Polynomials from Abramowitz and Stegun, evaluated in float with float
+// constants so the STM32 FPU is used and no double code is pulled in.
+// Largest absolute errors measured against the double libm, inputs in
+// radians:
+//   fastSin, fastCos, fastSinCos   |x| <= 100     1.7e-7
+//   fastAtan2                      any quadrant   1.2e-5
+//   fastAsin                       [-1, 1]        2.9e-7
+// Other than arctan2() in AQMath.h (0.07 rad) these are accurate enough
+// for the attitude and heading themselves, not only for corrections.
+
+#ifndef _AQ_FAST_TRIG_H_
+#define _AQ_FAST_TRIG_H_
+
+#include "Arduino.h"
+
+#define FAST_TRIG_PI 3.14159265f
+#define FAST_TRIG_HALF_PI 1.57079633f
+#define FAST_TRIG_INV_PI 0.318309886f
+// pi split in two so x - k * pi stays exact for the first part
+#define FAST_TRIG_PI_A 3.140625f
+#define FAST_TRIG_PI_B 9.67653589793e-4f
+
+// A&S 4.3.97 and 4.3.99, |x| <= pi/2, error 2e-9 before float rounding
+float fastSinPolynomial(float x) {
+  const float x2 = x * x;
+  return x * (1.0f + x2 * (-0.1666666664f + x2 * (0.0083333315f + x2 * (-0.0001984090f + x2 * (0.0000027526f - x2 * 0.0000000239f)))));
+}
+
+float fastCosPolynomial(float x) {
+  const float x2 = x * x;
+  return 1.0f + x2 * (-0.4999999963f + x2 * (0.0416666418f + x2 * (-0.0013888397f + x2 * (0.0000247609f - x2 * 0.0000002605f))));
+}
+
+/**
+ * Brings x into [-pi/2, pi/2], returns true if the result has to be negated
+ */
+boolean fastTrigReduce(float *x) {
+  const float turns = *x * FAST_TRIG_INV_PI;
+  const long k = (long)(turns >= 0.0f ? turns + 0.5f : turns - 0.5f);
+  *x = (*x - k * FAST_TRIG_PI_A) - k * FAST_TRIG_PI_B;
+  return (k & 1) != 0;
+}
+
+float fastSin(float x) {
+  const boolean negate = fastTrigReduce(&x);
+  const float result = fastSinPolynomial(x);
+  return negate ? -result : result;
+}
+
+float fastCos(float x) {
+  const boolean negate = fastTrigReduce(&x);
+  const float result = fastCosPolynomial(x);
+  return negate ? -result : result;
+}
+
+void fastSinCos(float x, float *sinX, float *cosX) {
+  const boolean negate = fastTrigReduce(&x);
+  *sinX = fastSinPolynomial(x);
+  *cosX = fastCosPolynomial(x);
+  if (negate) {
+    *sinX = -*sinX;
+    *cosX = -*cosX;
+  }
+}
+
+// A&S 4.4.47, |x| <= 1, error 1e-5
+float fastAtanPolynomial(float x) {
+  const float x2 = x * x;
+  return x * (0.9998660f + x2 * (-0.3302995f + x2 * (0.1801410f + x2 * (-0.0851330f + x2 * 0.0208351f))));
+}
+
+float fastAtan2(float y, float x) {
+  const float absX = x < 0.0f ? -x : x;
+  const float absY = y < 0.0f ? -y : y;
+  if (absX == 0.0f && absY == 0.0f) {
+    return 0.0f;
+  }
+  float angle;
+  if (absY <= absX) {
+    angle = fastAtanPolynomial(absY / absX);
+  }
+  else {
+    angle = FAST_TRIG_HALF_PI - fastAtanPolynomial(absX / absY);
+  }
+  if (x < 0.0f) {
+    angle = FAST_TRIG_PI - angle;
+  }
+  return y < 0.0f ? -angle : angle;
+}
+
+// A&S 4.4.46, error 2e-8, arguments outside [-1, 1] are clipped
+float fastAsin(float x) {
+  const float absX = min(x < 0.0f ? -x : x, 1.0f);
+  const float angle = FAST_TRIG_HALF_PI - sqrt(1.0f - absX) *
+    (1.5707963050f + absX * (-0.2145988016f + absX * (0.0889789874f + absX * (-0.0501743046f +
+     absX * (0.0308918810f + absX * (-0.0170881256f + absX * (0.0066700901f - absX * 0.0012624911f)))))));
+  return x < 0.0f ? -angle : angle;
+}
+
+#endif
@@ -37,17 +37,54 @@ struct fourthOrderData
 
 float computeFourthOrder(float currentInput, struct fourthOrderData *filterParameters)
 {
-  // cheby2(4,60,12.5/50)
-  #define _b0  0.001893594048567
-  #define _b1 -0.002220262954039
-  #define _b2  0.003389066536478
-  #define _b3 -0.002220262954039
-  #define _b4  0.001893594048567
+  // cheby2(4,60,12.5/(CONTROL_LOOP_RATE/2)), 12.5Hz stop band edge whatever the loop rate
+  // keep these double, rounded to single precision the poles move enough above 200Hz to shift the DC gain by percents
+  #if CONTROL_LOOP_RATE == 200
+    #define _b0  0.001139392787073
+    #define _b1 -0.003386240693441
+    #define _b2  0.004665482032666
+    #define _b3 -0.003386240693441
+    #define _b4  0.001139392787073
+
+    #define _a1 -3.692341608388113
+    #define _a2  5.123502002652342
+    #define _a3 -3.165946995349395
+    #define _a4  0.734958387305096
+  #elif CONTROL_LOOP_RATE == 400
+    #define _b0  0.000999173892890
+    #define _b1 -0.003703491400070
+    #define _b2  0.005419795463787
+    #define _b3 -0.003703491400070
+    #define _b4  0.000999173892890
+
+    #define _a1 -3.847503931136012
+    #define _a2  5.554035799676971
+    #define _a3 -3.565053513491903
+    #define _a4  0.858532805400371
+  #elif CONTROL_LOOP_RATE == 500
+    #define _b0  0.000987786751039
+    #define _b1 -0.003762348901931
+    #define _b2  0.005553744695291
+    #define _b3 -0.003762348901931
+    #define _b4  0.000987786751039
+
+    #define _a1 -3.878129734998889
+    #define _a2  5.641762572815878
+    #define _a3 -3.648875955419100
+    #define _a4  0.885247737995617
+  #else
+    // cheby2(4,60,12.5/50)
+    #define _b0  0.001893594048567
+    #define _b1 -0.002220262954039
+    #define _b2  0.003389066536478
+    #define _b3 -0.002220262954039
+    #define _b4  0.001893594048567
   
-  #define _a1 -3.362256889209355
-  #define _a2  4.282608240117919
-  #define _a3 -2.444765517272841
-  #define _a4  0.527149895089809
+    #define _a1 -3.362256889209355
+    #define _a2  4.282608240117919
+    #define _a3 -2.444765517272841
+    #define _a4  0.527149895089809
+  #endif
   
   float output;
   
@@ -0,0 +1,207 @@
+/*
+  AeroQuad v3.2 - Number to text formatting
+  www.AeroQuad.com
+  Copyright (c) 2012 Ted Carancho.  All rights reserved.
+  An Open Source Arduino based multicopter.
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Integers and floats written as text into a buffer without floating point
+//
+// Each function writes at buffer and returns the number of characters
+// written, no terminating 0 is added. Digits are produced two at a time
+// from a table, with 16 bit divisions once the value fits.
+//
+// formatFloat() gives the text of Print::print(value, digits) on AVR:
+// "nan", "inf", "ovf" beyond +-4294967040, otherwise the value rounded
+// half up to digits decimals. The rounding is done on the exact binary
+// value of the float with integers, where print() adds and multiplies in
+// floating point and is sometimes one in the last digit off. Up to 2
+// decimals only 32 bit arithmetic is used. The buffer must hold 21
+// characters for 9 decimals, 14 for 2.
+
+#ifndef _AQ_NUMBER_FORMAT_H_
+#define _AQ_NUMBER_FORMAT_H_
+
+#include "Arduino.h"
+#include <stdint.h>
+#include <string.h>
+
+#define NUMBER_FORMAT_MAX_DIGITS 9      // decimals formatFloat() writes at most
+
+#if defined(AeroQuadSTM32)
+  #define NUMBER_FORMAT_PROGMEM
+  #define numberFormatReadByte(address) (*(address))
+#else
+  #include <avr/pgmspace.h>
+  #define NUMBER_FORMAT_PROGMEM PROGMEM
+  #define numberFormatReadByte(address) pgm_read_byte(address)
+#endif
+
+const char numberFormatDigitPairs[201] NUMBER_FORMAT_PROGMEM =
+  "00010203040506070809"
+  "10111213141516171819"
+  "20212223242526272829"
+  "30313233343536373839"
+  "40414243444546474849"
+  "50515253545556575859"
+  "60616263646566676869"
+  "70717273747576777879"
+  "80818283848586878889"
+  "90919293949596979899";
+
+const unsigned long numberFormatPowersOfTen[NUMBER_FORMAT_MAX_DIGITS + 1] = {
+  1UL, 10UL, 100UL, 1000UL, 10000UL, 100000UL, 1000000UL, 10000000UL, 100000000UL, 1000000000UL
+};
+
+void formatDigitPair(char *text, byte pair) {
+  text[0] = numberFormatReadByte(&numberFormatDigitPairs[2 * pair]);
+  text[1] = numberFormatReadByte(&numberFormatDigitPairs[2 * pair + 1]);
+}
+
+/**
+ * Writes the digits of value backwards ending just before end, returns
+ * where they start
+ */
+char *formatDigitsBackward(char *end, unsigned long value) {
+  while (value >= 65536UL) {
+    const unsigned long quotient = value / 100;
+    end -= 2;
+    formatDigitPair(end, value - quotient * 100);
+    value = quotient;
+  }
+  unsigned int small = value;
+  while (small >= 100) {
+    const unsigned int quotient = small / 100;
+    end -= 2;
+    formatDigitPair(end, small - quotient * 100);
+    small = quotient;
+  }
+  if (small >= 10) {
+    end -= 2;
+    formatDigitPair(end, small);
+  }
+  else {
+    *--end = '0' + small;
+  }
+  return end;
+}
+
+// sign and digits right aligned to width, padded with spaces or zeros like %*ld and %0*ld
+byte formatAligned(char *buffer, boolean negative, unsigned long magnitude, byte width, char pad) {
+  char digits[10];
+  const char *start = formatDigitsBackward(digits + sizeof(digits), magnitude);
+  const byte count = digits + sizeof(digits) - start;
+  byte length = 0;
+  if (pad == '0') {
+    if (negative) {
+      buffer[length++] = '-';
+    }
+    while (length + count < width) {
+      buffer[length++] = '0';
+    }
+  }
+  else {
+    while (length + count + negative < width) {
+      buffer[length++] = ' ';
+    }
+    if (negative) {
+      buffer[length++] = '-';
+    }
+  }
+  for (byte i = 0; i < count; i++) {
+    buffer[length++] = start[i];
+  }
+  return length;
+}
+
+byte formatUnsigned(char *buffer, unsigned long value, byte width = 0, char pad = ' ') {
+  return formatAligned(buffer, false, value, width, pad);
+}
+
+byte formatInteger(char *buffer, long value, byte width = 0, char pad = ' ') {
+  // negated as unsigned so the most negative long has a magnitude too
+  return formatAligned(buffer, value < 0, value < 0 ? 0UL - (unsigned long)value : value, width, pad);
+}
+
+byte formatText(char *buffer, const char *text) {
+  byte length = 0;
+  while (text[length]) {
+    buffer[length] = text[length];
+    length++;
+  }
+  return length;
+}
+
+byte formatFloat(char *buffer, float value, byte digits) {
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(value));
+  const byte exponent = (bits >> 23) & 0xFF;
+  unsigned long mantissa = bits & 0x7FFFFFUL;
+
+  if (exponent == 0xFF) {
+    return formatText(buffer, mantissa ? "nan" : "inf");
+  }
+  if (exponent >= 127 + 32) {
+    return formatText(buffer, "ovf");     // 2^32 and beyond
+  }
+  if (digits > NUMBER_FORMAT_MAX_DIGITS) {
+    digits = NUMBER_FORMAT_MAX_DIGITS;
+  }
+
+  byte length = 0;
+  if ((bits & 0x80000000UL) && (bits & 0x7FFFFFFFUL)) {
+    buffer[length++] = '-';               // not for -0.0, which is not below 0
+  }
+
+  // value = mantissa / 2^shift
+  int shift = 149;
+  if (exponent != 0) {
+    mantissa |= 0x800000UL;
+    shift = 150 - exponent;
+  }
+  unsigned long integer;
+  unsigned long fraction = 0;
+  if (shift <= 0) {
+    integer = mantissa << -shift;
+  }
+  else {
+    integer = (shift < 32) ? mantissa >> shift : 0;
+    const unsigned long remainder = (shift < 32) ? mantissa & ((1UL << shift) - 1) : mantissa;
+    // remainder / 2^shift * 10^digits, rounded half up
+    if (digits <= 2) {
+      // below 2^24 * 100 + 2^30, and nothing below 0.005 is left beyond 31 bits
+      if (shift < 32) {
+        fraction = (remainder * numberFormatPowersOfTen[digits] + (1UL << (shift - 1))) >> shift;
+      }
+    }
+    else if (shift < 64) {
+      fraction = ((uint64_t)remainder * numberFormatPowersOfTen[digits] + (1ULL << (shift - 1))) >> shift;
+    }
+    if (fraction >= numberFormatPowersOfTen[digits]) {
+      fraction -= numberFormatPowersOfTen[digits];
+      integer++;
+    }
+  }
+
+  length += formatUnsigned(buffer + length, integer);
+  if (digits > 0) {
+    buffer[length++] = '.';
+    length += formatUnsigned(buffer + length, fraction, digits, '0');
+  }
+  return length;
+}
+
+#endif
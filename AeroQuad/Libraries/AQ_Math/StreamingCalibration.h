@@ -0,0 +1,119 @@
+/*
+  AeroQuad v3.0.1 - February 2012
+  www.AeroQuad.com
+  Copyright (c) 2012 Ted Carancho.  All rights reserved.
+  An Open Source Arduino based multicopter.
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Streaming mean and variance of a 3 axis sensor at rest (Welford)
+//
+// Replaces collecting a fixed number of samples and sorting them for the
+// median. Each sample updates the running mean and variance, a sample too
+// far from the mean is taken as motion and restarts the statistics, and the
+// caller can stop as soon as the standard error of the mean is small enough.
+
+#ifndef _AQ_STREAMING_CALIBRATION_H_
+#define _AQ_STREAMING_CALIBRATION_H_
+
+#include "Arduino.h"
+
+#define STREAMING_CALIBRATION_WARMUP 8  // samples before the motion test trusts the mean
+
+struct StreamingCalibration {
+  unsigned int count;
+  unsigned int restarts;
+  float mean[3];
+  float m2[3];
+};
+
+void initStreamingCalibration(struct StreamingCalibration *cal) {
+  cal->count = 0;
+  cal->restarts = 0;
+  for (byte axis = 0; axis < 3; axis++) {
+    cal->mean[axis] = 0.0;
+    cal->m2[axis] = 0.0;
+  }
+}
+
+/**
+ * Adds one sample, motionLimit is the largest distance from the running
+ * mean, in sample units, still considered noise
+ */
+void addStreamingCalibrationSample(struct StreamingCalibration *cal, const float *sample, float motionLimit) {
+  if (cal->count >= STREAMING_CALIBRATION_WARMUP) {
+    for (byte axis = 0; axis < 3; axis++) {
+      if (fabs(sample[axis] - cal->mean[axis]) > motionLimit) {
+        cal->count = 0;
+        cal->restarts++;
+        break;
+      }
+    }
+  }
+
+  cal->count++;
+  for (byte axis = 0; axis < 3; axis++) {
+    if (cal->count == 1) {
+      cal->mean[axis] = sample[axis];
+      cal->m2[axis] = 0.0;
+    }
+    else {
+      const float delta = sample[axis] - cal->mean[axis];
+      cal->mean[axis] += delta / cal->count;
+      cal->m2[axis] += delta * (sample[axis] - cal->mean[axis]);
+    }
+  }
+}
+
+float getStreamingCalibrationVariance(struct StreamingCalibration *cal, byte axis) {
+  if (cal->count < 2) {
+    return 0.0;
+  }
+  return cal->m2[axis] / (cal->count - 1);
+}
+
+/**
+ * True once there are minSamples since the last restart and the standard
+ * error of the mean is below maxError on every axis
+ */
+boolean isStreamingCalibrationDone(struct StreamingCalibration *cal, unsigned int minSamples, float maxError) {
+  if (cal->count < minSamples) {
+    return false;
+  }
+  for (byte axis = 0; axis < 3; axis++) {
+    if (getStreamingCalibrationVariance(cal, axis) > maxError * maxError * cal->count) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Stillness score, 100 for a noiseless sensor down to 0 when the
+ * noise reaches the motion limit
+ */
+byte getStreamingCalibrationQuality(struct StreamingCalibration *cal, float motionLimit) {
+  float variance = 0.0;
+  for (byte axis = 0; axis < 3; axis++) {
+    variance += getStreamingCalibrationVariance(cal, axis);
+  }
+  const float noise = sqrt(variance / 3.0);
+  if (noise >= motionLimit) {
+    return 0;
+  }
+  return (byte)(100.0 * (1.0 - noise / motionLimit));
+}
+
+#endif
@@ -0,0 +1,358 @@
+/*
+ * Equivalence test and benchmark of NumberFormat.h
+ *
+ * formatFloat() is compared with Print::print(float, digits) as the AVR
+ * core computes it, in single precision. The two must agree except
+ * where print() is one off in the last digit, and there formatFloat() must
+ * be the correctly rounded text, taken from the exact decimal expansion
+ * printf() gives. With 2 decimals, as the telemetry prints, every float
+ * is compared; other decimals on random floats. The integer formats are
+ * compared with printf(). The timings are of the PC, where print()'s
+ * float arithmetic runs on an FPU; the AVR does it in software.
+ *
+ *   make check          every float, a few minutes
+ *   ./numberformattest quick
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "Arduino.h"
+
+/* as built for AQ32, with the 32 bit longs of both flight controllers */
+#define AeroQuadSTM32
+#define long int
+#include "NumberFormat.h"
+#undef long
+
+static int failures = 0;
+
+static double seconds() {
+  return (double)clock() / CLOCKS_PER_SEC;
+}
+
+static char *writeUnsigned(char *p, uint32_t value) {
+  char digits[10];
+  int count = 0;
+  do {
+    digits[count++] = '0' + value % 10;
+    value /= 10;
+  } while (value);
+  while (count) {
+    *p++ = digits[--count];
+  }
+  return p;
+}
+
+/* Print::printFloat() of the AVR core, where double is float */
+static int avrPrintFloat(char *out, float number, int digits) {
+  char *p = out;
+  if (isnan(number)) return sprintf(out, "nan");
+  if (isinf(number)) return sprintf(out, "inf");
+  if (number > 4294967040.0f) return sprintf(out, "ovf");
+  if (number < -4294967040.0f) return sprintf(out, "ovf");
+  if (number < 0.0f) {
+    *p++ = '-';
+    number = -number;
+  }
+  float rounding = 0.5f;
+  for (int i = 0; i < digits; ++i) {
+    rounding /= 10.0f;
+  }
+  number += rounding;
+  const uint32_t intPart = (uint32_t)number;
+  float remainder = number - (float)intPart;
+  p = writeUnsigned(p, intPart);
+  if (digits > 0) {
+    *p++ = '.';
+  }
+  while (digits-- > 0) {
+    remainder *= 10.0f;
+    const int toPrint = (int)remainder;
+    if (toPrint < 0) {
+      *p++ = '-';
+      p = writeUnsigned(p, -toPrint);
+    }
+    else {
+      p = writeUnsigned(p, toPrint);
+    }
+    remainder -= toPrint;
+  }
+  *p = 0;
+  return p - out;
+}
+
+/* rounded half up from the exact decimal value of the float */
+static void exactFormat(char *out, float value, int digits) {
+  char expansion[400];
+  snprintf(expansion, sizeof(expansion), "%.160f", fabs((double)value));
+  char *point = strchr(expansion, '.');
+  const int integerDigits = point - expansion;
+  char kept[200];
+  memcpy(kept + 1, expansion, integerDigits);
+  memcpy(kept + 1 + integerDigits, point + 1, digits);
+  int length = 1 + integerDigits + digits;
+  kept[0] = '0';
+  if (point[1 + digits] >= '5') {
+    int i = length - 1;
+    while (kept[i] == '9') {
+      kept[i--] = '0';
+    }
+    kept[i]++;
+  }
+  const char *start = (kept[0] == '0') ? kept + 1 : kept;
+  const int shownInteger = integerDigits + (start == kept);
+  char *p = out;
+  if (value < 0.0f) {
+    *p++ = '-';
+  }
+  memcpy(p, start, shownInteger);
+  p += shownInteger;
+  if (digits > 0) {
+    *p++ = '.';
+    memcpy(p, start + shownInteger, digits);
+    p += digits;
+  }
+  *p = 0;
+}
+
+static float fromBits(uint32_t bits) {
+  float value;
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+static int format(char *out, float value, int digits) {
+  const int length = formatFloat(out, value, digits);
+  out[length] = 0;
+  return length;
+}
+
+/* a mismatch with print() is only allowed one off in the last digit, towards the exact text */
+static bool checkMismatch(float value, int digits, const char *ours, const char *avr) {
+  char exact[200];
+  exactFormat(exact, value, digits);
+  const double unit = pow(10.0, -digits);
+  const double difference = fabs(atof(ours) - atof(avr));
+  if (strcmp(ours, exact) != 0 || difference > unit * 1.5) {
+    if (failures < 20) {
+      printf("%.9g with %d decimals: \"%s\", print() \"%s\", exact \"%s\"\n", value, digits, ours, avr, exact);
+    }
+    failures++;
+    return false;
+  }
+  return true;
+}
+
+static void everyFloat(int digits, uint32_t stride) {
+  char ours[64];
+  char avr[64];
+  char exact[200];
+  unsigned long compared = 0;
+  unsigned long different = 0;
+  for (uint64_t bits = 0; bits <= 0xFFFFFFFFULL; bits += stride) {
+    const float value = fromBits((uint32_t)bits);
+    if (isnan(value) || fabsf(value) > 4294967040.0f) {
+      continue;
+    }
+    format(ours, value, digits);
+    avrPrintFloat(avr, value, digits);
+    compared++;
+    if (strcmp(ours, avr) != 0) {
+      different++;
+      checkMismatch(value, digits, ours, avr);
+    }
+    else if ((bits & 0xFFFF) < stride) {
+      exactFormat(exact, value, digits);
+      if (strcmp(ours, exact) != 0) {
+        printf("%.9g: \"%s\" and print() agree, exact \"%s\"\n", value, ours, exact);
+        failures++;
+      }
+    }
+  }
+  printf("%d decimals, %lu floats: %lu differ from print(), all correctly rounded where they do\n",
+         digits, compared, different);
+}
+
+static void randomFloats(int digits, int count) {
+  char ours[64];
+  char avr[64];
+  char exact[200];
+  int different = 0;
+  for (int i = 0; i < count; i++) {
+    float value;
+    if (i & 1) {
+      value = fromBits(((uint32_t)rand() << 16) ^ (uint32_t)rand());
+      if (isnan(value) || fabsf(value) > 4294967040.0f) {
+        continue;
+      }
+    }
+    else {
+      /* the sizes telemetry sends */
+      value = (rand() / (RAND_MAX + 1.0) - 0.5) * pow(10.0, rand() % 8 - 2);
+    }
+    format(ours, value, digits);
+    exactFormat(exact, value, digits);
+    if (strcmp(ours, exact) != 0) {
+      if (failures < 20) {
+        printf("%.9g with %d decimals: \"%s\", exact \"%s\"\n", value, digits, ours, exact);
+      }
+      failures++;
+    }
+    avrPrintFloat(avr, value, digits);
+    if (strcmp(ours, avr) != 0) {
+      different++;
+    }
+  }
+  printf("%d decimals, %d random floats: all exact, %d differ from print()\n", digits, count, different);
+}
+
+static void checkInteger(long value, int width, char pad) {
+  char ours[32];
+  char reference[32];
+  const int length = formatInteger(ours, (int)value, width, pad);
+  ours[length] = 0;
+  if (pad == '0') {
+    snprintf(reference, sizeof(reference), "%0*ld", width, value);
+  }
+  else {
+    snprintf(reference, sizeof(reference), "%*ld", width, value);
+  }
+  if (strcmp(ours, reference) != 0) {
+    if (failures < 20) {
+      printf("%ld width %d pad '%c': \"%s\", printf \"%s\"\n", value, width, pad, ours, reference);
+    }
+    failures++;
+  }
+}
+
+static void checkUnsigned(unsigned long value) {
+  char ours[32];
+  char reference[32];
+  const int length = formatUnsigned(ours, (unsigned int)value);
+  ours[length] = 0;
+  snprintf(reference, sizeof(reference), "%lu", value);
+  if (strcmp(ours, reference) != 0) {
+    if (failures < 20) {
+      printf("%lu: \"%s\", printf \"%s\"\n", value, ours, reference);
+    }
+    failures++;
+  }
+}
+
+static void integers() {
+  static const int widths[] = {0, 1, 2, 3, 4, 5, 6, 8};
+  for (long value = -(1L << 20); value <= (1L << 20); value++) {
+    for (unsigned int w = 0; w < sizeof(widths) / sizeof(widths[0]); w++) {
+      checkInteger(value, widths[w], ' ');
+      checkInteger(value, widths[w], '0');
+    }
+  }
+  for (int i = 0; i < 10000000; i++) {
+    const uint32_t bits = ((uint32_t)rand() << 16) ^ (uint32_t)rand();
+    checkInteger((int32_t)bits, rand() % 12, (i & 1) ? ' ' : '0');
+    checkUnsigned(bits);
+  }
+  for (int power = 0; power <= 9; power++) {
+    const long value = (long)pow(10.0, power);
+    for (long offset = -1; offset <= 1; offset++) {
+      checkInteger(value + offset, 0, ' ');
+      checkInteger(-(value + offset), 0, ' ');
+      checkUnsigned(value + offset);
+    }
+  }
+  checkInteger(INT32_MAX, 0, ' ');
+  checkInteger(INT32_MIN, 0, ' ');
+  checkInteger(INT32_MIN, 12, '0');
+  checkUnsigned(UINT32_MAX);
+  printf("integers: all of +-2^20 at 8 widths and 10 million random values match printf()\n");
+}
+
+static void benchmark() {
+  const int runs = 2000000;
+  static float values[1024];
+  char out[64];
+  unsigned int checksum = 0;
+  for (int i = 0; i < 1024; i++) {
+    values[i] = (rand() / (RAND_MAX + 1.0) - 0.5) * pow(10.0, rand() % 6 - 1);
+  }
+
+  double start = seconds();
+  for (int i = 0; i < runs; i++) {
+    checksum += formatFloat(out, values[i & 1023], 2);
+  }
+  const double ourTime = seconds() - start;
+  start = seconds();
+  for (int i = 0; i < runs; i++) {
+    checksum += avrPrintFloat(out, values[i & 1023], 2);
+  }
+  const double printTime = seconds() - start;
+  start = seconds();
+  for (int i = 0; i < runs; i++) {
+    checksum += snprintf(out, sizeof(out), "%.2f", values[i & 1023]);
+  }
+  const double printfTime = seconds() - start;
+  start = seconds();
+  for (int i = 0; i < runs; i++) {
+    checksum += formatFloat(out, values[i & 1023], 6);
+  }
+  const double sixTime = seconds() - start;
+  start = seconds();
+  for (int i = 0; i < runs; i++) {
+    checksum += formatInteger(out, (i & 4095) * 7919 - 16000000);
+  }
+  const double integerTime = seconds() - start;
+  start = seconds();
+  for (int i = 0; i < runs; i++) {
+    checksum += snprintf(out, sizeof(out), "%d", (i & 4095) * 7919 - 16000000);
+  }
+  const double integerPrintfTime = seconds() - start;
+
+  printf("formatFloat(x, 2)      %6.1f ns\n", ourTime / runs * 1e9);
+  printf("print(x, 2) algorithm  %6.1f ns\n", printTime / runs * 1e9);
+  printf("snprintf(\"%%.2f\")       %6.1f ns\n", printfTime / runs * 1e9);
+  printf("formatFloat(x, 6)      %6.1f ns\n", sixTime / runs * 1e9);
+  printf("formatInteger(x)       %6.1f ns\n", integerTime / runs * 1e9);
+  printf("snprintf(\"%%d\")         %6.1f ns (%u)\n", integerPrintfTime / runs * 1e9, checksum & 1);
+}
+
+int main(int argc, char *argv[]) {
+  const bool quick = (argc > 1 && strcmp(argv[1], "quick") == 0);
+  srand(1);
+
+  everyFloat(2, quick ? 4099 : 1);
+  for (int digits = 0; digits <= NUMBER_FORMAT_MAX_DIGITS; digits++) {
+    randomFloats(digits, quick ? 100000 : 1000000);
+  }
+  integers();
+
+  char text[64];
+  static const struct {
+    float value;
+    int digits;
+    const char *text;
+  } cases[] = {
+    {0.0f, 2, "0.00"}, {-0.0f, 2, "0.00"}, {-0.001f, 2, "-0.00"}, {0.125f, 2, "0.13"},
+    {1.5f, 0, "2"}, {4294967040.0f, 2, "4294967040.00"}, {-4294967296.0f, 2, "ovf"},
+    {INFINITY, 2, "inf"}, {-INFINITY, 2, "inf"}, {NAN, 2, "nan"}, {3.2f, 1, "3.2"},
+  };
+  for (unsigned int i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+    format(text, cases[i].value, cases[i].digits);
+    if (strcmp(text, cases[i].text) != 0) {
+      printf("%g with %d decimals: \"%s\", expected \"%s\"\n", cases[i].value, cases[i].digits, text, cases[i].text);
+      failures++;
+    }
+  }
+
+  benchmark();
+  printf(failures ? "FAILED\n" : "PASSED\n");
+  return failures ? 1 : 0;
+}
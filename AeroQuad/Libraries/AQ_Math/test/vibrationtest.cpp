@@ -0,0 +1,408 @@
+/*
+ * Test of the gyro vibration spectrum and dynamic notch filters
+ *
+ * A synthetic gyro signal at 400Hz, flight motion below 7Hz plus motor
+ * vibration whose frequency holds, ramps and steps, with its second
+ * harmonic aliased below half the loop rate, plus white noise, goes
+ * through computeDynamicNotch(). The motion and the vibration are also
+ * sent through copies of the notches taking the same coefficients every
+ * sample, so what the notches take out of each is known exactly. The
+ * fourth order filter the accelerometers use is run the same way for
+ * comparison. Reported and checked:
+ *   - how closely a notch follows the vibration
+ *   - vibration rejection, in dB of rms
+ * both while the vibration holds, from a second after it changed, and
+ * while it ramps or has just stepped, where only the first is checked
+ *   - phase lag of the flight motion at 2, 5 and 10Hz
+ *   - no notch on a signal without vibration
+ *
+ * A gyro recording, one sample per line with x, y and z in rad/s first and
+ * comma separated as the 'i' telemetry sends them, taken at the loop rate,
+ * can be given as argument; its power below 20Hz and in the notch band is
+ * reported before and after the notches.
+ *
+ *   make check
+ *   ./vibrationtest recording.csv
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <vector>
+#include "Arduino.h"
+
+#define CONTROL_LOOP_RATE 400
+#include "DynamicNotch.h"
+#include "FourtOrderFilter.h"
+
+#define SECONDS 12.0
+#define SETTLE 1.0            /* s after the start, the ramp and the step before the vibration holds */
+#define RAMP_START 3.0
+#define RAMP_END 6.0
+#define STEP_TIME 9.0
+
+#define HOLDING 0
+#define CHANGING 1
+
+static int failures = 0;
+
+static double motorFrequency(double t) {
+  if (t < RAMP_START) return 90.0;
+  if (t < RAMP_END) return 90.0 + (t - RAMP_START) / (RAMP_END - RAMP_START) * 70.0;
+  if (t < STEP_TIME) return 160.0;
+  return 110.0;
+}
+
+static int segment(double t) {
+  if (t < RAMP_START || (t >= RAMP_END + SETTLE && t < STEP_TIME) || t >= STEP_TIME + SETTLE) {
+    return HOLDING;
+  }
+  return CHANGING;
+}
+
+/* where a frequency shows up sampled at the loop rate */
+static double aliased(double frequency) {
+  double f = fmod(frequency, (double)CONTROL_LOOP_RATE);
+  return (f > CONTROL_LOOP_RATE / 2.0) ? CONTROL_LOOP_RATE - f : f;
+}
+
+static double gaussian() {
+  const double u = (rand() + 1.0) / (RAND_MAX + 2.0);
+  const double v = (rand() + 1.0) / (RAND_MAX + 2.0);
+  return sqrt(-2.0 * log(u)) * cos(2.0 * M_PI * v);
+}
+
+static double motion(int axis, double t) {
+  static const double frequency[3] = {0.7, 2.3, 6.1};
+  static const double amplitude[3] = {0.6, 0.3, 0.1};
+  double value = 0.0;
+  for (int i = 0; i < 3; i++) {
+    value += amplitude[i] * sin(2.0 * M_PI * frequency[i] * t + axis + i);
+  }
+  return value;
+}
+
+/* the notches as they were at one time, and the fourth order filter */
+struct FrozenNotches {
+  struct BiquadFilter filter[VIBRATION_NOTCHES];
+  void reset() {
+    for (int notch = 0; notch < VIBRATION_NOTCHES; notch++) resetBiquad(&filter[notch]);
+  }
+  float operator()(float x) {
+    for (int notch = 0; notch < VIBRATION_NOTCHES; notch++) x = computeBiquad(x, &filter[notch]);
+    return x;
+  }
+};
+
+struct FourthOrder {
+  struct fourthOrderData data;
+  void reset() { memset(&data, 0, sizeof(data)); }
+  float operator()(float x) { return computeFourthOrder(x, &data); }
+};
+
+/* wrapped phase lag in degrees of a filter at a frequency, from a fitted sine */
+template <class Filter> static double wrappedLag(Filter &filter, double frequency) {
+  const int samples = CONTROL_LOOP_RATE * 10;
+  double inPhase = 0.0, quadrature = 0.0;
+  filter.reset();
+  for (int i = 0; i < samples; i++) {
+    const double t = (double)i / CONTROL_LOOP_RATE;
+    const double output = filter((float)sin(2.0 * M_PI * frequency * t));
+    if (i >= samples / 2) {
+      inPhase += output * sin(2.0 * M_PI * frequency * t);
+      quadrature += output * cos(2.0 * M_PI * frequency * t);
+    }
+  }
+  return -atan2(quadrature, inPhase) * 180.0 / M_PI;
+}
+
+/* phase lag unwrapped by following it up from a low frequency */
+template <class Filter> static double phaseLag(Filter &filter, double frequency) {
+  double lag = wrappedLag(filter, 0.25);
+  for (double f = 0.5; f <= frequency + 1e-9; f += 0.25) {
+    const double wrapped = wrappedLag(filter, f);
+    lag += remainder(wrapped - lag, 360.0);
+  }
+  return lag;
+}
+
+/* copies coefficients, not the delay line */
+static void copyCoefficients(struct BiquadFilter *to, const struct BiquadFilter *from) {
+  to->b0 = from->b0;
+  to->b1 = from->b1;
+  to->b2 = from->b2;
+  to->a1 = from->a1;
+  to->a2 = from->a2;
+}
+
+static double decibels(double in, double out) {
+  return 20.0 * log10(sqrt(in) / sqrt(out));
+}
+
+static void synthetic() {
+  const int samples = (int)(SECONDS * CONTROL_LOOP_RATE);
+  static const double vibrationScale[3] = {1.0, 0.8, 0.5};
+  struct BiquadFilter motionNotch[3][VIBRATION_NOTCHES];
+  struct BiquadFilter vibrationOnlyNotch[3][VIBRATION_NOTCHES];
+  struct fourthOrderData chebyMotion[3], chebyVibration[3];
+  double phase = 0.0;
+  double vibrationIn[3][2], notchVibrationOut[3][2], chebyVibrationOut[3][2];
+  double motionIn[3], notchMotionError[3], chebyMotionError[3];
+  int tracked[3][2], harmonicTracked[3][2], counted[2] = {0, 0};
+  double worstError[3][2];
+  struct BiquadFilter worstCase[VIBRATION_NOTCHES];
+  double worstCaseLowest = 1e9;
+
+  initializeDynamicNotch();
+  memset(chebyMotion, 0, sizeof(chebyMotion));
+  memset(chebyVibration, 0, sizeof(chebyVibration));
+  memset(vibrationIn, 0, sizeof(vibrationIn));
+  memset(notchVibrationOut, 0, sizeof(notchVibrationOut));
+  memset(chebyVibrationOut, 0, sizeof(chebyVibrationOut));
+  memset(motionIn, 0, sizeof(motionIn));
+  memset(notchMotionError, 0, sizeof(notchMotionError));
+  memset(chebyMotionError, 0, sizeof(chebyMotionError));
+  memset(tracked, 0, sizeof(tracked));
+  memset(harmonicTracked, 0, sizeof(harmonicTracked));
+  memset(worstError, 0, sizeof(worstError));
+  for (int axis = 0; axis < 3; axis++) {
+    for (int notch = 0; notch < VIBRATION_NOTCHES; notch++) {
+      resetBiquad(&motionNotch[axis][notch]);
+      resetBiquad(&vibrationOnlyNotch[axis][notch]);
+    }
+  }
+  srand(1);
+
+  for (int i = 0; i < samples; i++) {
+    const double t = (double)i / CONTROL_LOOP_RATE;
+    phase += 2.0 * M_PI * motorFrequency(t) / CONTROL_LOOP_RATE;
+    float gyro[3];
+    double motionPart[3], vibrationPart[3];
+    for (int axis = 0; axis < 3; axis++) {
+      motionPart[axis] = motion(axis, t);
+      vibrationPart[axis] = vibrationScale[axis] * (0.4 * sin(phase + axis) + 0.15 * sin(2.0 * phase + 0.7));
+      gyro[axis] = motionPart[axis] + vibrationPart[axis] + 0.01 * gaussian();
+    }
+
+    computeDynamicNotch(gyro);
+
+    const bool measured = t >= SETTLE;
+    const int part = segment(t);
+    if (measured) counted[part]++;
+    for (int axis = 0; axis < 3; axis++) {
+      double notchMotion = motionPart[axis];
+      double notchVibration = vibrationPart[axis];
+      double closest = 1e9, closestHarmonic = 1e9;
+      for (int notch = 0; notch < VIBRATION_NOTCHES; notch++) {
+        copyCoefficients(&motionNotch[axis][notch], &vibrationNotch[axis][notch].filter);
+        copyCoefficients(&vibrationOnlyNotch[axis][notch], &vibrationNotch[axis][notch].filter);
+        notchMotion = computeBiquad(notchMotion, &motionNotch[axis][notch]);
+        notchVibration = computeBiquad(notchVibration, &vibrationOnlyNotch[axis][notch]);
+        const double frequency = vibrationNotch[axis][notch].frequency;
+        if (frequency != 0.0) {
+          closest = fmin(closest, fabs(frequency - motorFrequency(t)));
+          closestHarmonic = fmin(closestHarmonic, fabs(frequency - aliased(2.0 * motorFrequency(t))));
+        }
+      }
+      const double chebyMotionOut = computeFourthOrder(motionPart[axis], &chebyMotion[axis]);
+      const double chebyVibrationValue = computeFourthOrder(vibrationPart[axis], &chebyVibration[axis]);
+      if (measured) {
+        const double binWidth = (double)CONTROL_LOOP_RATE / VIBRATION_BLOCK_SIZE;
+        vibrationIn[axis][part] += vibrationPart[axis] * vibrationPart[axis];
+        notchVibrationOut[axis][part] += notchVibration * notchVibration;
+        chebyVibrationOut[axis][part] += chebyVibrationValue * chebyVibrationValue;
+        if (closest <= binWidth) tracked[axis][part]++;
+        if (closestHarmonic <= binWidth) harmonicTracked[axis][part]++;
+        worstError[axis][part] = fmax(worstError[axis][part], closest);
+        motionIn[axis] += motionPart[axis] * motionPart[axis];
+        notchMotionError[axis] += (notchMotion - motionPart[axis]) * (notchMotion - motionPart[axis]);
+        chebyMotionError[axis] += (chebyMotionOut - motionPart[axis]) * (chebyMotionOut - motionPart[axis]);
+      }
+    }
+
+    /* the notches closest to the control band, for the phase lag */
+    if (t > SETTLE) {
+      double lowest = 1e9;
+      for (int notch = 0; notch < VIBRATION_NOTCHES; notch++) {
+        if (vibrationNotch[XAXIS][notch].frequency != 0.0) {
+          lowest = fmin(lowest, vibrationNotch[XAXIS][notch].frequency);
+        }
+      }
+      if (lowest < worstCaseLowest) {
+        worstCaseLowest = lowest;
+        for (int notch = 0; notch < VIBRATION_NOTCHES; notch++) {
+          worstCase[notch] = vibrationNotch[XAXIS][notch].filter;
+        }
+      }
+    }
+  }
+
+  printf("synthetic: %ds at %dHz, %d bins of %.2fHz from %.2fHz, %d notches per axis of Q %.1f\n",
+         (int)SECONDS, CONTROL_LOOP_RATE, VIBRATION_BINS, (double)CONTROL_LOOP_RATE / VIBRATION_BLOCK_SIZE,
+         vibrationBinFrequency(0), VIBRATION_NOTCHES, VIBRATION_NOTCH_Q);
+  printf("vibration 90Hz, ramp to 160Hz, step to 110Hz, second harmonic aliased to %.0f..%.0fHz\n",
+         aliased(320.0), aliased(200.0));
+  static const char *const partName[2] = {"holding ", "changing"};
+  for (int axis = 0; axis < 3; axis++) {
+    printf("axis %d:\n", axis);
+    for (int part = HOLDING; part <= CHANGING; part++) {
+      const double notchRejection = decibels(vibrationIn[axis][part], notchVibrationOut[axis][part]);
+      const double chebyRejection = decibels(vibrationIn[axis][part], chebyVibrationOut[axis][part]);
+      printf("  %s: fundamental within a bin %5.1f%% (worst %4.1fHz off), harmonic %5.1f%%, "
+             "rejection: notches %5.1fdB, fourth order %5.1fdB\n", partName[part],
+             100.0 * tracked[axis][part] / counted[part], worstError[axis][part],
+             100.0 * harmonicTracked[axis][part] / counted[part], notchRejection, chebyRejection);
+      if (part == HOLDING) {
+        if (tracked[axis][part] < counted[part] * 0.95 || harmonicTracked[axis][part] < counted[part] * 0.95) {
+          printf("  FAIL: vibration not followed\n");
+          failures++;
+        }
+        if (notchRejection < 20.0) {
+          printf("  FAIL: less than 20dB of rejection\n");
+          failures++;
+        }
+      }
+    }
+    printf("  motion error rms: notches %5.2f%%, fourth order %5.1f%%\n",
+           100.0 * sqrt(notchMotionError[axis] / motionIn[axis]), 100.0 * sqrt(chebyMotionError[axis] / motionIn[axis]));
+  }
+
+  printf("phase lag, notches at their lowest (%.1fHz) against the fourth order:\n", worstCaseLowest);
+  static const double frequencies[] = {2.0, 5.0, 10.0};
+  for (unsigned int i = 0; i < sizeof(frequencies) / sizeof(frequencies[0]); i++) {
+    FrozenNotches notches;
+    for (int notch = 0; notch < VIBRATION_NOTCHES; notch++) {
+      notches.filter[notch] = worstCase[notch];
+    }
+    FourthOrder fourthOrder;
+    const double notchLag = phaseLag(notches, frequencies[i]);
+    const double chebyLag = phaseLag(fourthOrder, frequencies[i]);
+    printf("  %4.1fHz: notches %5.2f deg (%.2fms), fourth order %6.1f deg (%.1fms)\n", frequencies[i],
+           notchLag, notchLag / 360.0 / frequencies[i] * 1000.0, chebyLag, chebyLag / 360.0 / frequencies[i] * 1000.0);
+    if (notchLag >= chebyLag || notchLag > 5.0) {
+      printf("  FAIL: notch phase lag\n");
+      failures++;
+    }
+  }
+}
+
+static void withoutVibration() {
+  initializeDynamicNotch();
+  srand(2);
+  int notched = 0;
+  const int samples = 30 * CONTROL_LOOP_RATE;
+  for (int i = 0; i < samples; i++) {
+    const double t = (double)i / CONTROL_LOOP_RATE;
+    float gyro[3];
+    for (int axis = 0; axis < 3; axis++) {
+      gyro[axis] = motion(axis, t) * 3.0 + 0.01 * gaussian();
+    }
+    computeDynamicNotch(gyro);
+    for (int axis = 0; axis < 3; axis++) {
+      for (int notch = 0; notch < VIBRATION_NOTCHES; notch++) {
+        if (vibrationNotch[axis][notch].frequency != 0.0) notched++;
+      }
+    }
+  }
+  printf("without vibration: a notch on %d of %d axis samples\n", notched, samples * 3);
+  if (notched != 0) {
+    printf("FAIL: notch without vibration\n");
+    failures++;
+  }
+}
+
+static void timing() {
+  initializeDynamicNotch();
+  const int samples = 2000000;
+  float gyro[3] = {0, 0, 0};
+  float sink = 0.0;
+  const clock_t start = clock();
+  for (int i = 0; i < samples; i++) {
+    gyro[0] = sinf(i * 0.9f);
+    gyro[1] = sinf(i * 0.7f);
+    gyro[2] = sinf(i * 0.3f);
+    computeDynamicNotch(gyro);
+    sink += gyro[0];
+  }
+  const double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+  printf("computeDynamicNotch(): %.0f ns per control loop on this PC (%d)\n", seconds / samples * 1e9, sink > 1e30);
+}
+
+/* Welch estimate of the power between two frequencies */
+static double bandPower(const std::vector<double> &signal, double low, double high) {
+  const int size = 256;
+  double power = 0.0;
+  int segments = 0;
+  for (size_t start = 0; start + size <= signal.size(); start += size / 2) {
+    for (int k = 0; k <= size / 2; k++) {
+      const double frequency = (double)k * CONTROL_LOOP_RATE / size;
+      if (frequency < low || frequency >= high) continue;
+      double re = 0.0, im = 0.0;
+      for (int n = 0; n < size; n++) {
+        const double w = 0.5 - 0.5 * cos(2.0 * M_PI * n / size);
+        re += signal[start + n] * w * cos(2.0 * M_PI * k * n / size);
+        im -= signal[start + n] * w * sin(2.0 * M_PI * k * n / size);
+      }
+      power += re * re + im * im;
+    }
+    segments++;
+  }
+  return segments ? power / segments : 0.0;
+}
+
+static void recording(const char *path) {
+  FILE *file = fopen(path, "r");
+  if (!file) {
+    printf("cannot open %s\n", path);
+    failures++;
+    return;
+  }
+  std::vector<double> in[3], out[3];
+  double notchSum[3] = {0, 0, 0};
+  int notchCount[3] = {0, 0, 0};
+  char line[512];
+  initializeDynamicNotch();
+  while (fgets(line, sizeof(line), file)) {
+    float gyro[3];
+    if (sscanf(line, "%f,%f,%f", &gyro[0], &gyro[1], &gyro[2]) != 3) continue;
+    for (int axis = 0; axis < 3; axis++) in[axis].push_back(gyro[axis]);
+    computeDynamicNotch(gyro);
+    for (int axis = 0; axis < 3; axis++) {
+      out[axis].push_back(gyro[axis]);
+      for (int notch = 0; notch < VIBRATION_NOTCHES; notch++) {
+        if (vibrationNotch[axis][notch].frequency != 0.0) {
+          notchSum[axis] += vibrationNotch[axis][notch].frequency;
+          notchCount[axis]++;
+        }
+      }
+    }
+  }
+  fclose(file);
+  printf("%s: %zu samples taken as %dHz\n", path, in[0].size(), CONTROL_LOOP_RATE);
+  for (int axis = 0; axis < 3; axis++) {
+    const double lowIn = bandPower(in[axis], 0.0, 20.0), lowOut = bandPower(out[axis], 0.0, 20.0);
+    const double bandIn = bandPower(in[axis], VIBRATION_MIN_FREQUENCY, CONTROL_LOOP_RATE / 2.0);
+    const double bandOut = bandPower(out[axis], VIBRATION_MIN_FREQUENCY, CONTROL_LOOP_RATE / 2.0);
+    printf("axis %d: notches on %.0f%% of the time, at %.1fHz on average\n", axis,
+           100.0 * notchCount[axis] / (in[axis].size() * VIBRATION_NOTCHES), notchCount[axis] ? notchSum[axis] / notchCount[axis] : 0.0);
+    printf("        below 20Hz %.2fdB, %d-%dHz %.1fdB less after the notches\n", bandIn > 0 ? 10.0 * log10(lowIn / lowOut) : 0.0,
+           VIBRATION_MIN_FREQUENCY, CONTROL_LOOP_RATE / 2, bandOut > 0 ? 10.0 * log10(bandIn / bandOut) : 0.0);
+  }
+}
+
+int main(int argc, char *argv[]) {
+  synthetic();
+  withoutVibration();
+  timing();
+  for (int i = 1; i < argc; i++) {
+    recording(argv[i]);
+  }
+  printf(failures ? "FAILED\n" : "PASSED\n");
+  return failures ? 1 : 0;
+}
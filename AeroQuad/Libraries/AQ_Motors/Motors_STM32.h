@@ -71,6 +71,9 @@ void initializeMotors(NB_Motors numbers) {
 
 void writeMotors(void) { // update motor commands on timers
 
+  #if defined(MavLinkHIL)
+    return; // hardware in the loop, the commands only go to the simulator
+  #endif
   for(int motor=0; motor < _stm32_motor_number; motor++) {
     timer_set_compare(PIN_MAP[STM32_MOTOR_MAP[motor]].timer_device, PIN_MAP[STM32_MOTOR_MAP[motor]].timer_channel,  motorCommand[motor]);
   }
@@ -78,6 +81,9 @@ void writeMotors(void) { // update motor commands on timers
 
 void commandAllMotors(int _motorCommand) {   // Send same command to all motors
 
+  #if defined(MavLinkHIL)
+    _motorCommand = MINCOMMAND; // and the ESCs never see anything else
+  #endif
   for(int motor=0; motor < _stm32_motor_number; motor++) {
     timer_set_compare(PIN_MAP[STM32_MOTOR_MAP[motor]].timer_device, PIN_MAP[STM32_MOTOR_MAP[motor]].timer_channel, _motorCommand);
   }
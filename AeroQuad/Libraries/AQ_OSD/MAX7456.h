@@ -57,6 +57,7 @@
 
 #include <stdio.h>
 #include <stdarg.h>
+#include <NumberFormat.h>
 
 #include "OSD.h"
 #include "GlobalDefined.h"
@@ -29,6 +29,25 @@ int lastAltitude     = 12345;     // bogus initial values to force update
 int lastHoldAltitude = 12345;
 byte lastHoldState   = 6;
 
+// symbol and altitude in feet, or in meters with a decimal below 10m
+void formatOSDAltitude(char *buf, char symbol, int altitude) {
+  byte length = 0;
+  buf[length++] = symbol;
+  #ifdef USUnits
+    length += formatInteger(buf + length, altitude, 4);
+    buf[length++] = 'f';
+  #else
+    if (abs(altitude)<100) {
+      length += formatOSDTenths(buf + length, altitude);
+    }
+    else {
+      length += formatInteger(buf + length, altitude/10, 4);
+    }
+    buf[length++] = 'm';
+  #endif
+  buf[length] = 0;
+}
+
 void displayAltitude(float readedAltitude, float desiredAltitudeToKeep, boolean altHoldState) {
   #ifdef USUnits
     int currentAltitude = readedAltitude*3.281;
@@ -37,19 +56,10 @@ void displayAltitude(float readedAltitude, float desiredAltitudeToKeep, boolean
     int currentAltitude = readedAltitude*10.0; // 0.1m accuracy!!
     int currentHoldAltitude = desiredAltitudeToKeep*10.0;
   #endif
-  char buf[7];
+  char buf[10];
 
   if ( lastAltitude != currentAltitude ) {
-    #ifdef USUnits
-      snprintf(buf,7,"\011%4df",currentAltitude);
-    #else
-      if (abs(currentAltitude)<100) {
-        snprintf(buf,7,"\011%c%1d.%1dm",currentAltitude < 0 ? '-' : ' ', abs(currentAltitude/10),abs(currentAltitude%10));
-      }
-      else {
-        snprintf(buf,7,"\011%4dm",currentAltitude/10);
-      }
-    #endif
+    formatOSDAltitude(buf, '\011', currentAltitude);
     writeChars( buf, 6, 0, ALTITUDE_ROW, ALTITUDE_COL );
     lastAltitude = currentAltitude;
   }
@@ -70,23 +80,14 @@ void displayAltitude(float readedAltitude, float desiredAltitudeToKeep, boolean
     if ((lastHoldState != ON) || (lastHoldAltitude != currentHoldAltitude)) {
       lastHoldState = ON;
       lastHoldAltitude=currentHoldAltitude;
-      #ifdef USUnits
-        snprintf(buf,7,"\12%4df",currentHoldAltitude);
-      #else
-        if (abs(currentHoldAltitude)<100) {
-          snprintf(buf,7,"\012%c%1d.%1dm", currentHoldAltitude < 0 ? '-' : ' ',abs(currentHoldAltitude/10),abs(currentHoldAltitude%10));
-        }
-        else {
-          snprintf(buf,7,"\012%4dm",currentHoldAltitude/10);
-        }
-      #endif
+      formatOSDAltitude(buf, '\012', currentHoldAltitude);
       isWriteNeeded = true;
     }
     break;
   case ALTPANIC:
     if (lastHoldState != ALTPANIC) {
       lastHoldState = ALTPANIC;
-      snprintf(buf,7,"\12panic");
+      strcpy(buf,"\12panic");
       isWriteNeeded = true;
     }
     break;
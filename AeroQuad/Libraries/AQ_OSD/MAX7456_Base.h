@@ -72,40 +72,167 @@ void unhideOSD() {
   }
 }
 
+// Shadow copy of the display memory. Widgets render into it with writeChars()
+// and flushOSD() sends only the cells that changed since the last flush.
+#define OSD_SHADOW_SIZE 480
+
+// Clean cells tolerated inside a run before it is split, resending a couple
+// of unchanged characters is cheaper than a new DMM/DMAH/DMAL header
+#define OSD_RUN_MAX_GAP 2
+
+// Register/data bytes sent per flush, cells left over go out on the next one
+#ifndef OSD_TX_BUFFER_SIZE
+  #if defined(AeroQuadSTM32)
+    #define OSD_TX_BUFFER_SIZE 1024
+  #else
+    #define OSD_TX_BUFFER_SIZE 256
+  #endif
+#endif
+
+byte osdShadow[OSD_SHADOW_SIZE];
+byte osdShadowAttr[OSD_SHADOW_SIZE/4];  // 2 bits per cell, 0x01 blink, 0x02 invert
+byte osdDirty[OSD_SHADOW_SIZE/8];
+byte osdTxBuffer[OSD_TX_BUFFER_SIZE];
+unsigned osdFlushCursor = 0;
+
+byte getOSDAttr(unsigned cell) {
+  return (osdShadowAttr[cell >> 2] >> ((cell & 3) << 1)) & 0x03;
+}
+
+boolean isOSDCellDirty(unsigned cell) {
+  return osdDirty[cell >> 3] & (1 << (cell & 7));
+}
+
+void clearOSDShadow() {
+  memset(osdShadow, 0, sizeof(osdShadow));
+  memset(osdShadowAttr, 0, sizeof(osdShadowAttr));
+  memset(osdDirty, 0, sizeof(osdDirty));
+  osdFlushCursor = 0;
+}
+
 // void writeChars( const char* buf, byte len, byte flags, byte y, byte x )
 //
-// Writes 'len' character address bytes to the display memory corresponding to row y, column x
-// - uses autoincrement mode when writing more than one character
+// Renders 'len' character address bytes into the shadow screen at row y, column x
+// - nothing is sent to the MAX7456 until flushOSD()
 // - will wrap around to next row if 'len' is greater than the remaining cols in row y
 // - buf=NULL or len>strlen(buf) can be used to write zeroes (clear)
 // - flags: 0x01 blink, 0x02 invert (can be combined)
 void writeChars( const char* buf, byte len, byte flags, byte y, byte x ) {
 
-  unsigned offset = y * 30 + x;
+  unsigned cell = y * 30 + x;
+  byte attr = flags & 0x03;
 
   if (flags) {
     unhideOSD(); // make sure OSD is visible in case of alarms etc.
   }
-  
-  spi_osd_select();
-  // 16bit transfer, transparent BG, autoincrement mode (if len!=1)
-  spi_writereg(DMM, ((flags&1) ? 0x10 : 0x00) | ((flags&2) ? 0x08 : 0x00) | ((len!=1)?0x01:0x00) );
 
-  // send starting display memory address (position of text)
-  spi_writereg(DMAH, offset >> 8 );
-  spi_writereg(DMAL, offset & 0xff );
+  for ( byte i = 0; i < len && cell < OSD_SHADOW_SIZE; i++, cell++ ) {
+    byte c = 0;
+    if (buf) {
+      c = buf[i];
+      if (!c) {
+        buf = NULL; // rest of the field is cleared
+      }
+    }
+    if (osdShadow[cell] != c || getOSDAttr(cell) != attr) {
+      osdShadow[cell] = c;
+      byte shift = (cell & 3) << 1;
+      osdShadowAttr[cell >> 2] = (osdShadowAttr[cell >> 2] & ~(0x03 << shift)) | (attr << shift);
+      osdDirty[cell >> 3] |= 1 << (cell & 7);
+    }
+  }
+}
+
+// Writes tenths as a sign or space, the units, a point and the tenth,
+// what "%c%1d.%1d" gave the widgets, returns the number of characters
+byte formatOSDTenths(char *buf, int tenths) {
+  byte length = 0;
+  buf[length++] = tenths < 0 ? '-' : ' ';
+  length += formatInteger(buf + length, abs(tenths / 10));
+  buf[length++] = '.';
+  length += formatInteger(buf + length, abs(tenths % 10));
+  return length;
+}
+
+// Queues dirty cells of [from, to) as auto-increment runs into osdTxBuffer,
+// returns false when the buffer filled up before the range was done
+boolean queueOSDRange(unsigned from, unsigned to, unsigned *txLength) {
+
+  unsigned cell = from;
+  while (cell < to) {
+    if (!isOSDCellDirty(cell)) {
+      cell++;
+      continue;
+    }
+
+    // grow the run over cells with the same attribute, 0xFF can't be sent
+    // in auto-increment mode as it is the end marker so it gets its own run
+    byte attr = getOSDAttr(cell);
+    unsigned runEnd = cell + 1;
+    if (osdShadow[cell] != END_string) {
+      for (unsigned scan = cell + 1; scan < to && (scan - runEnd) <= OSD_RUN_MAX_GAP; scan++) {
+        if (getOSDAttr(scan) != attr || osdShadow[scan] == END_string) {
+          break;
+        }
+        if (isOSDCellDirty(scan)) {
+          runEnd = scan + 1;
+        }
+      }
+    }
+
+    // header (DMM, DMAH, DMAL) + 2 bytes per character + end marker
+    unsigned room = OSD_TX_BUFFER_SIZE - *txLength;
+    if (room < 8) {
+      osdFlushCursor = cell;
+      return false;
+    }
+    if (runEnd - cell > 1 && 8 + 2 * (runEnd - cell) > room) {
+      runEnd = cell + (room - 8) / 2;
+    }
+    unsigned runLength = runEnd - cell;
 
-  // write out data
-  for ( byte i = 0; i < len; i++ ) {
-    spi_writereg(DMDI, (!buf || strlen(buf)<i)?0:buf[i] );
+    byte *tx = osdTxBuffer + *txLength;
+    *tx++ = DMM;
+    *tx++ = ((attr&1) ? 0x10 : 0x00) | ((attr&2) ? 0x08 : 0x00) | ((runLength!=1)?0x01:0x00);
+    *tx++ = DMAH;
+    *tx++ = cell >> 8;
+    *tx++ = DMAL;
+    *tx++ = cell & 0xff;
+    for (unsigned i = cell; i < runEnd; i++) {
+      *tx++ = DMDI;
+      *tx++ = osdShadow[i];
+      osdDirty[i >> 3] &= ~(1 << (i & 7));
+    }
+    // Send escape 11111111 to exit autoincrement mode
+    if (runLength != 1) {
+      *tx++ = DMDI;
+      *tx++ = END_string;
+    }
+    *txLength = tx - osdTxBuffer;
+    cell = runEnd;
   }
+  return true;
+}
 
-  // Send escape 11111111 to exit autoincrement mode
-  if (len!=1) {
-    spi_writereg(DMDI, END_string );
+// Sends the changed part of the shadow screen, on AQ32 the transfer runs
+// by DMA and this returns at once. The scan resumes where the previous
+// flush ran out of buffer so the bottom rows are never starved.
+void flushOSD() {
+
+  if (spi_osd_busy()) {
+    return; // previous flush still on the wire, try again next time
+  }
+
+  unsigned txLength = 0;
+  unsigned start = osdFlushCursor < MAX_screen_size ? osdFlushCursor : 0;
+  osdFlushCursor = 0;
+  if (queueOSDRange(start, MAX_screen_size, &txLength)) {
+    queueOSDRange(0, start, &txLength);
+  }
+
+  if (txLength) {
+    spi_osd_send(osdTxBuffer, txLength);
   }
-  // finished writing
-  spi_osd_deselect();
 }
 
 void detectVideoStandard() {
@@ -155,6 +282,7 @@ void initializeOSD() {
   spi_osd_select();
   spi_writereg( VM0, MAX7456_reset );
   spi_osd_deselect();
+  clearOSDShadow();
   delay( 1 ); //Only takes ~100us typically
 
   //Set white level to 90% for all rows
@@ -175,6 +303,7 @@ void initializeOSD() {
 
   // show notification of active video format
   notifyOSD(OSD_NOW, "VIDEO: %s", (DISABLE_display) ? "PAL" : "NTSC");
+  flushOSD();
 }
 
 #endif  // #define _AQ_OSD_MAX7456_BASE_H_
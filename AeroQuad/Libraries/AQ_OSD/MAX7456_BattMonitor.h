@@ -34,8 +34,14 @@ void displayVoltage(byte areMotorsArmed) {
 
   int currentValue = batteryData[osdBatNo].voltage/10;
 
-  char buf[12];
-  snprintf(buf,7,"%c%2d.%1dV",'\20', currentValue/10,currentValue%10);
+  char buf[24];
+  byte length = 0;
+  buf[length++] = '\20';
+  length += formatInteger(buf + length, currentValue/10, 2);
+  buf[length++] = '.';
+  length += formatInteger(buf + length, currentValue%10);
+  buf[length++] = 'V';
+  buf[length] = 0;
 
   // Following blink only symbol on warning and all on alarm
   writeChars( buf,   1, batteryIsWarning(osdBatNo)?1:0, VOLTAGE_ROW + osdBatNo, VOLTAGE_COL );
@@ -46,11 +52,15 @@ void displayVoltage(byte areMotorsArmed) {
     currentValue = batteryData[osdBatNo].current/10;
 
     if (abs(currentValue)>=100) { // > 10A only display whole amps
-      snprintf(buf,12,"%4dA%5ld\24  ", currentValue/10, batteryData[osdBatNo].usedCapacity/1000);
+      length = formatInteger(buf, currentValue/10, 4);
     }
     else {
-      snprintf(buf,12,"%c%1d.%1dA%5ld\24  ", currentValue<0?'-':' ',abs(currentValue/10),abs(currentValue%10),batteryData[osdBatNo].usedCapacity/1000);
+      length = formatOSDTenths(buf, currentValue);
     }
+    buf[length++] = 'A';
+    length += formatInteger(buf + length, batteryData[osdBatNo].usedCapacity/1000, 5);
+    length += formatText(buf + length, "\24  ");
+    buf[length] = 0;
 
     writeChars( buf, 11, 0, VOLTAGE_ROW+osdBatNo, VOLTAGE_COL+6 );
   }
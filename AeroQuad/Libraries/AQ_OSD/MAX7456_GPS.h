@@ -46,28 +46,40 @@ void displayGPS(struct GeodeticPosition pos, struct GeodeticPosition home, long
       }
     }
     else {
-      char buf[5];
+      char buf[16];
+      byte length;
       computeDistanceAndBearing(pos, home);
       #ifdef USUnits
         const unsigned int distance = getDistanceFoot(); // dist to home in feet
 	    if (distance<1000) {
-          snprintf(buf,5,"%3df",(int)distance);
+          length = formatInteger(buf, (int)distance, 3);
+          buf[length++] = 'f';
         }
         else if (distance<5280) {
-          snprintf(buf,5,".%02dm", (int)(distance * 10 / 528));
+          buf[0] = '.';
+          length = 1 + formatInteger(buf + 1, (int)(distance * 10 / 528), 2, '0');
+          buf[length++] = 'm';
         }
         else {
-          snprintf(buf,5,"%d.%1dm", (int)(distance/5280), (int)(distance / 528 % 10));
+          length = formatInteger(buf, (int)(distance/5280));
+          buf[length++] = '.';
+          length += formatInteger(buf + length, (int)(distance / 528 % 10));
+          buf[length++] = 'm';
         }
       #else //metric
         const unsigned int distance = getDistanceMeter(); // dist to home in meters
 	    if (distance<1000) {
-          snprintf(buf,5,"%3dm",(int)distance);
+          length = formatInteger(buf, (int)distance, 3);
+          buf[length++] = 'm';
         }
         else {
-          snprintf(buf,5,"%d.%1d\032", (int)(distance/1000), (int)(distance / 100 % 10));
+          length = formatInteger(buf, (int)(distance/1000));
+          buf[length++] = '.';
+          length += formatInteger(buf + length, (int)(distance / 100 % 10));
+          buf[length++] = '\032';
         }
       #endif
+      buf[length] = 0;
       writeChars(buf, 4, 0, GPS_HA_ROW + 1, GPS_HA_COL - 1);
 
       short homearrow = gpsBearing - magheading; // direction of home vs. craft orientation
@@ -83,7 +95,8 @@ void displayGPS(struct GeodeticPosition pos, struct GeodeticPosition home, long
       if (courseCorrection>180) courseCorrection-=360;
       if (courseCorrection<-180) courseCorrection+=360;
       
-      snprintf(buf,5,"%c%d",courseCorrection>0?'R':'L', abs(courseCorrection));
+      buf[0] = courseCorrection>0?'R':'L';
+      buf[1 + formatInteger(buf + 1, abs(courseCorrection))] = 0;
       writeChars(buf, 4, 0, GPS_HA_ROW + 2, GPS_HA_COL - 1);
     
       osdGPSState&=~GPS_NONAV;
@@ -92,28 +105,36 @@ void displayGPS(struct GeodeticPosition pos, struct GeodeticPosition home, long
   else {
     // update position and speed
     if (gpsData.state==GPS_DETECTING) {
-      char buf[29];
-      snprintf(buf,29,"Detecting GPS");
-      writeChars(buf, 28, 0, GPS_ROW, GPS_COL);
+      writeChars("Detecting GPS", 28, 0, GPS_ROW, GPS_COL);
     } else if (gpsData.state==GPS_NOFIX) {
-      char buf[29];
-      snprintf(buf,29,"Waiting for GPS fix (%d/%d)",numsats,6);
+      char buf[40];
+      byte length = formatText(buf, "Waiting for GPS fix (");
+      length += formatInteger(buf + length, (int)numsats);
+      length += formatText(buf + length, "/6)");
+      buf[length] = 0;
       writeChars(buf, 28, 0, GPS_ROW, GPS_COL);
     } else {
-      char buf[29];
+      char buf[48];
+      byte length = formatInteger(buf, (int)numsats);
+      buf[length++] = ':';
+      buf[length++] = (pos.latitude>=0)?'N':'S';
+      length += formatInteger(buf + length, labs(pos.latitude)/10000000L, 2, '0');
+      buf[length++] = '.';
+      length += formatInteger(buf + length, labs(pos.latitude)%10000000L/10, 6, '0');
+      buf[length++] = (pos.longitude>=0)?'E':'W';
+      length += formatInteger(buf + length, labs(pos.longitude)/10000000L, 3, '0');
+      buf[length++] = '.';
+      length += formatInteger(buf + length, labs(pos.longitude)%10000000L/10, 6, '0');
 #ifdef USUnits
       speed=speed*36/1609; // convert from cm/s to mph 
-      snprintf(buf,29,"%d:%c%02ld.%06ld%c%03ld.%06ld%3ld\031",numsats,
-               (pos.latitude>=0)?'N':'S',labs(pos.latitude)/10000000L,labs(pos.latitude)%10000000L/10,
-               (pos.longitude>=0)?'E':'W',labs(pos.longitude)/10000000L,labs(pos.longitude)%10000000L/10,
-	       speed);
+      length += formatInteger(buf + length, speed, 3);
+      buf[length++] = '\031';
 #else
       speed=speed*36/1000; // convert from cm/s to kmh 
-      snprintf(buf,29,"%d:%c%02ld.%06ld%c%03ld.%06ld%3ld\030",numsats,
-               (pos.latitude>=0)?'N':'S',labs(pos.latitude)/10000000L,labs(pos.latitude)%10000000L/10,
-               (pos.longitude>=0)?'E':'W',labs(pos.longitude)/10000000L,labs(pos.longitude)%10000000L/10,
-	       speed);
+      length += formatInteger(buf + length, speed, 3);
+      buf[length++] = '\030';
 #endif
+      buf[length] = 0;
       writeChars(buf, 28, 0, GPS_ROW, GPS_COL);
     }
   }
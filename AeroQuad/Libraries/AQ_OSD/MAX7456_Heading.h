@@ -32,8 +32,11 @@ void displayHeading(float currentHeading) {
   int currentHeadingDeg = (int)( 0.5 + (deg<-0.5 ? deg+360.0 : deg));
 
   if (currentHeadingDeg != lastHeading) {
-    char buf[6];
-    snprintf(buf,6,"\026%3d\027",currentHeadingDeg); // \026 is compass \027 is degree symbol
+    char buf[10];
+    buf[0] = '\026'; // compass symbol
+    byte length = 1 + formatInteger(buf + 1, currentHeadingDeg, 3);
+    buf[length++] = '\027'; // degree symbol
+    buf[length] = 0;
     writeChars( buf, 5, 0, COMPASS_ROW, COMPASS_COL );
     lastHeading = currentHeadingDeg;
   }
@@ -66,6 +66,7 @@ byte notifyOSDmenu(byte flags, byte cursorLeft, byte cursorRight, const char *fm
   }
   if (flags & OSD_NOW) {
     displayNotify();
+    flushOSD();
   }
   else {
     osdNotificationFlags |= OSD_NOW; // this will tell next update to show message
@@ -42,19 +42,23 @@ void displayRSSI() {
 
   if (rssiRawValue != lastRSSI) {
     lastRSSI = rssiRawValue;
-    char buf[6];
+    char buf[16];
+    buf[0] = '\372';
     #ifdef RSSI_RAWVAL
-      snprintf(buf, 6, "\372%4u", rssiRawValue);
+      buf[1 + formatUnsigned(buf + 1, (unsigned int)rssiRawValue, 4)] = 0;
       writeChars(buf, 5, 0, RSSI_ROW, RSSI_COL);
     #else
-      snprintf(buf, 6, "\372%3u%%", rssiRawValue);
+      byte length = 1 + formatUnsigned(buf + 1, (unsigned int)rssiRawValue, 3);
+      buf[length++] = '%';
+      buf[length] = 0;
       writeChars(buf, 5, (RSSI_WARN>rssiRawValue)?1:0, RSSI_ROW, RSSI_COL);
     #endif
   }
   #if defined (UseEzUHFRSSIReader)
     if (lastQuality != signalQualityRawValue) {
-	  char buf[6];
-	  snprintf(buf, 6, "\372%4u", signalQualityRawValue);
+	  char buf[16];
+	  buf[0] = '\372';
+	  buf[1 + formatUnsigned(buf + 1, (unsigned int)signalQualityRawValue, 4)] = 0;
       writeChars(buf, 5, 0, SIGNAL_QUALITY_ROW, SIGNAL_QUALITY_COL);
 	  signalQualityRawValue = lastQuality;
 	}
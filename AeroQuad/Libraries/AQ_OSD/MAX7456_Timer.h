@@ -38,8 +38,12 @@ void displayFlightTime(byte areMotorsArmed) {
   unsigned int armedTimeSecs = armedTime / 1000000;
   if (armedTimeSecs != prevArmedTimeSecs) {
     prevArmedTimeSecs = armedTimeSecs;
-    char buf[7];
-    snprintf(buf,7,"\025%02u:%02u",armedTimeSecs/60,armedTimeSecs%60);
+    char buf[12];
+    buf[0] = '\025';
+    byte length = 1 + formatUnsigned(buf + 1, armedTimeSecs/60, 2, '0');
+    buf[length++] = ':';
+    length += formatUnsigned(buf + length, armedTimeSecs%60, 2, '0');
+    buf[length] = 0;
     writeChars(buf, 6, 0, TIMER_ROW, TIMER_COL );
   }
 }
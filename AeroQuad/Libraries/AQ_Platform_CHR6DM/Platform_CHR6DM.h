@@ -31,6 +31,8 @@
 #include "Arduino.h"
 
 #define DEFAULT_TIMEOUT 1000
+#define SENSOR_DATA_TIMEOUT 50      // ms without sensor data before GET_DATA is sent again
+#define MAX_PACKET_DATA 64          // largest report is about 40 data bytes
 
 
 
@@ -40,7 +42,7 @@
      const int  FAILED_CHECKSUM           = 0x01;
 
 
-     int packet[100];
+     byte packet[MAX_PACKET_DATA + 1];    // packet type then data bytes
      int packet_length = 0;
 
     // Client command packets
@@ -157,6 +159,16 @@
      const char PACKET_HEADER[] = {'s','n','p'};
      const int HEADER_CHECKSUM = 's'+'n'+'p';
 
+    // Frame decoder states
+     const byte DECODE_HEADER_S           = 0;
+     const byte DECODE_HEADER_N           = 1;
+     const byte DECODE_HEADER_P           = 2;
+     const byte DECODE_TYPE               = 3;
+     const byte DECODE_LENGTH             = 4;
+     const byte DECODE_DATA               = 5;
+     const byte DECODE_CHECKSUM_HIGH      = 6;
+     const byte DECODE_CHECKSUM_LOW       = 7;
+
 
 #include <Wire.h>
 
@@ -208,7 +220,10 @@ public:
 
 
     CHR6DM(void){
-        //Nothing here
+        decodeState = DECODE_HEADER_S;
+        checksumErrors = 0;
+        lengthErrors = 0;
+        lastSensorDataTime = 0;
     }
 
 
@@ -226,88 +241,104 @@ public:
   }
 
 
-    int readPacket()  {
-
-        if (!syncToHeader()){
-            //Serial.println("Not synced to header");
-            packet[0]= NO_DATA;
-            packet_length=1;
-            return NO_DATA;
-        }
-
-
-        int packetType =  blockingRead();
-        int dataBytes  =  blockingRead();
-
-        int calculatedChecksum = HEADER_CHECKSUM + packetType + dataBytes;
-
-        int  length = dataBytes+1;
-        packet[0] = packetType;
-
-        for (int i = 1; i <= dataBytes ;i++ ){
-            packet[i] = blockingRead() ;
-            calculatedChecksum+=packet[i];
-        }
-
-        int high =  blockingRead();
-        int low =   blockingRead();
-
-        int packetChecksum = bytesToSignedShort(high,low);
-
-        if (calculatedChecksum!=packetChecksum) {
-            //Serial.print("Bad checksum ");Serial.print(" calculated="); Serial.print(calculatedChecksum);Serial.print(" actual="); Serial.println(packetChecksum);
-            packet[0] = FAILED_CHECKSUM;
-            packet_length=1;
-            return FAILED_CHECKSUM;
+    // Incremental frame decoder, fed one byte at a time, keeps its place
+    // between calls so a frame can arrive over any number of loop passes
+    byte decodeState;
+    byte decodeIndex;
+    byte decodeLength;
+    unsigned int decodeChecksum;
+    unsigned int receivedChecksum;
+    unsigned int checksumErrors;
+    unsigned int lengthErrors;          // headers dropped for a length past MAX_PACKET_DATA
+    unsigned long lastSensorDataTime;
+
+    /**
+     * Returns the packet type once a frame is complete and valid, with
+     * packet[] and packet_length set, FAILED_CHECKSUM for a corrupted
+     * frame and NO_DATA otherwise
+     */
+    int decodeByte(byte c) {
+        switch (decodeState) {
+            case DECODE_HEADER_S:
+            case DECODE_HEADER_N:
+            case DECODE_HEADER_P:
+                if (c == PACKET_HEADER[decodeState]) {
+                    decodeState++;
+                }
+                else {
+                    decodeState = (c == PACKET_HEADER[0]) ? DECODE_HEADER_N : DECODE_HEADER_S;
+                }
+                return NO_DATA;
+            case DECODE_TYPE:
+                packet[0] = c;
+                decodeChecksum = HEADER_CHECKSUM + c;
+                decodeState = DECODE_LENGTH;
+                return NO_DATA;
+            case DECODE_LENGTH:
+                if (c > MAX_PACKET_DATA) {
+                    lengthErrors++;
+                    decodeState = DECODE_HEADER_S;   // not a real header, look for the next one
+                    return NO_DATA;
+                }
+                decodeLength = c;
+                decodeIndex = 1;
+                decodeChecksum += c;
+                decodeState = (c == 0) ? DECODE_CHECKSUM_HIGH : DECODE_DATA;
+                return NO_DATA;
+            case DECODE_DATA:
+                packet[decodeIndex++] = c;
+                decodeChecksum += c;
+                if (decodeIndex > decodeLength) {
+                    decodeState = DECODE_CHECKSUM_HIGH;
+                }
+                return NO_DATA;
+            case DECODE_CHECKSUM_HIGH:
+                receivedChecksum = (unsigned int)c << 8;
+                decodeState = DECODE_CHECKSUM_LOW;
+                return NO_DATA;
+            default:
+                decodeState = DECODE_HEADER_S;
+                if ((receivedChecksum | c) != decodeChecksum) {
+                    checksumErrors++;
+                    return FAILED_CHECKSUM;
+                }
+                packet_length = decodeLength + 1;
+                return packet[0];
         }
-
-        packet_length=length;
-        return packet[0];
-
     }
-    
-    int blockingRead(){
-        int read=-1;
 
-         long starttime = millis();
-         while(read==-1 && (millis()-starttime)<100){
-            read = Serial1.read();
-         }
-
-         return read;
-    }
-
-    bool syncToHeader()  {
-
-        int MAX_PACKET_LENGTH = 41; // TODO - Unsure about this, calculate the actual
-        int available = Serial1.available();
-
-        if (available > MAX_PACKET_LENGTH ){
-            for (int i = 0; i < available - MAX_PACKET_LENGTH; i++){
-                Serial1.read();
+    /**
+     * Consumes what Serial1 has buffered up to the end of the next frame,
+     * never waits
+     */
+    int readPacket()  {
+        while (Serial1.available() > 0) {
+            const int packetType = decodeByte(Serial1.read());
+            if (packetType != NO_DATA) {
+                if (packetType == FAILED_CHECKSUM) {
+                    packet[0] = FAILED_CHECKSUM;
+                    packet_length = 1;
+                }
+                return packetType;
             }
         }
-
-        while (Serial1.available()>0){
-            if (blockingRead()==PACKET_HEADER[0] && blockingRead()==PACKET_HEADER[1] && blockingRead()==PACKET_HEADER[2] ) return true;
-        }
-
-        return false;
+        return NO_DATA;
     }
 
-
      void resetToFactory()  {
         sendPacket(RESET_TO_FACTORY);
     }
 
      bool setActiveChannels(int channels)  {
-        sendPacket(SET_ACTIVE_CHANNELS,(int[]){channels},1);
+        int argument[] = {channels};
+        sendPacket(SET_ACTIVE_CHANNELS,argument,1);
         return waitForAck(DEFAULT_TIMEOUT);
     }
 
 
      void setBroadCastMode(int x) {
-        sendPacket(SET_BROADCAST_MODE,(int[]){x},1);
+        int argument[] = {x};
+        sendPacket(SET_BROADCAST_MODE,argument,1);
     }
 
      void sendPacket(int command)  {
@@ -316,7 +347,7 @@ public:
 
      void sendPacket(int command, int* bytes, int byteslength)  {
 
-            int checksum = 0;
+            unsigned int checksum = 0;
             int buffer[] = {'s','n','p',command,byteslength};
             int bufferlength=5;
             for (int i = 0; i < bufferlength; i++) {
@@ -337,10 +368,12 @@ public:
 
     bool requestPacket(){
         sendPacket(GET_DATA);
+        lastSensorDataTime = millis();
+        return true;
     }
 
     bool waitForAndReadPacket(){
-        waitFor(SENSOR_DATA, DEFAULT_TIMEOUT);
+        return waitFor(SENSOR_DATA, DEFAULT_TIMEOUT);
     }
 
      bool requestAndReadPacket() {
@@ -351,8 +384,8 @@ public:
 
      bool waitFor(int command,int timeout) {
 
-       long startTime = millis();
-        while((millis()-startTime)<timeout){
+       unsigned long startTime = millis();
+        while((millis()-startTime)<(unsigned long)timeout){
             int packetType  = readPacket();
 
             if (packetType>1){
@@ -373,11 +406,15 @@ public:
     }
 
      bool decodePacket() {
-        int index = 0;
-        switch (packet[index++]) {
+        int index = 1;
+        switch (packet[0]) {
             case SENSOR_DATA: {
 
-                int flags = bytesToSignedShort(packet[index++],packet[index++]);
+                if (packet_length < 3) {
+                    return false;
+                }
+                unsigned int flags = word(packet[1],packet[2]);
+                index = 3;
 
                 data.yawEnabled          = (flags & CHANNEL_YAW_MASK            ) == CHANNEL_YAW_MASK;
                 data.pitchEnabled        = (flags & CHANNEL_PITCH_MASK          ) == CHANNEL_PITCH_MASK;
@@ -396,21 +433,21 @@ public:
                 data.azEnabled           = (flags & CHANNEL_AZ_MASK             ) == CHANNEL_AZ_MASK;
 
 
-                if (data.yawEnabled          ){ data.yaw          = SCALE_YAW           * bytesToSignedShort(packet[index++],packet[index++]); }
-                if (data.pitchEnabled        ){ data.pitch        = SCALE_PITCH         * bytesToSignedShort(packet[index++],packet[index++]); }
-                if (data.rollEnabled         ){ data.roll         = SCALE_ROLL          * bytesToSignedShort(packet[index++],packet[index++]); }
-                if (data.yawRateEnabled      ){ data.yawRate      = SCALE_YAW_RATE      * bytesToSignedShort(packet[index++],packet[index++]); }
-                if (data.pitchRateEnabled    ){ data.pitchRate    = SCALE_PITCH_RATE    * bytesToSignedShort(packet[index++],packet[index++]); }
-                if (data.rollRateEnabled     ){ data.rollRate     = SCALE_ROLL_RATE     * bytesToSignedShort(packet[index++],packet[index++]); }
-                if (data.mxEnabled           ){ data.mx           = SCALE_MAG_X         * bytesToSignedShort(packet[index++],packet[index++]); }
-                if (data.myEnabled           ){ data.my           = SCALE_MAG_Y         * bytesToSignedShort(packet[index++],packet[index++]); }
-                if (data.mzEnabled           ){ data.mz           = SCALE_MAG_Z         * bytesToSignedShort(packet[index++],packet[index++]); }
-                if (data.gxEnabled           ){ data.gx           = SCALE_GYRO_X        * bytesToSignedShort(packet[index++],packet[index++]); }
-                if (data.gyEnabled           ){ data.gy           = SCALE_GYRO_Y        * bytesToSignedShort(packet[index++],packet[index++]); }
-                if (data.gzEnabled           ){ data.gz           = SCALE_GYRO_Z        * bytesToSignedShort(packet[index++],packet[index++]); }
-                if (data.axEnabled           ){ data.ax           = SCALE_ACCEL_X       * bytesToSignedShort(packet[index++],packet[index++]); }
-                if (data.ayEnabled           ){ data.ay           = SCALE_ACCEL_Y       * bytesToSignedShort(packet[index++],packet[index++]); }
-                if (data.azEnabled           ){ data.az           = SCALE_ACCEL_Z       * bytesToSignedShort(packet[index++],packet[index++]); }
+                if (data.yawEnabled          ){ data.yaw          = SCALE_YAW           * packetShort(&index); }
+                if (data.pitchEnabled        ){ data.pitch        = SCALE_PITCH         * packetShort(&index); }
+                if (data.rollEnabled         ){ data.roll         = SCALE_ROLL          * packetShort(&index); }
+                if (data.yawRateEnabled      ){ data.yawRate      = SCALE_YAW_RATE      * packetShort(&index); }
+                if (data.pitchRateEnabled    ){ data.pitchRate    = SCALE_PITCH_RATE    * packetShort(&index); }
+                if (data.rollRateEnabled     ){ data.rollRate     = SCALE_ROLL_RATE     * packetShort(&index); }
+                if (data.mxEnabled           ){ data.mx           = SCALE_MAG_X         * packetShort(&index); }
+                if (data.myEnabled           ){ data.my           = SCALE_MAG_Y         * packetShort(&index); }
+                if (data.mzEnabled           ){ data.mz           = SCALE_MAG_Z         * packetShort(&index); }
+                if (data.gxEnabled           ){ data.gx           = SCALE_GYRO_X        * packetShort(&index); }
+                if (data.gyEnabled           ){ data.gy           = SCALE_GYRO_Y        * packetShort(&index); }
+                if (data.gzEnabled           ){ data.gz           = SCALE_GYRO_Z        * packetShort(&index); }
+                if (data.axEnabled           ){ data.ax           = SCALE_ACCEL_X       * packetShort(&index); }
+                if (data.ayEnabled           ){ data.ay           = SCALE_ACCEL_Y       * packetShort(&index); }
+                if (data.azEnabled           ){ data.az           = SCALE_ACCEL_Z       * packetShort(&index); }
 
                 if (index!=packet_length){
                     //Serial.println("Recevied bad length packet!");
@@ -453,7 +490,20 @@ public:
     }
 
     int bytesToSignedShort(int high, int low) {
-        return word(high,low);
+        return (int16_t)word(high,low);
+    }
+
+    /**
+     * Next big endian signed short of the packet, zero past its end so a
+     * short frame is read safely and then rejected on its length
+     */
+    int packetShort(int *index) {
+        const int i = *index;
+        *index = i + 2;
+        if (i + 1 >= packet_length) {
+            return 0;
+        }
+        return bytesToSignedShort(packet[i], packet[i + 1]);
     }
 
     bool setListenMode() {
@@ -463,10 +513,9 @@ public:
 
     bool waitForAck(int timeout) {
 
-        long startTime = millis();
-        while(millis()-startTime<timeout){
-        readPacket();
-        int command=packet[0];
+        unsigned long startTime = millis();
+        while(millis()-startTime<(unsigned long)timeout){
+        int command = readPacket();
             switch(command){
                 case COMMAND_COMPLETE :
                     return true;
@@ -484,9 +533,21 @@ public:
         return false;
     }
 	
+	/**
+	 * Non blocking, decodes whatever sensor data has arrived and asks for
+	 * the next one as soon as it is in, or again if the answer got lost
+	 */
 	void read(){
-        waitForAndReadPacket();
-        requestPacket();
+        int packetType;
+        while ((packetType = readPacket()) != NO_DATA) {
+            if (packetType == SENSOR_DATA) {
+                decodePacket();
+                requestPacket();
+            }
+        }
+        if (millis() - lastSensorDataTime > SENSOR_DATA_TIMEOUT) {
+            requestPacket();
+        }
     }
 
 };
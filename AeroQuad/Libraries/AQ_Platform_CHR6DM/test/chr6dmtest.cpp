@@ -0,0 +1,335 @@
+/*
+ * Fuzz and throughput test of the incremental CHR6DM frame decoder
+ *
+ * Byte streams of SENSOR_DATA frames with random active channels, mixed
+ * with COMMAND_COMPLETE frames and line noise, are fed to the real
+ * decoder through a simulated Serial1 in random fragments, polled as on
+ * the flight controller. Each sensor frame carries its number in the yaw
+ * channel, so every decoded one is checked against the frame sent. Three
+ * streams are run:
+ *   - clean, every frame must decode
+ *   - corrupted, one byte of some frames flipped: exactly those are lost,
+ *     one checksum error each
+ *   - truncated, some frames cut short: one resync for each cut past the
+ *     header, but a cut frame swallowed by the one before may go without,
+ *     and every frame starting beyond the reach of a cut one must decode
+ * No stream may give a frame that was not sent. read() is then run on the
+ * clean stream, and the decoding rate of a clean stream is reported.
+ *
+ *   make check
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+#include "Arduino.h"
+
+#define SENSOR_FRAMES 20000
+#define DAMAGE_ONE_IN 10
+#define THROUGHPUT_ROUNDS 50
+
+/* simulated ports and clock, the decoder is built for the Mega */
+struct HostSerial1 {
+  std::vector<byte> stream;
+  size_t delivered;
+  size_t position;
+  unsigned long written;
+
+  int available() { return (int)(delivered - position); }
+  int read() { return stream[position++]; }
+  void write(int) { written++; }
+} Serial1;
+
+struct HostSerial {
+  template <typename T> void print(T) {}
+  template <typename T> void println(T) {}
+} Serial;
+
+static unsigned long simulatedMillis = 0;
+static unsigned long millis() { return simulatedMillis; }
+
+#define __AVR_ATmega2560__
+#include "Platform_CHR6DM.h"
+
+/* the shortest header, the longest frame a header can make the decoder take */
+#define FRAME_HEADER_SIZE 5
+#define FRAME_REACH (FRAME_HEADER_SIZE + MAX_PACKET_DATA + 2)
+
+/* the channels in packet order, as decodePacket() reads them */
+static const struct {
+  int mask;
+  double scale;
+  double Data::*value;
+  bool Data::*enabled;
+} channels[] = {
+  {CHANNEL_YAW_MASK,        SCALE_YAW,        &Data::yaw,       &Data::yawEnabled},
+  {CHANNEL_PITCH_MASK,      SCALE_PITCH,      &Data::pitch,     &Data::pitchEnabled},
+  {CHANNEL_ROLL_MASK,       SCALE_ROLL,       &Data::roll,      &Data::rollEnabled},
+  {CHANNEL_YAW_RATE_MASK,   SCALE_YAW_RATE,   &Data::yawRate,   &Data::yawRateEnabled},
+  {CHANNEL_PITCH_RATE_MASK, SCALE_PITCH_RATE, &Data::pitchRate, &Data::pitchRateEnabled},
+  {CHANNEL_ROLL_RATE_MASK,  SCALE_ROLL_RATE,  &Data::rollRate,  &Data::rollRateEnabled},
+  {CHANNEL_MX_MASK,         SCALE_MAG_X,      &Data::mx,        &Data::mxEnabled},
+  {CHANNEL_MY_MASK,         SCALE_MAG_Y,      &Data::my,        &Data::myEnabled},
+  {CHANNEL_MZ_MASK,         SCALE_MAG_Z,      &Data::mz,        &Data::mzEnabled},
+  {CHANNEL_GX_MASK,         SCALE_GYRO_X,     &Data::gx,        &Data::gxEnabled},
+  {CHANNEL_GY_MASK,         SCALE_GYRO_Y,     &Data::gy,        &Data::gyEnabled},
+  {CHANNEL_GZ_MASK,         SCALE_GYRO_Z,     &Data::gz,        &Data::gzEnabled},
+  {CHANNEL_AX_MASK,         SCALE_ACCEL_X,    &Data::ax,        &Data::axEnabled},
+  {CHANNEL_AY_MASK,         SCALE_ACCEL_Y,    &Data::ay,        &Data::ayEnabled},
+  {CHANNEL_AZ_MASK,         SCALE_ACCEL_Z,    &Data::az,        &Data::azEnabled},
+};
+#define CHANNELS (int)(sizeof(channels) / sizeof(channels[0]))
+
+/* xorshift, the same streams on every host */
+static uint32_t randomState = 2463534242u;
+static uint32_t nextRandom() {
+  randomState ^= randomState << 13;
+  randomState ^= randomState >> 17;
+  randomState ^= randomState << 5;
+  return randomState;
+}
+
+enum { CLEAN, CORRUPTED, TRUNCATED };
+
+struct SensorFrame {
+  unsigned int flags;
+  int16_t value[CHANNELS];
+  size_t start;             // offset of its 's' in the stream
+  bool damaged;
+  bool truncatedPastHeader;
+};
+
+struct TestStream {
+  std::vector<byte> bytes;
+  std::vector<SensorFrame> frames;  // frame n has n in its yaw channel
+  int commands;
+};
+
+static void appendFrame(std::vector<byte> &bytes, byte type, const std::vector<byte> &data) {
+  unsigned int checksum = 's' + 'n' + 'p' + type + data.size();
+  bytes.push_back('s');
+  bytes.push_back('n');
+  bytes.push_back('p');
+  bytes.push_back(type);
+  bytes.push_back(data.size());
+  for (size_t i = 0; i < data.size(); i++) {
+    bytes.push_back(data[i]);
+    checksum += data[i];
+  }
+  bytes.push_back(checksum >> 8);
+  bytes.push_back(checksum);
+}
+
+static TestStream buildStream(int kind, int frameCount) {
+  TestStream stream;
+  stream.commands = 0;
+  for (int n = 0; n < frameCount; n++) {
+    if (nextRandom() % 4 == 0) {
+      // line noise, never an 's' so it can not start a header of its own
+      for (int i = 1 + nextRandom() % 8; i > 0; i--) {
+        byte noise = nextRandom();
+        stream.bytes.push_back(noise == 's' ? 0 : noise);
+      }
+    }
+    if (nextRandom() % 8 == 0) {
+      appendFrame(stream.bytes, COMMAND_COMPLETE, std::vector<byte>());
+      stream.commands++;
+    }
+
+    SensorFrame frame;
+    frame.flags = (nextRandom() & 0x7FFE) | CHANNEL_YAW_MASK;
+    std::vector<byte> data;
+    data.push_back(frame.flags >> 8);
+    data.push_back(frame.flags);
+    for (int c = 0; c < CHANNELS; c++) {
+      frame.value[c] = (c == 0) ? n : (int16_t)nextRandom();
+      if (frame.flags & channels[c].mask) {
+        data.push_back((uint16_t)frame.value[c] >> 8);
+        data.push_back(frame.value[c]);
+      }
+    }
+    frame.start = stream.bytes.size();
+    appendFrame(stream.bytes, SENSOR_DATA, data);
+    const size_t frameSize = stream.bytes.size() - frame.start;
+
+    frame.damaged = kind != CLEAN && nextRandom() % DAMAGE_ONE_IN == 0;
+    frame.truncatedPastHeader = false;
+    if (frame.damaged && kind == CORRUPTED) {
+      const size_t at = frame.start + FRAME_HEADER_SIZE + nextRandom() % (frameSize - FRAME_HEADER_SIZE);
+      stream.bytes[at] ^= 1 + nextRandom() % 255;
+    }
+    if (frame.damaged && kind == TRUNCATED) {
+      const size_t kept = 1 + nextRandom() % (frameSize - 1);
+      stream.bytes.resize(frame.start + kept);
+      frame.truncatedPastHeader = kept >= 3;
+    }
+    stream.frames.push_back(frame);
+  }
+  return stream;
+}
+
+static bool matches(const Data &data, const SensorFrame &frame) {
+  for (int c = 0; c < CHANNELS; c++) {
+    const bool enabled = frame.flags & channels[c].mask;
+    if (data.*channels[c].enabled != enabled) {
+      return false;
+    }
+    if (enabled && data.*channels[c].value != channels[c].scale * frame.value[c]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/* Delivers the stream in fragments of what a loop pass may find buffered
+ * and polls readPacket() after each, returns the number of failures */
+static int runStream(const char *name, int kind) {
+  const TestStream stream = buildStream(kind, SENSOR_FRAMES);
+  CHR6DM chr6;
+  Serial1.stream = stream.bytes;
+  Serial1.delivered = 0;
+  Serial1.position = 0;
+
+  std::vector<bool> decoded(stream.frames.size(), false);
+  int sensorPackets = 0;
+  int commandPackets = 0;
+  int falseAccepts = 0;
+  int lastFrame = -1;
+  while (Serial1.delivered < Serial1.stream.size()) {
+    Serial1.delivered = min(Serial1.stream.size(), Serial1.delivered + 1 + nextRandom() % 64);
+    int packetType;
+    while ((packetType = chr6.readPacket()) != NO_DATA) {
+      if (packetType == COMMAND_COMPLETE) {
+        commandPackets++;
+      }
+      else if (packetType == SENSOR_DATA) {
+        sensorPackets++;
+        const int n = chr6.decodePacket() ? (int)lround(chr6.data.yaw / SCALE_YAW) : -1;
+        if (n <= lastFrame || n >= (int)stream.frames.size() || !matches(chr6.data, stream.frames[n])) {
+          falseAccepts++;
+        }
+        else {
+          decoded[n] = true;
+          lastFrame = n;
+        }
+      }
+      else if (packetType != FAILED_CHECKSUM) {
+        falseAccepts++;
+      }
+    }
+  }
+
+  int damaged = 0;
+  int truncatedPastHeader = 0;
+  int isolatedPastHeader = 0;
+  int lost = 0;
+  int lostBeyondReach = 0;
+  size_t reach = 0;
+  for (size_t n = 0; n < stream.frames.size(); n++) {
+    const SensorFrame &frame = stream.frames[n];
+    damaged += frame.damaged;
+    truncatedPastHeader += frame.truncatedPastHeader;
+    isolatedPastHeader += frame.truncatedPastHeader && frame.start >= reach;
+    if (!decoded[n] && !frame.damaged) {
+      lost++;
+      if (frame.start >= reach) {
+        lostBeyondReach++;
+      }
+    }
+    if (frame.damaged) {
+      reach = frame.start + FRAME_REACH;
+    }
+  }
+
+  int failures = 0;
+  const int resyncs = chr6.checksumErrors + chr6.lengthErrors;
+  printf("%-10s %7u bytes, %5d sensor frames, %4d commands, %4d damaged: %5d decoded, %4d commands, %4d lost, %4d checksum and %3d length resyncs\n",
+         name, (unsigned)stream.bytes.size(), (int)stream.frames.size(), stream.commands, damaged,
+         sensorPackets, commandPackets, lost, chr6.checksumErrors, chr6.lengthErrors);
+  if (falseAccepts > 0) {
+    printf("  %d packets decoded that were not sent\n", falseAccepts);
+    failures++;
+  }
+  if (kind == CLEAN && (sensorPackets != SENSOR_FRAMES || commandPackets != stream.commands || resyncs != 0)) {
+    printf("  the clean stream must decode whole without resyncs\n");
+    failures++;
+  }
+  if (kind == CORRUPTED && (sensorPackets != SENSOR_FRAMES - damaged || commandPackets != stream.commands ||
+                            (int)chr6.checksumErrors != damaged || chr6.lengthErrors != 0)) {
+    printf("  every corrupted frame must be one checksum error and cost no other frame\n");
+    failures++;
+  }
+  if (kind == TRUNCATED && (lostBeyondReach != 0 || resyncs < isolatedPastHeader || resyncs > truncatedPastHeader)) {
+    printf("  %d frames lost beyond the reach of a cut one, %d resyncs for %d cuts past the header, %d of them isolated\n",
+           lostBeyondReach, resyncs, truncatedPastHeader, isolatedPastHeader);
+    failures++;
+  }
+  return failures;
+}
+
+/* read() answers every sensor frame with the next GET_DATA, and sends one
+ * again once SENSOR_DATA_TIMEOUT passes without data */
+static int runPolling() {
+  const TestStream stream = buildStream(CLEAN, SENSOR_FRAMES);
+  CHR6DM chr6;
+  Serial1.stream = stream.bytes;
+  Serial1.delivered = 0;
+  Serial1.position = 0;
+  Serial1.written = 0;
+  simulatedMillis = 0;
+  while (Serial1.delivered < Serial1.stream.size()) {
+    Serial1.delivered = min(Serial1.stream.size(), Serial1.delivered + 1 + nextRandom() % 64);
+    chr6.read();
+  }
+  const unsigned long requests = Serial1.written / (FRAME_HEADER_SIZE + 2);
+  simulatedMillis += SENSOR_DATA_TIMEOUT + 1;
+  chr6.read();
+  const unsigned long retries = Serial1.written / (FRAME_HEADER_SIZE + 2) - requests;
+
+  printf("read()     %lu GET_DATA for %d sensor frames, %lu after the timeout\n", requests, SENSOR_FRAMES, retries);
+  if (requests != SENSOR_FRAMES || retries != 1 || !matches(chr6.data, stream.frames.back())) {
+    printf("  read() must request once per frame, again after the timeout, and keep the last frame\n");
+    return 1;
+  }
+  return 0;
+}
+
+/* Decoding rate of a clean stream, all of it buffered */
+static void runThroughput() {
+  const TestStream stream = buildStream(CLEAN, SENSOR_FRAMES);
+  Serial1.stream = stream.bytes;
+  double checksum = 0.0;
+  const auto start = std::chrono::steady_clock::now();
+  for (int round = 0; round < THROUGHPUT_ROUNDS; round++) {
+    CHR6DM chr6;
+    Serial1.delivered = Serial1.stream.size();
+    Serial1.position = 0;
+    int packetType;
+    while ((packetType = chr6.readPacket()) != NO_DATA) {
+      if (packetType == SENSOR_DATA && chr6.decodePacket()) {
+        checksum += chr6.data.yaw;
+      }
+    }
+  }
+  const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  const double bytes = (double)stream.bytes.size() * THROUGHPUT_ROUNDS;
+  printf("throughput %.1f Mbytes/s, %.0f ns per byte (%.0f)\n", bytes / elapsed / 1e6, elapsed / bytes * 1e9, checksum);
+}
+
+int main() {
+  int failures = 0;
+  failures += runStream("clean", CLEAN);
+  failures += runStream("corrupted", CORRUPTED);
+  failures += runStream("truncated", TRUNCATED);
+  failures += runPolling();
+  runThroughput();
+  printf(failures ? "FAILED\n" : "PASSED\n");
+  return failures ? 1 : 0;
+}
@@ -88,6 +88,9 @@
 #define BIT_RAW_RDY_EN			0x01
 #define BIT_I2C_IF_DIS          0x10
 #define BIT_INT_STATUS_DATA		0x01
+#define BIT_FIFO_EN             0x40
+#define BIT_FIFO_RESET          0x04
+#define BITS_FIFO_ACCEL_TEMP_GYRO  0xF8
 
 
 typedef struct {
@@ -106,6 +109,14 @@ union uMPU6000 {
   } data;
 } MPU6000;
 
+#if defined(MavLinkHIL)
+  // hardware in the loop, MavLink.h puts the simulator's accel and gyro
+  // in place of the ones just read
+  #if defined(MPU6000_FIFO)
+    #error "MavLinkHIL replaces single samples, it can't be used with MPU6000_FIFO"
+  #endif
+  void readHILMPU6000(tAxis *accel, tAxis *gyro);
+#endif
 
 #ifdef MPU6000_I2C
   #ifndef MPU6000_I2C_ADDRESS
@@ -113,13 +124,112 @@ union uMPU6000 {
   #endif
 #else
   #include <HardwareSPIExt.h>
+  #include <SPITransaction.h>
   HardwareSPIExt spiMPU6000(4);
+
+  // SPI4 is SPI3 on the alternate pins, SPI3_RX is on DMA1 stream 0, SPI3_TX on stream 7, both channel 0
+  SPIBus mpu6000SpiBus = {SPI4, DMA1, DMA_STREAM0, DMA_STREAM7, DMA_CR_CH0};
+  // APB1 / 4 = 10.5MHz, sensor registers may be read at up to 20MHz
+  SPIDevice mpu6000SpiDevice = {&mpu6000SpiBus, spiMPU6000.nssPin(), SPI_BAUD_PCLK_DIV_4, SPI_MODE_3};
+
+  // register address followed by the 14 bytes of accel, temperature and gyro
+  byte mpu6000BurstTx[15] = {MPUREG_ACCEL_XOUT_H | SPI_READ_FLAG};
+  byte mpu6000BurstRx[15];
+  SPITransaction mpu6000Burst = {&mpu6000SpiDevice, mpu6000BurstTx, mpu6000BurstRx, sizeof(mpu6000BurstRx), NULL, SPI_TRANSACTION_IDLE};
+
+  void mpu6000SpiBusComplete() {
+    completeSPITransaction(&mpu6000SpiBus);
+  }
+#endif
+
+#if defined(MPU6000_FIFO)
+  // Every 1kHz sample goes through the FIFO, in the register order of the
+  // burst read. readMPU6000Sensors() queues a count read, its completion
+  // queues the read of the whole samples waiting, and that completion adds
+  // them to running sums. The gyro and accel sum functions take the sums
+  // instead of a single sample, so the 100Hz average covers every sample.
+  #if defined(MPU6000_I2C)
+    #error "MPU6000_FIFO needs the SPI connected MPU6000"
+  #endif
+
+  #define MPU6000_FIFO_SAMPLE_SIZE 14
+  #define MPU6000_FIFO_SAMPLE_PERIOD 1000   // us, 1kHz sample rate
+  #define MPU6000_FIFO_MAX_SAMPLES 16       // per read, more are left for the next drain
+  #define MPU6000_FIFO_SIZE 1024
+  #define MPU6000_FIFO_MAX_BATCH 100       // samples kept for the sum functions before they count as stale
+
+  byte mpu6000FifoCountTx[3] = {MPUREG_FIFO_COUNTH | SPI_READ_FLAG};
+  byte mpu6000FifoCountRx[3];
+  byte mpu6000FifoTx[1 + MPU6000_FIFO_MAX_SAMPLES * MPU6000_FIFO_SAMPLE_SIZE] = {MPUREG_FIFO_R_W | SPI_READ_FLAG};
+  byte mpu6000FifoRx[1 + MPU6000_FIFO_MAX_SAMPLES * MPU6000_FIFO_SAMPLE_SIZE];
+
+  // written by the DMA interrupt
+  volatile long mpu6000FifoGyroSum[3] = {0,0,0};
+  volatile long mpu6000FifoAccelSum[3] = {0,0,0};
+  volatile byte mpu6000FifoSamples = 0;
+  volatile unsigned long mpu6000FifoSampleCount = 0;   // since start, the sensor's own clock
+  volatile boolean mpu6000FifoOverflow = false;
+  byte mpu6000FifoLast[MPU6000_FIFO_SAMPLE_SIZE];
+
+  // taken by measureGyroSum() and measureAccelSum()
+  long mpu6000BatchGyro[3] = {0,0,0};
+  byte mpu6000BatchGyroSamples = 0;
+  long mpu6000BatchAccel[3] = {0,0,0};
+  byte mpu6000BatchAccelSamples = 0;
+  unsigned long mpu6000BatchTime = 0;         // us of sensor time at the last sample
+  unsigned int mpu6000FifoOverflows = 0;
+
+  void mpu6000FifoDataRead(SPITransaction *transaction);
+  void mpu6000FifoCountRead(SPITransaction *transaction);
+
+  SPITransaction mpu6000FifoCount = {&mpu6000SpiDevice, mpu6000FifoCountTx, mpu6000FifoCountRx, sizeof(mpu6000FifoCountRx), mpu6000FifoCountRead, SPI_TRANSACTION_IDLE};
+  SPITransaction mpu6000FifoData = {&mpu6000SpiDevice, mpu6000FifoTx, mpu6000FifoRx, 0, mpu6000FifoDataRead, SPI_TRANSACTION_IDLE};
+
+  void mpu6000FifoCountRead(SPITransaction *transaction) {
+    const unsigned int count = (mpu6000FifoCountRx[1] << 8) | mpu6000FifoCountRx[2];
+    if (count >= MPU6000_FIFO_SIZE - MPU6000_FIFO_SAMPLE_SIZE) {
+      // samples were lost and the FIFO is no longer aligned on a sample
+      mpu6000FifoOverflow = true;
+      return;
+    }
+    const unsigned int samples = min(count / MPU6000_FIFO_SAMPLE_SIZE, (unsigned int)MPU6000_FIFO_MAX_SAMPLES);
+    if (samples > 0) {
+      mpu6000FifoData.length = 1 + samples * MPU6000_FIFO_SAMPLE_SIZE;
+      queueSPITransaction(&mpu6000FifoData);
+    }
+  }
+
+  void mpu6000FifoDataRead(SPITransaction *transaction) {
+    const byte samples = (transaction->length - 1) / MPU6000_FIFO_SAMPLE_SIZE;
+    const byte *sample = &mpu6000FifoRx[1];
+    for (byte i = 0; i < samples; i++) {
+      for (byte axis = 0; axis < 3; axis++) {
+        mpu6000FifoAccelSum[axis] += (short)((sample[axis * 2] << 8) | sample[axis * 2 + 1]);
+        mpu6000FifoGyroSum[axis] += (short)((sample[8 + axis * 2] << 8) | sample[8 + axis * 2 + 1]);
+      }
+      sample += MPU6000_FIFO_SAMPLE_SIZE;
+    }
+    sample -= MPU6000_FIFO_SAMPLE_SIZE;
+    for (byte i = 0; i < MPU6000_FIFO_SAMPLE_SIZE; i++) {
+      mpu6000FifoLast[i] = sample[i];
+    }
+    mpu6000FifoSamples += samples;
+    mpu6000FifoSampleCount += samples;
+  }
+
+  void resetMPU6000Fifo() {
+    while (isSPIBusBusy(&mpu6000SpiBus));
+    spiMPU6000.Write(MPUREG_USER_CTRL, BIT_I2C_IF_DIS | BIT_FIFO_RESET);
+    spiMPU6000.Write(MPUREG_USER_CTRL, BIT_I2C_IF_DIS | BIT_FIFO_EN);
+    mpu6000FifoOverflow = false;
+  }
 #endif
 
 void MPU6000_SpiLowSpeed()
 {
   #ifndef MPU6000_I2C
 	spiMPU6000.begin(SPI_562_500KHZ, MSBFIRST, 3);
+	initializeSPIBus(&mpu6000SpiBus, mpu6000SpiBusComplete);
   #endif
 }
 
@@ -128,6 +238,7 @@ void MPU6000_SpiHighSpeed()
   #ifndef MPU6000_I2C
 	spiMPU6000.end();
     spiMPU6000.begin(SPI_9MHZ, MSBFIRST, 3);
+    invalidateSPIBus(&mpu6000SpiBus);
   #endif
 }
 
@@ -136,6 +247,7 @@ void MPU6000_WriteReg(int addr, byte data)
   #ifdef MPU6000_I2C
 	updateRegisterI2C(MPU6000_I2C_ADDRESS, addr, data);
   #else
+	while (isSPIBusBusy(&mpu6000SpiBus)); // polled access, wait for a running burst
 	spiMPU6000.Write(addr, data);
   #endif
   delay(1);
@@ -147,6 +259,7 @@ byte MPU6000_ReadReg(int addr)
 	sendByteI2C(MPU6000_I2C_ADDRESS, addr);
 	byte data = readByteI2C(MPU6000_I2C_ADDRESS);
   #else
+	while (isSPIBusBusy(&mpu6000SpiBus)); // polled access, wait for a running burst
 	byte data = spiMPU6000.Read(addr);
   #endif
   delay(1);
@@ -195,9 +308,22 @@ void initializeMPU6000Sensors()
   MPU6000_WriteReg(MPUREG_GYRO_CONFIG,BITS_FS_1000DPS);  // Gyro scale 1000/s
   MPU6000_WriteReg(MPUREG_ACCEL_CONFIG,0x08);   // Accel scale +-4g (4096LSB/g)
 
+  #if defined(MPU6000_FIFO)
+    MPU6000_WriteReg(MPUREG_FIFO_EN, BITS_FIFO_ACCEL_TEMP_GYRO);
+    MPU6000_WriteReg(MPUREG_USER_CTRL, BIT_I2C_IF_DIS | BIT_FIFO_RESET);
+    MPU6000_WriteReg(MPUREG_USER_CTRL, BIT_I2C_IF_DIS | BIT_FIFO_EN);
+  #endif
 
   // switch to high clock rate
   MPU6000_SpiHighSpeed();
+
+  #if defined(MPU6000_FIFO)
+    // one blocking drain so MPU6000 holds a sample when this returns
+    delay(2);
+    queueSPITransaction(&mpu6000FifoCount);
+    waitSPITransaction(&mpu6000FifoCount);
+    waitSPITransaction(&mpu6000FifoData);
+  #endif
 }
 
 
@@ -220,10 +346,55 @@ void readMPU6000Sensors()
     for(byte i=0; i<sizeof(MPU6000)/sizeof(short); i++) {
       MPU6000.rawWord[i] = readWordI2C();
     }
+  #elif defined(MPU6000_FIFO)
+    if (mpu6000FifoOverflow) {
+      resetMPU6000Fifo();
+      mpu6000FifoOverflows++;
+    }
+    // collect what the last drain read and start the next one
+    // sums nobody took, e.g. during a calibration reading MPU6000 directly, are stale
+    if (mpu6000BatchGyroSamples > MPU6000_FIFO_MAX_BATCH) {
+      mpu6000BatchGyro[0] = mpu6000BatchGyro[1] = mpu6000BatchGyro[2] = 0;
+      mpu6000BatchGyroSamples = 0;
+    }
+    if (mpu6000BatchAccelSamples > MPU6000_FIFO_MAX_BATCH) {
+      mpu6000BatchAccel[0] = mpu6000BatchAccel[1] = mpu6000BatchAccel[2] = 0;
+      mpu6000BatchAccelSamples = 0;
+    }
+    noInterrupts();
+    for (byte axis = 0; axis < 3; axis++) {
+      mpu6000BatchGyro[axis] += mpu6000FifoGyroSum[axis];
+      mpu6000BatchAccel[axis] += mpu6000FifoAccelSum[axis];
+      mpu6000FifoGyroSum[axis] = 0;
+      mpu6000FifoAccelSum[axis] = 0;
+    }
+    mpu6000BatchGyroSamples += mpu6000FifoSamples;
+    mpu6000BatchAccelSamples += mpu6000FifoSamples;
+    mpu6000FifoSamples = 0;
+    mpu6000BatchTime = mpu6000FifoSampleCount * MPU6000_FIFO_SAMPLE_PERIOD;
+    for (byte i = 0; i < sizeof(MPU6000); i++) {
+      MPU6000.rawByte[i] = mpu6000FifoLast[i];
+    }
+    interrupts();
+    MPU6000SwapData(MPU6000.rawByte, sizeof(MPU6000));
+    if (!isSPITransactionPending(&mpu6000FifoCount) && !isSPITransactionPending(&mpu6000FifoData)) {
+      queueSPITransaction(&mpu6000FifoCount);
+    }
   #else
-    spiMPU6000.Read(MPUREG_ACCEL_XOUT_H, MPU6000.rawByte, sizeof(MPU6000));
+    // read at the start of the control loop and waited for, so the PIDs get
+    // the newest sample, the 15 bytes take about 15us at 10.5MHz
+    if (!isSPITransactionPending(&mpu6000Burst)) {
+      queueSPITransaction(&mpu6000Burst);
+    }
+    waitSPITransaction(&mpu6000Burst);
+    for (byte i = 0; i < sizeof(MPU6000); i++) {
+      MPU6000.rawByte[i] = mpu6000BurstRx[i + 1];
+    }
     MPU6000SwapData(MPU6000.rawByte, sizeof(MPU6000));
   #endif
+  #if defined(MavLinkHIL)
+    readHILMPU6000(&MPU6000.data.accel, &MPU6000.data.gyro);
+  #endif
 }
 
 int readMPU6000Count=0;
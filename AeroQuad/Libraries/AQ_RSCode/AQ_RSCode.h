@@ -1,4 +1,5 @@
- #ifndef AQ_RSCODE
+#ifndef AQ_RSCODE
+#define AQ_RSCODE
 
 /*********************************************************************
  * AeroQuad Reed-Solomon coding library
@@ -8,7 +9,8 @@
  *
  * The encoder is based on RSCODE project.
  *
- * Standard rscode library can be used for decoding (with NPAR=8)
+ * Standard rscode library can be used for decoding (with NPAR=8), or
+ * the portable decoder in AeroQuadConfigurator/Source/Utilities/RScode/Portable
  *********************************************************************/
 
 /*********************************************************************
@@ -39,102 +41,278 @@
 /* Number of parity bytes */
 #define NPAR 8
 
-/* Maximum degree of various polynomials. */
-#define MAXDEG ((NPAR)*2)
+/* Generator polynomial, product of (x + a^i) for i = 1..NPAR over GF(2^8)
+ * with x^8 + x^4 + x^3 + x^2 + 1, lowest order first:
+ *   0x25,0xe0,0x08,0xac,0x47,0xb2,0x2c,0xe3,0x01
+ *
+ * rsGenTable[d][j] is genPoly[j] * d, so one LFSR step is NPAR table reads
+ * and xors instead of NPAR log/antilog multiplies. The table is only valid
+ * for this NPAR and generator, the ground side decoder uses the same code.
+ */
 
 #ifdef AeroQuadSTM32
-  #define GEXP(x) (gexp[(x)])
-  #define GLOG(x) (glog[(x)])
-  #define RSCODE_PROGMEM
+  #define RSCODE_PROGMEM __attribute__((aligned(8)))
 #else
-  #define GEXP(x) pgm_read_byte_far(&gexp[(x)])
-  #define GLOG(x) pgm_read_byte_far(&glog[(x)])
   #define RSCODE_PROGMEM PROGMEM
 #endif
 
-RSCODE_PROGMEM const byte gexp[512] = {
-  0x01,0x02,0x04,0x08,0x10,0x20,0x40,0x80,0x1d,0x3a,0x74,0xe8,0xcd,0x87,0x13,0x26,
-  0x4c,0x98,0x2d,0x5a,0xb4,0x75,0xea,0xc9,0x8f,0x03,0x06,0x0c,0x18,0x30,0x60,0xc0,
-  0x9d,0x27,0x4e,0x9c,0x25,0x4a,0x94,0x35,0x6a,0xd4,0xb5,0x77,0xee,0xc1,0x9f,0x23,
-  0x46,0x8c,0x05,0x0a,0x14,0x28,0x50,0xa0,0x5d,0xba,0x69,0xd2,0xb9,0x6f,0xde,0xa1,
-  0x5f,0xbe,0x61,0xc2,0x99,0x2f,0x5e,0xbc,0x65,0xca,0x89,0x0f,0x1e,0x3c,0x78,0xf0,
-  0xfd,0xe7,0xd3,0xbb,0x6b,0xd6,0xb1,0x7f,0xfe,0xe1,0xdf,0xa3,0x5b,0xb6,0x71,0xe2,
-  0xd9,0xaf,0x43,0x86,0x11,0x22,0x44,0x88,0x0d,0x1a,0x34,0x68,0xd0,0xbd,0x67,0xce,
-  0x81,0x1f,0x3e,0x7c,0xf8,0xed,0xc7,0x93,0x3b,0x76,0xec,0xc5,0x97,0x33,0x66,0xcc,
-  0x85,0x17,0x2e,0x5c,0xb8,0x6d,0xda,0xa9,0x4f,0x9e,0x21,0x42,0x84,0x15,0x2a,0x54,
-  0xa8,0x4d,0x9a,0x29,0x52,0xa4,0x55,0xaa,0x49,0x92,0x39,0x72,0xe4,0xd5,0xb7,0x73,
-  0xe6,0xd1,0xbf,0x63,0xc6,0x91,0x3f,0x7e,0xfc,0xe5,0xd7,0xb3,0x7b,0xf6,0xf1,0xff,
-  0xe3,0xdb,0xab,0x4b,0x96,0x31,0x62,0xc4,0x95,0x37,0x6e,0xdc,0xa5,0x57,0xae,0x41,
-  0x82,0x19,0x32,0x64,0xc8,0x8d,0x07,0x0e,0x1c,0x38,0x70,0xe0,0xdd,0xa7,0x53,0xa6,
-  0x51,0xa2,0x59,0xb2,0x79,0xf2,0xf9,0xef,0xc3,0x9b,0x2b,0x56,0xac,0x45,0x8a,0x09,
-  0x12,0x24,0x48,0x90,0x3d,0x7a,0xf4,0xf5,0xf7,0xf3,0xfb,0xeb,0xcb,0x8b,0x0b,0x16,
-  0x2c,0x58,0xb0,0x7d,0xfa,0xe9,0xcf,0x83,0x1b,0x36,0x6c,0xd8,0xad,0x47,0x8e,0x01,
-  0x02,0x04,0x08,0x10,0x20,0x40,0x80,0x1d,0x3a,0x74,0xe8,0xcd,0x87,0x13,0x26,0x4c,
-  0x98,0x2d,0x5a,0xb4,0x75,0xea,0xc9,0x8f,0x03,0x06,0x0c,0x18,0x30,0x60,0xc0,0x9d,
-  0x27,0x4e,0x9c,0x25,0x4a,0x94,0x35,0x6a,0xd4,0xb5,0x77,0xee,0xc1,0x9f,0x23,0x46,
-  0x8c,0x05,0x0a,0x14,0x28,0x50,0xa0,0x5d,0xba,0x69,0xd2,0xb9,0x6f,0xde,0xa1,0x5f,
-  0xbe,0x61,0xc2,0x99,0x2f,0x5e,0xbc,0x65,0xca,0x89,0x0f,0x1e,0x3c,0x78,0xf0,0xfd,
-  0xe7,0xd3,0xbb,0x6b,0xd6,0xb1,0x7f,0xfe,0xe1,0xdf,0xa3,0x5b,0xb6,0x71,0xe2,0xd9,
-  0xaf,0x43,0x86,0x11,0x22,0x44,0x88,0x0d,0x1a,0x34,0x68,0xd0,0xbd,0x67,0xce,0x81,
-  0x1f,0x3e,0x7c,0xf8,0xed,0xc7,0x93,0x3b,0x76,0xec,0xc5,0x97,0x33,0x66,0xcc,0x85,
-  0x17,0x2e,0x5c,0xb8,0x6d,0xda,0xa9,0x4f,0x9e,0x21,0x42,0x84,0x15,0x2a,0x54,0xa8,
-  0x4d,0x9a,0x29,0x52,0xa4,0x55,0xaa,0x49,0x92,0x39,0x72,0xe4,0xd5,0xb7,0x73,0xe6,
-  0xd1,0xbf,0x63,0xc6,0x91,0x3f,0x7e,0xfc,0xe5,0xd7,0xb3,0x7b,0xf6,0xf1,0xff,0xe3,
-  0xdb,0xab,0x4b,0x96,0x31,0x62,0xc4,0x95,0x37,0x6e,0xdc,0xa5,0x57,0xae,0x41,0x82,
-  0x19,0x32,0x64,0xc8,0x8d,0x07,0x0e,0x1c,0x38,0x70,0xe0,0xdd,0xa7,0x53,0xa6,0x51,
-  0xa2,0x59,0xb2,0x79,0xf2,0xf9,0xef,0xc3,0x9b,0x2b,0x56,0xac,0x45,0x8a,0x09,0x12,
-  0x24,0x48,0x90,0x3d,0x7a,0xf4,0xf5,0xf7,0xf3,0xfb,0xeb,0xcb,0x8b,0x0b,0x16,0x2c,
-  0x58,0xb0,0x7d,0xfa,0xe9,0xcf,0x83,0x1b,0x36,0x6c,0xd8,0xad,0x47,0x8e,0x01,0x00};
-RSCODE_PROGMEM const byte glog[256] = {
-  0x00,0x00,0x01,0x19,0x02,0x32,0x1a,0xc6,0x03,0xdf,0x33,0xee,0x1b,0x68,0xc7,0x4b,
-  0x04,0x64,0xe0,0x0e,0x34,0x8d,0xef,0x81,0x1c,0xc1,0x69,0xf8,0xc8,0x08,0x4c,0x71,
-  0x05,0x8a,0x65,0x2f,0xe1,0x24,0x0f,0x21,0x35,0x93,0x8e,0xda,0xf0,0x12,0x82,0x45,
-  0x1d,0xb5,0xc2,0x7d,0x6a,0x27,0xf9,0xb9,0xc9,0x9a,0x09,0x78,0x4d,0xe4,0x72,0xa6,
-  0x06,0xbf,0x8b,0x62,0x66,0xdd,0x30,0xfd,0xe2,0x98,0x25,0xb3,0x10,0x91,0x22,0x88,
-  0x36,0xd0,0x94,0xce,0x8f,0x96,0xdb,0xbd,0xf1,0xd2,0x13,0x5c,0x83,0x38,0x46,0x40,
-  0x1e,0x42,0xb6,0xa3,0xc3,0x48,0x7e,0x6e,0x6b,0x3a,0x28,0x54,0xfa,0x85,0xba,0x3d,
-  0xca,0x5e,0x9b,0x9f,0x0a,0x15,0x79,0x2b,0x4e,0xd4,0xe5,0xac,0x73,0xf3,0xa7,0x57,
-  0x07,0x70,0xc0,0xf7,0x8c,0x80,0x63,0x0d,0x67,0x4a,0xde,0xed,0x31,0xc5,0xfe,0x18,
-  0xe3,0xa5,0x99,0x77,0x26,0xb8,0xb4,0x7c,0x11,0x44,0x92,0xd9,0x23,0x20,0x89,0x2e,
-  0x37,0x3f,0xd1,0x5b,0x95,0xbc,0xcf,0xcd,0x90,0x87,0x97,0xb2,0xdc,0xfc,0xbe,0x61,
-  0xf2,0x56,0xd3,0xab,0x14,0x2a,0x5d,0x9e,0x84,0x3c,0x39,0x53,0x47,0x6d,0x41,0xa2,
-  0x1f,0x2d,0x43,0xd8,0xb7,0x7b,0xa4,0x76,0xc4,0x17,0x49,0xec,0x7f,0x0c,0x6f,0xf6,
-  0x6c,0xa1,0x3b,0x52,0x29,0x9d,0x55,0xaa,0xfb,0x60,0x86,0xb1,0xbb,0xcc,0x3e,0x5a,
-  0xcb,0x59,0x5f,0xb0,0x9c,0xa9,0xa0,0x51,0x0b,0xf5,0x16,0xeb,0x7a,0x75,0x2c,0xd7,
-  0x4f,0xae,0xd5,0xe9,0xe6,0xe7,0xad,0xe8,0x74,0xd6,0xf4,0xea,0xa8,0x50,0x58,0xaf};
-
-/* generator polynomial */
-const byte genPoly[NPAR+1] = {0x25,0xe0,0x08,0xac,0x47,0xb2,0x2c,0xe3,0x01};
-
-/* multiplication using logarithms */
-byte gmult(byte a, byte b)
-{
-  if (a==0 || b == 0) return (0);
-  return (GEXP(GLOG(a)+GLOG(b)));
-}
-
-/* polynomial multiplication */
-void
-mult_polys (byte dst[], byte p1[], byte p2[])
-{
-  short i, j;
-  byte tmp1[MAXDEG*2];
-
-  for (i=0; i < (MAXDEG*2); i++) dst[i] = 0;
-	
-  for (i = 0; i < MAXDEG; i++) {
-    for(j=MAXDEG; j<(MAXDEG*2); j++) tmp1[j]=0;
-		
-    /* scale tmp1 by p1[i] */
-    for(j=0; j<MAXDEG; j++) tmp1[j]=gmult(p2[j], p1[i]);
-    /* and mult (shift) tmp1 right by i */
-    for (j = (MAXDEG*2)-1; j >= i; j--) tmp1[j] = tmp1[j-i];
-    for (j = 0; j < i; j++) tmp1[j] = 0;
-		
-    /* add into partial product */
-    for(j=0; j < (MAXDEG*2); j++) dst[j] ^= tmp1[j];
-  }
-}
+RSCODE_PROGMEM const byte rsGenTable[256][NPAR] = {
+  {0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},
+  {0x25,0xe0,0x08,0xac,0x47,0xb2,0x2c,0xe3},
+  {0x4a,0xdd,0x10,0x45,0x8e,0x79,0x58,0xdb},
+  {0x6f,0x3d,0x18,0xe9,0xc9,0xcb,0x74,0x38},
+  {0x94,0xa7,0x20,0x8a,0x01,0xf2,0xb0,0xab},
+  {0xb1,0x47,0x28,0x26,0x46,0x40,0x9c,0x48},
+  {0xde,0x7a,0x30,0xcf,0x8f,0x8b,0xe8,0x70},
+  {0xfb,0x9a,0x38,0x63,0xc8,0x39,0xc4,0x93},
+  {0x35,0x53,0x40,0x09,0x02,0xf9,0x7d,0x4b},
+  {0x10,0xb3,0x48,0xa5,0x45,0x4b,0x51,0xa8},
+  {0x7f,0x8e,0x50,0x4c,0x8c,0x80,0x25,0x90},
+  {0x5a,0x6e,0x58,0xe0,0xcb,0x32,0x09,0x73},
+  {0xa1,0xf4,0x60,0x83,0x03,0x0b,0xcd,0xe0},
+  {0x84,0x14,0x68,0x2f,0x44,0xb9,0xe1,0x03},
+  {0xeb,0x29,0x70,0xc6,0x8d,0x72,0x95,0x3b},
+  {0xce,0xc9,0x78,0x6a,0xca,0xc0,0xb9,0xd8},
+  {0x6a,0xa6,0x80,0x12,0x04,0xef,0xfa,0x96},
+  {0x4f,0x46,0x88,0xbe,0x43,0x5d,0xd6,0x75},
+  {0x20,0x7b,0x90,0x57,0x8a,0x96,0xa2,0x4d},
+  {0x05,0x9b,0x98,0xfb,0xcd,0x24,0x8e,0xae},
+  {0xfe,0x01,0xa0,0x98,0x05,0x1d,0x4a,0x3d},
+  {0xdb,0xe1,0xa8,0x34,0x42,0xaf,0x66,0xde},
+  {0xb4,0xdc,0xb0,0xdd,0x8b,0x64,0x12,0xe6},
+  {0x91,0x3c,0xb8,0x71,0xcc,0xd6,0x3e,0x05},
+  {0x5f,0xf5,0xc0,0x1b,0x06,0x16,0x87,0xdd},
+  {0x7a,0x15,0xc8,0xb7,0x41,0xa4,0xab,0x3e},
+  {0x15,0x28,0xd0,0x5e,0x88,0x6f,0xdf,0x06},
+  {0x30,0xc8,0xd8,0xf2,0xcf,0xdd,0xf3,0xe5},
+  {0xcb,0x52,0xe0,0x91,0x07,0xe4,0x37,0x76},
+  {0xee,0xb2,0xe8,0x3d,0x40,0x56,0x1b,0x95},
+  {0x81,0x8f,0xf0,0xd4,0x89,0x9d,0x6f,0xad},
+  {0xa4,0x6f,0xf8,0x78,0xce,0x2f,0x43,0x4e},
+  {0xd4,0x51,0x1d,0x24,0x08,0xc3,0xe9,0x31},
+  {0xf1,0xb1,0x15,0x88,0x4f,0x71,0xc5,0xd2},
+  {0x9e,0x8c,0x0d,0x61,0x86,0xba,0xb1,0xea},
+  {0xbb,0x6c,0x05,0xcd,0xc1,0x08,0x9d,0x09},
+  {0x40,0xf6,0x3d,0xae,0x09,0x31,0x59,0x9a},
+  {0x65,0x16,0x35,0x02,0x4e,0x83,0x75,0x79},
+  {0x0a,0x2b,0x2d,0xeb,0x87,0x48,0x01,0x41},
+  {0x2f,0xcb,0x25,0x47,0xc0,0xfa,0x2d,0xa2},
+  {0xe1,0x02,0x5d,0x2d,0x0a,0x3a,0x94,0x7a},
+  {0xc4,0xe2,0x55,0x81,0x4d,0x88,0xb8,0x99},
+  {0xab,0xdf,0x4d,0x68,0x84,0x43,0xcc,0xa1},
+  {0x8e,0x3f,0x45,0xc4,0xc3,0xf1,0xe0,0x42},
+  {0x75,0xa5,0x7d,0xa7,0x0b,0xc8,0x24,0xd1},
+  {0x50,0x45,0x75,0x0b,0x4c,0x7a,0x08,0x32},
+  {0x3f,0x78,0x6d,0xe2,0x85,0xb1,0x7c,0x0a},
+  {0x1a,0x98,0x65,0x4e,0xc2,0x03,0x50,0xe9},
+  {0xbe,0xf7,0x9d,0x36,0x0c,0x2c,0x13,0xa7},
+  {0x9b,0x17,0x95,0x9a,0x4b,0x9e,0x3f,0x44},
+  {0xf4,0x2a,0x8d,0x73,0x82,0x55,0x4b,0x7c},
+  {0xd1,0xca,0x85,0xdf,0xc5,0xe7,0x67,0x9f},
+  {0x2a,0x50,0xbd,0xbc,0x0d,0xde,0xa3,0x0c},
+  {0x0f,0xb0,0xb5,0x10,0x4a,0x6c,0x8f,0xef},
+  {0x60,0x8d,0xad,0xf9,0x83,0xa7,0xfb,0xd7},
+  {0x45,0x6d,0xa5,0x55,0xc4,0x15,0xd7,0x34},
+  {0x8b,0xa4,0xdd,0x3f,0x0e,0xd5,0x6e,0xec},
+  {0xae,0x44,0xd5,0x93,0x49,0x67,0x42,0x0f},
+  {0xc1,0x79,0xcd,0x7a,0x80,0xac,0x36,0x37},
+  {0xe4,0x99,0xc5,0xd6,0xc7,0x1e,0x1a,0xd4},
+  {0x1f,0x03,0xfd,0xb5,0x0f,0x27,0xde,0x47},
+  {0x3a,0xe3,0xf5,0x19,0x48,0x95,0xf2,0xa4},
+  {0x55,0xde,0xed,0xf0,0x81,0x5e,0x86,0x9c},
+  {0x70,0x3e,0xe5,0x5c,0xc6,0xec,0xaa,0x7f},
+  {0xb5,0xa2,0x3a,0x48,0x10,0x9b,0xcf,0x62},
+  {0x90,0x42,0x32,0xe4,0x57,0x29,0xe3,0x81},
+  {0xff,0x7f,0x2a,0x0d,0x9e,0xe2,0x97,0xb9},
+  {0xda,0x9f,0x22,0xa1,0xd9,0x50,0xbb,0x5a},
+  {0x21,0x05,0x1a,0xc2,0x11,0x69,0x7f,0xc9},
+  {0x04,0xe5,0x12,0x6e,0x56,0xdb,0x53,0x2a},
+  {0x6b,0xd8,0x0a,0x87,0x9f,0x10,0x27,0x12},
+  {0x4e,0x38,0x02,0x2b,0xd8,0xa2,0x0b,0xf1},
+  {0x80,0xf1,0x7a,0x41,0x12,0x62,0xb2,0x29},
+  {0xa5,0x11,0x72,0xed,0x55,0xd0,0x9e,0xca},
+  {0xca,0x2c,0x6a,0x04,0x9c,0x1b,0xea,0xf2},
+  {0xef,0xcc,0x62,0xa8,0xdb,0xa9,0xc6,0x11},
+  {0x14,0x56,0x5a,0xcb,0x13,0x90,0x02,0x82},
+  {0x31,0xb6,0x52,0x67,0x54,0x22,0x2e,0x61},
+  {0x5e,0x8b,0x4a,0x8e,0x9d,0xe9,0x5a,0x59},
+  {0x7b,0x6b,0x42,0x22,0xda,0x5b,0x76,0xba},
+  {0xdf,0x04,0xba,0x5a,0x14,0x74,0x35,0xf4},
+  {0xfa,0xe4,0xb2,0xf6,0x53,0xc6,0x19,0x17},
+  {0x95,0xd9,0xaa,0x1f,0x9a,0x0d,0x6d,0x2f},
+  {0xb0,0x39,0xa2,0xb3,0xdd,0xbf,0x41,0xcc},
+  {0x4b,0xa3,0x9a,0xd0,0x15,0x86,0x85,0x5f},
+  {0x6e,0x43,0x92,0x7c,0x52,0x34,0xa9,0xbc},
+  {0x01,0x7e,0x8a,0x95,0x9b,0xff,0xdd,0x84},
+  {0x24,0x9e,0x82,0x39,0xdc,0x4d,0xf1,0x67},
+  {0xea,0x57,0xfa,0x53,0x16,0x8d,0x48,0xbf},
+  {0xcf,0xb7,0xf2,0xff,0x51,0x3f,0x64,0x5c},
+  {0xa0,0x8a,0xea,0x16,0x98,0xf4,0x10,0x64},
+  {0x85,0x6a,0xe2,0xba,0xdf,0x46,0x3c,0x87},
+  {0x7e,0xf0,0xda,0xd9,0x17,0x7f,0xf8,0x14},
+  {0x5b,0x10,0xd2,0x75,0x50,0xcd,0xd4,0xf7},
+  {0x34,0x2d,0xca,0x9c,0x99,0x06,0xa0,0xcf},
+  {0x11,0xcd,0xc2,0x30,0xde,0xb4,0x8c,0x2c},
+  {0x61,0xf3,0x27,0x6c,0x18,0x58,0x26,0x53},
+  {0x44,0x13,0x2f,0xc0,0x5f,0xea,0x0a,0xb0},
+  {0x2b,0x2e,0x37,0x29,0x96,0x21,0x7e,0x88},
+  {0x0e,0xce,0x3f,0x85,0xd1,0x93,0x52,0x6b},
+  {0xf5,0x54,0x07,0xe6,0x19,0xaa,0x96,0xf8},
+  {0xd0,0xb4,0x0f,0x4a,0x5e,0x18,0xba,0x1b},
+  {0xbf,0x89,0x17,0xa3,0x97,0xd3,0xce,0x23},
+  {0x9a,0x69,0x1f,0x0f,0xd0,0x61,0xe2,0xc0},
+  {0x54,0xa0,0x67,0x65,0x1a,0xa1,0x5b,0x18},
+  {0x71,0x40,0x6f,0xc9,0x5d,0x13,0x77,0xfb},
+  {0x1e,0x7d,0x77,0x20,0x94,0xd8,0x03,0xc3},
+  {0x3b,0x9d,0x7f,0x8c,0xd3,0x6a,0x2f,0x20},
+  {0xc0,0x07,0x47,0xef,0x1b,0x53,0xeb,0xb3},
+  {0xe5,0xe7,0x4f,0x43,0x5c,0xe1,0xc7,0x50},
+  {0x8a,0xda,0x57,0xaa,0x95,0x2a,0xb3,0x68},
+  {0xaf,0x3a,0x5f,0x06,0xd2,0x98,0x9f,0x8b},
+  {0x0b,0x55,0xa7,0x7e,0x1c,0xb7,0xdc,0xc5},
+  {0x2e,0xb5,0xaf,0xd2,0x5b,0x05,0xf0,0x26},
+  {0x41,0x88,0xb7,0x3b,0x92,0xce,0x84,0x1e},
+  {0x64,0x68,0xbf,0x97,0xd5,0x7c,0xa8,0xfd},
+  {0x9f,0xf2,0x87,0xf4,0x1d,0x45,0x6c,0x6e},
+  {0xba,0x12,0x8f,0x58,0x5a,0xf7,0x40,0x8d},
+  {0xd5,0x2f,0x97,0xb1,0x93,0x3c,0x34,0xb5},
+  {0xf0,0xcf,0x9f,0x1d,0xd4,0x8e,0x18,0x56},
+  {0x3e,0x06,0xe7,0x77,0x1e,0x4e,0xa1,0x8e},
+  {0x1b,0xe6,0xef,0xdb,0x59,0xfc,0x8d,0x6d},
+  {0x74,0xdb,0xf7,0x32,0x90,0x37,0xf9,0x55},
+  {0x51,0x3b,0xff,0x9e,0xd7,0x85,0xd5,0xb6},
+  {0xaa,0xa1,0xc7,0xfd,0x1f,0xbc,0x11,0x25},
+  {0x8f,0x41,0xcf,0x51,0x58,0x0e,0x3d,0xc6},
+  {0xe0,0x7c,0xd7,0xb8,0x91,0xc5,0x49,0xfe},
+  {0xc5,0x9c,0xdf,0x14,0xd6,0x77,0x65,0x1d},
+  {0x77,0x59,0x74,0x90,0x20,0x2b,0x83,0xc4},
+  {0x52,0xb9,0x7c,0x3c,0x67,0x99,0xaf,0x27},
+  {0x3d,0x84,0x64,0xd5,0xae,0x52,0xdb,0x1f},
+  {0x18,0x64,0x6c,0x79,0xe9,0xe0,0xf7,0xfc},
+  {0xe3,0xfe,0x54,0x1a,0x21,0xd9,0x33,0x6f},
+  {0xc6,0x1e,0x5c,0xb6,0x66,0x6b,0x1f,0x8c},
+  {0xa9,0x23,0x44,0x5f,0xaf,0xa0,0x6b,0xb4},
+  {0x8c,0xc3,0x4c,0xf3,0xe8,0x12,0x47,0x57},
+  {0x42,0x0a,0x34,0x99,0x22,0xd2,0xfe,0x8f},
+  {0x67,0xea,0x3c,0x35,0x65,0x60,0xd2,0x6c},
+  {0x08,0xd7,0x24,0xdc,0xac,0xab,0xa6,0x54},
+  {0x2d,0x37,0x2c,0x70,0xeb,0x19,0x8a,0xb7},
+  {0xd6,0xad,0x14,0x13,0x23,0x20,0x4e,0x24},
+  {0xf3,0x4d,0x1c,0xbf,0x64,0x92,0x62,0xc7},
+  {0x9c,0x70,0x04,0x56,0xad,0x59,0x16,0xff},
+  {0xb9,0x90,0x0c,0xfa,0xea,0xeb,0x3a,0x1c},
+  {0x1d,0xff,0xf4,0x82,0x24,0xc4,0x79,0x52},
+  {0x38,0x1f,0xfc,0x2e,0x63,0x76,0x55,0xb1},
+  {0x57,0x22,0xe4,0xc7,0xaa,0xbd,0x21,0x89},
+  {0x72,0xc2,0xec,0x6b,0xed,0x0f,0x0d,0x6a},
+  {0x89,0x58,0xd4,0x08,0x25,0x36,0xc9,0xf9},
+  {0xac,0xb8,0xdc,0xa4,0x62,0x84,0xe5,0x1a},
+  {0xc3,0x85,0xc4,0x4d,0xab,0x4f,0x91,0x22},
+  {0xe6,0x65,0xcc,0xe1,0xec,0xfd,0xbd,0xc1},
+  {0x28,0xac,0xb4,0x8b,0x26,0x3d,0x04,0x19},
+  {0x0d,0x4c,0xbc,0x27,0x61,0x8f,0x28,0xfa},
+  {0x62,0x71,0xa4,0xce,0xa8,0x44,0x5c,0xc2},
+  {0x47,0x91,0xac,0x62,0xef,0xf6,0x70,0x21},
+  {0xbc,0x0b,0x94,0x01,0x27,0xcf,0xb4,0xb2},
+  {0x99,0xeb,0x9c,0xad,0x60,0x7d,0x98,0x51},
+  {0xf6,0xd6,0x84,0x44,0xa9,0xb6,0xec,0x69},
+  {0xd3,0x36,0x8c,0xe8,0xee,0x04,0xc0,0x8a},
+  {0xa3,0x08,0x69,0xb4,0x28,0xe8,0x6a,0xf5},
+  {0x86,0xe8,0x61,0x18,0x6f,0x5a,0x46,0x16},
+  {0xe9,0xd5,0x79,0xf1,0xa6,0x91,0x32,0x2e},
+  {0xcc,0x35,0x71,0x5d,0xe1,0x23,0x1e,0xcd},
+  {0x37,0xaf,0x49,0x3e,0x29,0x1a,0xda,0x5e},
+  {0x12,0x4f,0x41,0x92,0x6e,0xa8,0xf6,0xbd},
+  {0x7d,0x72,0x59,0x7b,0xa7,0x63,0x82,0x85},
+  {0x58,0x92,0x51,0xd7,0xe0,0xd1,0xae,0x66},
+  {0x96,0x5b,0x29,0xbd,0x2a,0x11,0x17,0xbe},
+  {0xb3,0xbb,0x21,0x11,0x6d,0xa3,0x3b,0x5d},
+  {0xdc,0x86,0x39,0xf8,0xa4,0x68,0x4f,0x65},
+  {0xf9,0x66,0x31,0x54,0xe3,0xda,0x63,0x86},
+  {0x02,0xfc,0x09,0x37,0x2b,0xe3,0xa7,0x15},
+  {0x27,0x1c,0x01,0x9b,0x6c,0x51,0x8b,0xf6},
+  {0x48,0x21,0x19,0x72,0xa5,0x9a,0xff,0xce},
+  {0x6d,0xc1,0x11,0xde,0xe2,0x28,0xd3,0x2d},
+  {0xc9,0xae,0xe9,0xa6,0x2c,0x07,0x90,0x63},
+  {0xec,0x4e,0xe1,0x0a,0x6b,0xb5,0xbc,0x80},
+  {0x83,0x73,0xf9,0xe3,0xa2,0x7e,0xc8,0xb8},
+  {0xa6,0x93,0xf1,0x4f,0xe5,0xcc,0xe4,0x5b},
+  {0x5d,0x09,0xc9,0x2c,0x2d,0xf5,0x20,0xc8},
+  {0x78,0xe9,0xc1,0x80,0x6a,0x47,0x0c,0x2b},
+  {0x17,0xd4,0xd9,0x69,0xa3,0x8c,0x78,0x13},
+  {0x32,0x34,0xd1,0xc5,0xe4,0x3e,0x54,0xf0},
+  {0xfc,0xfd,0xa9,0xaf,0x2e,0xfe,0xed,0x28},
+  {0xd9,0x1d,0xa1,0x03,0x69,0x4c,0xc1,0xcb},
+  {0xb6,0x20,0xb9,0xea,0xa0,0x87,0xb5,0xf3},
+  {0x93,0xc0,0xb1,0x46,0xe7,0x35,0x99,0x10},
+  {0x68,0x5a,0x89,0x25,0x2f,0x0c,0x5d,0x83},
+  {0x4d,0xba,0x81,0x89,0x68,0xbe,0x71,0x60},
+  {0x22,0x87,0x99,0x60,0xa1,0x75,0x05,0x58},
+  {0x07,0x67,0x91,0xcc,0xe6,0xc7,0x29,0xbb},
+  {0xc2,0xfb,0x4e,0xd8,0x30,0xb0,0x4c,0xa6},
+  {0xe7,0x1b,0x46,0x74,0x77,0x02,0x60,0x45},
+  {0x88,0x26,0x5e,0x9d,0xbe,0xc9,0x14,0x7d},
+  {0xad,0xc6,0x56,0x31,0xf9,0x7b,0x38,0x9e},
+  {0x56,0x5c,0x6e,0x52,0x31,0x42,0xfc,0x0d},
+  {0x73,0xbc,0x66,0xfe,0x76,0xf0,0xd0,0xee},
+  {0x1c,0x81,0x7e,0x17,0xbf,0x3b,0xa4,0xd6},
+  {0x39,0x61,0x76,0xbb,0xf8,0x89,0x88,0x35},
+  {0xf7,0xa8,0x0e,0xd1,0x32,0x49,0x31,0xed},
+  {0xd2,0x48,0x06,0x7d,0x75,0xfb,0x1d,0x0e},
+  {0xbd,0x75,0x1e,0x94,0xbc,0x30,0x69,0x36},
+  {0x98,0x95,0x16,0x38,0xfb,0x82,0x45,0xd5},
+  {0x63,0x0f,0x2e,0x5b,0x33,0xbb,0x81,0x46},
+  {0x46,0xef,0x26,0xf7,0x74,0x09,0xad,0xa5},
+  {0x29,0xd2,0x3e,0x1e,0xbd,0xc2,0xd9,0x9d},
+  {0x0c,0x32,0x36,0xb2,0xfa,0x70,0xf5,0x7e},
+  {0xa8,0x5d,0xce,0xca,0x34,0x5f,0xb6,0x30},
+  {0x8d,0xbd,0xc6,0x66,0x73,0xed,0x9a,0xd3},
+  {0xe2,0x80,0xde,0x8f,0xba,0x26,0xee,0xeb},
+  {0xc7,0x60,0xd6,0x23,0xfd,0x94,0xc2,0x08},
+  {0x3c,0xfa,0xee,0x40,0x35,0xad,0x06,0x9b},
+  {0x19,0x1a,0xe6,0xec,0x72,0x1f,0x2a,0x78},
+  {0x76,0x27,0xfe,0x05,0xbb,0xd4,0x5e,0x40},
+  {0x53,0xc7,0xf6,0xa9,0xfc,0x66,0x72,0xa3},
+  {0x9d,0x0e,0x8e,0xc3,0x36,0xa6,0xcb,0x7b},
+  {0xb8,0xee,0x86,0x6f,0x71,0x14,0xe7,0x98},
+  {0xd7,0xd3,0x9e,0x86,0xb8,0xdf,0x93,0xa0},
+  {0xf2,0x33,0x96,0x2a,0xff,0x6d,0xbf,0x43},
+  {0x09,0xa9,0xae,0x49,0x37,0x54,0x7b,0xd0},
+  {0x2c,0x49,0xa6,0xe5,0x70,0xe6,0x57,0x33},
+  {0x43,0x74,0xbe,0x0c,0xb9,0x2d,0x23,0x0b},
+  {0x66,0x94,0xb6,0xa0,0xfe,0x9f,0x0f,0xe8},
+  {0x16,0xaa,0x53,0xfc,0x38,0x73,0xa5,0x97},
+  {0x33,0x4a,0x5b,0x50,0x7f,0xc1,0x89,0x74},
+  {0x5c,0x77,0x43,0xb9,0xb6,0x0a,0xfd,0x4c},
+  {0x79,0x97,0x4b,0x15,0xf1,0xb8,0xd1,0xaf},
+  {0x82,0x0d,0x73,0x76,0x39,0x81,0x15,0x3c},
+  {0xa7,0xed,0x7b,0xda,0x7e,0x33,0x39,0xdf},
+  {0xc8,0xd0,0x63,0x33,0xb7,0xf8,0x4d,0xe7},
+  {0xed,0x30,0x6b,0x9f,0xf0,0x4a,0x61,0x04},
+  {0x23,0xf9,0x13,0xf5,0x3a,0x8a,0xd8,0xdc},
+  {0x06,0x19,0x1b,0x59,0x7d,0x38,0xf4,0x3f},
+  {0x69,0x24,0x03,0xb0,0xb4,0xf3,0x80,0x07},
+  {0x4c,0xc4,0x0b,0x1c,0xf3,0x41,0xac,0xe4},
+  {0xb7,0x5e,0x33,0x7f,0x3b,0x78,0x68,0x77},
+  {0x92,0xbe,0x3b,0xd3,0x7c,0xca,0x44,0x94},
+  {0xfd,0x83,0x23,0x3a,0xb5,0x01,0x30,0xac},
+  {0xd8,0x63,0x2b,0x96,0xf2,0xb3,0x1c,0x4f},
+  {0x7c,0x0c,0xd3,0xee,0x3c,0x9c,0x5f,0x01},
+  {0x59,0xec,0xdb,0x42,0x7b,0x2e,0x73,0xe2},
+  {0x36,0xd1,0xc3,0xab,0xb2,0xe5,0x07,0xda},
+  {0x13,0x31,0xcb,0x07,0xf5,0x57,0x2b,0x39},
+  {0xe8,0xab,0xf3,0x64,0x3d,0x6e,0xef,0xaa},
+  {0xcd,0x4b,0xfb,0xc8,0x7a,0xdc,0xc3,0x49},
+  {0xa2,0x76,0xe3,0x21,0xb3,0x17,0xb7,0x71},
+  {0x87,0x96,0xeb,0x8d,0xf4,0xa5,0x9b,0x92},
+  {0x49,0x5f,0x93,0xe7,0x3e,0x65,0x22,0x4a},
+  {0x6c,0xbf,0x9b,0x4b,0x79,0xd7,0x0e,0xa9},
+  {0x03,0x82,0x83,0xa2,0xb0,0x1c,0x7a,0x91},
+  {0x26,0x62,0x8b,0x0e,0xf7,0xae,0x56,0x72},
+  {0xdd,0xf8,0xb3,0x6d,0x3f,0x97,0x92,0xe1},
+  {0xf8,0x18,0xbb,0xc1,0x78,0x25,0xbe,0x02},
+  {0x97,0x25,0xa3,0x28,0xb1,0xee,0xca,0x3a},
+  {0xb2,0xc5,0xab,0x84,0xf6,0x5c,0xe6,0xd9}};
 
 /* Simulate a LFSR with generator polynomial for n byte RS code. 
  * Pass in a pointer to the data array, and amount of data. 
@@ -143,24 +321,55 @@ mult_polys (byte dst[], byte p1[], byte p2[])
  * 
  */
 
+#ifdef AeroQuadSTM32
+
+/* The 8 LFSR stages are the bytes of one 64 bit register, stage j in
+ * bits 8j..8j+7, so shifting the register by a byte shifts every stage
+ * and a table row xors the feedback into all of them at once. Table rows
+ * are read in the same little endian order.
+ */
+void
+encode_data (byte msg[], int nbytes)
+{
+  uint64_t LFSR = 0;
+  int i;
+
+  for (i = 0; i < nbytes; i++) {
+    const byte dbyte = msg[i] ^ (byte)(LFSR >> 56);
+    uint64_t row;
+    memcpy(&row, rsGenTable[dbyte], sizeof(row));  // a single aligned 64 bit load
+    LFSR = (LFSR << 8) ^ row;
+  }
+
+  for (i = 0; i < NPAR; i++) {
+    msg[nbytes+i] = (byte)(LFSR >> (8 * (NPAR-1-i)));
+  }
+}
+
+#else
+
 void
 encode_data (byte msg[], int nbytes)
 {
-  byte i, LFSR[NPAR+1],dbyte, j;
-	
-  for(i=0; i < NPAR+1; i++) LFSR[i]=0;
+  byte LFSR[NPAR], dbyte, j;
+  int i;
+
+  for (j = 0; j < NPAR; j++) LFSR[j] = 0;
 
   for (i = 0; i < nbytes; i++) {
     dbyte = msg[i] ^ LFSR[NPAR-1];
+    const byte *row = rsGenTable[dbyte];
     for (j = NPAR-1; j > 0; j--) {
-      LFSR[j] = LFSR[j-1] ^ gmult(genPoly[j], dbyte);
+      LFSR[j] = LFSR[j-1] ^ pgm_read_byte_far(&row[j]);
     }
-    LFSR[0] = gmult(genPoly[0], dbyte);
+    LFSR[0] = pgm_read_byte_far(&row[0]);
   }
 
-  for (i = 0; i < NPAR; i++) { 
-    msg[nbytes+i] = LFSR[NPAR-1-i];
-  }	
+  for (j = 0; j < NPAR; j++) {
+    msg[nbytes+j] = LFSR[NPAR-1-j];
+  }
 }
 
 #endif
+
+#endif
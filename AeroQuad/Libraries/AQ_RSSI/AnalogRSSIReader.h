@@ -21,6 +21,8 @@
 #ifndef _AQ_ANALOG_RSSI_READER_H_
 #define _AQ_ANALOG_RSSI_READER_H_
 
+#include <BackgroundADC.h>
+
 
 #define RSSI_PIN     A6     // analog pin to read
 //#define RSSI_RAWVAL         // show raw A/D value instead of percents (for tuning)
@@ -38,7 +40,7 @@ short rssiRawValue = 0; //forces update at first run
 
 void readRSSI() {
 
-  rssiRawValue = analogRead(RSSI_PIN);
+  rssiRawValue = analogReadShared(RSSI_PIN);
   #ifndef RSSI_RAWVAL
     rssiRawValue = ((long)rssiRawValue - RSSI_0P) * 100 / (RSSI_100P - RSSI_0P);
     if (rssiRawValue < 0) {
@@ -21,6 +21,7 @@
 #define ADC_NUMBER_OF_BITS 10
 
 #include <SensorsStatus.h>
+#include <BackgroundADC.h>     // Arduino IDE bug, needed because the analog sensors share the ADC through it
 #include <MaxSonarRangeFinder.h>
 
 void setup() {
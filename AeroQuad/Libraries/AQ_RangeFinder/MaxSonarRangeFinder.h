@@ -26,6 +26,7 @@
 #if defined (__AVR_ATmega1280__) || defined(__AVR_ATmega2560__) || defined(BOARD_aeroquad32)
 
 #include "RangeFinder.h"
+#include <BackgroundADC.h>
 
 #define MB1000 0 // Maxbotix LV-MaxSonar-EZ*
 #define MB1200 1 // Maxbotix XL-MaxSonar-EZ*
@@ -115,7 +116,7 @@ void updateRangeFinders() {
     digitalWrite(rangeFinders[rangerToTrigger].triggerpin, HIGH);
   }
 
-  short range = (short)((long)analogRead(rangeFinders[rangerToRead].pin) * (long)(rangerScale[rangeFinders[rangerToRead].type]) / (1L<<ADC_NUMBER_OF_BITS));
+  short range = (short)((long)analogReadShared(rangeFinders[rangerToRead].pin) * (long)(rangerScale[rangeFinders[rangerToRead].type]) / (1L<<ADC_NUMBER_OF_BITS));
 
   // Following will accept the sample if it's either withing "spike margin" of last raw reading or previous accepted reading
   // otherwise it's ignored as noise
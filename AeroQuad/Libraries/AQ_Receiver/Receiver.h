@@ -84,13 +84,20 @@ void initializeReceiverParam(int nbChannel = 6) {
   
 int getRawChannelValue(byte channel);  
 void readReceiver();
+#if defined(MavLinkHIL)
+  int getHILChannelValue(byte channel);  // MavLink.h, the simulator's sticks
+#endif
   
 void readReceiver()
 {
   for(byte channel = XAXIS; channel < lastReceiverChannel; channel++) {
 
     // Apply receiver calibration adjustment
-    receiverData[channel] = (receiverSlope[channel] * getRawChannelValue(channel)) + receiverOffset[channel];
+    #if defined(MavLinkHIL)
+      receiverData[channel] = (receiverSlope[channel] * getHILChannelValue(channel)) + receiverOffset[channel];
+    #else
+      receiverData[channel] = (receiverSlope[channel] * getRawChannelValue(channel)) + receiverOffset[channel];
+    #endif
     // Smooth the flight control receiver inputs
     receiverCommandSmooth[channel] = filterSmooth(receiverData[channel], receiverCommandSmooth[channel], receiverSmoothFactor[channel]);
   }
@@ -79,15 +79,39 @@ byte spi_readreg(byte r) {
   return spi_transfer(0);
 }
 
+// Sends a prepared register/data byte stream to the OSD in one chip select
+void spi_osd_send(const byte *data, unsigned len) {
+
+  spi_osd_select();
+  while (len--) {
+    SPDR = *data++;
+    while ( !(SPSR & _BV(SPIF)) ) ;
+  }
+  spi_osd_deselect();
+}
+
+boolean spi_osd_busy() {
+  return false;
+}
+
 #endif // Mega1280/2560
 
 #if defined(AeroQuadSTM32)
 
+#include <SPITransaction.h>
+
 HardwareSPI device_spi(2); // SPI2 on STM32; wired on header
 
 #define OSD_CS    Port2Pin('A', 3) // pin 26 == 'SVR0' pin on AQ32 (TIM5_CH4), may need to be changed...
 
+// SPI2_RX is on DMA1 stream 3, SPI2_TX on stream 4, both channel 0
+SPIBus osdSpiBus = {SPI2, DMA1, DMA_STREAM3, DMA_STREAM4, DMA_CR_CH0};
+// APB1 / 8 = 5.25MHz, the MAX7456 allows 10MHz
+SPIDevice osdSpiDevice = {&osdSpiBus, OSD_CS, SPI_BAUD_PCLK_DIV_8, SPI_MODE_0};
+SPITransaction osdTransaction = {&osdSpiDevice, NULL, NULL, 0, NULL, SPI_TRANSACTION_IDLE};
+
 void spi_osd_select() {
+  acquireSPIDevice(&osdSpiDevice); // let a running flush finish before touching the bus
   digitalWrite( OSD_CS, LOW );
 }
 
@@ -95,13 +119,31 @@ void spi_osd_deselect() {
   digitalWrite( OSD_CS, HIGH );
 }
 
+void osdSpiBusComplete() {
+  completeSPITransaction(&osdSpiBus);
+}
 
 void initializeSPI() {
 
-  pinMode( OSD_CS, OUTPUT );
-  digitalWrite( OSD_CS, HIGH );
+  initializeSPIDevice(&osdSpiDevice);
 
   device_spi.begin(SPI_9MHZ, MSBFIRST, 0);
+
+  initializeSPIBus(&osdSpiBus, osdSpiBusComplete);
+}
+
+// Sends a prepared register/data byte stream to the OSD in the background,
+// data must stay untouched until spi_osd_busy() returns false
+void spi_osd_send(const byte *data, unsigned len) {
+
+  waitSPITransaction(&osdTransaction);
+  osdTransaction.txData = data;
+  osdTransaction.length = len;
+  queueSPITransaction(&osdTransaction);
+}
+
+boolean spi_osd_busy() {
+  return isSPITransactionPending(&osdTransaction);
 }
 
 
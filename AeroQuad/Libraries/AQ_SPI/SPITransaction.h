@@ -0,0 +1,228 @@
+/*
+  AeroQuad v3.2 - SPI transactions over DMA
+  www.AeroQuad.com
+  Copyright (c) 2012 Ted Carancho.  All rights reserved.
+  An Open Source Arduino based multicopter.
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Queued full duplex SPI transfers on the STM32F4 DMA controller
+//
+// An SPIBus holds the DMA streams of one SPI port and a short queue,
+// an SPIDevice the chip select, clock divider and mode of one chip on it.
+// A transaction is handed over with queueSPITransaction() and runs without
+// the CPU: the chip is selected, the bus reconfigured if the previous
+// transaction was for another device, and the RX and TX streams started.
+// The RX stream complete interrupt deselects the chip, marks the
+// transaction done, calls its callback if any and starts the next one.
+//
+// Polled transfers on a bus (register setup, font upload) go through
+// acquireSPIDevice() first, which waits for the queue to drain and applies
+// the device settings.
+
+#ifndef _AEROQUAD_SPI_TRANSACTION_H_
+#define _AEROQUAD_SPI_TRANSACTION_H_
+
+#if defined(AeroQuadSTM32)
+
+#include <spi.h>
+#include <dma.h>
+
+#define SPI_TRANSACTION_QUEUE_SIZE 4
+
+#define SPI_TRANSACTION_IDLE 0      // never queued
+#define SPI_TRANSACTION_QUEUED 1
+#define SPI_TRANSACTION_RUNNING 2
+#define SPI_TRANSACTION_DONE 3
+
+struct SPIDevice;
+
+struct SPITransaction {
+  SPIDevice *device;
+  const byte *txData;               // NULL sends zeros
+  byte *rxData;                     // NULL discards what is read
+  unsigned int length;
+  void (*done)(SPITransaction *);   // called from the DMA interrupt, may be NULL
+  volatile byte state;
+};
+
+struct SPIBus {
+  spi_dev *spi;
+  dma_dev *dma;
+  dma_stream rxStream;
+  dma_stream txStream;
+  uint32 dmaChannel;
+  SPIDevice *activeDevice;          // device the port is configured for
+  SPITransaction *queue[SPI_TRANSACTION_QUEUE_SIZE];
+  volatile byte queueHead;
+  volatile byte queueTail;
+  volatile boolean running;
+};
+
+struct SPIDevice {
+  SPIBus *bus;
+  byte csPin;
+  spi_baud_rate baud;
+  spi_mode mode;
+};
+
+byte spiTransactionDummyTx = 0;
+byte spiTransactionDummyRx;
+
+void applySPIDevice(SPIDevice *device) {
+  SPIBus *bus = device->bus;
+  if (bus->activeDevice == device) {
+    return;
+  }
+  // baud rate and clock mode can only change with the port disabled
+  const uint32 cr1 = bus->spi->regs->CR1 & ~(SPI_CR1_SPE | SPI_CR1_BR | SPI_CR1_CPOL | SPI_CR1_CPHA);
+  bus->spi->regs->CR1 = cr1;
+  bus->spi->regs->CR1 = cr1 | device->baud | device->mode;
+  bus->spi->regs->CR1 |= SPI_CR1_SPE;
+  bus->activeDevice = device;
+}
+
+// called with the bus idle, from the main loop or the DMA interrupt
+void startSPITransaction(SPIBus *bus) {
+  SPITransaction *transaction = bus->queue[bus->queueTail];
+  bus->running = true;
+  transaction->state = SPI_TRANSACTION_RUNNING;
+  applySPIDevice(transaction->device);
+  digitalWrite(transaction->device->csPin, LOW);
+
+  // flush anything left over from polled transfers
+  while (spi_is_rx_nonempty(bus->spi)) {
+    spi_rx_reg(bus->spi);
+  }
+  (void)bus->spi->regs->SR;
+
+  const uint32 flags = bus->dmaChannel | DMA_CR_PL_HIGH | DMA_CR_MSIZE_8BITS | DMA_CR_PSIZE_8BITS;
+  if (transaction->rxData != NULL) {
+    dma_setup_transfer(bus->dma, bus->rxStream, &bus->spi->regs->DR, transaction->rxData, NULL,
+                       flags | DMA_CR_MINC | DMA_CR_DIR_P2M | DMA_CR_TCIE, 0);
+  }
+  else {
+    dma_setup_transfer(bus->dma, bus->rxStream, &bus->spi->regs->DR, &spiTransactionDummyRx, NULL,
+                       flags | DMA_CR_DIR_P2M | DMA_CR_TCIE, 0);
+  }
+  if (transaction->txData != NULL) {
+    dma_setup_transfer(bus->dma, bus->txStream, &bus->spi->regs->DR, (void *)transaction->txData, NULL,
+                       flags | DMA_CR_MINC | DMA_CR_DIR_M2P, 0);
+  }
+  else {
+    dma_setup_transfer(bus->dma, bus->txStream, &bus->spi->regs->DR, &spiTransactionDummyTx, NULL,
+                       flags | DMA_CR_DIR_M2P, 0);
+  }
+  dma_set_num_transfers(bus->dma, bus->rxStream, transaction->length);
+  dma_set_num_transfers(bus->dma, bus->txStream, transaction->length);
+  dma_clear_isr_bits(bus->dma, bus->rxStream);
+  dma_clear_isr_bits(bus->dma, bus->txStream);
+  dma_enable(bus->dma, bus->rxStream);
+  dma_enable(bus->dma, bus->txStream);
+  bus->spi->regs->CR2 |= SPI_CR2_RXDMAEN | SPI_CR2_TXDMAEN;
+}
+
+// RX stream complete, every byte has been clocked in and out
+void completeSPITransaction(SPIBus *bus) {
+  SPITransaction *transaction = bus->queue[bus->queueTail];
+  bus->spi->regs->CR2 &= ~(SPI_CR2_RXDMAEN | SPI_CR2_TXDMAEN);
+  dma_disable(bus->dma, bus->rxStream);
+  dma_disable(bus->dma, bus->txStream);
+  dma_clear_isr_bits(bus->dma, bus->txStream);
+  while (spi_is_busy(bus->spi));
+  digitalWrite(transaction->device->csPin, HIGH);
+
+  bus->queueTail = (bus->queueTail + 1) % SPI_TRANSACTION_QUEUE_SIZE;
+  transaction->state = SPI_TRANSACTION_DONE;
+  if (transaction->done != NULL) {
+    transaction->done(transaction);
+  }
+
+  if (bus->queueTail != bus->queueHead) {
+    startSPITransaction(bus);
+  }
+  else {
+    bus->running = false;
+  }
+}
+
+void initializeSPIBus(SPIBus *bus, void (*rxComplete)(void)) {
+  bus->activeDevice = NULL;
+  bus->queueHead = 0;
+  bus->queueTail = 0;
+  bus->running = false;
+  dma_init(bus->dma);
+  dma_attach_interrupt(bus->dma, bus->rxStream, rxComplete);
+}
+
+void initializeSPIDevice(SPIDevice *device) {
+  pinMode(device->csPin, OUTPUT);
+  digitalWrite(device->csPin, HIGH);
+}
+
+/**
+ * Queues a transaction, its buffers must stay untouched until its state
+ * is SPI_TRANSACTION_DONE. Returns false if it is still pending or the
+ * queue is full.
+ */
+boolean queueSPITransaction(SPITransaction *transaction) {
+  SPIBus *bus = transaction->device->bus;
+  noInterrupts();
+  const byte next = (bus->queueHead + 1) % SPI_TRANSACTION_QUEUE_SIZE;
+  if (transaction->state == SPI_TRANSACTION_QUEUED || transaction->state == SPI_TRANSACTION_RUNNING ||
+      next == bus->queueTail) {
+    interrupts();
+    return false;
+  }
+  transaction->state = SPI_TRANSACTION_QUEUED;
+  bus->queue[bus->queueHead] = transaction;
+  bus->queueHead = next;
+  if (!bus->running) {
+    startSPITransaction(bus);
+  }
+  interrupts();
+  return true;
+}
+
+boolean isSPITransactionPending(SPITransaction *transaction) {
+  return transaction->state == SPI_TRANSACTION_QUEUED || transaction->state == SPI_TRANSACTION_RUNNING;
+}
+
+void waitSPITransaction(SPITransaction *transaction) {
+  while (isSPITransactionPending(transaction));
+}
+
+boolean isSPIBusBusy(SPIBus *bus) {
+  return bus->running;
+}
+
+/**
+ * Waits for the queue to drain and configures the port for a polled
+ * transfer to the device, the caller drives chip select
+ */
+void acquireSPIDevice(SPIDevice *device) {
+  while (device->bus->running);
+  applySPIDevice(device);
+}
+
+/**
+ * To be called after the port was set up by other means, e.g. HardwareSPI::begin()
+ */
+void invalidateSPIBus(SPIBus *bus) {
+  bus->activeDevice = NULL;
+}
+
+#endif // AeroQuadSTM32
+#endif
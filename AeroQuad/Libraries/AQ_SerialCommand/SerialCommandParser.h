@@ -0,0 +1,301 @@
+/*
+  AeroQuad v3.2 - Resumable serial command parser
+  www.AeroQuad.com
+  Copyright (c) 2012 Ted Carancho.  All rights reserved.
+  An Open Source Arduino based multicopter.
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Configurator commands taken one byte at a time
+//
+// A command is one character followed by numeric fields, each ended by
+// ';'. The parser is fed whatever bytes are buffered and keeps its place
+// between calls, numbers are converted digit by digit as they arrive so
+// no byte costs more than a few multiplications. How many fields follow a
+// command, and whether they are floats or integers, is asked from
+// serialCommandFieldKind(), which the user of the parser provides; it is
+// asked again after every field so the count may depend on what came
+// before. Once the last field is in, the command is ready and no further
+// byte is taken until takeSerialCommand() hands it over, its fields are
+// then read in order with nextSerialCommandFloat() and
+// nextSerialCommandInteger(). A command whose bytes stop coming is
+// dropped as a whole by expireSerialCommand().
+
+#ifndef _AEROQUAD_SERIAL_COMMAND_PARSER_H_
+#define _AEROQUAD_SERIAL_COMMAND_PARSER_H_
+
+#include "Arduino.h"
+
+#define SERIAL_COMMAND_MAX_FIELDS 16
+#define SERIAL_COMMAND_TIMEOUT 250      // ms without a byte before a partial command is dropped
+
+#define SERIAL_FIELD_NONE 0             // no more fields, the command is complete
+#define SERIAL_FIELD_FLOAT 1
+#define SERIAL_FIELD_INTEGER 2
+
+#define SERIAL_COMMAND_IDLE 0
+#define SERIAL_COMMAND_RECEIVING 1
+#define SERIAL_COMMAND_READY 2
+
+// number states, a field is [spaces][sign]digits[.digits][e[sign]digits]
+#define SERIAL_NUMBER_START 0
+#define SERIAL_NUMBER_INTEGER 1
+#define SERIAL_NUMBER_FRACTION 2
+#define SERIAL_NUMBER_EXPONENT_START 3
+#define SERIAL_NUMBER_EXPONENT 4
+#define SERIAL_NUMBER_END 5             // anything else, ignored up to the ';'
+
+#define SERIAL_MANTISSA_LIMIT 429496728UL  // one more digit still fits an unsigned long
+
+union SerialCommandField {
+  float value;
+  long integer;
+};
+
+struct SerialCommandParser {
+  byte state;
+  char command;
+  byte fields;                          // fields completed
+  byte fieldKind;                       // kind of the field being received
+  byte readIndex;                       // next field handed to the command
+  unsigned long lastByteTime;
+  unsigned int dropped;                 // commands expired or with too many fields
+
+  byte numberState;
+  boolean negative;
+  boolean exponentNegative;
+  unsigned long mantissa;
+  int exponent;                         // decimal exponent of the mantissa
+  int exponentValue;                    // as written after the 'e'
+
+  SerialCommandField field[SERIAL_COMMAND_MAX_FIELDS];
+} serialCommandParser;
+
+// powers of ten that are exact in single precision
+const float serialPowersOfTen[11] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10};
+
+/**
+ * Provided by the user of the parser: the kind of the field'th field of
+ * command, SERIAL_FIELD_NONE once all its fields are received. The fields
+ * before it are in serialCommandParser.field[].
+ */
+byte serialCommandFieldKind(char command, byte field);
+
+void startSerialNumber() {
+  serialCommandParser.numberState = SERIAL_NUMBER_START;
+  serialCommandParser.negative = false;
+  serialCommandParser.exponentNegative = false;
+  serialCommandParser.mantissa = 0;
+  serialCommandParser.exponent = 0;
+  serialCommandParser.exponentValue = 0;
+}
+
+float serialNumberValue() {
+  int exponent = serialCommandParser.exponent +
+                 (serialCommandParser.exponentNegative ? -serialCommandParser.exponentValue : serialCommandParser.exponentValue);
+  float value = serialCommandParser.mantissa;
+  if (value != 0.0) {
+    // one rounding for the usual few decimals, 1e10 steps beyond
+    while (exponent > 10) {
+      value *= serialPowersOfTen[10];
+      exponent -= 10;
+    }
+    while (exponent < -10) {
+      value /= serialPowersOfTen[10];
+      exponent += 10;
+    }
+    value = (exponent >= 0) ? value * serialPowersOfTen[exponent] : value / serialPowersOfTen[-exponent];
+  }
+  return serialCommandParser.negative ? -value : value;
+}
+
+void serialNumberDigit(byte digit) {
+  SerialCommandParser *parser = &serialCommandParser;
+  switch (parser->numberState) {
+  case SERIAL_NUMBER_START:
+    parser->numberState = SERIAL_NUMBER_INTEGER;
+    // fall through
+  case SERIAL_NUMBER_INTEGER:
+    if (parser->mantissa <= SERIAL_MANTISSA_LIMIT) {
+      parser->mantissa = parser->mantissa * 10 + digit;
+    }
+    else {
+      parser->exponent++;
+    }
+    break;
+  case SERIAL_NUMBER_FRACTION:
+    // integer fields stop at the decimal point, like atol()
+    if (parser->fieldKind == SERIAL_FIELD_FLOAT && parser->mantissa <= SERIAL_MANTISSA_LIMIT) {
+      parser->mantissa = parser->mantissa * 10 + digit;
+      parser->exponent--;
+    }
+    break;
+  case SERIAL_NUMBER_EXPONENT_START:
+    parser->numberState = SERIAL_NUMBER_EXPONENT;
+    // fall through
+  case SERIAL_NUMBER_EXPONENT:
+    if (parser->exponentValue < 100) {
+      parser->exponentValue = parser->exponentValue * 10 + digit;
+    }
+    break;
+  }
+}
+
+void serialNumberCharacter(char data) {
+  SerialCommandParser *parser = &serialCommandParser;
+  if (data >= '0' && data <= '9') {
+    serialNumberDigit(data - '0');
+    return;
+  }
+  switch (parser->numberState) {
+  case SERIAL_NUMBER_START:
+    if (data == '-' || data == '+') {
+      parser->negative = (data == '-');
+      parser->numberState = SERIAL_NUMBER_INTEGER;
+    }
+    else if (data == '.') {
+      parser->numberState = SERIAL_NUMBER_FRACTION;
+    }
+    else if (data != ' ') {
+      parser->numberState = SERIAL_NUMBER_END;
+    }
+    break;
+  case SERIAL_NUMBER_INTEGER:
+    if (data == '.') {
+      parser->numberState = SERIAL_NUMBER_FRACTION;
+    }
+    else if ((data == 'e' || data == 'E') && parser->fieldKind == SERIAL_FIELD_FLOAT) {
+      parser->numberState = SERIAL_NUMBER_EXPONENT_START;
+    }
+    else {
+      parser->numberState = SERIAL_NUMBER_END;
+    }
+    break;
+  case SERIAL_NUMBER_FRACTION:
+    if ((data == 'e' || data == 'E') && parser->fieldKind == SERIAL_FIELD_FLOAT) {
+      parser->numberState = SERIAL_NUMBER_EXPONENT_START;
+    }
+    else {
+      parser->numberState = SERIAL_NUMBER_END;
+    }
+    break;
+  case SERIAL_NUMBER_EXPONENT_START:
+    if (data == '-' || data == '+') {
+      parser->exponentNegative = (data == '-');
+      parser->numberState = SERIAL_NUMBER_EXPONENT;
+    }
+    else {
+      parser->numberState = SERIAL_NUMBER_END;
+    }
+    break;
+  case SERIAL_NUMBER_EXPONENT:
+    parser->numberState = SERIAL_NUMBER_END;
+    break;
+  }
+}
+
+// asks for the next field, the command is ready when there is none
+void nextSerialCommandField() {
+  SerialCommandParser *parser = &serialCommandParser;
+  parser->fieldKind = serialCommandFieldKind(parser->command, parser->fields);
+  if (parser->fieldKind == SERIAL_FIELD_NONE) {
+    parser->state = SERIAL_COMMAND_READY;
+  }
+  else if (parser->fields >= SERIAL_COMMAND_MAX_FIELDS) {
+    parser->dropped++;
+    parser->state = SERIAL_COMMAND_IDLE;
+  }
+  else {
+    startSerialNumber();
+  }
+}
+
+/**
+ * Feeds one received byte, returns true when it completes a command.
+ * Must not be called while a command is ready.
+ */
+boolean parseSerialCommandByte(byte data, unsigned long now) {
+  SerialCommandParser *parser = &serialCommandParser;
+  parser->lastByteTime = now;
+  if (parser->state == SERIAL_COMMAND_IDLE) {
+    parser->command = data;
+    parser->fields = 0;
+    parser->readIndex = 0;
+    parser->state = SERIAL_COMMAND_RECEIVING;
+    nextSerialCommandField();
+  }
+  else if (data == ';') {
+    if (parser->fieldKind == SERIAL_FIELD_FLOAT) {
+      parser->field[parser->fields].value = serialNumberValue();
+    }
+    else {
+      const long integer = parser->mantissa;
+      parser->field[parser->fields].integer = parser->negative ? -integer : integer;
+    }
+    parser->fields++;
+    nextSerialCommandField();
+  }
+  else {
+    serialNumberCharacter(data);
+  }
+  return parser->state == SERIAL_COMMAND_READY;
+}
+
+/**
+ * Drops a partly received command once no byte came for SERIAL_COMMAND_TIMEOUT,
+ * to be called when nothing is waiting to be parsed
+ */
+void expireSerialCommand(unsigned long now) {
+  if (serialCommandParser.state == SERIAL_COMMAND_RECEIVING &&
+      now - serialCommandParser.lastByteTime > SERIAL_COMMAND_TIMEOUT) {
+    serialCommandParser.dropped++;
+    serialCommandParser.state = SERIAL_COMMAND_IDLE;
+  }
+}
+
+boolean isSerialCommandReady() {
+  return serialCommandParser.state == SERIAL_COMMAND_READY;
+}
+
+/**
+ * Returns the ready command and frees the parser for the next one, the
+ * fields stay readable until more bytes are parsed
+ */
+char takeSerialCommand() {
+  serialCommandParser.state = SERIAL_COMMAND_IDLE;
+  serialCommandParser.readIndex = 0;
+  return serialCommandParser.command;
+}
+
+// past the received fields, 0 as the old readers returned on a timeout
+float nextSerialCommandFloat() {
+  if (serialCommandParser.readIndex >= serialCommandParser.fields) {
+    return 0.0;
+  }
+  return serialCommandParser.field[serialCommandParser.readIndex++].value;
+}
+
+long nextSerialCommandInteger() {
+  if (serialCommandParser.readIndex >= serialCommandParser.fields) {
+    return 0;
+  }
+  return serialCommandParser.field[serialCommandParser.readIndex++].integer;
+}
+
+void skipSerialCommandFields(byte number) {
+  serialCommandParser.readIndex = min(serialCommandParser.readIndex + number, (int)serialCommandParser.fields);
+}
+
+#endif
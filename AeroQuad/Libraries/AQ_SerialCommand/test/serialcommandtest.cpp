@@ -0,0 +1,348 @@
+/*
+ * Replay test of the resumable serial command parser
+ *
+ * Every Configurator command 'A'..'Z' and '1'..'5', with random values in
+ * the number formats a PC may print, is sent through a simulated port
+ * that delivers the bytes in random fragments with random gaps. The
+ * firmware side is polled as on the flight controller: parseSerialCommand()
+ * at 100Hz, readSerialCommand() at 10Hz. Each command must be applied
+ * exactly once, only after its last byte, with the values atof()/atol()
+ * give. Commands cut short must be dropped whole. The time of every
+ * parseSerialCommand() call is measured.
+ *
+ *   make && ./serialcommandtest
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include "SerialCommandParser.h"
+
+#define ROUNDS 20000
+
+/* the flight controller with the default UserConfiguration.h */
+#define XAXIS 0
+#define LASTCHANNEL 8
+static byte LASTMOTOR = 4;
+
+/* simulated serial port and clock */
+static std::vector<byte> portStream;
+static size_t portDelivered = 0;
+static size_t portRead = 0;
+static unsigned long simulatedMillis = 0;
+
+#define SERIAL_AVAILABLE() ((int)(portDelivered - portRead))
+#define SERIAL_READ() (portStream[portRead++])
+static unsigned long millis() { return simulatedMillis; }
+
+/* serialCommandFieldCount(), serialCommandFieldKind() and parseSerialCommand()
+ * as in SerialCom.h, the key compared in single precision like the flight
+ * builds do */
+static byte serialCommandFieldCount(char command) {
+  switch (command) {
+  case 'A':
+  case 'C':
+    return 7;
+  case 'B':
+    return 13;
+  case 'D':
+    return 12;
+  case 'E':
+  case 'G':
+  case 'H':
+  case 'U':
+    return 2;
+  case 'F':
+    return 1 + LASTCHANNEL - XAXIS;
+  case 'K':
+    return 6;
+  case 'M':
+  case 'N':
+    return 3;
+  case 'O':
+    return 4;
+  case 'P':
+    return 13;
+  case 'V':
+    return 9;
+  case 'Y':
+  case 'Z':
+  case '1':
+  case '2':
+  case '4':
+    return 1;
+  case '3':
+    return serialCommandParser.field[0].value == 123.45f ? 2 : 1;
+  case '5':
+    return serialCommandParser.field[0].value == 123.45f ? 1 + LASTMOTOR : 1;
+  }
+  return 0;
+}
+
+byte serialCommandFieldKind(char command, byte field) {
+  if (field >= serialCommandFieldCount(command)) {
+    return SERIAL_FIELD_NONE;
+  }
+  return (command == 'O') ? SERIAL_FIELD_INTEGER : SERIAL_FIELD_FLOAT;
+}
+
+static boolean parseSerialCommand() {
+  const unsigned long now = millis();
+  if (!isSerialCommandReady() && SERIAL_AVAILABLE() == 0) {
+    expireSerialCommand(now);
+  }
+  while (!isSerialCommandReady() && SERIAL_AVAILABLE()) {
+    parseSerialCommandByte(SERIAL_READ(), now);
+  }
+  return isSerialCommandReady();
+}
+
+/* what was sent and what was applied */
+struct Command {
+  char command;
+  std::vector<std::string> text;
+  size_t end;               /* stream offset just past its last byte */
+};
+
+static std::vector<Command> sent;
+static size_t nextExpected = 0;
+static int failures = 0;
+static unsigned long applied = 0;
+
+static double maxCallTime = 0.0;
+static double totalCallTime = 0.0;
+static unsigned long calls = 0;
+static size_t maxCallBytes = 0;
+static size_t maxBacklog = 0;
+static std::vector<float> byteCallTimes;   /* of the calls that took bytes */
+
+static boolean timedParse() {
+  const size_t before = portRead;
+  const auto start = std::chrono::steady_clock::now();
+  const boolean ready = parseSerialCommand();
+  const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  maxCallTime = max(maxCallTime, elapsed);
+  totalCallTime += elapsed;
+  calls++;
+  maxCallBytes = max(maxCallBytes, portRead - before);
+  if (portRead != before) {
+    byteCallTimes.push_back((float)elapsed);
+  }
+  return ready;
+}
+
+static bool closeEnough(float value, float expected) {
+  return fabsf(value - expected) <= 5e-7f * fabsf(expected) || value == expected;
+}
+
+/* readSerialCommand(), checking the command against what was sent */
+static void readSerialCommand() {
+  if (!timedParse()) {
+    return;
+  }
+  if (nextExpected >= sent.size()) {
+    printf("command '%c' applied that was never sent\n", serialCommandParser.command);
+    failures++;
+    takeSerialCommand();
+    return;
+  }
+  const Command &expected = sent[nextExpected++];
+  const char command = takeSerialCommand();
+  applied++;
+  if (command != expected.command || portRead != expected.end) {
+    printf("expected '%c' ending at %zu, got '%c' at %zu\n", expected.command, expected.end, command, portRead);
+    failures++;
+    return;
+  }
+  for (size_t i = 0; i < expected.text.size(); i++) {
+    const char *text = expected.text[i].c_str();
+    if (command == 'O') {
+      const long value = nextSerialCommandInteger();
+      if (value != atol(text)) {
+        printf("'%c' field %zu \"%s\": %ld, atol %ld\n", command, i, text, value, atol(text));
+        failures++;
+      }
+    }
+    else {
+      const float value = nextSerialCommandFloat();
+      const float reference = (float)atof(text);
+      if (!closeEnough(value, reference)) {
+        printf("'%c' field %zu \"%s\": %.9g, atof %.9g\n", command, i, text, value, reference);
+        failures++;
+      }
+    }
+  }
+  if (serialCommandParser.fields != expected.text.size()) {
+    printf("'%c' has more fields than sent\n", command);
+    failures++;
+  }
+}
+
+static double uniform() {
+  return rand() / (RAND_MAX + 1.0);
+}
+
+/* a value the way a PC program could print it */
+static std::string randomFloatText() {
+  char text[40];
+  const double magnitude = pow(10.0, uniform() * 8.0 - 4.0);
+  const double value = (rand() % 4 == 0 ? -1.0 : 1.0) * magnitude * uniform();
+  switch (rand() % 6) {
+  case 0:  snprintf(text, sizeof(text), "%.*f", rand() % 7, value); break;
+  case 1:  snprintf(text, sizeof(text), "%g", value); break;
+  case 2:  snprintf(text, sizeof(text), "%e", value); break;
+  case 3:  snprintf(text, sizeof(text), "%+.3f", value); break;
+  case 4:  snprintf(text, sizeof(text), " %.2f", value); break;
+  default: snprintf(text, sizeof(text), "%d", (int)value); break;
+  }
+  return text;
+}
+
+static std::string randomIntegerText() {
+  char text[24];
+  const long value = (long)((uniform() * 2.0 - 1.0) * 1800000000.0);
+  snprintf(text, sizeof(text), "%ld", value);
+  return text;
+}
+
+/* field count of a command whose first value is or is not the calibration key */
+static byte fieldCount(char command, bool validKey) {
+  const SerialCommandField saved = serialCommandParser.field[0];
+  serialCommandParser.field[0].value = validKey ? 123.45f : 100.0f;
+  const byte count = serialCommandFieldCount(command);
+  serialCommandParser.field[0] = saved;
+  return count;
+}
+
+static void queueCommand(char command) {
+  Command c;
+  c.command = command;
+  portStream.push_back(command);
+  const bool validKey = rand() % 2;
+  const byte count = fieldCount(command, validKey);
+  for (byte field = 0; field < count; field++) {
+    std::string text;
+    if ((command == '3' || command == '5') && field == 0) {
+      text = validKey ? "123.45" : "100";
+    }
+    else {
+      text = (command == 'O') ? randomIntegerText() : randomFloatText();
+    }
+    portStream.insert(portStream.end(), text.begin(), text.end());
+    portStream.push_back(';');
+    c.text.push_back(text);
+  }
+  c.end = portStream.size();
+  sent.push_back(c);
+}
+
+/* advances the clock 1ms, running the flight controller tasks that are due */
+static void tick() {
+  simulatedMillis++;
+  if (simulatedMillis % 10 == 0) {
+    timedParse();
+  }
+  if (simulatedMillis % 100 == 0) {
+    readSerialCommand();
+  }
+  maxBacklog = max(maxBacklog, portDelivered - portRead);
+}
+
+int main() {
+  static const char commands[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ12345abs";
+  srand(1);
+
+  /* every command in random order, the bytes trickling in fragments */
+  for (int round = 0; round < ROUNDS; round++) {
+    std::string order(commands);
+    for (size_t i = order.size() - 1; i > 0; i--) {
+      std::swap(order[i], order[rand() % (i + 1)]);
+    }
+    for (size_t i = 0; i < order.size(); i++) {
+      queueCommand(order[i]);
+    }
+    while (portDelivered < portStream.size()) {
+      const int gap = (rand() % 20 == 0) ? rand() % 200 : rand() % 3;
+      for (int i = 0; i < gap; i++) {
+        tick();
+      }
+      const size_t fragment = 1 + rand() % ((rand() % 8 == 0) ? 64 : 6);
+      portDelivered = (portDelivered + fragment < portStream.size()) ? portDelivered + fragment : portStream.size();
+      tick();
+    }
+    while (nextExpected < sent.size() && portRead < portStream.size()) {
+      tick();
+    }
+    for (int i = 0; i < 100; i++) {
+      tick();
+    }
+  }
+  if (nextExpected != sent.size()) {
+    printf("%zu commands applied, %zu sent\n", nextExpected, sent.size());
+    failures++;
+  }
+  printf("%lu commands applied in %lu parse calls, %u dropped\n", applied, calls, serialCommandParser.dropped);
+  if (serialCommandParser.dropped != 0) failures++;
+
+  /* a command that stops halfway is dropped, the next one is whole */
+  for (int trial = 0; trial < 1000; trial++) {
+    const unsigned int dropped = serialCommandParser.dropped;
+    const std::string partial = "B1.5;2.5;";
+    portStream.insert(portStream.end(), partial.begin(), partial.begin() + 1 + rand() % (partial.size() - 1));
+    portDelivered = portStream.size();
+    for (int i = 0; i < SERIAL_COMMAND_TIMEOUT + 20; i++) {
+      tick();
+    }
+    if (serialCommandParser.dropped != dropped + 1 || isSerialCommandReady()) {
+      printf("partial command not dropped\n");
+      failures++;
+      break;
+    }
+    queueCommand('A');
+    portDelivered = portStream.size();
+    for (int i = 0; i < 200; i++) {
+      tick();
+    }
+    if (nextExpected != sent.size()) {
+      printf("command after a dropped one not applied\n");
+      failures++;
+      break;
+    }
+  }
+  printf("1000 interrupted commands dropped without being applied\n");
+
+  /* worst case for one call: the longest command buffered in one piece */
+  double worstWhole = 0.0;
+  for (int trial = 0; trial < 10000; trial++) {
+    queueCommand('B');
+    portDelivered = portStream.size();
+    const size_t bytes = portStream.size() - portRead;
+    const auto start = std::chrono::steady_clock::now();
+    parseSerialCommand();
+    worstWhole = max(worstWhole, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    if (portRead != portStream.size() || bytes == 0) failures++;
+    readSerialCommand();
+  }
+
+  std::sort(byteCallTimes.begin(), byteCallTimes.end());
+  printf("parse call: %.0f ns mean, %.0f ns worst, %zu bytes at most per call\n",
+         totalCallTime / calls * 1e9, maxCallTime * 1e9, maxCallBytes);
+  printf("calls taking bytes: %.0f ns median, %.0f ns 99.9%%, %.0f ns 99.999%% (the worst above includes preemption)\n",
+         byteCallTimes[byteCallTimes.size() / 2] * 1e9, byteCallTimes[byteCallTimes.size() * 999 / 1000] * 1e9,
+         byteCallTimes[byteCallTimes.size() * 99999 / 100000] * 1e9);
+  printf("whole 'B' command in one call: %.0f ns worst\n", worstWhole * 1e9);
+  printf("bytes left waiting in the port: %zu at most\n", maxBacklog);
+  printf(failures ? "FAILED\n" : "PASSED\n");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,401 @@
+/*
+  AeroQuad v3.2 - serial link multiplexer
+  www.AeroQuad.com
+  Copyright (c) 2012 Ted Carancho.  All rights reserved.
+  An Open Source Arduino based multicopter.
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Several byte streams sharing one UART or USB link
+//
+// Every channel is a stream object with its own statically allocated
+// transmit and receive rings, so any code written against a serial port
+// (SERIAL_PORT.print(), write(), available(), read()) can run on a channel.
+// On the link the channels travel as frames
+//   0xA5, channel, length, payload[length], fletcher16 sum A, sum B
+// with the checksum taken over channel, length and payload.
+//
+// Writing to a channel never blocks, data that does not fit the ring is
+// dropped and counted. serialMuxService() is called from the flight loop and
+// moves whole frames onto the link, never more than the link can take
+// without blocking: txSpace() on AQ32, SERIAL_MUX_TX_BUDGET bytes per call
+// on AVR where HardwareSerial cannot report it.
+//
+// Channels are served by priority with a deficit round robin: each call
+// every channel earns its share in bytes, and a channel sends only while it
+// has earned enough for the next frame. Link space left over after that
+// goes to the channels still holding data, highest priority first.
+//
+// Received payload bytes go straight into the receive ring of their
+// channel and only become readable once the frame checksum matched.
+//
+// The link object is given by SERIAL_MUX_LINK, defined before this file
+// is included.
+
+#ifndef _AQ_SERIAL_MUX_H_
+#define _AQ_SERIAL_MUX_H_
+
+#include "Arduino.h"
+
+#define SERIAL_MUX_SYNC 0xA5
+#define SERIAL_MUX_MAX_PAYLOAD 64
+#define SERIAL_MUX_FRAME_OVERHEAD 5
+#ifndef SERIAL_MUX_TX_BUDGET
+  #define SERIAL_MUX_TX_BUDGET 64   // bytes per serialMuxService() call when the link cannot report its free space
+#endif
+
+#define SERIAL_MUX_WAIT_SYNC 0
+#define SERIAL_MUX_WAIT_CHANNEL 1
+#define SERIAL_MUX_WAIT_LENGTH 2
+#define SERIAL_MUX_WAIT_PAYLOAD 3
+#define SERIAL_MUX_WAIT_SUM_A 4
+#define SERIAL_MUX_WAIT_SUM_B 5
+
+#if defined(AeroQuadSTM32)
+  #define SERIAL_MUX_WRITE_TYPE void
+  #define SERIAL_MUX_WRITE_RETURN(n) return
+  class SerialMuxChannel : public Print {
+#else
+  #define SERIAL_MUX_WRITE_TYPE size_t
+  #define SERIAL_MUX_WRITE_RETURN(n) return (n)
+  class SerialMuxChannel : public Stream {
+#endif
+public:
+  byte id;
+  byte priority;          // higher is served first
+  unsigned int share;     // bytes earned per serialMuxService() call
+  int deficit;
+  byte *txBuffer;
+  unsigned int txSize;
+  unsigned int txHead;
+  unsigned int txTail;
+  byte *rxBuffer;
+  unsigned int rxSize;
+  unsigned int rxHead;
+  unsigned int rxTail;
+  unsigned long txDropped;
+  unsigned long rxDropped;
+  SerialMuxChannel *next;
+
+  SerialMuxChannel(byte channelId, byte channelPriority, unsigned int channelShare,
+                   byte *transmitBuffer, unsigned int transmitSize,
+                   byte *receiveBuffer, unsigned int receiveSize);
+
+  void begin() {}
+  void begin(unsigned long) {}
+
+  unsigned int txUsed() {
+    return (txHead + txSize - txTail) % txSize;
+  }
+
+  unsigned int txSpace() {
+    return txSize - 1 - txUsed();
+  }
+
+  unsigned int rxUsed() {
+    return (rxHead + rxSize - rxTail) % rxSize;
+  }
+
+  int available();
+
+  int peek() {
+    if (available() == 0) {
+      return -1;
+    }
+    return rxBuffer[rxTail];
+  }
+
+  int read() {
+    if (available() == 0) {
+      return -1;
+    }
+    const byte data = rxBuffer[rxTail];
+    rxTail = (rxTail + 1) % rxSize;
+    return data;
+  }
+
+  // discards pending input, transmit data is never waited for
+  void flush() {
+    rxTail = rxHead;
+  }
+
+  SERIAL_MUX_WRITE_TYPE write(uint8_t data) {
+    if (txSpace() == 0) {
+      txDropped++;
+      SERIAL_MUX_WRITE_RETURN(0);
+    }
+    txBuffer[txHead] = data;
+    txHead = (txHead + 1) % txSize;
+    SERIAL_MUX_WRITE_RETURN(1);
+  }
+
+  // all or nothing, so a binary record is never cut short by an overflow
+  #if defined(AeroQuadSTM32)
+  void write(const void *buffer, uint32 length) {
+    const byte *data = (const byte *)buffer;
+  #else
+  size_t write(const uint8_t *data, size_t length) {
+  #endif
+    if (length > txSpace()) {
+      txDropped += length;
+      SERIAL_MUX_WRITE_RETURN(0);
+    }
+    for (unsigned int i = 0; i < length; i++) {
+      txBuffer[txHead] = data[i];
+      txHead = (txHead + 1) % txSize;
+    }
+    SERIAL_MUX_WRITE_RETURN(length);
+  }
+
+  #if defined(AeroQuadSTM32)
+  void write(const char *str) {
+    write(str, strlen(str));
+  }
+  #else
+  using Print::write;
+  #endif
+};
+
+SerialMuxChannel *serialMuxChannels = NULL;   // sorted by priority, highest first
+
+byte serialMuxRxState = SERIAL_MUX_WAIT_SYNC;
+SerialMuxChannel *serialMuxRxChannel = NULL;
+byte serialMuxRxLength = 0;
+byte serialMuxRxCount = 0;
+unsigned int serialMuxRxHead = 0;
+byte serialMuxRxSumA = 0;
+byte serialMuxRxSumB = 0;
+unsigned long serialMuxRxFrames = 0;
+unsigned long serialMuxRxErrors = 0;
+unsigned long serialMuxTxFrames = 0;
+
+SerialMuxChannel::SerialMuxChannel(byte channelId, byte channelPriority, unsigned int channelShare,
+                                   byte *transmitBuffer, unsigned int transmitSize,
+                                   byte *receiveBuffer, unsigned int receiveSize) {
+  id = channelId;
+  priority = channelPriority;
+  share = channelShare;
+  deficit = 0;
+  txBuffer = transmitBuffer;
+  txSize = transmitSize;
+  txHead = 0;
+  txTail = 0;
+  rxBuffer = receiveBuffer;
+  rxSize = receiveSize;
+  rxHead = 0;
+  rxTail = 0;
+  txDropped = 0;
+  rxDropped = 0;
+
+  SerialMuxChannel **link = &serialMuxChannels;
+  while (*link != NULL && (*link)->priority >= priority) {
+    link = &(*link)->next;
+  }
+  next = *link;
+  *link = this;
+}
+
+SerialMuxChannel *findSerialMuxChannel(byte channelId) {
+  for (SerialMuxChannel *channel = serialMuxChannels; channel != NULL; channel = channel->next) {
+    if (channel->id == channelId) {
+      return channel;
+    }
+  }
+  return NULL;
+}
+
+void serialMuxChecksum(byte data) {
+  serialMuxRxSumA += data;
+  serialMuxRxSumB += serialMuxRxSumA;
+}
+
+/**
+ * Parses what the link has received so far
+ * Payload is stored in the channel ring past its head, the head only
+ * moves once the checksum matched. Frames for unknown channels or that
+ * do not fit the ring are skipped.
+ */
+void serialMuxReceive() {
+  while (SERIAL_MUX_LINK.available() > 0) {
+    const byte data = SERIAL_MUX_LINK.read();
+    switch (serialMuxRxState) {
+    case SERIAL_MUX_WAIT_SYNC:
+      if (data == SERIAL_MUX_SYNC) {
+        serialMuxRxSumA = 0;
+        serialMuxRxSumB = 0;
+        serialMuxRxState = SERIAL_MUX_WAIT_CHANNEL;
+      }
+      break;
+
+    case SERIAL_MUX_WAIT_CHANNEL:
+      serialMuxChecksum(data);
+      serialMuxRxChannel = findSerialMuxChannel(data);
+      serialMuxRxState = SERIAL_MUX_WAIT_LENGTH;
+      break;
+
+    case SERIAL_MUX_WAIT_LENGTH:
+      serialMuxChecksum(data);
+      if (data > SERIAL_MUX_MAX_PAYLOAD) {
+        serialMuxRxErrors++;
+        serialMuxRxState = SERIAL_MUX_WAIT_SYNC;
+        break;
+      }
+      serialMuxRxLength = data;
+      serialMuxRxCount = 0;
+      if (serialMuxRxChannel != NULL) {
+        if (serialMuxRxChannel->rxSize - 1 - serialMuxRxChannel->rxUsed() < data) {
+          serialMuxRxChannel->rxDropped += data;
+          serialMuxRxChannel = NULL;
+        }
+        else {
+          serialMuxRxHead = serialMuxRxChannel->rxHead;
+        }
+      }
+      serialMuxRxState = (data == 0) ? SERIAL_MUX_WAIT_SUM_A : SERIAL_MUX_WAIT_PAYLOAD;
+      break;
+
+    case SERIAL_MUX_WAIT_PAYLOAD:
+      serialMuxChecksum(data);
+      if (serialMuxRxChannel != NULL) {
+        serialMuxRxChannel->rxBuffer[serialMuxRxHead] = data;
+        serialMuxRxHead = (serialMuxRxHead + 1) % serialMuxRxChannel->rxSize;
+      }
+      if (++serialMuxRxCount == serialMuxRxLength) {
+        serialMuxRxState = SERIAL_MUX_WAIT_SUM_A;
+      }
+      break;
+
+    case SERIAL_MUX_WAIT_SUM_A:
+      serialMuxRxState = (data == serialMuxRxSumA) ? SERIAL_MUX_WAIT_SUM_B : SERIAL_MUX_WAIT_SYNC;
+      if (serialMuxRxState == SERIAL_MUX_WAIT_SYNC) {
+        serialMuxRxErrors++;
+      }
+      break;
+
+    case SERIAL_MUX_WAIT_SUM_B:
+      if (data == serialMuxRxSumB) {
+        serialMuxRxFrames++;
+        if (serialMuxRxChannel != NULL) {
+          serialMuxRxChannel->rxHead = serialMuxRxHead;
+        }
+      }
+      else {
+        serialMuxRxErrors++;
+      }
+      serialMuxRxState = SERIAL_MUX_WAIT_SYNC;
+      break;
+    }
+  }
+}
+
+// empty channels look at the link first, so code polling available() sees new frames
+int SerialMuxChannel::available() {
+  if (rxHead == rxTail) {
+    serialMuxReceive();
+  }
+  return rxUsed();
+}
+
+unsigned int serialMuxLinkSpace() {
+  #if defined(AeroQuadSTM32)
+    return SERIAL_MUX_LINK.txSpace();
+  #else
+    return SERIAL_MUX_TX_BUDGET;
+  #endif
+}
+
+void serialMuxSendBytes(const byte *data, unsigned int length, byte *sumA, byte *sumB) {
+  for (unsigned int i = 0; i < length; i++) {
+    *sumA += data[i];
+    *sumB += *sumA;
+  }
+  SERIAL_MUX_LINK.write(data, length);
+}
+
+/**
+ * Sends up to length bytes of the channel as one frame
+ * Returns the bytes of link space used
+ */
+unsigned int sendSerialMuxFrame(SerialMuxChannel *channel, unsigned int length) {
+  const byte header[3] = {SERIAL_MUX_SYNC, channel->id, (byte)length};
+  byte sumA = 0;
+  byte sumB = 0;
+  SERIAL_MUX_LINK.write(header[0]);
+  serialMuxSendBytes(&header[1], 2, &sumA, &sumB);
+
+  // at most two pieces, the ring may wrap inside the frame
+  const unsigned int firstPart = min(length, channel->txSize - channel->txTail);
+  serialMuxSendBytes(&channel->txBuffer[channel->txTail], firstPart, &sumA, &sumB);
+  if (firstPart < length) {
+    serialMuxSendBytes(channel->txBuffer, length - firstPart, &sumA, &sumB);
+  }
+  channel->txTail = (channel->txTail + length) % channel->txSize;
+
+  SERIAL_MUX_LINK.write(sumA);
+  SERIAL_MUX_LINK.write(sumB);
+  serialMuxTxFrames++;
+  return length + SERIAL_MUX_FRAME_OVERHEAD;
+}
+
+/**
+ * Sends frames while the channel has data, the link has room
+ * and, when useDeficit is set, the channel has earned the bytes
+ */
+void serviceSerialMuxChannel(SerialMuxChannel *channel, unsigned int *linkSpace, boolean useDeficit) {
+  while (*linkSpace > SERIAL_MUX_FRAME_OVERHEAD) {
+    unsigned int length = min(channel->txUsed(), (unsigned int)SERIAL_MUX_MAX_PAYLOAD);
+    length = min(length, *linkSpace - SERIAL_MUX_FRAME_OVERHEAD);
+    if (useDeficit) {
+      if (channel->deficit <= 0) {
+        return;
+      }
+      length = min(length, (unsigned int)channel->deficit);
+    }
+    if (length == 0) {
+      return;
+    }
+    *linkSpace -= sendSerialMuxFrame(channel, length);
+    if (useDeficit) {
+      channel->deficit -= length;
+    }
+  }
+}
+
+/**
+ * Called from the flight loop, receives pending frames and
+ * sends as much as the link takes without blocking
+ */
+void serialMuxService() {
+  serialMuxReceive();
+
+  unsigned int linkSpace = serialMuxLinkSpace();
+  SerialMuxChannel *channel;
+  for (channel = serialMuxChannels; channel != NULL; channel = channel->next) {
+    if (channel->txUsed() == 0) {
+      channel->deficit = 0;   // idle channels do not bank bandwidth
+    }
+    else {
+      channel->deficit = min(channel->deficit + (int)channel->share, (int)(channel->share + SERIAL_MUX_MAX_PAYLOAD));
+    }
+  }
+  for (channel = serialMuxChannels; channel != NULL; channel = channel->next) {
+    serviceSerialMuxChannel(channel, &linkSpace, true);
+  }
+  for (channel = serialMuxChannels; channel != NULL; channel = channel->next) {
+    serviceSerialMuxChannel(channel, &linkSpace, false);
+  }
+}
+
+#endif
@@ -0,0 +1,245 @@
+/*
+ * Portable Reed Solomon encoder/decoder for the AeroQuad slow telemetry
+ *
+ * Based on RSCODE, Copyright Henry Minsky (hqm@alum.mit.edu) 1991-2009
+ *
+ * This software library is licensed under terms of the GNU GENERAL
+ * PUBLIC LICENSE
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include "rscode.h"
+
+/* x^8 + x^4 + x^3 + x^2 + 1, the high order 1 bit is implicit */
+#define PPOLY 0x1D
+
+namespace {
+
+/* Field and generator tables, built once by the first user */
+struct Tables {
+  unsigned char gexp[512];
+  unsigned char glog[256];
+  unsigned char genPoly[RS_NPAR+1];
+  unsigned char genTable[256][RS_NPAR];   /* genPoly[j] * d, as in AQ_RSCode.h */
+
+  Tables() {
+    int i, j;
+    unsigned int x = 1;
+
+    for (i = 0; i < 255; i++) {
+      gexp[i] = (unsigned char)x;
+      glog[x] = (unsigned char)i;
+      x <<= 1;
+      if (x & 0x100) x ^= 0x100 | PPOLY;
+    }
+    for (i = 255; i < 512; i++) gexp[i] = gexp[i-255];
+    glog[0] = 0;
+
+    /* multiply (x + a^i) for i = 1 to NPAR */
+    memset(genPoly, 0, sizeof(genPoly));
+    genPoly[0] = 1;
+    for (i = 1; i <= RS_NPAR; i++) {
+      for (j = i; j > 0; j--) {
+        genPoly[j] = genPoly[j-1] ^ mult(genPoly[j], gexp[i]);
+      }
+      genPoly[0] = mult(genPoly[0], gexp[i]);
+    }
+
+    for (i = 0; i < 256; i++) {
+      for (j = 0; j < RS_NPAR; j++) {
+        genTable[i][j] = mult(genPoly[j], (unsigned char)i);
+      }
+    }
+  }
+
+  unsigned char mult(unsigned char a, unsigned char b) const {
+    if (a == 0 || b == 0) return 0;
+    return gexp[glog[a] + glog[b]];
+  }
+
+  unsigned char inv(unsigned char a) const {
+    return gexp[255 - glog[a]];
+  }
+
+  /* a^power for any power >= 0 */
+  unsigned char power(int p) const {
+    return gexp[p % 255];
+  }
+};
+
+const Tables &tables() {
+  static const Tables t;
+  return t;
+}
+
+/* S[j] = codeword(a^(j+1)), all zero for a valid codeword */
+bool compute_syndromes(const Tables &t, const unsigned char codeword[], int csize,
+                       unsigned char syndromes[RS_NPAR]) {
+  bool nonZero = false;
+  for (int j = 0; j < RS_NPAR; j++) {
+    const unsigned char root = t.gexp[j+1];
+    unsigned char sum = 0;
+    for (int i = 0; i < csize; i++) {
+      sum = codeword[i] ^ t.mult(root, sum);
+    }
+    syndromes[j] = sum;
+    nonZero |= (sum != 0);
+  }
+  return nonZero;
+}
+
+/* Error locator Lambda from the syndromes, returns its degree */
+int berlekamp_massey(const Tables &t, const unsigned char S[RS_NPAR],
+                     unsigned char lambda[RS_NPAR+1]) {
+  unsigned char previous[RS_NPAR+1];
+  unsigned char saved[RS_NPAR+1];
+  int L = 0;
+  int shift = 1;
+  unsigned char previousDiscrepancy = 1;
+
+  memset(lambda, 0, RS_NPAR+1);
+  memset(previous, 0, RS_NPAR+1);
+  lambda[0] = 1;
+  previous[0] = 1;
+
+  for (int n = 0; n < RS_NPAR; n++) {
+    unsigned char d = S[n];
+    for (int i = 1; i <= L; i++) {
+      d ^= t.mult(lambda[i], S[n-i]);
+    }
+    if (d == 0) {
+      shift++;
+      continue;
+    }
+
+    /* lambda -= d / previousDiscrepancy * x^shift * previous */
+    const unsigned char scale = t.mult(d, t.inv(previousDiscrepancy));
+    memcpy(saved, lambda, RS_NPAR+1);
+    for (int i = shift; i <= RS_NPAR; i++) {
+      lambda[i] ^= t.mult(scale, previous[i-shift]);
+    }
+    if (2 * L <= n) {
+      L = n + 1 - L;
+      memcpy(previous, saved, RS_NPAR+1);
+      previousDiscrepancy = d;
+      shift = 1;
+    }
+    else {
+      shift++;
+    }
+  }
+  return L;
+}
+
+/* p(x) for x = a^power */
+unsigned char evaluate(const Tables &t, const unsigned char p[], int degree, int power) {
+  unsigned char sum = 0;
+  const unsigned char x = t.power(power);
+  for (int i = degree; i >= 0; i--) {
+    sum = p[i] ^ t.mult(x, sum);
+  }
+  return sum;
+}
+
+} // namespace
+
+void rs_encode(unsigned char msg[], int nbytes) {
+  const Tables &t = tables();
+  unsigned char LFSR[RS_NPAR];
+  int i, j;
+
+  memset(LFSR, 0, sizeof(LFSR));
+  for (i = 0; i < nbytes; i++) {
+    const unsigned char *row = t.genTable[msg[i] ^ LFSR[RS_NPAR-1]];
+    for (j = RS_NPAR-1; j > 0; j--) {
+      LFSR[j] = LFSR[j-1] ^ row[j];
+    }
+    LFSR[0] = row[0];
+  }
+
+  for (i = 0; i < RS_NPAR; i++) {
+    msg[nbytes+i] = LFSR[RS_NPAR-1-i];
+  }
+}
+
+bool rs_check(const unsigned char codeword[], int csize) {
+  unsigned char syndromes[RS_NPAR];
+  return !compute_syndromes(tables(), codeword, csize, syndromes);
+}
+
+int rs_decode(unsigned char codeword[], int csize) {
+  const Tables &t = tables();
+  unsigned char S[RS_NPAR];
+  unsigned char lambda[RS_NPAR+1];
+  unsigned char omega[RS_NPAR];
+  unsigned char derivative[RS_NPAR];
+  int locations[RS_NPAR/2];
+  unsigned char values[RS_NPAR/2];
+  int i, j;
+
+  if (csize <= RS_NPAR || csize > RS_MAX_CODEWORD) {
+    return RS_UNCORRECTABLE;
+  }
+  if (!compute_syndromes(t, codeword, csize, S)) {
+    return 0;
+  }
+
+  const int L = berlekamp_massey(t, S, lambda);
+  if (L > RS_NPAR/2) {
+    return RS_UNCORRECTABLE;
+  }
+
+  /* Omega = S * Lambda mod x^NPAR */
+  for (i = 0; i < RS_NPAR; i++) {
+    unsigned char sum = 0;
+    for (j = 0; j <= i && j <= L; j++) {
+      sum ^= t.mult(lambda[j], S[i-j]);
+    }
+    omega[i] = sum;
+  }
+  /* formal derivative, only odd powers survive in characteristic 2 */
+  for (i = 0; i < RS_NPAR; i++) {
+    derivative[i] = (i & 1) ? 0 : lambda[i+1];
+  }
+
+  /* Chien search over the codeword positions, byte i is the coefficient
+   * of x^(csize-1-i) so its locator is a^(csize-1-i), then Forney */
+  int found = 0;
+  for (i = 0; i < csize; i++) {
+    const int inversePower = 255 - (csize - 1 - i);
+    if (evaluate(t, lambda, L, inversePower) != 0) {
+      continue;
+    }
+    if (found == L) {
+      return RS_UNCORRECTABLE;
+    }
+    const unsigned char denominator = evaluate(t, derivative, RS_NPAR-1, inversePower);
+    if (denominator == 0) {
+      return RS_UNCORRECTABLE;
+    }
+    locations[found] = i;
+    values[found] = t.mult(evaluate(t, omega, RS_NPAR-1, inversePower), t.inv(denominator));
+    found++;
+  }
+  if (found != L) {
+    return RS_UNCORRECTABLE;
+  }
+
+  for (i = 0; i < found; i++) {
+    codeword[locations[i]] ^= values[i];
+  }
+  return found;
+}
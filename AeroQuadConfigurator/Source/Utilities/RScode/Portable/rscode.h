@@ -0,0 +1,52 @@
+/*
+ * Portable Reed Solomon encoder/decoder for the AeroQuad slow telemetry
+ *
+ * Same code as AQ_RSCode.h on the flight controller, GF(2^8) with
+ * x^8 + x^4 + x^3 + x^2 + 1 and generator roots a^1..a^NPAR, so it
+ * decodes what encode_data() sends and is interchangeable with the
+ * rscode based RScode.dll. Unlike rscode it keeps no global decoder
+ * state and builds with any C++ compiler.
+ *
+ * Based on RSCODE, Copyright Henry Minsky (hqm@alum.mit.edu) 1991-2009
+ *
+ * This software library is licensed under terms of the GNU GENERAL
+ * PUBLIC LICENSE
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RSCODE_PORTABLE_H
+#define RSCODE_PORTABLE_H
+
+/* Number of parity bytes, must match the flight controller */
+#define RS_NPAR 8
+
+/* Largest codeword, data plus parity */
+#define RS_MAX_CODEWORD 255
+
+#define RS_UNCORRECTABLE -1
+
+/* Appends RS_NPAR parity bytes to the nbytes of msg */
+void rs_encode(unsigned char msg[], int nbytes);
+
+/* True if the codeword of csize bytes, parity included, has no errors */
+bool rs_check(const unsigned char codeword[], int csize);
+
+/* Corrects up to RS_NPAR/2 wrong bytes in place
+ * Returns the number of bytes corrected, or RS_UNCORRECTABLE with the
+ * codeword left untouched.
+ */
+int rs_decode(unsigned char codeword[], int csize);
+
+#endif
@@ -0,0 +1,191 @@
+/*
+ * Round trip, error injection and speed test of the slow telemetry
+ * Reed Solomon code
+ *
+ * Encodes with the flight controller encoder (AQ_RSCode.h) and checks
+ * it against the portable one, then corrupts 0..NPAR/2 random bytes
+ * of every packet and checks rs_decode() restores it. Packets with
+ * more errors than that must be rejected or at least not crash.
+ *
+ *   make && ./rstest
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include "rscode.h"
+
+/* the flight encoder, built the way AeroQuad32 builds it */
+typedef uint8_t byte;
+#define AeroQuadSTM32
+#include "AQ_RSCode.h"
+
+#define PACKET_DATA 24       /* size of the telemetryPacket */
+#define PACKET_SIZE (PACKET_DATA + RS_NPAR)
+#define TRIALS 200000
+
+#if NPAR != RS_NPAR
+  #error flight and ground parity sizes differ
+#endif
+
+/* the encoder AQ_RSCode.h used before the generator tables, for the benchmark */
+static unsigned char logGexp[512];
+static unsigned char logGlog[256];
+static const unsigned char logGenPoly[NPAR+1] = {0x25,0xe0,0x08,0xac,0x47,0xb2,0x2c,0xe3,0x01};
+
+static void init_log_tables() {
+  unsigned int x = 1;
+  for (int i = 0; i < 255; i++) {
+    logGexp[i] = logGexp[i+255] = (unsigned char)x;
+    logGlog[x] = (unsigned char)i;
+    x <<= 1;
+    if (x & 0x100) x ^= 0x11D;
+  }
+}
+
+static unsigned char log_gmult(unsigned char a, unsigned char b) {
+  if (a == 0 || b == 0) return 0;
+  return logGexp[logGlog[a] + logGlog[b]];
+}
+
+static void log_encode_data(unsigned char msg[], int nbytes) {
+  unsigned char LFSR[NPAR+1], dbyte;
+  int i, j;
+  for (i = 0; i < NPAR+1; i++) LFSR[i] = 0;
+  for (i = 0; i < nbytes; i++) {
+    dbyte = msg[i] ^ LFSR[NPAR-1];
+    for (j = NPAR-1; j > 0; j--) {
+      LFSR[j] = LFSR[j-1] ^ log_gmult(logGenPoly[j], dbyte);
+    }
+    LFSR[0] = log_gmult(logGenPoly[0], dbyte);
+  }
+  for (i = 0; i < NPAR; i++) msg[nbytes+i] = LFSR[NPAR-1-i];
+}
+
+static double seconds() {
+  return (double)clock() / CLOCKS_PER_SEC;
+}
+
+/* corrupts count distinct bytes with non zero error values */
+static void inject_errors(unsigned char packet[], int count) {
+  int positions[PACKET_SIZE];
+  for (int i = 0; i < PACKET_SIZE; i++) positions[i] = i;
+  for (int i = 0; i < count; i++) {
+    const int pick = i + rand() % (PACKET_SIZE - i);
+    const int position = positions[pick];
+    positions[pick] = positions[i];
+    packet[position] ^= (unsigned char)(1 + rand() % 255);
+  }
+}
+
+static void random_packet(unsigned char packet[]) {
+  for (int i = 0; i < PACKET_DATA; i++) packet[i] = (unsigned char)rand();
+}
+
+int main() {
+  unsigned char packet[PACKET_SIZE];
+  unsigned char reference[PACKET_SIZE];
+  unsigned char sent[PACKET_SIZE];
+  int failures = 0;
+
+  srand(1);
+  init_log_tables();
+
+  /* the three encoders agree */
+  for (int trial = 0; trial < TRIALS; trial++) {
+    random_packet(packet);
+    memcpy(reference, packet, PACKET_DATA);
+    memcpy(sent, packet, PACKET_DATA);
+    encode_data(packet, PACKET_DATA);
+    rs_encode(reference, PACKET_DATA);
+    log_encode_data(sent, PACKET_DATA);
+    if (memcmp(packet, reference, PACKET_SIZE) != 0 || memcmp(packet, sent, PACKET_SIZE) != 0) {
+      printf("encoder mismatch on trial %d\n", trial);
+      failures++;
+      break;
+    }
+  }
+  printf("encoders agree on %d packets\n", TRIALS);
+
+  /* up to NPAR/2 errors are always corrected */
+  for (int errors = 0; errors <= RS_NPAR/2; errors++) {
+    int corrected = 0;
+    for (int trial = 0; trial < TRIALS; trial++) {
+      random_packet(sent);
+      encode_data(sent, PACKET_DATA);
+      memcpy(packet, sent, PACKET_SIZE);
+      inject_errors(packet, errors);
+      if (rs_decode(packet, PACKET_SIZE) == errors && memcmp(packet, sent, PACKET_SIZE) == 0) {
+        corrected++;
+      }
+    }
+    printf("%d errors: %d/%d corrected\n", errors, corrected, TRIALS);
+    if (corrected != TRIALS) failures++;
+  }
+
+  /* beyond that, count what is caught and what is miscorrected */
+  for (int errors = RS_NPAR/2 + 1; errors <= RS_NPAR; errors++) {
+    int rejected = 0;
+    int miscorrected = 0;
+    for (int trial = 0; trial < TRIALS; trial++) {
+      random_packet(sent);
+      encode_data(sent, PACKET_DATA);
+      memcpy(packet, sent, PACKET_SIZE);
+      inject_errors(packet, errors);
+      memcpy(reference, packet, PACKET_SIZE);
+      const int result = rs_decode(packet, PACKET_SIZE);
+      if (result == RS_UNCORRECTABLE) {
+        rejected++;
+        if (memcmp(packet, reference, PACKET_SIZE) != 0) failures++;  /* must be left untouched */
+      }
+      else if (!rs_check(packet, PACKET_SIZE)) {
+        failures++;   /* a claimed correction has to be a valid codeword */
+      }
+      else {
+        miscorrected++;
+      }
+    }
+    printf("%d errors: %d rejected, %d miscorrected to another codeword\n", errors, rejected, miscorrected);
+  }
+
+  /* speed */
+  const int runs = 2000000;
+  unsigned int checksum = 0;
+  random_packet(packet);
+  double start = seconds();
+  for (int i = 0; i < runs; i++) {
+    packet[0] = (unsigned char)i;
+    log_encode_data(packet, PACKET_DATA);
+    checksum += packet[PACKET_DATA];
+  }
+  const double logTime = seconds() - start;
+  start = seconds();
+  for (int i = 0; i < runs; i++) {
+    packet[0] = (unsigned char)i;
+    encode_data(packet, PACKET_DATA);
+    checksum += packet[PACKET_DATA];
+  }
+  const double tableTime = seconds() - start;
+  start = seconds();
+  for (int i = 0; i < runs / 10; i++) {
+    random_packet(sent);
+    encode_data(sent, PACKET_DATA);
+    inject_errors(sent, RS_NPAR/2);
+    checksum += rs_decode(sent, PACKET_SIZE);
+  }
+  const double decodeTime = seconds() - start;
+
+  printf("encode, log tables:       %.1f ns/packet\n", logTime / runs * 1e9);
+  printf("encode, generator tables: %.1f ns/packet (%.1fx)\n", tableTime / runs * 1e9, logTime / tableTime);
+  printf("decode with %d errors:     %.1f ns/packet (%u)\n", RS_NPAR/2, decodeTime / (runs / 10) * 1e9, checksum & 1);
+
+  printf(failures ? "FAILED\n" : "PASSED\n");
+  return failures ? 1 : 0;
+}